@@ -79,6 +79,29 @@ typedef int (*send_t) (
 static send_t s_send = DAQ_Inject;
 static uint64_t s_injects = 0;
 
+// injection queue for config response: batch <n>; s_send queues
+// and s_xmit is the actual sender.  resets and unreachables are well
+// under a slot; only large data responses bypass the queue.
+#define FRAME_MAX (ETHERNET_HEADER_LEN + 2*VLAN_HEADER_LEN + ETHERNET_MTU + 64)
+
+typedef struct
+{
+    DAQ_PktHdr_t hdr;
+    int rev;
+    uint32_t len;
+    uint8_t* frame;
+} InjectSlot;
+
+static send_t s_xmit = DAQ_Inject;
+static InjectSlot* s_queue = NULL;
+static uint8_t* s_frames = NULL;
+static unsigned s_queue_max = 0;
+static unsigned s_queued = 0;
+
+static int Active_QueueFrame(const DAQ_PktHdr_t*, int, const uint8_t*, uint32_t);
+static void Active_InitQueue(unsigned);
+static void Active_TermQueue(void);
+
 static inline PROTO_ID GetInnerProto (const Packet* p)
 {
     if ( !p->next_layer ) return PROTO_MAX;
@@ -201,11 +224,16 @@ int Active_Init (SnortConfig* sc)
         if (NULL != sc->eth_dst)
             Encode_SetDstMAC(sc->eth_dst);
     }
+    if ( s_enabled && s_attempts && sc->respond_batch )
+        Active_InitQueue(sc->respond_batch);
+
     return 0;
 }
 
 int Active_Term (void)
 {
+    // the daq is already gone so anything still queued is dropped
+    Active_TermQueue();
     Active_Close();
     return 0;
 }
@@ -285,6 +313,89 @@ void Active_SendData (
     }
 }
 
+//--------------------------------------------------------------------
+// injection queue
+//
+// injecting from the middle of packet processing holds up the rest of
+// the burst, so when batching is configured the encoded frames are
+// copied to preallocated slots and sent after the burst.  the daq
+// header is copied with each frame; daqs that need more than the
+// header to inject (eg those that reuse state of the last packet
+// read) must not batch.
+
+static void Active_InitQueue (unsigned max)
+{
+    unsigned i;
+
+    s_queue = (InjectSlot*)SnortAlloc(max * sizeof(*s_queue));
+    s_frames = (uint8_t*)SnortAlloc(max * FRAME_MAX);
+
+    for ( i = 0; i < max; i++ )
+        s_queue[i].frame = s_frames + i * FRAME_MAX;
+
+    s_queue_max = max;
+    s_queued = 0;
+
+    s_xmit = s_send;
+    s_send = Active_QueueFrame;
+}
+
+static void Active_TermQueue (void)
+{
+    if ( !s_queue )
+        return;
+
+    s_send = s_xmit;
+
+    free(s_queue);
+    free(s_frames);
+
+    s_queue = NULL;
+    s_frames = NULL;
+    s_queue_max = s_queued = 0;
+}
+
+static int Active_QueueFrame (
+    const DAQ_PktHdr_t* h, int rev, const uint8_t* buf, uint32_t len)
+{
+    InjectSlot* slot;
+
+    if ( len > FRAME_MAX )
+    {
+        // keep the order on the wire
+        Active_SendQueued();
+        return s_xmit(h, rev, buf, len);
+    }
+    if ( s_queued == s_queue_max )
+        Active_SendQueued();
+
+    slot = s_queue + s_queued++;
+
+    slot->hdr = *h;
+    slot->rev = rev;
+    slot->len = len;
+    memcpy(slot->frame, buf, len);
+
+    return 0;
+}
+
+void Active_SendQueued (void)
+{
+    unsigned i;
+
+    for ( i = 0; i < s_queued; i++ )
+    {
+        InjectSlot* slot = s_queue + i;
+        s_xmit(&slot->hdr, slot->rev, slot->frame, slot->len);
+    }
+    s_queued = 0;
+}
+
+unsigned Active_GetBurst (void)
+{
+    return s_queue_max;
+}
+
 //--------------------------------------------------------------------
 
 int Active_IsRSTCandidate(const Packet* p)
@@ -46,6 +46,12 @@ int Active_ResetQueue(void);
 int Active_SendResponses(Packet*);
 uint64_t Active_GetInjects(void);
 
+// with config response: batch <n>, injected frames are queued and
+// sent by this after each DAQ_Acquire(); bursts are limited to the
+// queue size, which is returned by Active_GetBurst() (0 if disabled)
+void Active_SendQueued(void);
+unsigned Active_GetBurst(void);
+
 // NULL flags implies ENC_FLAG_FWD
 void Active_KillSession(Packet*, EncodeFlags*);
 
@@ -0,0 +1,462 @@
+/****************************************************************************
+ *
+ * Copyright (C) 2013 Sourcefire, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 2 as
+ * published by the Free Software Foundation.  You may not use, modify or
+ * distribute this program under any other version of the GNU General
+ * Public License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ ****************************************************************************/
+
+// @file    bypass.c
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include "bypass.h"
+#include "decode.h"
+#include "snort.h"
+#include "util.h"
+#include "sfhashfcn.h"
+#include "stream_api.h"
+#include "stream5_common.h"
+
+//--------------------------------------------------------------------
+// the table is set associative; each row holds BYPASS_WAYS flows and a
+// new flow replaces an idle or the least recently seen one in its row.
+// keys are ordered so that both directions of a flow share an entry.
+
+#define BYPASS_WAYS 4
+
+#define ETH_HDR_LEN  14
+#define VLAN_HDR_LEN  4
+
+#define TH_FLAGS_CLOSE (TH_SYN | TH_FIN | TH_RST)
+
+typedef struct _BypassKey
+{
+    uint32_t ip_lo[4];
+    uint32_t ip_hi[4];
+    uint16_t port_lo;
+    uint16_t port_hi;
+    uint16_t vlan;
+    uint16_t addr_space;
+    uint8_t  proto;
+    uint8_t  family;
+    uint16_t pad;
+} BypassKey;
+
+typedef struct _BypassEntry
+{
+    BypassKey key;
+    uint32_t last_seen;
+    uint8_t  verdict;
+    uint8_t  used;
+} BypassEntry;
+
+typedef struct _BypassTable
+{
+    BypassEntry* rows;
+    uint32_t mask;       // number of rows - 1
+    int dlt;
+} BypassTable;
+
+void* bypass_table = NULL;
+
+static BypassTable s_table;
+
+//--------------------------------------------------------------------
+// raw header parsing
+// only the plain cases are handled: optional single vlan tag, ip4 with
+// any options or ip6 without extension headers, unfragmented tcp/udp.
+// anything else is left to the full decoder.
+//--------------------------------------------------------------------
+
+static inline uint16_t get16 (const uint8_t* p)
+{
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static inline void Bypass_SetKey (
+    BypassKey* key, const uint32_t* src, const uint32_t* dst,
+    uint16_t sp, uint16_t dp, int words)
+{
+    int cmp = memcmp(src, dst, words * sizeof(uint32_t));
+
+    if ( cmp < 0 || (cmp == 0 && sp <= dp) )
+    {
+        memcpy(key->ip_lo, src, words * sizeof(uint32_t));
+        memcpy(key->ip_hi, dst, words * sizeof(uint32_t));
+        key->port_lo = sp;
+        key->port_hi = dp;
+    }
+    else
+    {
+        memcpy(key->ip_lo, dst, words * sizeof(uint32_t));
+        memcpy(key->ip_hi, src, words * sizeof(uint32_t));
+        key->port_lo = dp;
+        key->port_hi = sp;
+    }
+}
+
+// returns the tcp flags (or 0 for udp) + 1 on success, 0 on failure
+static int Bypass_GetKey (
+    const DAQ_PktHdr_t* pkth, const uint8_t* pkt, BypassKey* key)
+{
+    const uint8_t* end = pkt + pkth->caplen;
+    const uint8_t* l3 = pkt;
+    const uint8_t* l4;
+    uint32_t src[4], dst[4];
+    uint16_t type;
+    int words;
+
+    memset(key, 0, sizeof(*key));
+
+    if ( s_table.dlt == DLT_EN10MB )
+    {
+        if ( end - pkt < ETH_HDR_LEN )
+            return 0;
+
+        type = get16(pkt + 12);
+        l3 = pkt + ETH_HDR_LEN;
+
+        if ( type == ETHERNET_TYPE_8021Q )
+        {
+            if ( end - l3 < VLAN_HDR_LEN )
+                return 0;
+
+            if ( !ScVlanAgnostic() )
+                key->vlan = get16(l3) & 0x0FFF;
+
+            type = get16(l3 + 2);
+            l3 += VLAN_HDR_LEN;
+        }
+    }
+    else
+    {
+        if ( end - l3 < 1 )
+            return 0;
+
+        type = ((l3[0] >> 4) == 6) ? ETHERNET_TYPE_IPV6 : ETHERNET_TYPE_IP;
+    }
+
+#ifdef HAVE_DAQ_ADDRESS_SPACE_ID
+    if ( !ScAddressSpaceAgnostic() )
+        key->addr_space = pkth->address_space_id;
+#endif
+
+    if ( type == ETHERNET_TYPE_IP )
+    {
+        unsigned hlen;
+
+        if ( end - l3 < IP_HEADER_LEN || (l3[0] >> 4) != 4 )
+            return 0;
+
+        hlen = (l3[0] & 0x0F) << 2;
+
+        // fragments, including first fragments, need frag3
+        if ( hlen < IP_HEADER_LEN || (get16(l3 + 6) & 0x3FFF) )
+            return 0;
+
+        key->proto = l3[9];
+        key->family = 4;
+        memcpy(src, l3 + 12, 4);
+        memcpy(dst, l3 + 16, 4);
+        words = 1;
+        l4 = l3 + hlen;
+    }
+    else if ( type == ETHERNET_TYPE_IPV6 )
+    {
+        if ( end - l3 < IP6_HDR_LEN || (l3[0] >> 4) != 6 )
+            return 0;
+
+        key->proto = l3[6];
+        key->family = 6;
+        memcpy(src, l3 + 8, 16);
+        memcpy(dst, l3 + 24, 16);
+        words = 4;
+        l4 = l3 + IP6_HDR_LEN;
+    }
+    else
+        return 0;
+
+    if ( key->proto == IPPROTO_TCP )
+    {
+        if ( end - l4 < TCP_HEADER_LEN )
+            return 0;
+
+        Bypass_SetKey(key, src, dst, get16(l4), get16(l4 + 2), words);
+        return l4[13] + 1;
+    }
+    if ( key->proto == IPPROTO_UDP )
+    {
+        if ( end - l4 < UDP_HEADER_LEN )
+            return 0;
+
+        Bypass_SetKey(key, src, dst, get16(l4), get16(l4 + 2), words);
+        return 1;
+    }
+    return 0;
+}
+
+static inline BypassEntry* Bypass_GetRow (const BypassKey* key)
+{
+    const uint32_t* k = (const uint32_t*)key;
+    uint32_t a, b, c;
+
+    a = k[0] ^ k[4];
+    b = k[1] ^ k[5] ^ k[8];
+    c = k[2] ^ k[6] ^ k[9];
+    mix(a, b, c);
+    a += k[3] ^ k[7];
+    b += k[10];
+    final(a, b, c);
+
+    return s_table.rows + (c & s_table.mask) * BYPASS_WAYS;
+}
+
+// bypassed packets never reach stream; keep the flow's session alive
+// with them.  returns 0 if stream no longer has the session.
+static int Bypass_Refresh (const BypassKey* key, uint32_t now)
+{
+    sfip_t lo, hi;
+    int family = (key->family == 6) ? AF_INET6 : AF_INET;
+
+    sfip_set_raw(&lo, (void*)key->ip_lo, family);
+    sfip_set_raw(&hi, (void*)key->ip_hi, family);
+
+    return refreshLWSession(&lo, key->port_lo, &hi, key->port_hi,
+        (char)key->proto, key->vlan, key->addr_space, (time_t)now);
+}
+
+//--------------------------------------------------------------------
+// api
+//--------------------------------------------------------------------
+
+void Bypass_Init (SnortConfig* sc, int dlt)
+{
+    uint32_t rows = 1;
+
+    if ( !sc->bypass_flows )
+        return;
+
+    switch ( dlt )
+    {
+    case DLT_EN10MB:
+    case DLT_RAW:
+    case DLT_IPV4:
+    case DLT_IPV6:
+        break;
+
+    default:
+        Bypass_Term();
+        return;
+    }
+    s_table.dlt = dlt;
+
+    if ( bypass_table )
+    {
+        Bypass_Reset();
+        return;
+    }
+
+    while ( rows * BYPASS_WAYS < sc->bypass_flows )
+        rows <<= 1;
+
+    s_table.rows = (BypassEntry*)SnortAlloc(rows * BYPASS_WAYS * sizeof(BypassEntry));
+    s_table.mask = rows - 1;
+
+    bypass_table = &s_table;
+}
+
+void Bypass_Term (void)
+{
+    if ( s_table.rows )
+        free(s_table.rows);
+
+    memset(&s_table, 0, sizeof(s_table));
+    bypass_table = NULL;
+}
+
+void Bypass_Reset (void)
+{
+    if ( !bypass_table )
+        return;
+
+    memset(s_table.rows, 0,
+        (s_table.mask + 1) * BYPASS_WAYS * sizeof(BypassEntry));
+}
+
+int Bypass_Add (Packet* p, DAQ_Verdict verdict)
+{
+    BypassKey key;
+    BypassEntry* row;
+    BypassEntry* slot = NULL;
+    uint32_t now;
+    int i, flags;
+
+    if ( !bypass_table || !p->pkth || !p->pkt )
+        return 0;
+
+    // the key must describe the same flow stream ignored, so skip
+    // anything tunneled, fragmented, or otherwise decoded beyond
+    // what Bypass_GetKey() understands.
+    if ( !IPH_IS_VALID(p) || p->outer_iph || p->encapsulated ||
+        p->GTPencapsulated || p->frag_flag )
+        return 0;
+
+    flags = Bypass_GetKey(p->pkth, p->pkt, &key);
+
+    if ( !flags || (--flags & TH_FLAGS_CLOSE) )
+        return 0;
+
+    if ( key.proto != GET_IPH_PROTO(p) )
+        return 0;
+
+    if ( !((key.port_lo == p->sp && key.port_hi == p->dp) ||
+           (key.port_lo == p->dp && key.port_hi == p->sp)) )
+        return 0;
+
+    // udp may carry tunnels the decoder only recognizes by inspection
+    if ( key.proto == IPPROTO_UDP )
+    {
+        if ( ScDeepTeredoInspection() ||
+            p->sp == TEREDO_PORT || p->dp == TEREDO_PORT )
+            return 0;
+
+        if ( ScGTPDecoding() && (ScIsGTPPort(p->sp) || ScIsGTPPort(p->dp)) )
+            return 0;
+    }
+
+    now = (uint32_t)p->pkth->ts.tv_sec;
+    row = Bypass_GetRow(&key);
+
+    for ( i = 0; i < BYPASS_WAYS; i++ )
+    {
+        BypassEntry* e = row + i;
+
+        if ( e->used && !memcmp(&e->key, &key, sizeof(key)) )
+        {
+            slot = e;
+            break;
+        }
+        if ( !slot || !e->used ||
+            (slot->used && e->last_seen < slot->last_seen) )
+        {
+            slot = e;
+        }
+    }
+
+    if ( !slot->used || memcmp(&slot->key, &key, sizeof(key)) )
+    {
+        if ( slot->used )
+            pc.bypass_evicts++;
+
+        pc.bypass_flows++;
+    }
+
+    slot->key = key;
+    slot->last_seen = now;
+    slot->verdict = (uint8_t)verdict;
+    slot->used = 1;
+
+    return 1;
+}
+
+void Bypass_Remove (const StreamSessionKey* skey, int ip6)
+{
+    BypassKey key;
+    BypassEntry* row;
+    int i;
+
+    if ( skey->protocol != IPPROTO_TCP && skey->protocol != IPPROTO_UDP )
+        return;
+
+    // mpls and gtp flows are never added
+    if ( skey->mplsLabel || skey->tunnelId )
+        return;
+
+    memset(&key, 0, sizeof(key));
+    key.proto = skey->protocol;
+    key.family = ip6 ? 6 : 4;
+    key.vlan = skey->vlan_tag;
+    key.addr_space = skey->addressSpaceId;
+
+    Bypass_SetKey(&key, skey->ip_l, skey->ip_h,
+        skey->port_l, skey->port_h, ip6 ? 4 : 1);
+
+    row = Bypass_GetRow(&key);
+
+    for ( i = 0; i < BYPASS_WAYS; i++ )
+    {
+        BypassEntry* e = row + i;
+
+        if ( e->used && !memcmp(&e->key, &key, sizeof(key)) )
+        {
+            e->used = 0;
+            return;
+        }
+    }
+}
+
+int Bypass_Check (
+    const DAQ_PktHdr_t* pkth, const uint8_t* pkt, DAQ_Verdict* verdict)
+{
+    BypassKey key;
+    BypassEntry* row;
+    uint32_t now;
+    int i, flags;
+
+    flags = Bypass_GetKey(pkth, pkt, &key);
+
+    if ( !flags )
+        return 0;
+
+    row = Bypass_GetRow(&key);
+
+    for ( i = 0; i < BYPASS_WAYS; i++ )
+    {
+        BypassEntry* e = row + i;
+
+        if ( !e->used || memcmp(&e->key, &key, sizeof(key)) )
+            continue;
+
+        now = (uint32_t)pkth->ts.tv_sec;
+
+        if ( (--flags & TH_FLAGS_CLOSE) ||
+            (now - e->last_seen > ScBypassTimeout()) )
+        {
+            e->used = 0;
+            return 0;
+        }
+
+        // sessions only track time to the second
+        if ( e->last_seen != now )
+        {
+            if ( !Bypass_Refresh(&e->key, now) )
+            {
+                e->used = 0;
+                return 0;
+            }
+            e->last_seen = now;
+        }
+        *verdict = (DAQ_Verdict)e->verdict;
+        return 1;
+    }
+    return 0;
+}
+
@@ -0,0 +1,84 @@
+/****************************************************************************
+ *
+ * Copyright (C) 2013 Sourcefire, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 2 as
+ * published by the Free Software Foundation.  You may not use, modify or
+ * distribute this program under any other version of the GNU General
+ * Public License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ ****************************************************************************/
+
+// @file    bypass.h
+
+// Fast path for flows that have already been whitelisted, ignored, or
+// trusted.  Once stream ignores both directions of a session the only
+// thing left to do for its packets is return the same verdict, so the
+// 5-tuple is recorded here and PacketCallback() answers later packets
+// straight from the raw header, before decode and preprocessing.
+//
+// The table is enabled with "config bypass_flows: <n>".  Entries idle
+// for "config bypass_timeout: <secs>" are dropped, as are entries for
+// TCP flows that see SYN, FIN or RST so that connection setup and
+// teardown always take the full path.  Bypassed packets refresh the
+// stream session (at most once a second), so a long-lived flow keeps
+// both its session and its entry.  An entry still goes away with its
+// session when stream prunes or deletes it, and a packet whose session
+// is already gone takes the full path.
+
+#ifndef __BYPASS_H__
+#define __BYPASS_H__
+
+#include "decode.h"
+#include "snort.h"
+
+#define DEFAULT_BYPASS_TIMEOUT 60
+#define MAX_BYPASS_TIMEOUT     86400U
+#define MAX_BYPASS_FLOWS       (1U << 24)
+
+void Bypass_Init(SnortConfig*, int dlt);
+void Bypass_Term(void);
+
+// forget all flows; used when stream state is reset
+void Bypass_Reset(void);
+
+// record the verdict given to the (wire) packet's flow
+int Bypass_Add(Packet*, DAQ_Verdict);
+
+int Bypass_Check(const DAQ_PktHdr_t*, const uint8_t*, DAQ_Verdict*);
+
+struct _StreamSessionKey;
+void Bypass_Remove(const struct _StreamSessionKey*, int ip6);
+
+extern void* bypass_table;
+
+// returns 1 and sets the verdict if the packet belongs to a bypassed flow
+static inline int Bypass_Lookup (
+    const DAQ_PktHdr_t* pkth, const uint8_t* pkt, DAQ_Verdict* verdict)
+{
+    if ( !bypass_table )
+        return 0;
+
+    return Bypass_Check(pkth, pkt, verdict);
+}
+
+// forget the flow of a session that stream is deleting
+static inline void Bypass_RemoveSession (
+    const struct _StreamSessionKey* key, int ip6)
+{
+    if ( bypass_table )
+        Bypass_Remove(key, ip6);
+}
+
+#endif // __BYPASS_H__
+
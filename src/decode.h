@@ -2099,5 +2099,28 @@ static inline void SetExtraData (Packet* p, uint32_t xid)
     p->xtradata_mask |= BIT(xid);
 }
 
+/* Gets the TEID of the GTPv1 tunnel a packet arrived in.  A TEID is
+ * allocated by the receiving end of the tunnel, so the two directions
+ * of a bearer carry different TEIDs. */
+static inline bool GetGTPTeid (const Packet* p, uint32_t* teid)
+{
+    int i;
+
+    for (i = 0; i < p->next_layer; i++)
+    {
+        const uint8_t *hdr = p->layers[i].start;
+
+        if (p->layers[i].proto != PROTO_GTP)
+            continue;
+
+        if (((hdr[0] & 0xE0) >> 5) != 1)
+            return false;
+
+        *teid = ntohl(*(uint32_t *)(hdr + 4));
+        return true;
+    }
+    return false;
+}
+
 #endif  /* __DECODE_H__ */
 
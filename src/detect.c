@@ -1096,6 +1096,91 @@ int RuleListEnd(Packet *p, struct _RuleTreeNode *rtn_idx,
     return 1;
 }
 
+static inline int RulePortsHavePort(const RulePortRange *ranges,
+        unsigned int num_ranges, uint16_t port)
+{
+    unsigned int i;
+
+    for (i = 0; i < num_ranges; i++)
+    {
+        if ((port >= ranges[i].lport) && (port <= ranges[i].hport))
+            return 1;
+    }
+
+    return 0;
+}
+
+/****************************************************************************
+ *
+ * Function: CheckRuleHeader(Packet *, struct _RuleTreeNode *, int)
+ *
+ * Purpose: Evaluate the header checks compiled into the RTN by
+ *          SetupRTNFuncList() in one pass.  This gives the same result as
+ *          walking the rule_func list, in the same order, without an
+ *          indirect call per check.
+ *
+ * Arguments: p => ptr to the decoded packet data structure
+ *            rtn_idx => ptr to the current rule data struct
+ *            check_ports => whether to check ports (see TARGET_BASED)
+ *
+ * Returns: 0 on failure (no match), 1 on success (match)
+ *
+ ***************************************************************************/
+int CheckRuleHeader(Packet *p, struct _RuleTreeNode *rtn_idx, int check_ports)
+{
+    uint32_t checks = rtn_idx->header_checks;
+
+    if (checks & RULE_HDR_CHECK_BIDIRECTIONAL)
+        return CheckBidirectional(p, rtn_idx, NULL, check_ports);
+
+#ifdef TARGET_BASED
+    if (check_ports)
+#endif
+    {
+        if (checks & RULE_HDR_CHECK_DST_PORT)
+        {
+            if (!RulePortsHavePort(rtn_idx->dst_ports, rtn_idx->num_dst_ports, p->dp))
+                return 0;
+        }
+        else if (checks & RULE_HDR_CHECK_DST_PORT_NOT)
+        {
+            if (RulePortsHavePort(rtn_idx->dst_ports, rtn_idx->num_dst_ports, p->dp))
+                return 0;
+        }
+
+        if (checks & RULE_HDR_CHECK_SRC_PORT)
+        {
+            if (!RulePortsHavePort(rtn_idx->src_ports, rtn_idx->num_src_ports, p->sp))
+                return 0;
+        }
+        else if (checks & RULE_HDR_CHECK_SRC_PORT_NOT)
+        {
+            if (RulePortsHavePort(rtn_idx->src_ports, rtn_idx->num_src_ports, p->sp))
+                return 0;
+        }
+    }
+
+    if (checks & RULE_HDR_CHECK_SRC_IP)
+    {
+        /* with the global exception flag up the address must not match */
+        int in_set = sfvar_ip_in(rtn_idx->sip, GET_SRC_IP(p)) ? 1 : 0;
+
+        if (in_set == ((rtn_idx->flags & EXCEPT_SRC_IP) ? 1 : 0))
+            return 0;
+    }
+
+    if (checks & RULE_HDR_CHECK_DST_IP)
+    {
+        /* with the global exception flag up the address must not match */
+        int in_set = sfvar_ip_in(rtn_idx->dip, GET_DST_IP(p)) ? 1 : 0;
+
+        if (in_set == ((rtn_idx->flags & EXCEPT_DST_IP) ? 1 : 0))
+            return 0;
+    }
+
+    return 1;
+}
+
 
 int OptListEnd(void *option_data, Packet *p)
 {
@@ -74,6 +74,7 @@ int CheckSrcPortNotEq(Packet *, struct _RuleTreeNode *, RuleFpList *, int);
 int CheckDstPortNotEq(Packet *, struct _RuleTreeNode *, RuleFpList *, int);
 
 int RuleListEnd(Packet *, struct _RuleTreeNode *, RuleFpList *, int);
+int CheckRuleHeader(Packet *, struct _RuleTreeNode *, int);
 int OptListEnd(void *option_data, Packet *p);
 
 void CallLogPlugins(Packet *, char *, Event *);
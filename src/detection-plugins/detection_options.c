@@ -791,6 +791,90 @@ void print_option_tree(detection_option_tree_node_t *node, int level)
 }
 #endif
 
+static void detection_option_tree_size(detection_option_tree_node_t *node,
+        int *num_nodes, int *num_links)
+{
+    int i;
+
+    (*num_nodes)++;
+    *num_links += node->num_children;
+
+    for (i = 0; i < node->num_children; i++)
+        detection_option_tree_size(node->children[i], num_nodes, num_links);
+}
+
+static detection_option_eval_op_t detection_option_eval_op(detection_option_tree_node_t *node)
+{
+    if (node->evaluate == CheckANDPatternMatch)
+        return DETECTION_EVAL_CONTENT;
+    if (node->evaluate == CheckUriPatternMatch)
+        return DETECTION_EVAL_URI_CONTENT;
+    if (node->evaluate == SnortPcre)
+        return DETECTION_EVAL_PCRE;
+    if (node->evaluate == ByteTest)
+        return DETECTION_EVAL_BYTE_TEST;
+    if (node->evaluate == ByteJump)
+        return DETECTION_EVAL_BYTE_JUMP;
+    if (node->evaluate == FlowBitsCheck)
+        return DETECTION_EVAL_FLOWBITS;
+
+    return DETECTION_EVAL_INDIRECT;
+}
+
+static detection_option_tree_node_t *detection_option_tree_copy(
+        detection_option_tree_node_t *node, detection_option_tree_node_t **next_node,
+        detection_option_tree_node_t ***next_link)
+{
+    detection_option_tree_node_t *copy = (*next_node)++;
+    int i;
+
+    *copy = *node;
+    copy->is_flat = 1;
+    copy->eval_op = (uint8_t)detection_option_eval_op(node);
+
+    if (node->num_children == 0)
+    {
+        copy->children = NULL;
+        return copy;
+    }
+
+    copy->children = *next_link;
+    *next_link += node->num_children;
+
+    for (i = 0; i < node->num_children; i++)
+        copy->children[i] = detection_option_tree_copy(node->children[i], next_node, next_link);
+
+    return copy;
+}
+
+/* Copies a finished tree into a single allocation with the nodes in
+ * pre-order, followed by the children arrays, so that evaluating a branch
+ * walks forward through memory.  The root is the start of the block and
+ * freeing it frees the whole tree. */
+detection_option_tree_node_t *flatten_detection_option_tree(detection_option_tree_node_t *node)
+{
+    detection_option_tree_node_t *block, *next_node;
+    detection_option_tree_node_t **next_link;
+    int num_nodes = 0, num_links = 0;
+
+    if (node == NULL)
+        return NULL;
+
+    detection_option_tree_size(node, &num_nodes, &num_links);
+
+    block = (detection_option_tree_node_t *)SnortAlloc(
+        (num_nodes * sizeof(detection_option_tree_node_t)) +
+        (num_links * sizeof(detection_option_tree_node_t *)));
+
+    next_node = block;
+    next_link = (detection_option_tree_node_t **)(block + num_nodes);
+
+    return detection_option_tree_copy(node, &next_node, &next_link);
+}
+
+/* Returns the tree to use in place of option_tree in *existing_data, either
+ * an equal one already added or the flattened copy of this one.  The caller
+ * frees option_tree either way. */
 int add_detection_option_tree(SnortConfig *sc, detection_option_tree_node_t *option_tree, void **existing_data)
 {
     detection_option_key_t key;
@@ -819,12 +903,38 @@ int add_detection_option_tree(SnortConfig *sc, detection_option_tree_node_t *opt
         return DETECTION_OPTION_EQUAL;
     }
 
-    sfxhash_add(sc->detection_option_tree_hash_table, &key, option_tree);
+    *existing_data = flatten_detection_option_tree(option_tree);
+    key.option_data = *existing_data;
+
+    sfxhash_add(sc->detection_option_tree_hash_table, &key, *existing_data);
     return DETECTION_OPTION_NOT_EQUAL;
 }
 
 uint64_t rule_eval_pkt_count = 0;
 
+static inline int detection_option_call(detection_option_tree_node_t *node,
+        void *option_data, Packet *p)
+{
+    switch (node->eval_op)
+    {
+        case DETECTION_EVAL_CONTENT:
+            return CheckANDPatternMatch(option_data, p);
+        case DETECTION_EVAL_URI_CONTENT:
+            return CheckUriPatternMatch(option_data, p);
+        case DETECTION_EVAL_PCRE:
+            return SnortPcre(option_data, p);
+        case DETECTION_EVAL_BYTE_TEST:
+            return ByteTest(option_data, p);
+        case DETECTION_EVAL_BYTE_JUMP:
+            return ByteJump(option_data, p);
+        case DETECTION_EVAL_FLOWBITS:
+            return FlowBitsCheck(option_data, p);
+        default:
+            break;
+    }
+    return node->evaluate(option_data, p);
+}
+
 int detection_option_node_evaluate(detection_option_tree_node_t *node, detection_option_eval_data_t *eval_data)
 {
     int i, result = 0, prior_result = 0;
@@ -1059,19 +1169,19 @@ int detection_option_node_evaluate(detection_option_tree_node_t *node, detection
                         }
                     }
 
-                    rval = node->evaluate(&dup_content_option_data, eval_data->p);
+                    rval = detection_option_call(node, &dup_content_option_data, eval_data->p);
                 }
                 break;
             case RULE_OPTION_TYPE_CONTENT_URI:
                 if (node->evaluate)
                 {
-                    rval = node->evaluate(&dup_content_option_data, eval_data->p);
+                    rval = detection_option_call(node, &dup_content_option_data, eval_data->p);
                 }
                 break;
             case RULE_OPTION_TYPE_PCRE:
                 if (node->evaluate)
                 {
-                    rval = node->evaluate(&dup_pcre_option_data, eval_data->p);
+                    rval = detection_option_call(node, &dup_pcre_option_data, eval_data->p);
                 }
                 break;
             case RULE_OPTION_TYPE_PKT_DATA:
@@ -1080,7 +1190,7 @@ int detection_option_node_evaluate(detection_option_tree_node_t *node, detection
                 if (node->evaluate)
                 {
                     save_dflags = Get_DetectFlags();
-                    rval = node->evaluate(node->option_data, eval_data->p);
+                    rval = detection_option_call(node, node->option_data, eval_data->p);
                 }
                 break;
             case RULE_OPTION_TYPE_FLOWBIT:
@@ -1089,7 +1199,7 @@ int detection_option_node_evaluate(detection_option_tree_node_t *node, detection
                     flowbits_setoperation = FlowBits_SetOperation(node->option_data);
                     if (!flowbits_setoperation)
                     {
-                        rval = node->evaluate(node->option_data, eval_data->p);
+                        rval = detection_option_call(node, node->option_data, eval_data->p);
                     }
                     else
                     {
@@ -1136,11 +1246,11 @@ int detection_option_node_evaluate(detection_option_tree_node_t *node, detection
             case RULE_OPTION_TYPE_HDR_OPT_CHECK:
             case RULE_OPTION_TYPE_PREPROCESSOR:
                 if (node->evaluate)
-                    rval = node->evaluate(node->option_data, eval_data->p);
+                    rval = detection_option_call(node, node->option_data, eval_data->p);
                 break;
             case RULE_OPTION_TYPE_DYNAMIC:
                 if (node->evaluate)
-                    rval = node->evaluate(node->option_data, eval_data->p);
+                    rval = detection_option_call(node, node->option_data, eval_data->p);
                 break;
         }
 
@@ -1394,7 +1504,7 @@ int detection_option_node_evaluate(detection_option_tree_node_t *node, detection
     {
         /* Do any setting/clearing/resetting/toggling of flowbits here
          * given that other rule options matched. */
-        rval = node->evaluate(node->option_data, eval_data->p);
+        rval = detection_option_call(node, node->option_data, eval_data->p);
         if (rval != DETECTION_OPTION_MATCH)
         {
             result = rval;
@@ -51,10 +51,27 @@
 
 typedef int (*eval_func_t)(void *option_data, Packet *p);
 
+/* How detection_option_node_evaluate() calls a node's evaluate function.
+ * The common options are called directly instead of through the pointer;
+ * set when the tree is flattened. */
+typedef enum _detection_option_eval_op
+{
+    DETECTION_EVAL_INDIRECT = 0,
+    DETECTION_EVAL_CONTENT,
+    DETECTION_EVAL_URI_CONTENT,
+    DETECTION_EVAL_PCRE,
+    DETECTION_EVAL_BYTE_TEST,
+    DETECTION_EVAL_BYTE_JUMP,
+    DETECTION_EVAL_FLOWBITS
+
+} detection_option_eval_op_t;
+
 typedef struct _detection_option_tree_node
 {
     void *option_data;
     option_type_t option_type;
+    uint8_t eval_op;    /* detection_option_eval_op_t */
+    uint8_t is_flat;    /* part of a tree allocated as one block */
     eval_func_t evaluate;
     int num_children;
     struct _detection_option_tree_node **children;
@@ -105,6 +122,7 @@ typedef struct _detection_option_eval_data
 
 int add_detection_option(struct _SnortConfig *, option_type_t type, void *option_data, void **existing_data);
 int add_detection_option_tree(struct _SnortConfig *, detection_option_tree_node_t *option_tree, void **existing_data);
+detection_option_tree_node_t *flatten_detection_option_tree(detection_option_tree_node_t *node);
 int detection_option_node_evaluate(detection_option_tree_node_t *node, detection_option_eval_data_t *eval_data);
 void DetectionHashTableFree(SFXHASH *);
 void DetectionTreeHashTableFree(SFXHASH *);
@@ -228,7 +228,7 @@ void FlowInit(struct _SnortConfig *sc, char *data, OptTreeNode *otn, int protoco
 
     if(protocol == IPPROTO_UDP)
     {
-        if (!stream_api || (stream_api->version != STREAM_API_VERSION5))
+        if (!stream_api || (stream_api->version != STREAM_API_VERSION7))
         {
             FatalError("%s(%d): Cannot check flow connection "
                    "for UDP traffic\n", file_name, file_line);
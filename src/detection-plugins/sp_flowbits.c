@@ -293,7 +293,7 @@ static void FlowBitsInit(struct _SnortConfig *sc, char *data, OptTreeNode *otn,
         return;
 
     /* Flow bits are handled by Stream5 if its enabled */
-    if( stream_api && stream_api->version != STREAM_API_VERSION5)
+    if( stream_api && stream_api->version != STREAM_API_VERSION7)
     {
         if (ScConfErrorOut())
         {
@@ -377,7 +377,9 @@ static void udpateFlowBitGroupInfo(FLOWBITS_GRP *flowbits_grp, char *flowbitName
     if (!groupName)
         return;
 
-    flowbits_grp->count++;
+    /* count distinct members; the same bit may be named by many rules */
+    if (!boIsBitSet(&(flowbits_grp->GrpBitOp), flowbits_item->id))
+        flowbits_grp->count++;
     if ( flowbits_grp->max_id < flowbits_item->id )
         flowbits_grp->max_id = flowbits_item->id;
     boSetBit(&(flowbits_grp->GrpBitOp),flowbits_item->id);
@@ -837,63 +839,263 @@ static void FlowBitsParse(struct _SnortConfig *sc, char *data, FLOWBITS_OP *flow
     mSplitFree(&toks, num_toks);
 }
 
-static inline int boUnSetGrpBit(BITOP *BitOp, char *group)
+/*
+**  Per-session flowbits start out as a short unordered list of set ids
+**  (see StreamFlowData) and are converted to the full bitmap the first
+**  time the list would overflow.  Only the list is pooled with the
+**  session; the bitmap is allocated on conversion and freed when the
+**  flowbits are reset or handed back.  Group operations on the bitmap
+**  work a machine word at a time against the group's precomputed mask.
+*/
+static inline int flowbitsIsDense(StreamFlowData *flowdata)
 {
-    FLOWBITS_GRP *flowbits_grp;
-    BITOP *GrpBitOp;
-    unsigned int i, max_bytes;
+    return flowdata->boFlowbits.pucBitBuffer != NULL;
+}
 
-    if( group == NULL )
-        return 0;
-    flowbits_grp = (FLOWBITS_GRP *)sfghash_find(flowbits_grp_hash, group);
-    if( flowbits_grp == NULL )
-        return 0;
-    if((BitOp == NULL) || (BitOp->uiMaxBits <= flowbits_grp->max_id) || flowbits_grp->count == 0)
+static inline int flowbitsFindSparse(StreamFlowData *flowdata, uint16_t id)
+{
+    unsigned int i;
+
+    for (i = 0; i < flowdata->num_sparse; i++)
+    {
+        if (flowdata->sparse_ids[i] == id)
+            return (int)i;
+    }
+    return -1;
+}
+
+/* Returns 0 on success; the list is left alone if the bitmap can't be
+ * allocated. */
+int flowbitsMakeDense(StreamFlowData *flowdata)
+{
+    unsigned int i;
+
+    if (boInitBITOP(&(flowdata->boFlowbits), getFlowbitSizeInBytes()) != 0)
+        return -1;
+
+    for (i = 0; i < flowdata->num_sparse; i++)
+        boSetBit(&(flowdata->boFlowbits), flowdata->sparse_ids[i]);
+
+    flowdata->num_sparse = 0;
+    return 0;
+}
+
+static inline int flowbitsIsSet(StreamFlowData *flowdata, uint16_t id)
+{
+    if (flowdata == NULL)
         return 0;
-    GrpBitOp = &(flowbits_grp->GrpBitOp);
 
-    /* note, max_id is an index, not a count.
-     * Calculate max_bytes by adding 8 to max_id, then dividing by 8.  */
-    max_bytes = (flowbits_grp->max_id + 8) >> 3;
-    for ( i = 0; i < max_bytes; i++ )
+    if (flowbitsIsDense(flowdata))
+        return boIsBitSet(&(flowdata->boFlowbits), id);
+
+    return (flowbitsFindSparse(flowdata, id) >= 0);
+}
+
+static inline void flowbitsSet(StreamFlowData *flowdata, uint16_t id)
+{
+    if (!flowbitsIsDense(flowdata))
     {
-        BitOp->pucBitBuffer[i] &= ~GrpBitOp->pucBitBuffer[i];
+        if (flowbitsFindSparse(flowdata, id) >= 0)
+            return;
+
+        if (flowdata->num_sparse < STREAM_FLOWBITS_SPARSE_MAX)
+        {
+            flowdata->sparse_ids[flowdata->num_sparse++] = id;
+            return;
+        }
+
+        if (flowbitsMakeDense(flowdata) != 0)
+            return;
     }
-    return 1;
+
+    boSetBit(&(flowdata->boFlowbits), id);
 }
 
-static inline int boToggleGrpBit(BITOP *BitOp, char *group)
+static inline void flowbitsClear(StreamFlowData *flowdata, uint16_t id)
+{
+    int i;
+
+    if (flowdata == NULL)
+        return;
+
+    if (flowbitsIsDense(flowdata))
+    {
+        boClearBit(&(flowdata->boFlowbits), id);
+        return;
+    }
+
+    i = flowbitsFindSparse(flowdata, id);
+    if (i >= 0)
+        flowdata->sparse_ids[i] = flowdata->sparse_ids[--flowdata->num_sparse];
+}
+
+static inline void flowbitsReset(StreamFlowData *flowdata)
+{
+    if (flowdata == NULL)
+        return;
+
+    /* Back to the empty list; the bitmap is allocated again if needed */
+    boFreeBITOP(&(flowdata->boFlowbits));
+    flowdata->boFlowbits.uiBitBufferSize = 0;
+    flowdata->boFlowbits.uiMaxBits = 0;
+    flowdata->num_sparse = 0;
+}
+
+static inline FLOWBITS_GRP *getFlowbitsGrpForOp(char *group)
 {
     FLOWBITS_GRP *flowbits_grp;
-    BITOP *GrpBitOp;
-    unsigned int i, max_bytes;
 
-    if( group == NULL )
-        return 0;
+    if ((group == NULL) || (flowbits_grp_hash == NULL))
+        return NULL;
+
     flowbits_grp = (FLOWBITS_GRP *)sfghash_find(flowbits_grp_hash, group);
-    if( flowbits_grp == NULL )
-        return 0;
-    if((BitOp == NULL) || (BitOp->uiMaxBits <= flowbits_grp->max_id) || flowbits_grp->count == 0)
+    if ((flowbits_grp == NULL) || (flowbits_grp->count == 0))
+        return NULL;
+
+    return flowbits_grp;
+}
+
+/* note, max_id is an index, not a count. */
+#define FLOWBITS_GRP_BYTES(grp)  ((unsigned int)(((grp)->max_id >> 3) + 1))
+
+/* Bitmaps are not assumed to be word aligned, so words are moved with
+ * memcpy, which compiles down to plain loads and stores. */
+typedef uint64_t flowbits_word_t;
+#define FLOWBITS_WORD_SIZE  sizeof(flowbits_word_t)
+
+static inline void flowbitsGrpClear(BITOP *BitOp, FLOWBITS_GRP *flowbits_grp)
+{
+    unsigned char *buf = BitOp->pucBitBuffer;
+    unsigned char *mask = flowbits_grp->GrpBitOp.pucBitBuffer;
+    unsigned int max_bytes = FLOWBITS_GRP_BYTES(flowbits_grp);
+    unsigned int i;
+
+    for (i = 0; i + FLOWBITS_WORD_SIZE <= max_bytes; i += FLOWBITS_WORD_SIZE)
+    {
+        flowbits_word_t w, m;
+        memcpy(&w, buf + i, FLOWBITS_WORD_SIZE);
+        memcpy(&m, mask + i, FLOWBITS_WORD_SIZE);
+        w &= ~m;
+        memcpy(buf + i, &w, FLOWBITS_WORD_SIZE);
+    }
+    for (; i < max_bytes; i++)
+        buf[i] &= ~mask[i];
+}
+
+static inline void flowbitsGrpToggle(BITOP *BitOp, FLOWBITS_GRP *flowbits_grp)
+{
+    unsigned char *buf = BitOp->pucBitBuffer;
+    unsigned char *mask = flowbits_grp->GrpBitOp.pucBitBuffer;
+    unsigned int max_bytes = FLOWBITS_GRP_BYTES(flowbits_grp);
+    unsigned int i;
+
+    for (i = 0; i + FLOWBITS_WORD_SIZE <= max_bytes; i += FLOWBITS_WORD_SIZE)
+    {
+        flowbits_word_t w, m;
+        memcpy(&w, buf + i, FLOWBITS_WORD_SIZE);
+        memcpy(&m, mask + i, FLOWBITS_WORD_SIZE);
+        w ^= m;
+        memcpy(buf + i, &w, FLOWBITS_WORD_SIZE);
+    }
+    for (; i < max_bytes; i++)
+        buf[i] ^= mask[i];
+}
+
+static inline int flowbitsGrpAll(BITOP *BitOp, FLOWBITS_GRP *flowbits_grp)
+{
+    unsigned char *buf = BitOp->pucBitBuffer;
+    unsigned char *mask = flowbits_grp->GrpBitOp.pucBitBuffer;
+    unsigned int max_bytes = FLOWBITS_GRP_BYTES(flowbits_grp);
+    unsigned int i;
+
+    for (i = 0; i + FLOWBITS_WORD_SIZE <= max_bytes; i += FLOWBITS_WORD_SIZE)
+    {
+        flowbits_word_t w, m;
+        memcpy(&w, buf + i, FLOWBITS_WORD_SIZE);
+        memcpy(&m, mask + i, FLOWBITS_WORD_SIZE);
+        if ((w & m) != m)
+            return 0;
+    }
+    for (; i < max_bytes; i++)
+    {
+        if ((buf[i] & mask[i]) != mask[i])
+            return 0;
+    }
+    return 1;
+}
+
+static inline int flowbitsGrpAny(BITOP *BitOp, FLOWBITS_GRP *flowbits_grp)
+{
+    unsigned char *buf = BitOp->pucBitBuffer;
+    unsigned char *mask = flowbits_grp->GrpBitOp.pucBitBuffer;
+    unsigned int max_bytes = FLOWBITS_GRP_BYTES(flowbits_grp);
+    unsigned int i;
+
+    for (i = 0; i + FLOWBITS_WORD_SIZE <= max_bytes; i += FLOWBITS_WORD_SIZE)
+    {
+        flowbits_word_t w, m;
+        memcpy(&w, buf + i, FLOWBITS_WORD_SIZE);
+        memcpy(&m, mask + i, FLOWBITS_WORD_SIZE);
+        if (w & m)
+            return 1;
+    }
+    for (; i < max_bytes; i++)
+    {
+        if (buf[i] & mask[i])
+            return 1;
+    }
+    return 0;
+}
+
+static inline int boUnSetGrpBit(StreamFlowData *flowdata, char *group)
+{
+    FLOWBITS_GRP *flowbits_grp = getFlowbitsGrpForOp(group);
+    unsigned int i;
+
+    if (flowbits_grp == NULL)
         return 0;
-    GrpBitOp = &(flowbits_grp->GrpBitOp);
 
-    /* note, max_id is an index, not a count.
-     * Calculate max_bytes by adding 8 to max_id, then dividing by 8.  */
-    max_bytes = (flowbits_grp->max_id + 8) >> 3;
-    for ( i = 0; i < max_bytes; i++ )
+    if (flowdata == NULL)
+        return 1;
+
+    if (flowbitsIsDense(flowdata))
+    {
+        flowbitsGrpClear(&(flowdata->boFlowbits), flowbits_grp);
+        return 1;
+    }
+
+    for (i = 0; i < flowdata->num_sparse; )
     {
-        BitOp->pucBitBuffer[i] ^= GrpBitOp->pucBitBuffer[i];
+        if (boIsBitSet(&(flowbits_grp->GrpBitOp), flowdata->sparse_ids[i]))
+            flowdata->sparse_ids[i] = flowdata->sparse_ids[--flowdata->num_sparse];
+        else
+            i++;
     }
     return 1;
 }
 
-static inline int boSetxBitsToGrp(BITOP *BitOp, uint16_t *ids, uint16_t num_ids, char *group)
+static inline int boToggleGrpBit(StreamFlowData *flowdata, char *group)
+{
+    FLOWBITS_GRP *flowbits_grp = getFlowbitsGrpForOp(group);
+
+    if (flowbits_grp == NULL)
+        return 0;
+
+    /* Toggling a group generally sets most of it; go to the bitmap */
+    if (!flowbitsIsDense(flowdata) && (flowbitsMakeDense(flowdata) != 0))
+        return 0;
+
+    flowbitsGrpToggle(&(flowdata->boFlowbits), flowbits_grp);
+    return 1;
+}
+
+static inline int boSetxBitsToGrp(StreamFlowData *flowdata, uint16_t *ids, uint16_t num_ids, char *group)
 {
     unsigned int i;
-    if (!boUnSetGrpBit(BitOp, group))
+    if (!boUnSetGrpBit(flowdata, group))
         return 0;
     for(i = 0; i < num_ids; i++)
-        boSetBit(BitOp,ids[i]);
+        flowbitsSet(flowdata, ids[i]);
     return 1;
 }
 
@@ -901,7 +1103,7 @@ static inline int boSetxBitsToGrp(BITOP *BitOp, uint16_t *ids, uint16_t num_ids,
 static inline int issetFlowbits(StreamFlowData *flowdata, uint8_t eval, uint16_t *ids,
         uint16_t num_ids, char *group )
 {
-    unsigned int i;
+    unsigned int i, found;
     FLOWBITS_GRP *flowbits_grp;
     Flowbits_eval  evalType = (Flowbits_eval)eval;
 
@@ -910,7 +1112,7 @@ static inline int issetFlowbits(StreamFlowData *flowdata, uint8_t eval, uint16_t
     case FLOWBITS_AND:
         for(i = 0; i < num_ids; i++)
         {
-            if(!boIsBitSet(&(flowdata->boFlowbits), ids[i]))
+            if(!flowbitsIsSet(flowdata, ids[i]))
                 return 0;
         }
         return 1;
@@ -918,7 +1120,7 @@ static inline int issetFlowbits(StreamFlowData *flowdata, uint8_t eval, uint16_t
     case FLOWBITS_OR:
         for(i = 0; i < num_ids; i++)
         {
-            if(boIsBitSet(&(flowdata->boFlowbits), ids[i]))
+            if(flowbitsIsSet(flowdata, ids[i]))
                 return 1;
         }
         return 0;
@@ -927,22 +1129,31 @@ static inline int issetFlowbits(StreamFlowData *flowdata, uint8_t eval, uint16_t
         flowbits_grp = (FLOWBITS_GRP *)sfghash_find(flowbits_grp_hash, group);
         if( flowbits_grp == NULL )
             return 0;
-        for ( i = 0; i <= (unsigned int)(flowbits_grp->max_id >>3) ; i++ )
+        if (flowdata == NULL)
+            return (flowbits_grp->count == 0);
+        if (flowbitsIsDense(flowdata))
+            return flowbitsGrpAll(&(flowdata->boFlowbits), flowbits_grp);
+        /* sparse ids are unique, so count the group members present */
+        if (flowbits_grp->count > flowdata->num_sparse)
+            return 0;
+        for (i = 0, found = 0; i < flowdata->num_sparse; i++)
         {
-            uint8_t val = flowdata->boFlowbits.pucBitBuffer[i] & flowbits_grp->GrpBitOp.pucBitBuffer[i];
-            if (val != flowbits_grp->GrpBitOp.pucBitBuffer[i])
-                return 0;
+            if (boIsBitSet(&(flowbits_grp->GrpBitOp), flowdata->sparse_ids[i]))
+                found++;
         }
-        return 1;
+        return (found == flowbits_grp->count);
         break;
     case FLOWBITS_ANY:
         flowbits_grp = (FLOWBITS_GRP *)sfghash_find(flowbits_grp_hash, group);
         if( flowbits_grp == NULL )
             return 0;
-        for ( i = 0; i <= (unsigned int)(flowbits_grp->max_id >>3) ; i++ )
+        if (flowdata == NULL)
+            return 0;
+        if (flowbitsIsDense(flowdata))
+            return flowbitsGrpAny(&(flowdata->boFlowbits), flowbits_grp);
+        for (i = 0; i < flowdata->num_sparse; i++)
         {
-            uint8_t val = flowdata->boFlowbits.pucBitBuffer[i] & flowbits_grp->GrpBitOp.pucBitBuffer[i];
-            if (val)
+            if (boIsBitSet(&(flowbits_grp->GrpBitOp), flowdata->sparse_ids[i]))
                 return 1;
         }
         return 0;
@@ -981,41 +1192,50 @@ int checkFlowBits( uint8_t type, uint8_t evalType, uint16_t *ids, uint16_t num_i
         return rval;
 
 
-    flowdata = stream_api->get_flow_data(p);
-    if(!flowdata)
+    /* Flowbits are only allocated once something is set; until then
+     * every bit of the session reads as clear. */
+    if (type & (FLOWBITS_SET | FLOWBITS_SETX | FLOWBITS_TOGGLE))
     {
-        DEBUG_WRAP(DebugMessage(DEBUG_FLOWBITS, "No FLOWBITS_DATA"););
-        return rval;
+        flowdata = stream_api->get_sparse_flow_data(p, true);
+        if(!flowdata)
+        {
+            DEBUG_WRAP(DebugMessage(DEBUG_FLOWBITS, "No FLOWBITS_DATA"););
+            return rval;
+        }
+    }
+    else
+    {
+        flowdata = stream_api->get_sparse_flow_data(p, false);
     }
 
     switch(type)
     {
     case FLOWBITS_SET:
         for(i = 0; i < num_ids; i++)
-            boSetBit(&(flowdata->boFlowbits),ids[i]);
+            flowbitsSet(flowdata, ids[i]);
         result = 1;
         break;
 
     case FLOWBITS_SETX:
-        result = boSetxBitsToGrp(&(flowdata->boFlowbits), ids, num_ids, group);
+        result = boSetxBitsToGrp(flowdata, ids, num_ids, group);
         break;
 
     case FLOWBITS_UNSET:
         if (eval == FLOWBITS_ALL )
-            boUnSetGrpBit(&(flowdata->boFlowbits), group);
+            boUnSetGrpBit(flowdata, group);
         else
         {
             for(i = 0; i < num_ids; i++)
-                boClearBit(&(flowdata->boFlowbits),ids[i]);
+                flowbitsClear(flowdata, ids[i]);
         }
         result = 1;
         break;
 
     case FLOWBITS_RESET:
         if (!group)
-            boResetBITOP(&(flowdata->boFlowbits));
+            flowbitsReset(flowdata);
         else
-            boUnSetGrpBit(&(flowdata->boFlowbits), group);
+            boUnSetGrpBit(flowdata, group);
         result = 1;
         break;
 
@@ -1045,18 +1265,18 @@ int checkFlowBits( uint8_t type, uint8_t evalType, uint16_t *ids, uint16_t num_i
 
     case FLOWBITS_TOGGLE:
         if (group)
-            boToggleGrpBit(&(flowdata->boFlowbits),group);
+            boToggleGrpBit(flowdata, group);
         else
         {
             for(i = 0; i < num_ids; i++)
             {
-                if (boIsBitSet(&(flowdata->boFlowbits),ids[i]))
+                if (flowbitsIsSet(flowdata, ids[i]))
                 {
-                    boClearBit(&(flowdata->boFlowbits),ids[i]);
+                    flowbitsClear(flowdata, ids[i]);
                 }
                 else
                 {
-                    boSetBit(&(flowdata->boFlowbits),ids[i]);
+                    flowbitsSet(flowdata, ids[i]);
                 }
             }
         }
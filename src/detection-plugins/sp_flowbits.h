@@ -122,4 +122,7 @@ void setFlowbitSize(char *);
 unsigned int getFlowbitSize(void);
 unsigned int getFlowbitSizeInBytes(void);
 
+struct _StreamFlowData;
+int flowbitsMakeDense(struct _StreamFlowData *);
+
 #endif  /* __SP_FLOWBITS_H__ */
@@ -65,5 +65,6 @@ int PcreCompare(void *l, void *r);
 void PcreDuplicatePcreData(void *src, PcreData *pcre_dup);
 int PcreAdjustRelativeOffsets(PcreData *pcre, uint32_t search_offset);
 void PcreCheckAnchored(PcreData *);
+int SnortPcre(void *, Packet *);
 
 #endif /* __SNORT_PCRE_H__ */
@@ -41,7 +41,7 @@
 #include <arpa/inet.h>
 #endif
 
-static SFXHASH *detection_filter_hash = NULL;
+static SFOHASH *detection_filter_hash = NULL;
 
 DetectionFilterConfig * DetectionFilterConfigNew(void)
 {
@@ -68,7 +68,7 @@ void detection_filter_cleanup(void)
     if (detection_filter_hash == NULL)
         return;
 
-    sfxhash_delete(detection_filter_hash);
+    sfohash_delete(detection_filter_hash);
     detection_filter_hash = NULL;
 }
 
@@ -122,7 +122,7 @@ void detection_filter_reset_active(void)
     if (detection_filter_hash == NULL)
         return;
 
-    sfxhash_make_empty(detection_filter_hash);
+    sfohash_make_empty(detection_filter_hash);
 }
 
 void * detection_filter_create(DetectionFilterConfig *df_config, THDX_STRUCT *thdx)
@@ -115,7 +115,8 @@ static void DCE2_CoHandleFrag(DCE2_SsnData *, DCE2_CoTracker *,
                               const DceRpcCoHdr *, const uint8_t *, uint16_t);
 static inline DCE2_Ret DCE2_CoHandleSegmentation(DCE2_CoSeg *, const uint8_t *,
         uint16_t, uint16_t, uint16_t *);
-static void DCE2_CoReassemble(DCE2_SsnData *, DCE2_CoTracker *, DCE2_CoRpktType);
+static void DCE2_CoReassemble(DCE2_SsnData *, DCE2_CoTracker *, DCE2_CoRpktType,
+        const uint8_t *, uint16_t);
 static inline void DCE2_CoFragReassemble(DCE2_SsnData *, DCE2_CoTracker *);
 static inline void DCE2_CoSegReassemble(DCE2_SsnData *, DCE2_CoTracker *);
 static DCE2_Ret DCE2_CoSetIface(DCE2_SsnData *, DCE2_CoTracker *, uint16_t);
@@ -131,7 +132,8 @@ static inline void DCE2_CoEraseCtxIds(DCE2_CoTracker *);
 static inline void DCE2_CoSegAlert(DCE2_SsnData *, DCE2_CoTracker *, DCE2_Event);
 static inline SFSnortPacket * DCE2_CoGetSegRpkt(DCE2_SsnData *, const uint8_t *, uint32_t);
 static inline DCE2_RpktType DCE2_CoGetRpktType(DCE2_SsnData *, DCE2_BufType);
-static SFSnortPacket * DCE2_CoGetRpkt(DCE2_SsnData *, DCE2_CoTracker *, DCE2_CoRpktType, DCE2_RpktType *);
+static SFSnortPacket * DCE2_CoGetRpkt(DCE2_SsnData *, DCE2_CoTracker *, DCE2_CoRpktType,
+        const uint8_t *, uint16_t, DCE2_RpktType *);
 
 static inline DCE2_CoSeg * DCE2_CoGetSegPtr(DCE2_SsnData *, DCE2_CoTracker *);
 static inline DCE2_Buffer * DCE2_CoGetFragBuf(DCE2_SsnData *, DCE2_CoFragTracker *);
@@ -1720,7 +1722,8 @@ static void DCE2_CoHandleFrag(DCE2_SsnData *sd, DCE2_CoTracker *cot,
             dce2_stats.co_srv_min_frag_size = frag_len;
     }
 
-    if (frag_buf == NULL)
+    /* A last fragment is never queued so don't allocate just for it */
+    if ((frag_buf == NULL) && !DceRpcCoLastFrag(co_hdr))
     {
         if (DCE2_SsnFromServer(sd->wire_pkt))
         {
@@ -1762,12 +1765,30 @@ static void DCE2_CoHandleFrag(DCE2_SsnData *sd, DCE2_CoTracker *cot,
     if ((DCE2_BufferLength(frag_buf) + frag_len) > max_frag_data)
         frag_len = max_frag_data - (uint16_t)DCE2_BufferLength(frag_buf);
 
+    /* Reassemble if we got a last frag.  Its stub data is added to the
+     * reassembled packet straight from the PDU instead of being copied
+     * into the fragment buffer and then out again */
+    if (DceRpcCoLastFrag(co_hdr))
+    {
+        PREPROC_PROFILE_END(dce2_pstat_co_frag);
+
+        DCE2_CoReassemble(sd, cot, DCE2_CO_RPKT_TYPE__FRAG, frag_ptr, frag_len);
+        DCE2_BufferEmpty(frag_buf);
+
+        /* Set this for the server response since response doesn't
+         * contain client opnum used */
+        cot->opnum = cot->frag_tracker.opnum;
+        DCE2_CoResetFragTracker(&cot->frag_tracker);
+
+        /* Return early - rule opts will be set in reassembly handler */
+        return;
+    }
+
     if (frag_len != 0)
     {
-        /* If it's the last fragment we're going to flush so just alloc
-         * exactly what we need ... or if there is more data than can fit
-         * in the reassembly buffer */
-        if (DceRpcCoLastFrag(co_hdr) || (DCE2_BufferLength(frag_buf) == max_frag_data))
+        /* If there is more data than can fit in the reassembly buffer
+         * we're going to flush so just alloc exactly what we need */
+        if (DCE2_BufferLength(frag_buf) + frag_len == max_frag_data)
             mflag = DCE2_BUFFER_MIN_ADD_FLAG__IGNORE;
 
         status = DCE2_BufferAddData(frag_buf, frag_ptr,
@@ -1786,23 +1807,9 @@ static void DCE2_CoHandleFrag(DCE2_SsnData *sd, DCE2_CoTracker *cot,
 
     PREPROC_PROFILE_END(dce2_pstat_co_frag);
 
-    /* Reassemble if we got a last frag ... */
-    if (DceRpcCoLastFrag(co_hdr))
+    if (DCE2_BufferLength(frag_buf) == max_frag_data)
     {
-        DCE2_CoFragReassemble(sd, cot);
-        DCE2_BufferEmpty(frag_buf);
-
-        /* Set this for the server response since response doesn't
-         * contain client opnum used */
-        cot->opnum = cot->frag_tracker.opnum;
-        DCE2_CoResetFragTracker(&cot->frag_tracker);
-
-        /* Return early - rule opts will be set in reassembly handler */
-        return;
-    }
-    else if (DCE2_BufferLength(frag_buf) == max_frag_data)
-    {
-        /* ... or can't fit any more data in the buffer
+        /* Reassemble if we can't fit any more data in the buffer
          * Don't reset frag tracker */
         DCE2_CoFragReassemble(sd, cot);
         DCE2_BufferEmpty(frag_buf);
@@ -1828,7 +1835,7 @@ static void DCE2_CoHandleFrag(DCE2_SsnData *sd, DCE2_CoTracker *cot,
  ********************************************************************/
 static inline void DCE2_CoFragReassemble(DCE2_SsnData *sd, DCE2_CoTracker *cot)
 {
-    DCE2_CoReassemble(sd, cot, DCE2_CO_RPKT_TYPE__FRAG);
+    DCE2_CoReassemble(sd, cot, DCE2_CO_RPKT_TYPE__FRAG, NULL, 0);
 }
 
 /********************************************************************
@@ -1849,7 +1856,7 @@ static inline void DCE2_CoFragReassemble(DCE2_SsnData *sd, DCE2_CoTracker *cot)
  ********************************************************************/
 static inline void DCE2_CoSegReassemble(DCE2_SsnData *sd, DCE2_CoTracker *cot)
 {
-    DCE2_CoReassemble(sd, cot, DCE2_CO_RPKT_TYPE__SEG);
+    DCE2_CoReassemble(sd, cot, DCE2_CO_RPKT_TYPE__SEG, NULL, 0);
 }
 
 /********************************************************************
@@ -1867,11 +1874,17 @@ static inline void DCE2_CoSegReassemble(DCE2_SsnData *sd, DCE2_CoTracker *cot)
  *  DCE2_CoRpktType
  *      Specifies whether we want to do segmenation, fragmentation
  *      or fragmentation and segmentation reassembly.
+ *  const uint8_t *
+ *      Stub data of a last fragment that was not queued in the
+ *      fragment buffer or NULL.
+ *  uint16_t
+ *      Length of the last fragment stub data.
  *
  * Returns: None
  *
  ********************************************************************/
-static void DCE2_CoReassemble(DCE2_SsnData *sd, DCE2_CoTracker *cot, DCE2_CoRpktType co_rtype)
+static void DCE2_CoReassemble(DCE2_SsnData *sd, DCE2_CoTracker *cot, DCE2_CoRpktType co_rtype,
+        const uint8_t *frag_tail, uint16_t tail_len)
 {
     DCE2_RpktType rpkt_type;
     DceRpcCoHdr *co_hdr;
@@ -1882,7 +1895,7 @@ static void DCE2_CoReassemble(DCE2_SsnData *sd, DCE2_CoTracker *cot, DCE2_CoRpkt
 
     PREPROC_PROFILE_START(dce2_pstat_co_reass);
 
-    rpkt = DCE2_CoGetRpkt(sd, cot, co_rtype, &rpkt_type);
+    rpkt = DCE2_CoGetRpkt(sd, cot, co_rtype, frag_tail, tail_len, &rpkt_type);
     if (rpkt == NULL)
     {
         DCE2_Log(DCE2_LOG_TYPE__ERROR,
@@ -2517,12 +2530,12 @@ static void DCE2_CoEarlyReassemble(DCE2_SsnData *sd, DCE2_CoTracker *cot)
             if (seg_bytes == 0)
             {
                 DEBUG_WRAP(DCE2_DebugMsg(DCE2_DEBUG__CO, "Early reassemble - DCE/RPC fragments\n"));
-                DCE2_CoReassemble(sd, cot, DCE2_CO_RPKT_TYPE__FRAG);
+                DCE2_CoReassemble(sd, cot, DCE2_CO_RPKT_TYPE__FRAG, NULL, 0);
             }
             else
             {
                 DEBUG_WRAP(DCE2_DebugMsg(DCE2_DEBUG__CO, "Early reassemble - DCE/RPC fragments and segments\n"));
-                DCE2_CoReassemble(sd, cot, DCE2_CO_RPKT_TYPE__ALL);
+                DCE2_CoReassemble(sd, cot, DCE2_CO_RPKT_TYPE__ALL, NULL, 0);
             }
         }
     }
@@ -2548,7 +2561,7 @@ static void DCE2_CoEarlyReassemble(DCE2_SsnData *sd, DCE2_CoTracker *cot)
                 return;
             }
 
-            DCE2_CoReassemble(sd, cot, DCE2_CO_RPKT_TYPE__SEG);
+            DCE2_CoReassemble(sd, cot, DCE2_CO_RPKT_TYPE__SEG, NULL, 0);
         }
     }
 }
@@ -2568,6 +2581,11 @@ static void DCE2_CoEarlyReassemble(DCE2_SsnData *sd, DCE2_CoTracker *cot)
  *  DCE2_CoRpktType
  *      Whether we want a defrag, deseg or defrag + deseg
  *      reassembled packet.
+ *  const uint8_t *
+ *      For a defrag packet, stub data of the last fragment to
+ *      add after the data in the fragment buffer or NULL.
+ *  uint16_t
+ *      Length of the last fragment stub data.
  *  DCE2_RpktType *
  *      This is set based on the transport for the session, and
  *      potentially used by the caller to set fields in the
@@ -2579,7 +2597,8 @@ static void DCE2_CoEarlyReassemble(DCE2_SsnData *sd, DCE2_CoTracker *cot)
  *
  ********************************************************************/
 static SFSnortPacket * DCE2_CoGetRpkt(DCE2_SsnData *sd, DCE2_CoTracker *cot,
-                                      DCE2_CoRpktType co_rtype, DCE2_RpktType *rtype)
+                                      DCE2_CoRpktType co_rtype, const uint8_t *frag_tail,
+                                      uint16_t tail_len, DCE2_RpktType *rtype)
 {
     DCE2_CoSeg *seg_buf = DCE2_CoGetSegPtr(sd, cot);
     DCE2_Buffer *frag_buf = DCE2_CoGetFragBuf(sd, &cot->frag_tracker);
@@ -2613,6 +2632,14 @@ static SFSnortPacket * DCE2_CoGetRpkt(DCE2_SsnData *sd, DCE2_CoTracker *cot,
                 frag_len = DCE2_BufferLength(frag_buf);
             }
 
+            /* Last fragment is the only data if nothing was queued */
+            if ((frag_data == NULL) && (frag_tail != NULL) && (tail_len != 0))
+            {
+                frag_data = frag_tail;
+                frag_len = tail_len;
+                frag_tail = NULL;
+            }
+
             break;
 
         case DCE2_CO_RPKT_TYPE__SEG:
@@ -2687,6 +2714,10 @@ static SFSnortPacket * DCE2_CoGetRpkt(DCE2_SsnData *sd, DCE2_CoTracker *cot,
             /* If this fails, we'll still have the frag data */
             DCE2_AddDataToRpkt(rpkt, *rtype, seg_data, seg_len);
         }
+        else if ((frag_tail != NULL) && (tail_len != 0))
+        {
+            DCE2_AddDataToRpkt(rpkt, *rtype, frag_tail, tail_len);
+        }
     }
     else if (seg_data != NULL)
     {
@@ -155,12 +155,26 @@ static inline bool DCE2_ComInfoCanProcessCommand(const DCE2_SmbComInfo *com_info
 typedef DCE2_Ret (*DCE2_SmbComFunc)(DCE2_SmbSsnData *, const SmbNtHdr *,
         const DCE2_SmbComInfo *, const uint8_t *, uint32_t);
 
-static DCE2_SmbComFunc smb_com_funcs[SMB_MAX_NUM_COMS];
-static uint8_t smb_wcts[SMB_MAX_NUM_COMS][2][32];
-static uint16_t smb_bccs[SMB_MAX_NUM_COMS][2][2];
+// Everything needed to validate and dispatch a command, kept together
+// so a command only touches its own entry.
+typedef struct _DCE2_SmbComEntry
+{
+    DCE2_SmbComFunc func;
+    bool deprecated;
+    bool unusual;
+
+    // The command function is called even if the command fails the
+    // basic checks so it can clean up or handle the error itself.
+    // Otherwise the command isn't processed.
+    bool handles_errors;
+
+    uint16_t bccs[2][2];   // valid byte count range for request / response
+    uint8_t wcts[2][32];   // valid word count bit map for request / response
+
+} DCE2_SmbComEntry;
+
+static DCE2_SmbComEntry smb_com_table[SMB_MAX_NUM_COMS];
 static DCE2_SmbComFunc smb_chain_funcs[DCE2_POLICY__MAX][SMB_ANDX_COM__MAX][SMB_MAX_NUM_COMS];
-static bool smb_deprecated_coms[SMB_MAX_NUM_COMS];
-static bool smb_unusual_coms[SMB_MAX_NUM_COMS];
 
 // Exported
 SmbAndXCom smb_chain_map[SMB_MAX_NUM_COMS];
@@ -724,7 +738,7 @@ static inline int DCE2_SmbType(DCE2_SmbSsnData *ssd)
 static inline void DCE2_SmbSetValidWordCount(uint8_t com,
         uint8_t resp, uint8_t wct)
 {
-    smb_wcts[com][resp][wct/8] |= (1 << (wct % 8));
+    smb_com_table[com].wcts[resp][wct/8] |= (1 << (wct % 8));
 }
 
 /********************************************************************
@@ -746,7 +760,7 @@ static inline void DCE2_SmbSetValidWordCount(uint8_t com,
 static inline bool DCE2_SmbIsValidWordCount(uint8_t com,
         uint8_t resp, uint8_t wct)
 {
-    return (smb_wcts[com][resp][wct/8] & (1 << (wct % 8))) ? true : false;
+    return (smb_com_table[com].wcts[resp][wct/8] & (1 << (wct % 8))) ? true : false;
 }
 
 /********************************************************************
@@ -771,8 +785,8 @@ static inline bool DCE2_SmbIsValidWordCount(uint8_t com,
 static inline void DCE2_SmbSetValidByteCount(uint8_t com,
         uint8_t resp, uint16_t min, uint16_t max)
 {
-    smb_bccs[com][resp][0] = min;
-    smb_bccs[com][resp][1] = max;
+    smb_com_table[com].bccs[resp][0] = min;
+    smb_com_table[com].bccs[resp][1] = max;
 }
 
 /********************************************************************
@@ -794,8 +808,8 @@ static inline void DCE2_SmbSetValidByteCount(uint8_t com,
 static inline bool DCE2_SmbIsValidByteCount(uint8_t com,
         uint8_t resp, uint16_t bcc)
 {
-    return ((bcc < smb_bccs[com][resp][0])
-            || (bcc > smb_bccs[com][resp][1])) ? false : true;
+    return ((bcc < smb_com_table[com].bccs[resp][0])
+            || (bcc > smb_com_table[com].bccs[resp][1])) ? false : true;
 }
 
 /********************************************************************
@@ -815,7 +829,7 @@ static inline bool DCE2_SmbIsValidByteCount(uint8_t com,
  ********************************************************************/
 static inline uint16_t DCE2_SmbGetMinByteCount(uint8_t com, uint8_t resp)
 {
-    return smb_bccs[com][resp][0];
+    return smb_com_table[com].bccs[resp][0];
 }
 
 /********************************************************************
@@ -840,8 +854,7 @@ void DCE2_SmbInitGlobals(void)
     SmbAndXCom andx;
     int i;
 
-    memset(&smb_wcts, 0, sizeof(smb_wcts));
-    memset(&smb_bccs, 0, sizeof(smb_bccs));
+    memset(&smb_com_table, 0, sizeof(smb_com_table));
 
     // Sets up the function to call for the command and valid word and byte
     // counts for the command.  Ensuring valid word and byte counts is very
@@ -858,10 +871,10 @@ void DCE2_SmbInitGlobals(void)
         switch (com)
         {
             case SMB_COM_OPEN:
-                smb_com_funcs[com] = DCE2_SmbOpen;
+                smb_com_table[com].func = DCE2_SmbOpen;
 
-                smb_deprecated_coms[com] = true;
-                smb_unusual_coms[com] = false;
+                smb_com_table[com].deprecated = true;
+                smb_com_table[com].unusual = false;
 
                 DCE2_SmbSetValidWordCount((uint8_t)com, SMB_TYPE__REQUEST, 2);
                 DCE2_SmbSetValidWordCount((uint8_t)com, SMB_TYPE__RESPONSE, 7);
@@ -870,10 +883,10 @@ void DCE2_SmbInitGlobals(void)
                 DCE2_SmbSetValidByteCount((uint8_t)com, SMB_TYPE__RESPONSE, 0, 0);
                 break;
             case SMB_COM_CREATE:
-                smb_com_funcs[com] = DCE2_SmbCreate;
+                smb_com_table[com].func = DCE2_SmbCreate;
 
-                smb_deprecated_coms[com] = true;
-                smb_unusual_coms[com] = false;
+                smb_com_table[com].deprecated = true;
+                smb_com_table[com].unusual = false;
 
                 DCE2_SmbSetValidWordCount((uint8_t)com, SMB_TYPE__REQUEST, 3);
                 DCE2_SmbSetValidWordCount((uint8_t)com, SMB_TYPE__RESPONSE, 1);
@@ -882,10 +895,10 @@ void DCE2_SmbInitGlobals(void)
                 DCE2_SmbSetValidByteCount((uint8_t)com, SMB_TYPE__RESPONSE, 0, 0);
                 break;
             case SMB_COM_CLOSE:
-                smb_com_funcs[com] = DCE2_SmbClose;
+                smb_com_table[com].func = DCE2_SmbClose;
 
-                smb_deprecated_coms[com] = false;
-                smb_unusual_coms[com] = false;
+                smb_com_table[com].deprecated = false;
+                smb_com_table[com].unusual = false;
 
                 DCE2_SmbSetValidWordCount((uint8_t)com, SMB_TYPE__REQUEST, 3);
                 DCE2_SmbSetValidWordCount((uint8_t)com, SMB_TYPE__RESPONSE, 0);
@@ -894,10 +907,10 @@ void DCE2_SmbInitGlobals(void)
                 DCE2_SmbSetValidByteCount((uint8_t)com, SMB_TYPE__RESPONSE, 0, 0);
                 break;
             case SMB_COM_RENAME:
-                smb_com_funcs[com] = DCE2_SmbRename;
+                smb_com_table[com].func = DCE2_SmbRename;
 
-                smb_deprecated_coms[com] = false;
-                smb_unusual_coms[com] = false;
+                smb_com_table[com].deprecated = false;
+                smb_com_table[com].unusual = false;
 
                 DCE2_SmbSetValidWordCount((uint8_t)com, SMB_TYPE__REQUEST, 1);
                 DCE2_SmbSetValidWordCount((uint8_t)com, SMB_TYPE__RESPONSE, 0);
@@ -906,10 +919,10 @@ void DCE2_SmbInitGlobals(void)
                 DCE2_SmbSetValidByteCount((uint8_t)com, SMB_TYPE__RESPONSE, 0, 0);
                 break;
             case SMB_COM_READ:
-                smb_com_funcs[com] = DCE2_SmbRead;
+                smb_com_table[com].func = DCE2_SmbRead;
 
-                smb_deprecated_coms[com] = true;
-                smb_unusual_coms[com] = false;
+                smb_com_table[com].deprecated = true;
+                smb_com_table[com].unusual = false;
 
                 DCE2_SmbSetValidWordCount((uint8_t)com, SMB_TYPE__REQUEST, 5);
                 DCE2_SmbSetValidWordCount((uint8_t)com, SMB_TYPE__RESPONSE, 5);
@@ -918,10 +931,10 @@ void DCE2_SmbInitGlobals(void)
                 DCE2_SmbSetValidByteCount((uint8_t)com, SMB_TYPE__RESPONSE, 3, UINT16_MAX);
                 break;
             case SMB_COM_WRITE:
-                smb_com_funcs[com] = DCE2_SmbWrite;
+                smb_com_table[com].func = DCE2_SmbWrite;
 
-                smb_deprecated_coms[com] = true;
-                smb_unusual_coms[com] = false;
+                smb_com_table[com].deprecated = true;
+                smb_com_table[com].unusual = false;
 
                 DCE2_SmbSetValidWordCount((uint8_t)com, SMB_TYPE__REQUEST, 5);
                 DCE2_SmbSetValidWordCount((uint8_t)com, SMB_TYPE__RESPONSE, 1);
@@ -930,10 +943,10 @@ void DCE2_SmbInitGlobals(void)
                 DCE2_SmbSetValidByteCount((uint8_t)com, SMB_TYPE__RESPONSE, 0, 0);
                 break;
             case SMB_COM_CREATE_NEW:
-                smb_com_funcs[com] = DCE2_SmbCreateNew;
+                smb_com_table[com].func = DCE2_SmbCreateNew;
 
-                smb_deprecated_coms[com] = true;
-                smb_unusual_coms[com] = false;
+                smb_com_table[com].deprecated = true;
+                smb_com_table[com].unusual = false;
 
                 DCE2_SmbSetValidWordCount((uint8_t)com, SMB_TYPE__REQUEST, 3);
                 DCE2_SmbSetValidWordCount((uint8_t)com, SMB_TYPE__RESPONSE, 1);
@@ -942,10 +955,11 @@ void DCE2_SmbInitGlobals(void)
                 DCE2_SmbSetValidByteCount((uint8_t)com, SMB_TYPE__RESPONSE, 0, 0);
                 break;
             case SMB_COM_WRITE_AND_UNLOCK:
-                smb_com_funcs[com] = DCE2_SmbWriteAndUnlock;
+                smb_com_table[com].func = DCE2_SmbWriteAndUnlock;
+                smb_com_table[com].handles_errors = true;
 
-                smb_deprecated_coms[com] = true;
-                smb_unusual_coms[com] = false;
+                smb_com_table[com].deprecated = true;
+                smb_com_table[com].unusual = false;
 
                 DCE2_SmbSetValidWordCount((uint8_t)com, SMB_TYPE__REQUEST, 5);
                 DCE2_SmbSetValidWordCount((uint8_t)com, SMB_TYPE__RESPONSE, 1);
@@ -954,10 +968,10 @@ void DCE2_SmbInitGlobals(void)
                 DCE2_SmbSetValidByteCount((uint8_t)com, SMB_TYPE__RESPONSE, 0, 0);
                 break;
             case SMB_COM_READ_RAW:
-                smb_com_funcs[com] = DCE2_SmbReadRaw;
+                smb_com_table[com].func = DCE2_SmbReadRaw;
 
-                smb_deprecated_coms[com] = true;
-                smb_unusual_coms[com] = false;
+                smb_com_table[com].deprecated = true;
+                smb_com_table[com].unusual = false;
 
                 DCE2_SmbSetValidWordCount((uint8_t)com, SMB_TYPE__REQUEST, 8);
                 // With optional OffsetHigh
@@ -967,10 +981,10 @@ void DCE2_SmbInitGlobals(void)
                 // Response is raw data, i.e. without SMB
                 break;
             case SMB_COM_WRITE_RAW:
-                smb_com_funcs[com] = DCE2_SmbWriteRaw;
+                smb_com_table[com].func = DCE2_SmbWriteRaw;
 
-                smb_deprecated_coms[com] = true;
-                smb_unusual_coms[com] = false;
+                smb_com_table[com].deprecated = true;
+                smb_com_table[com].unusual = false;
 
                 DCE2_SmbSetValidWordCount((uint8_t)com, SMB_TYPE__REQUEST, 12);
                 // With optional OffsetHigh
@@ -983,20 +997,21 @@ void DCE2_SmbInitGlobals(void)
                 break;
             case SMB_COM_WRITE_COMPLETE:
                 // Final server response to SMB_COM_WRITE_RAW
-                smb_com_funcs[com] = DCE2_SmbWriteComplete;
+                smb_com_table[com].func = DCE2_SmbWriteComplete;
 
-                smb_deprecated_coms[com] = true;
-                smb_unusual_coms[com] = false;
+                smb_com_table[com].deprecated = true;
+                smb_com_table[com].unusual = false;
 
                 DCE2_SmbSetValidWordCount((uint8_t)com, SMB_TYPE__RESPONSE, 1);
 
                 DCE2_SmbSetValidByteCount((uint8_t)com, SMB_TYPE__RESPONSE, 0, 0);
                 break;
             case SMB_COM_TRANSACTION:
-                smb_com_funcs[com] = DCE2_SmbTransaction;
+                smb_com_table[com].func = DCE2_SmbTransaction;
+                smb_com_table[com].handles_errors = true;
 
-                smb_deprecated_coms[com] = false;
-                smb_unusual_coms[com] = false;
+                smb_com_table[com].deprecated = false;
+                smb_com_table[com].unusual = false;
 
                 // Word count depends on setup count
                 //for (i = 14; i < 256; i++)
@@ -1029,10 +1044,10 @@ void DCE2_SmbInitGlobals(void)
                 DCE2_SmbSetValidByteCount((uint8_t)com, SMB_TYPE__RESPONSE, 0, UINT16_MAX);
                 break;
             case SMB_COM_TRANSACTION_SECONDARY:
-                smb_com_funcs[com] = DCE2_SmbTransactionSecondary;
+                smb_com_table[com].func = DCE2_SmbTransactionSecondary;
 
-                smb_deprecated_coms[com] = false;
-                smb_unusual_coms[com] = false;
+                smb_com_table[com].deprecated = false;
+                smb_com_table[com].unusual = false;
 
                 DCE2_SmbSetValidWordCount((uint8_t)com, SMB_TYPE__REQUEST, 8);
                 // Response is an SMB_COM_TRANSACTION
@@ -1040,10 +1055,10 @@ void DCE2_SmbInitGlobals(void)
                 DCE2_SmbSetValidByteCount((uint8_t)com, SMB_TYPE__REQUEST, 0, UINT16_MAX);
                 break;
             case SMB_COM_WRITE_AND_CLOSE:
-                smb_com_funcs[com] = DCE2_SmbWriteAndClose;
+                smb_com_table[com].func = DCE2_SmbWriteAndClose;
 
-                smb_deprecated_coms[com] = true;
-                smb_unusual_coms[com] = false;
+                smb_com_table[com].deprecated = true;
+                smb_com_table[com].unusual = false;
 
                 DCE2_SmbSetValidWordCount((uint8_t)com, SMB_TYPE__REQUEST, 6);
                 // For some reason MS-CIFS specifies a version of this command
@@ -1058,10 +1073,10 @@ void DCE2_SmbInitGlobals(void)
                 DCE2_SmbSetValidByteCount((uint8_t)com, SMB_TYPE__RESPONSE, 0, 0);
                 break;
             case SMB_COM_OPEN_ANDX:
-                smb_com_funcs[com] = DCE2_SmbOpenAndX;
+                smb_com_table[com].func = DCE2_SmbOpenAndX;
 
-                smb_deprecated_coms[com] = true;
-                smb_unusual_coms[com] = false;
+                smb_com_table[com].deprecated = true;
+                smb_com_table[com].unusual = false;
 
                 DCE2_SmbSetValidWordCount((uint8_t)com, SMB_TYPE__REQUEST, 15);
                 DCE2_SmbSetValidWordCount((uint8_t)com, SMB_TYPE__RESPONSE, 15);
@@ -1075,10 +1090,10 @@ void DCE2_SmbInitGlobals(void)
                 DCE2_SmbSetValidByteCount((uint8_t)com, SMB_TYPE__RESPONSE, 0, UINT16_MAX);
                 break;
             case SMB_COM_READ_ANDX:
-                smb_com_funcs[com] = DCE2_SmbReadAndX;
+                smb_com_table[com].func = DCE2_SmbReadAndX;
 
-                smb_deprecated_coms[com] = false;
-                smb_unusual_coms[com] = false;
+                smb_com_table[com].deprecated = false;
+                smb_com_table[com].unusual = false;
 
                 DCE2_SmbSetValidWordCount((uint8_t)com, SMB_TYPE__REQUEST, 10);
                 // With optional OffsetHigh
@@ -1089,10 +1104,11 @@ void DCE2_SmbInitGlobals(void)
                 DCE2_SmbSetValidByteCount((uint8_t)com, SMB_TYPE__RESPONSE, 0, UINT16_MAX);
                 break;
             case SMB_COM_WRITE_ANDX:
-                smb_com_funcs[com] = DCE2_SmbWriteAndX;
+                smb_com_table[com].func = DCE2_SmbWriteAndX;
+                smb_com_table[com].handles_errors = true;
 
-                smb_deprecated_coms[com] = false;
-                smb_unusual_coms[com] = false;
+                smb_com_table[com].deprecated = false;
+                smb_com_table[com].unusual = false;
 
                 DCE2_SmbSetValidWordCount((uint8_t)com, SMB_TYPE__REQUEST, 12);
                 // With optional OffsetHigh
@@ -1103,10 +1119,10 @@ void DCE2_SmbInitGlobals(void)
                 DCE2_SmbSetValidByteCount((uint8_t)com, SMB_TYPE__RESPONSE, 0, 0);
                 break;
             case SMB_COM_TRANSACTION2:
-                smb_com_funcs[com] = DCE2_SmbTransaction2;
+                smb_com_table[com].func = DCE2_SmbTransaction2;
 
-                smb_deprecated_coms[com] = false;
-                smb_unusual_coms[com] = false;
+                smb_com_table[com].deprecated = false;
+                smb_com_table[com].unusual = false;
 
                 // Word count depends on setup count
                 //for (i = 14; i < 256; i++)
@@ -1132,10 +1148,11 @@ void DCE2_SmbInitGlobals(void)
                 DCE2_SmbSetValidByteCount((uint8_t)com, SMB_TYPE__RESPONSE, 0, UINT16_MAX);
                 break;
             case SMB_COM_TRANSACTION2_SECONDARY:
-                smb_com_funcs[com] = DCE2_SmbTransaction2Secondary;
+                smb_com_table[com].func = DCE2_SmbTransaction2Secondary;
+                smb_com_table[com].handles_errors = true;
 
-                smb_deprecated_coms[com] = false;
-                smb_unusual_coms[com] = false;
+                smb_com_table[com].deprecated = false;
+                smb_com_table[com].unusual = false;
 
                 DCE2_SmbSetValidWordCount((uint8_t)com, SMB_TYPE__REQUEST, 9);
                 // Response is an SMB_COM_TRANSACTION2
@@ -1143,10 +1160,10 @@ void DCE2_SmbInitGlobals(void)
                 DCE2_SmbSetValidByteCount((uint8_t)com, SMB_TYPE__REQUEST, 0, UINT16_MAX);
                 break;
             case SMB_COM_TREE_CONNECT:
-                smb_com_funcs[com] = DCE2_SmbTreeConnect;
+                smb_com_table[com].func = DCE2_SmbTreeConnect;
 
-                smb_deprecated_coms[com] = true;
-                smb_unusual_coms[com] = false;
+                smb_com_table[com].deprecated = true;
+                smb_com_table[com].unusual = false;
 
                 DCE2_SmbSetValidWordCount((uint8_t)com, SMB_TYPE__REQUEST, 0);
                 DCE2_SmbSetValidWordCount((uint8_t)com, SMB_TYPE__RESPONSE, 2);
@@ -1155,10 +1172,10 @@ void DCE2_SmbInitGlobals(void)
                 DCE2_SmbSetValidByteCount((uint8_t)com, SMB_TYPE__RESPONSE, 0, 0);
                 break;
             case SMB_COM_TREE_DISCONNECT:
-                smb_com_funcs[com] = DCE2_SmbTreeDisconnect;
+                smb_com_table[com].func = DCE2_SmbTreeDisconnect;
 
-                smb_deprecated_coms[com] = false;
-                smb_unusual_coms[com] = false;
+                smb_com_table[com].deprecated = false;
+                smb_com_table[com].unusual = false;
 
                 DCE2_SmbSetValidWordCount((uint8_t)com, SMB_TYPE__REQUEST, 0);
                 DCE2_SmbSetValidWordCount((uint8_t)com, SMB_TYPE__RESPONSE, 0);
@@ -1168,10 +1185,10 @@ void DCE2_SmbInitGlobals(void)
                 break;
             case SMB_COM_NEGOTIATE:
                 // Not doing anything with this command right now.
-                smb_com_funcs[com] = DCE2_SmbNegotiate;
+                smb_com_table[com].func = DCE2_SmbNegotiate;
 
-                smb_deprecated_coms[com] = false;
-                smb_unusual_coms[com] = false;
+                smb_com_table[com].deprecated = false;
+                smb_com_table[com].unusual = false;
 
                 DCE2_SmbSetValidWordCount((uint8_t)com, SMB_TYPE__REQUEST, 0);
                 DCE2_SmbSetValidWordCount((uint8_t)com, SMB_TYPE__RESPONSE, 1);
@@ -1183,10 +1200,10 @@ void DCE2_SmbInitGlobals(void)
                 DCE2_SmbSetValidByteCount((uint8_t)com, SMB_TYPE__RESPONSE, 0, UINT16_MAX);
                 break;
             case SMB_COM_SESSION_SETUP_ANDX:
-                smb_com_funcs[com] = DCE2_SmbSessionSetupAndX;
+                smb_com_table[com].func = DCE2_SmbSessionSetupAndX;
 
-                smb_deprecated_coms[com] = false;
-                smb_unusual_coms[com] = false;
+                smb_com_table[com].deprecated = false;
+                smb_com_table[com].unusual = false;
 
                 DCE2_SmbSetValidWordCount((uint8_t)com, SMB_TYPE__REQUEST, 10);
                 DCE2_SmbSetValidWordCount((uint8_t)com, SMB_TYPE__REQUEST, 12);
@@ -1199,10 +1216,10 @@ void DCE2_SmbInitGlobals(void)
                 DCE2_SmbSetValidByteCount((uint8_t)com, SMB_TYPE__RESPONSE, 0, UINT16_MAX);
                 break;
             case SMB_COM_LOGOFF_ANDX:
-                smb_com_funcs[com] = DCE2_SmbLogoffAndX;
+                smb_com_table[com].func = DCE2_SmbLogoffAndX;
 
-                smb_deprecated_coms[com] = false;
-                smb_unusual_coms[com] = false;
+                smb_com_table[com].deprecated = false;
+                smb_com_table[com].unusual = false;
 
                 DCE2_SmbSetValidWordCount((uint8_t)com, SMB_TYPE__REQUEST, 2);
                 DCE2_SmbSetValidWordCount((uint8_t)com, SMB_TYPE__RESPONSE, 2);
@@ -1215,10 +1232,10 @@ void DCE2_SmbInitGlobals(void)
                 DCE2_SmbSetValidByteCount((uint8_t)com, SMB_TYPE__RESPONSE, 0, 0);
                 break;
             case SMB_COM_TREE_CONNECT_ANDX:
-                smb_com_funcs[com] = DCE2_SmbTreeConnectAndX;
+                smb_com_table[com].func = DCE2_SmbTreeConnectAndX;
 
-                smb_deprecated_coms[com] = false;
-                smb_unusual_coms[com] = false;
+                smb_com_table[com].deprecated = false;
+                smb_com_table[com].unusual = false;
 
                 DCE2_SmbSetValidWordCount((uint8_t)com, SMB_TYPE__REQUEST, 4);
                 DCE2_SmbSetValidWordCount((uint8_t)com, SMB_TYPE__RESPONSE, 2);
@@ -1230,10 +1247,10 @@ void DCE2_SmbInitGlobals(void)
                 DCE2_SmbSetValidByteCount((uint8_t)com, SMB_TYPE__RESPONSE, 2, UINT16_MAX);
                 break;
             case SMB_COM_NT_TRANSACT:
-                smb_com_funcs[com] = DCE2_SmbNtTransact;
+                smb_com_table[com].func = DCE2_SmbNtTransact;
 
-                smb_deprecated_coms[com] = false;
-                smb_unusual_coms[com] = false;
+                smb_com_table[com].deprecated = false;
+                smb_com_table[com].unusual = false;
 
                 // Word count depends on setup count
                 // In reality, all subcommands of SMB_COM_NT_TRANSACT
@@ -1260,10 +1277,11 @@ void DCE2_SmbInitGlobals(void)
                 DCE2_SmbSetValidByteCount((uint8_t)com, SMB_TYPE__RESPONSE, 0, UINT16_MAX);
                 break;
             case SMB_COM_NT_TRANSACT_SECONDARY:
-                smb_com_funcs[com] = DCE2_SmbNtTransactSecondary;
+                smb_com_table[com].func = DCE2_SmbNtTransactSecondary;
+                smb_com_table[com].handles_errors = true;
 
-                smb_deprecated_coms[com] = false;
-                smb_unusual_coms[com] = false;
+                smb_com_table[com].deprecated = false;
+                smb_com_table[com].unusual = false;
 
                 DCE2_SmbSetValidWordCount((uint8_t)com, SMB_TYPE__REQUEST, 18);
                 // Response is an SMB_COM_NT_TRANSACT
@@ -1271,10 +1289,10 @@ void DCE2_SmbInitGlobals(void)
                 DCE2_SmbSetValidByteCount((uint8_t)com, SMB_TYPE__REQUEST, 0, UINT16_MAX);
                 break;
             case SMB_COM_NT_CREATE_ANDX:
-                smb_com_funcs[com] = DCE2_SmbNtCreateAndX;
+                smb_com_table[com].func = DCE2_SmbNtCreateAndX;
 
-                smb_deprecated_coms[com] = false;
-                smb_unusual_coms[com] = false;
+                smb_com_table[com].deprecated = false;
+                smb_com_table[com].unusual = false;
 
                 DCE2_SmbSetValidWordCount((uint8_t)com, SMB_TYPE__REQUEST, 24);
                 DCE2_SmbSetValidWordCount((uint8_t)com, SMB_TYPE__RESPONSE, 34);
@@ -1289,9 +1307,9 @@ void DCE2_SmbInitGlobals(void)
                 DCE2_SmbSetValidByteCount((uint8_t)com, SMB_TYPE__RESPONSE, 0, UINT16_MAX);
                 break;
             default:
-                smb_com_funcs[com] = NULL;
-                smb_deprecated_coms[com] = false;
-                smb_unusual_coms[com] = false;
+                smb_com_table[com].func = NULL;
+                smb_com_table[com].deprecated = false;
+                smb_com_table[com].unusual = false;
                 // Just set to all valid since the specific command won't
                 // be processed.  Don't want to false positive on these.
                 for (i = 0; i < 256; i++)
@@ -1366,11 +1384,11 @@ void DCE2_SmbInitGlobals(void)
                                     case SMB_COM_OPEN_ANDX:
                                     case SMB_COM_CREATE:
                                     case SMB_COM_CREATE_NEW:
-                                        com_func = smb_com_funcs[com];
+                                        com_func = smb_com_table[com].func;
                                         break;
                                     case SMB_COM_TRANSACTION:
                                         if (policy == DCE2_POLICY__WIN2000)
-                                            com_func = smb_com_funcs[com];
+                                            com_func = smb_com_table[com].func;
                                         break;
                                     default:
                                         break;
@@ -1381,7 +1399,7 @@ void DCE2_SmbInitGlobals(void)
                                 {
                                     case SMB_COM_SESSION_SETUP_ANDX:
                                     case SMB_COM_TREE_CONNECT_ANDX:   // Only for responses
-                                        com_func = smb_com_funcs[com];
+                                        com_func = smb_com_table[com].func;
                                         break;
                                     default:
                                         break;
@@ -1393,11 +1411,11 @@ void DCE2_SmbInitGlobals(void)
                                     case SMB_COM_OPEN:
                                     case SMB_COM_CREATE:
                                     case SMB_COM_CREATE_NEW:
-                                        com_func = smb_com_funcs[com];
+                                        com_func = smb_com_table[com].func;
                                         break;
                                     case SMB_COM_TRANSACTION:
                                         if (policy == DCE2_POLICY__WIN2000)
-                                            com_func = smb_com_funcs[com];
+                                            com_func = smb_com_table[com].func;
                                         break;
                                     default:
                                         break;
@@ -1413,7 +1431,7 @@ void DCE2_SmbInitGlobals(void)
                                     case SMB_COM_WRITE_ANDX:
                                     case SMB_COM_READ:
                                     case SMB_COM_READ_ANDX:
-                                        com_func = smb_com_funcs[com];
+                                        com_func = smb_com_table[com].func;
                                         break;
                                     default:
                                         break;
@@ -1442,12 +1460,12 @@ void DCE2_SmbInitGlobals(void)
                                     case SMB_COM_NT_CREATE_ANDX:
                                     case SMB_COM_CLOSE:
                                     case SMB_COM_READ_ANDX:
-                                        com_func = smb_com_funcs[com];
+                                        com_func = smb_com_table[com].func;
                                         break;
                                     case SMB_COM_WRITE:
                                         if ((policy == DCE2_POLICY__SAMBA_3_0_22)
                                                 || (policy == DCE2_POLICY__SAMBA_3_0_20))
-                                            com_func = smb_com_funcs[com];
+                                            com_func = smb_com_table[com].func;
                                         break;
                                     default:
                                         break;
@@ -1458,7 +1476,7 @@ void DCE2_SmbInitGlobals(void)
                                 {
                                     case SMB_COM_SESSION_SETUP_ANDX:
                                     case SMB_COM_TREE_DISCONNECT:
-                                        com_func = smb_com_funcs[com];
+                                        com_func = smb_com_table[com].func;
                                         break;
                                     default:
                                         break;
@@ -1475,7 +1493,7 @@ void DCE2_SmbInitGlobals(void)
                                     case SMB_COM_CLOSE:
                                     case SMB_COM_WRITE:
                                     case SMB_COM_READ_ANDX:
-                                        com_func = smb_com_funcs[com];
+                                        com_func = smb_com_table[com].func;
                                         break;
                                     default:
                                         break;
@@ -1494,7 +1512,7 @@ void DCE2_SmbInitGlobals(void)
                                     case SMB_COM_CLOSE:
                                     case SMB_COM_WRITE:
                                     case SMB_COM_READ_ANDX:
-                                        com_func = smb_com_funcs[com];
+                                        com_func = smb_com_table[com].func;
                                         break;
                                     default:
                                         break;
@@ -1510,14 +1528,14 @@ void DCE2_SmbInitGlobals(void)
                                     case SMB_COM_NT_CREATE_ANDX:
                                     case SMB_COM_WRITE:
                                     case SMB_COM_READ_ANDX:
-                                        com_func = smb_com_funcs[com];
+                                        com_func = smb_com_table[com].func;
                                         break;
                                     case SMB_COM_LOGOFF_ANDX:
                                     case SMB_COM_TREE_DISCONNECT:
                                     case SMB_COM_CLOSE:
                                         if ((policy == DCE2_POLICY__SAMBA)
                                                 || (policy == DCE2_POLICY__SAMBA_3_0_37))
-                                            com_func = smb_com_funcs[com];
+                                            com_func = smb_com_table[com].func;
                                         break;
                                     default:
                                         break;
@@ -1536,7 +1554,7 @@ void DCE2_SmbInitGlobals(void)
                                     case SMB_COM_WRITE:
                                     case SMB_COM_READ_ANDX:
                                     case SMB_COM_WRITE_ANDX:
-                                        com_func = smb_com_funcs[com];
+                                        com_func = smb_com_table[com].func;
                                         break;
                                     default:
                                         break;
@@ -1547,7 +1565,7 @@ void DCE2_SmbInitGlobals(void)
                                 {
                                     case SMB_COM_SESSION_SETUP_ANDX:
                                     case SMB_COM_WRITE:
-                                        com_func = smb_com_funcs[com];
+                                        com_func = smb_com_table[com].func;
                                         break;
                                     case SMB_COM_LOGOFF_ANDX:
                                     case SMB_COM_TREE_CONNECT:
@@ -1559,7 +1577,7 @@ void DCE2_SmbInitGlobals(void)
                                     case SMB_COM_READ_ANDX:
                                         if ((policy == DCE2_POLICY__SAMBA)
                                                 || (policy == DCE2_POLICY__SAMBA_3_0_37))
-                                            com_func = smb_com_funcs[com];
+                                            com_func = smb_com_table[com].func;
                                         break;
                                     default:
                                         break;
@@ -1890,7 +1908,7 @@ static DCE2_SmbRequestTracker * DCE2_SmbInspect(DCE2_SmbSsnData *ssd, const SmbN
     DEBUG_WRAP(DCE2_DebugMsg(DCE2_DEBUG__SMB, "SMB command: %s (0x%02X)\n",
                 smb_com_strings[smb_com], smb_com));
 
-    if (smb_com_funcs[smb_com] == NULL)
+    if (smb_com_table[smb_com].func == NULL)
     {
         DEBUG_WRAP(DCE2_DebugMsg(DCE2_DEBUG__SMB, "Command isn't processed "
                     "by preprocessor.\n"));
@@ -3077,16 +3095,16 @@ static void DCE2_SmbProcessCommand(DCE2_SmbSsnData *ssd, const SmbNtHdr *smb_hdr
         DCE2_SmbComInfo *com_info;
 
         // Break out if command not supported
-        if (smb_com_funcs[smb_com] == NULL)
+        if (smb_com_table[smb_com].func == NULL)
             break;
 
-        if (smb_deprecated_coms[smb_com])
+        if (smb_com_table[smb_com].deprecated)
         {
             DCE2_Alert(&ssd->sd, DCE2_EVENT__SMB_DEPR_COMMAND_USED,
                     smb_com_strings[smb_com]);
         }
 
-        if (smb_unusual_coms[smb_com])
+        if (smb_com_table[smb_com].unusual)
         {
             DCE2_Alert(&ssd->sd, DCE2_EVENT__SMB_UNUSUAL_COMMAND_USED,
                     smb_com_strings[smb_com]);
@@ -3099,8 +3117,15 @@ static void DCE2_SmbProcessCommand(DCE2_SmbSsnData *ssd, const SmbNtHdr *smb_hdr
 
         // Note that even if the command shouldn't be processed, some of
         // the command functions need to know and do cleanup or some other
-        // processing.
-        status = smb_com_funcs[smb_com](ssd, smb_hdr,
+        // processing.  The rest never see such a command.
+        if (!DCE2_ComInfoCanProcessCommand(com_info)
+                && !smb_com_table[smb_com].handles_errors)
+        {
+            status = DCE2_RET__ERROR;
+            break;
+        }
+
+        status = smb_com_table[smb_com].func(ssd, smb_hdr,
                 (const DCE2_SmbComInfo *)com_info, nb_ptr, nb_len);
 
         if (status != DCE2_RET__SUCCESS)
@@ -3670,9 +3695,6 @@ static inline void DCE2_SmbInvalidShareCheck(DCE2_SmbSsnData *ssd,
 static DCE2_Ret DCE2_SmbOpen(DCE2_SmbSsnData *ssd, const SmbNtHdr *smb_hdr,
         const DCE2_SmbComInfo *com_info, const uint8_t *nb_ptr, uint32_t nb_len)
 {
-    if (!DCE2_ComInfoCanProcessCommand(com_info))
-        return DCE2_RET__ERROR;
-
     if (DCE2_ComInfoIsResponse(com_info))
     {
         DCE2_SmbNewPipeTracker(ssd, ssd->cur_rtracker->uid,
@@ -3686,9 +3708,6 @@ static DCE2_Ret DCE2_SmbOpen(DCE2_SmbSsnData *ssd, const SmbNtHdr *smb_hdr,
 static DCE2_Ret DCE2_SmbCreate(DCE2_SmbSsnData *ssd, const SmbNtHdr *smb_hdr,
         const DCE2_SmbComInfo *com_info, const uint8_t *nb_ptr, uint32_t nb_len)
 {
-    if (!DCE2_ComInfoCanProcessCommand(com_info))
-        return DCE2_RET__ERROR;
-
     if (DCE2_ComInfoIsResponse(com_info))
     {
         DCE2_SmbNewPipeTracker(ssd, ssd->cur_rtracker->uid,
@@ -3702,9 +3721,6 @@ static DCE2_Ret DCE2_SmbCreate(DCE2_SmbSsnData *ssd, const SmbNtHdr *smb_hdr,
 static DCE2_Ret DCE2_SmbClose(DCE2_SmbSsnData *ssd, const SmbNtHdr *smb_hdr,
         const DCE2_SmbComInfo *com_info, const uint8_t *nb_ptr, uint32_t nb_len)
 {
-    if (!DCE2_ComInfoCanProcessCommand(com_info))
-        return DCE2_RET__ERROR;
-
     if (DCE2_ComInfoIsRequest(com_info))
     {
         uint16_t fid = SmbCloseReqFid((SmbCloseReq *)nb_ptr);
@@ -3727,9 +3743,6 @@ static DCE2_Ret DCE2_SmbRename(DCE2_SmbSsnData *ssd, const SmbNtHdr *smb_hdr,
     // NOTE: This command is only processed for CVE-2006-4696 where the buffer
     // formats are invalid and has no bearing on DCE/RPC processing.
 
-    if (!DCE2_ComInfoCanProcessCommand(com_info))
-        return DCE2_RET__ERROR;
-
     if (DCE2_ComInfoIsRequest(com_info))
     {
         // Have at least 4 bytes of data based on byte count check done earlier
@@ -3787,9 +3800,6 @@ static DCE2_Ret DCE2_SmbRename(DCE2_SmbSsnData *ssd, const SmbNtHdr *smb_hdr,
 static DCE2_Ret DCE2_SmbRead(DCE2_SmbSsnData *ssd, const SmbNtHdr *smb_hdr,
         const DCE2_SmbComInfo *com_info, const uint8_t *nb_ptr, uint32_t nb_len)
 {
-    if (!DCE2_ComInfoCanProcessCommand(com_info))
-        return DCE2_RET__ERROR;
-
     if (DCE2_ComInfoIsRequest(com_info))
     {
         uint16_t fid = SmbReadReqFid((SmbReadReq *)nb_ptr);
@@ -3825,9 +3835,6 @@ static DCE2_Ret DCE2_SmbRead(DCE2_SmbSsnData *ssd, const SmbNtHdr *smb_hdr,
 static DCE2_Ret DCE2_SmbWrite(DCE2_SmbSsnData *ssd, const SmbNtHdr *smb_hdr,
         const DCE2_SmbComInfo *com_info, const uint8_t *nb_ptr, uint32_t nb_len)
 {
-    if (!DCE2_ComInfoCanProcessCommand(com_info))
-        return DCE2_RET__ERROR;
-
     if (DCE2_ComInfoIsRequest(com_info))
     {
         // Have at least 3 bytes of data based on byte count check done earlier
@@ -3863,9 +3870,6 @@ static DCE2_Ret DCE2_SmbWrite(DCE2_SmbSsnData *ssd, const SmbNtHdr *smb_hdr,
 static DCE2_Ret DCE2_SmbCreateNew(DCE2_SmbSsnData *ssd, const SmbNtHdr *smb_hdr,
         const DCE2_SmbComInfo *com_info, const uint8_t *nb_ptr, uint32_t nb_len)
 {
-    if (!DCE2_ComInfoCanProcessCommand(com_info))
-        return DCE2_RET__ERROR;
-
     if (DCE2_ComInfoIsResponse(com_info))
     {
         DCE2_SmbNewPipeTracker(ssd, ssd->cur_rtracker->uid,
@@ -3930,9 +3934,6 @@ static DCE2_Ret DCE2_SmbWriteAndUnlock(DCE2_SmbSsnData *ssd, const SmbNtHdr *smb
 static DCE2_Ret DCE2_SmbReadRaw(DCE2_SmbSsnData *ssd, const SmbNtHdr *smb_hdr,
         const DCE2_SmbComInfo *com_info, const uint8_t *nb_ptr, uint32_t nb_len)
 {
-    if (!DCE2_ComInfoCanProcessCommand(com_info))
-        return DCE2_RET__ERROR;
-
     if (DCE2_ComInfoIsRequest(com_info))
     {
         uint16_t fid = SmbReadRawReqFid((SmbReadRawReq *)nb_ptr);
@@ -3957,9 +3958,6 @@ static DCE2_Ret DCE2_SmbReadRaw(DCE2_SmbSsnData *ssd, const SmbNtHdr *smb_hdr,
 static DCE2_Ret DCE2_SmbWriteRaw(DCE2_SmbSsnData *ssd, const SmbNtHdr *smb_hdr,
         const DCE2_SmbComInfo *com_info, const uint8_t *nb_ptr, uint32_t nb_len)
 {
-    if (!DCE2_ComInfoCanProcessCommand(com_info))
-        return DCE2_RET__ERROR;
-
     if (DCE2_ComInfoIsRequest(com_info))
     {
         uint16_t com_size = DCE2_ComInfoCommandSize(com_info);
@@ -4018,9 +4016,6 @@ static DCE2_Ret DCE2_SmbWriteRaw(DCE2_SmbSsnData *ssd, const SmbNtHdr *smb_hdr,
 static DCE2_Ret DCE2_SmbWriteComplete(DCE2_SmbSsnData *ssd, const SmbNtHdr *smb_hdr,
         const DCE2_SmbComInfo *com_info, const uint8_t *nb_ptr, uint32_t nb_len)
 {
-    if (!DCE2_ComInfoCanProcessCommand(com_info))
-        return DCE2_RET__ERROR;
-
     return DCE2_RET__SUCCESS;
 }
 
@@ -4666,9 +4661,6 @@ static DCE2_Ret DCE2_SmbTransactionSecondary(DCE2_SmbSsnData *ssd, const SmbNtHd
     uint16_t tpcnt, poff, pcnt, pdisp;
     DCE2_SmbTransactionTracker *ttracker = &ssd->cur_rtracker->ttracker;
 
-    if (!DCE2_ComInfoCanProcessCommand(com_info))
-        return DCE2_RET__ERROR;
-
     if (DCE2_SsnIsSambaPolicy(&ssd->sd))
     {
         // If the total count decreases, Samba will reset this to the new
@@ -4817,9 +4809,6 @@ static DCE2_Ret DCE2_SmbTransactionSecondary(DCE2_SmbSsnData *ssd, const SmbNtHd
 static DCE2_Ret DCE2_SmbWriteAndClose(DCE2_SmbSsnData *ssd, const SmbNtHdr *smb_hdr,
         const DCE2_SmbComInfo *com_info, const uint8_t *nb_ptr, uint32_t nb_len)
 {
-    if (!DCE2_ComInfoCanProcessCommand(com_info))
-        return DCE2_RET__ERROR;
-
     if (DCE2_ComInfoIsRequest(com_info))
     {
         // Have at least one byte based on byte count check done earlier
@@ -4863,9 +4852,6 @@ static DCE2_Ret DCE2_SmbWriteAndClose(DCE2_SmbSsnData *ssd, const SmbNtHdr *smb_
 static DCE2_Ret DCE2_SmbOpenAndX(DCE2_SmbSsnData *ssd, const SmbNtHdr *smb_hdr,
         const DCE2_SmbComInfo *com_info, const uint8_t *nb_ptr, uint32_t nb_len)
 {
-    if (!DCE2_ComInfoCanProcessCommand(com_info))
-        return DCE2_RET__ERROR;
-
     if (DCE2_ComInfoIsResponse(com_info))
     {
         const uint16_t uid = ssd->cur_rtracker->uid;
@@ -4900,9 +4886,6 @@ static DCE2_Ret DCE2_SmbOpenAndX(DCE2_SmbSsnData *ssd, const SmbNtHdr *smb_hdr,
 static DCE2_Ret DCE2_SmbReadAndX(DCE2_SmbSsnData *ssd, const SmbNtHdr *smb_hdr,
         const DCE2_SmbComInfo *com_info, const uint8_t *nb_ptr, uint32_t nb_len)
 {
-    if (!DCE2_ComInfoCanProcessCommand(com_info))
-        return DCE2_RET__ERROR;
-
     if (DCE2_ComInfoIsRequest(com_info))
     {
         uint16_t fid = SmbReadAndXReqFid((SmbReadAndXReq *)nb_ptr);
@@ -5202,9 +5185,6 @@ static DCE2_Ret DCE2_SmbTransaction2(DCE2_SmbSsnData *ssd, const SmbNtHdr *smb_h
 
     // NOTE: Only looking at TRANS2_OPEN2 as another way to open a named pipe
 
-    if (!DCE2_ComInfoCanProcessCommand(com_info))
-        return DCE2_RET__ERROR;
-
     // Interim response is sent if client didn't send all data / parameters
     // in initial Transaction2 request and will have to complete the request
     // with Transaction2Secondary commands.
@@ -5326,9 +5306,6 @@ static DCE2_Ret DCE2_SmbTransaction2Secondary(DCE2_SmbSsnData *ssd, const SmbNtH
 static DCE2_Ret DCE2_SmbTreeConnect(DCE2_SmbSsnData *ssd, const SmbNtHdr *smb_hdr,
         const DCE2_SmbComInfo *com_info, const uint8_t *nb_ptr, uint32_t nb_len)
 {
-    if (!DCE2_ComInfoCanProcessCommand(com_info))
-        return DCE2_RET__ERROR;
-
     if (DCE2_ComInfoIsRequest(com_info))
     {
         uint16_t com_size = DCE2_ComInfoCommandSize(com_info);
@@ -5425,9 +5402,6 @@ static DCE2_Ret DCE2_SmbTreeConnect(DCE2_SmbSsnData *ssd, const SmbNtHdr *smb_hd
 static DCE2_Ret DCE2_SmbTreeDisconnect(DCE2_SmbSsnData *ssd, const SmbNtHdr *smb_hdr,
         const DCE2_SmbComInfo *com_info, const uint8_t *nb_ptr, uint32_t nb_len)
 {
-    if (!DCE2_ComInfoCanProcessCommand(com_info))
-        return DCE2_RET__ERROR;
-
     if (DCE2_ComInfoIsResponse(com_info))
         DCE2_SmbRemoveTid(ssd, ssd->cur_rtracker->tid);
 
@@ -5441,9 +5415,6 @@ static DCE2_Ret DCE2_SmbNegotiate(DCE2_SmbSsnData *ssd, const SmbNtHdr *smb_hdr,
     uint16_t com_size = DCE2_ComInfoCommandSize(com_info);
     PROFILE_VARS;
 
-    if (!DCE2_ComInfoCanProcessCommand(com_info))
-        return DCE2_RET__ERROR;
-
     PREPROC_PROFILE_START(dce2_pstat_smb_negotiate);
 
     if (DCE2_ComInfoIsRequest(com_info))
@@ -5631,9 +5602,6 @@ static DCE2_SmbOsFsm dce2_smb_os_fsm[] =
 static DCE2_Ret DCE2_SmbSessionSetupAndX(DCE2_SmbSsnData *ssd, const SmbNtHdr *smb_hdr,
         const DCE2_SmbComInfo *com_info, const uint8_t *nb_ptr, uint32_t nb_len)
 {
-    if (!DCE2_ComInfoCanProcessCommand(com_info))
-        return DCE2_RET__ERROR;
-
     if (DCE2_ComInfoIsRequest(com_info))
     {
         uint16_t max_multiplex =
@@ -6109,9 +6077,6 @@ static DCE2_Ret DCE2_SmbSessionSetupAndX(DCE2_SmbSsnData *ssd, const SmbNtHdr *s
 static DCE2_Ret DCE2_SmbLogoffAndX(DCE2_SmbSsnData *ssd, const SmbNtHdr *smb_hdr,
         const DCE2_SmbComInfo *com_info, const uint8_t *nb_ptr, uint32_t nb_len)
 {
-    if (!DCE2_ComInfoCanProcessCommand(com_info))
-        return DCE2_RET__ERROR;
-
     if (DCE2_ComInfoIsResponse(com_info))
     {
         DCE2_SmbRemoveUid(ssd, ssd->cur_rtracker->uid);
@@ -6147,9 +6112,6 @@ static DCE2_Ret DCE2_SmbTreeConnectAndX(DCE2_SmbSsnData *ssd, const SmbNtHdr *sm
 {
     uint16_t com_size = DCE2_ComInfoCommandSize(com_info);
 
-    if (!DCE2_ComInfoCanProcessCommand(com_info))
-        return DCE2_RET__ERROR;
-
     if (DCE2_ComInfoIsRequest(com_info))
     {
         if (DCE2_ScSmbInvalidShares(ssd->sd.sconfig) != NULL)
@@ -6220,9 +6182,6 @@ static DCE2_Ret DCE2_SmbNtTransact(DCE2_SmbSsnData *ssd, const SmbNtHdr *smb_hdr
 
     // NOTE: Only looking at NT_TRANSACT_CREATE as another way to open a named pipe
 
-    if (!DCE2_ComInfoCanProcessCommand(com_info))
-        return DCE2_RET__ERROR;
-
     // Interim response is sent if client didn't send all data / parameters
     // in initial NtTransact request and will have to complete the request
     // with NtTransactSecondary commands.
@@ -6334,9 +6293,6 @@ static DCE2_Ret DCE2_SmbNtTransactSecondary(DCE2_SmbSsnData *ssd, const SmbNtHdr
 static DCE2_Ret DCE2_SmbNtCreateAndX(DCE2_SmbSsnData *ssd, const SmbNtHdr *smb_hdr,
         const DCE2_SmbComInfo *com_info, const uint8_t *nb_ptr, uint32_t nb_len)
 {
-    if (!DCE2_ComInfoCanProcessCommand(com_info))
-        return DCE2_RET__ERROR;
-
     if (DCE2_ComInfoIsResponse(com_info))
     {
         uint16_t uid = ssd->cur_rtracker->uid;
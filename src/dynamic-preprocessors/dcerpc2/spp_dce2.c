@@ -168,7 +168,7 @@ static void DCE2_InitGlobal(struct _SnortConfig *sc, char *args)
     DCE2_Config *pDefaultPolicyConfig = NULL;
     DCE2_Config *pCurrentPolicyConfig = NULL;
 
-    if ((_dpd.streamAPI == NULL) || (_dpd.streamAPI->version != STREAM_API_VERSION5))
+    if ((_dpd.streamAPI == NULL) || (_dpd.streamAPI->version != STREAM_API_VERSION7))
     {
         DCE2_Die("%s(%d) \"%s\" configuration: "
             "Stream5 must be enabled with TCP and UDP tracking.",
@@ -921,7 +921,7 @@ static void DCE2_ReloadGlobal(struct _SnortConfig *sc, char *args, void **new_co
     DCE2_Config *pDefaultPolicyConfig = NULL;
     DCE2_Config *pCurrentPolicyConfig = NULL;
 
-    if ((_dpd.streamAPI == NULL) || (_dpd.streamAPI->version != STREAM_API_VERSION5))
+    if ((_dpd.streamAPI == NULL) || (_dpd.streamAPI->version != STREAM_API_VERSION7))
     {
         DCE2_Die("%s(%d) \"%s\" configuration: "
             "Stream5 must be enabled with TCP and UDP tracking.",
@@ -48,7 +48,8 @@ enum
     IP_INVALID,
     IP_INSERT_FAILURE,
     IP_INSERT_DUPLICATE,
-    IP_MEM_ALLOC_FAILURE
+    IP_MEM_ALLOC_FAILURE,
+    IP_NOT_LISTED
 };
 
 
@@ -109,6 +110,9 @@ char* WhiteActionOption[] =
 
 #define MAX_MSGS_TO_PRINT      20
 
+/*Data table slots reserved for hosts added by delta updates*/
+#define DELTA_HEADROOM(lines)  ((lines)/4 + 1024)
+
 static unsigned long total_duplicates;
 static unsigned long total_invalids;
 
@@ -117,6 +121,35 @@ void **IPtables;
 #ifdef SHARED_REP
 ReputationConfig *reputation_shmem_config;
 table_flat_t *emptyIPtables;
+
+/*
+ * Delta updates of the shared IP table
+ *
+ * Memory and data table slots that an update made unreachable are kept
+ * here, with the delta version that did so, until all instances have seen
+ * that version. Only the process that loaded the segment can update it.
+ */
+typedef struct _DeltaRetired
+{
+    uint32_t version;
+    MEM_OFFSET offset;  /*memory block, or data table slot if size is 0*/
+    uint32_t size;
+} DeltaRetired;
+
+typedef struct _DeltaState
+{
+    void *segment;      /*segment the lists were loaded into*/
+    int numLists;
+    uint32_t version;   /*delta version being applied*/
+    DeltaRetired *retired;
+    uint32_t numRetired;
+    uint32_t maxRetired;
+    FLAT_INDEX *freeSlots;
+    uint32_t numFreeSlots;
+    uint32_t maxFreeSlots;
+} DeltaState;
+
+static DeltaState delta_state;
 #endif
 /*
  * Function prototype(s)
@@ -125,6 +158,11 @@ static void IpListInit(uint32_t,ReputationConfig *config);
 static void LoadListFile(char *filename, INFO info, ReputationConfig *config);
 static void DisplayIPlistStats(ReputationConfig *);
 static void DisplayReputationConfig(ReputationConfig *);
+#ifdef SHARED_REP
+int LoadDeltaFilesIntoShmem(void* ptrSegment, uint32_t size,
+        ShmemDataFileList** file_list, int num_files,
+        uint32_t version, uint32_t released_version);
+#endif
 
 /* ********************************************************************
  * Function: estimateSizeFromEntries
@@ -255,6 +293,12 @@ int LoadFileIntoShmem(void* ptrSegment, ShmemDataFileList** file_list, int num_f
 
     reputation_shmem_config->memCapReached = false;
 
+    /*Anything kept for delta updates of the previous segment is dropped*/
+    delta_state.segment = ptrSegment;
+    delta_state.numLists = num_files;
+    delta_state.numRetired = 0;
+    delta_state.numFreeSlots = 0;
+
     /*Reset the log message count*/
     total_duplicates = 0;
     for (i = 0; i < num_files; i++)
@@ -325,9 +369,14 @@ uint32_t GetSegmentSizeFromFileList(ShmemDataFileList** file_list, int file_coun
     {
         return ZEROSEG;
     }
-    reputation_shmem_config->numEntries = totalLines + 1;
+
+    /*Leave room in the data table for hosts added by delta updates*/
+    reputation_shmem_config->numEntries = totalLines + 1 + DELTA_HEADROOM(totalLines);
+    if (reputation_shmem_config->numEntries < totalLines + 1)
+        reputation_shmem_config->numEntries = totalLines + 1;
 
     reputation_shmem_config->memsize =  estimateSizeFromEntries(reputation_shmem_config->numEntries, reputation_shmem_config->memcap);
+
     return reputation_shmem_config->memsize;
 }
 
@@ -406,7 +455,7 @@ void initShareMemory(struct _SnortConfig *sc, void *conf)
     switch_state = SWITCHING;
     reputation_shmem_config = config;
     if (InitShmemDataMgmtFunctions(InitPerProcessZeroSegment,
-            GetSegmentSizeFromFileList,LoadFileIntoShmem))
+            GetSegmentSizeFromFileList,LoadFileIntoShmem,LoadDeltaFilesIntoShmem))
     {
         DynamicPreprocessorFatalMessage("Unable to initialize DataManagement functions\n");
 
@@ -1357,6 +1406,615 @@ static void LoadListFile(char *filename, INFO info, ReputationConfig *config)
     fclose(fp);
 }
 
+#ifdef SHARED_REP
+/********************************************************************
+ * Function: GrowDeltaArray
+ *
+ * Make room for more items in one of the delta update arrays
+ *
+ * Arguments:
+ *  array: the array to grow
+ *  max: the number of items the array can hold
+ *  item_size: the size of one item
+ *
+ * Returns:
+ *  true if successful
+ *
+ ********************************************************************/
+
+static bool GrowDeltaArray(void **array, uint32_t *max, size_t item_size)
+{
+    uint32_t new_max = *max ? (*max + *max/2) : 1024;
+    void *new_array;
+
+    if (new_max < *max)
+        return false;
+
+    if ((new_array = realloc(*array, new_max * item_size)) == NULL)
+        return false;
+
+    *array = new_array;
+    *max = new_max;
+    return true;
+}
+
+/********************************************************************
+ * Function: RetireDeltaMemory
+ *
+ * Keep a memory block, or a data table slot if size is 0, that the
+ * delta update being applied made unreachable, until readers are done
+ * with it. If it can't be kept, it is never reused.
+ *
+ ********************************************************************/
+
+static void RetireDeltaMemory(MEM_OFFSET offset, size_t size)
+{
+    DeltaRetired *item;
+
+    if ((delta_state.numRetired == delta_state.maxRetired) &&
+            !GrowDeltaArray((void **)&delta_state.retired, &delta_state.maxRetired,
+                sizeof(DeltaRetired)))
+        return;
+
+    item = &delta_state.retired[delta_state.numRetired++];
+    item->version = delta_state.version;
+    item->offset = offset;
+    item->size = (uint32_t)size;
+}
+
+/********************************************************************
+ * Function: ReleaseDeltaMemory
+ *
+ * Reuse the memory and the slots made unreachable by delta updates up to
+ * released_version, which all readers have seen.
+ *
+ ********************************************************************/
+
+static void ReleaseDeltaMemory(uint32_t released_version)
+{
+    uint32_t i;
+
+    for (i = 0; i < delta_state.numRetired; i++)
+    {
+        DeltaRetired *item = &delta_state.retired[i];
+
+        if ((int32_t)(item->version - released_version) > 0)
+            break;
+
+        if (item->size)
+            segment_release(item->offset, item->size);
+
+        else if ((delta_state.numFreeSlots < delta_state.maxFreeSlots) ||
+                GrowDeltaArray((void **)&delta_state.freeSlots,
+                    &delta_state.maxFreeSlots, sizeof(FLAT_INDEX)))
+            delta_state.freeSlots[delta_state.numFreeSlots++] = item->offset;
+    }
+
+    if (i)
+    {
+        delta_state.numRetired -= i;
+        memmove(delta_state.retired, &delta_state.retired[i],
+                delta_state.numRetired * sizeof(DeltaRetired));
+    }
+}
+
+/*********************************************************************
+ * Call dispose() with each block of IP reputation information
+ *********************************************************************/
+static void disposeInfo(INFO info, uint8_t *base, retireMemFunc dispose)
+{
+    while (info)
+    {
+        INFO next = ((IPrepInfo *)&base[info])->next;
+        dispose(info, sizeof(IPrepInfo));
+        info = next;
+    }
+}
+
+/*********************************************************************
+ * Create IP reputation information holding the given list indexes
+ *
+ * RETURNS:
+ *     the new information, 0 if out of memory
+ *********************************************************************/
+static INFO createInfo(char *indexes, int count, uint8_t *base)
+{
+    INFO info = 0;
+    MEM_OFFSET *link = &info;
+    IPrepInfo *repInfo = NULL;
+    int i;
+
+    for (i = 0; i < count; i++)
+    {
+        if (!(i % NUM_INDEX_PER_ENTRY))
+        {
+            MEM_OFFSET ipInfo_ptr = segment_calloc(1,sizeof(IPrepInfo));
+
+            if (!ipInfo_ptr)
+            {
+                /*Nobody has seen it yet*/
+                disposeInfo(info, base, segment_release);
+                return 0;
+            }
+            *link = ipInfo_ptr;
+            repInfo = (IPrepInfo *)&base[ipInfo_ptr];
+            link = &repInfo->next;
+        }
+        repInfo->listIndexes[i % NUM_INDEX_PER_ENTRY] = indexes[i];
+    }
+
+    return info;
+}
+
+/********************************************************************
+ * Function: UpdateHostInList
+ *
+ * Add a host address to, or remove it from, a list. The host gets a new
+ * data table slot with new information, leaving what readers might be
+ * looking at untouched. The order of the lists is kept, so an added list
+ * comes last, as it does when the lists are loaded.
+ *
+ * Arguments:
+ *  sfip_t *: host address, in host byte order
+ *  char: index of the list
+ *  bool: true to add, false to remove
+ *  table_flat_t *: the table being updated
+ *
+ * Returns:
+ *  IP_INSERT_SUCCESS
+ *  IP_INSERT_DUPLICATE: already in the list
+ *  IP_NOT_LISTED: not in the list
+ *  IP_MEM_ALLOC_FAILURE: out of memory or data table slots
+ *  IP_INSERT_FAILURE
+ *
+ ********************************************************************/
+
+static int UpdateHostInList(sfip_t *ipAddr, char listIndex, bool add,
+        table_flat_t *table)
+{
+    uint8_t *base = (uint8_t *)table;
+    INFO *data = (INFO *)&base[table->data];
+    char indexes[MAX_IPLIST_FILES];
+    tuple_flat_t tuple;
+    IPrepInfo *repInfo;
+    FLAT_INDEX slot = 0;
+    MEM_OFFSET old_slot;
+    int count = 0;
+    int i;
+    int iRet;
+
+    /*Current lists of the host, including the ones inherited from networks*/
+    tuple = sfrt_flat_pending_lookup((void *)ipAddr, table);
+
+    repInfo = data[tuple.index] ? (IPrepInfo *)&base[data[tuple.index]] : NULL;
+
+    while (repInfo)
+    {
+        for (i = 0; i < NUM_INDEX_PER_ENTRY; i++)
+        {
+            if (!repInfo->listIndexes[i])
+                break;
+            if (count < MAX_IPLIST_FILES)
+                indexes[count++] = repInfo->listIndexes[i];
+        }
+        if (!repInfo->next)
+            break;
+        repInfo = (IPrepInfo *)&base[repInfo->next];
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        if (indexes[i] == listIndex)
+            break;
+    }
+
+    if (add)
+    {
+        if (i < count)
+            return IP_INSERT_DUPLICATE;
+        if (count == MAX_IPLIST_FILES)
+            return IP_INSERT_FAILURE;
+        indexes[count++] = listIndex;
+    }
+    else
+    {
+        if (i == count)
+            return IP_NOT_LISTED;
+        memmove(&indexes[i], &indexes[i + 1], count - i - 1);
+        count--;
+    }
+
+    /*A host that is in no list any more uses slot 0, which is empty*/
+    if (count)
+    {
+        if (delta_state.numFreeSlots)
+            slot = delta_state.freeSlots[--delta_state.numFreeSlots];
+        else if (table->num_ent < table->max_size)
+            slot = table->num_ent++;
+        else
+            return IP_MEM_ALLOC_FAILURE;
+
+        if (!(data[slot] = createInfo(indexes, count, base)))
+            return IP_MEM_ALLOC_FAILURE;
+    }
+
+    iRet = sfrt_flat_update_host((void *)ipAddr, slot, table,
+            &RetireDeltaMemory, &old_slot);
+
+    if (MEM_ALLOC_FAILURE == iRet)
+        return IP_MEM_ALLOC_FAILURE;
+    else if (RT_SUCCESS != iRet)
+        return IP_INSERT_FAILURE;
+
+    /*The previous slot of a host entry belonged to that host only*/
+    if (old_slot)
+    {
+        disposeInfo(data[old_slot], base, &RetireDeltaMemory);
+        RetireDeltaMemory(old_slot, 0);
+    }
+
+    return IP_INSERT_SUCCESS;
+}
+
+/********************************************************************
+ * Function: LoadListNetworks
+ *
+ * Read the networks (entries less specific than a host) of a list file.
+ * A host removed from the list by a delta file is still listed after a
+ * full load if one of them covers it.
+ *
+ * Arguments:
+ *  filename: list file name
+ *  networks: the networks, in network byte order, to be freed by the
+ *            caller
+ *
+ * Returns:
+ *  the number of networks, -1 if the file can't be read
+ *
+ ********************************************************************/
+
+static int LoadListNetworks(char *filename, sfip_t **networks)
+{
+    char linebuf[MAX_ADDR_LINE_LENGTH];
+    FILE *fp = NULL;
+    char *cmt = NULL;
+    int count = 0;
+    int max = 0;
+
+    *networks = NULL;
+
+    if((fp = fopen(filename, "r")) == NULL)
+        return -1;
+
+    while( fgets(linebuf, MAX_ADDR_LINE_LENGTH, fp) )
+    {
+        sfip_t address;
+
+        // Remove comments
+        if( (cmt = strchr(linebuf, '#')) )
+            *cmt = '\0';
+
+        // Remove newline as well, prevent double newline in logging.
+        if( (cmt = strchr(linebuf, '\n')) )
+            *cmt = '\0';
+
+        if ( *linebuf == '\0' )
+            continue;
+
+        if ( snort_pton(linebuf, &address) < 1 )
+            continue;
+
+        if (address.bits == ((address.family == AF_INET) ? 32 : 128))
+            continue;
+
+        if (count == max)
+        {
+            sfip_t *grown;
+
+            max = max ? max * 2 : 64;
+            if ((grown = realloc(*networks, max * sizeof(sfip_t))) == NULL)
+            {
+                free(*networks);
+                *networks = NULL;
+                fclose(fp);
+                return -1;
+            }
+            *networks = grown;
+        }
+        (*networks)[count++] = address;
+    }
+
+    fclose(fp);
+    return count;
+}
+
+/********************************************************************
+ * Function: LoadDeltaFile
+ *
+ * Apply the host addresses in one delta file to a list. Invalid lines
+ * are skipped as they are in list files.
+ *
+ * Arguments:
+ *  filename: list file name
+ *  suffix: delta file suffix
+ *  listIndex: index of the list
+ *  add: true to add the addresses, false to remove them
+ *  table_flat_t *: the table being updated
+ *
+ * Returns:
+ *  0 successful, or the file doesn't exist
+ *  -1 the lists have to be loaded again instead
+ *
+ ********************************************************************/
+
+static int LoadDeltaFile(char *filename, const char *suffix, char listIndex,
+        bool add, table_flat_t *table)
+{
+    char linebuf[MAX_ADDR_LINE_LENGTH];
+    char delta_filename[PATH_MAX+1];
+    int addrline = 0;
+    FILE *fp = NULL;
+    char *cmt = NULL;
+    int iRet = 0;
+    sfip_t *networks = NULL;
+    int num_networks = -1;            /*not read yet*/
+
+    /*entries processing statistics*/
+    unsigned int changed_count = 0;   /*number of entries applied*/
+    unsigned int unchanged_count = 0; /*number of entries with no effect*/
+    unsigned int invalid_count = 0;   /*number of invalid entries in this file*/
+
+    snprintf(delta_filename, sizeof(delta_filename), "%s%s", filename, suffix);
+
+    if((fp = fopen(delta_filename, "r")) == NULL)
+    {
+        char errBuf[STD_BUF];
+
+        if (errno == ENOENT)
+            return 0;
+
+        strerror_r(errno, errBuf, STD_BUF);
+        errBuf[STD_BUF-1] = '\0';
+        _dpd.errMsg("Reputation preprocessor: Unable to open delta file %s, Error: %s\n",
+            delta_filename, errBuf);
+        return -1;
+    }
+
+    _dpd.logMsg("    Processing delta file %s\n", delta_filename);
+
+    while( fgets(linebuf, MAX_ADDR_LINE_LENGTH, fp) )
+    {
+        sfip_t address;
+
+        addrline++;
+
+        // Remove comments
+        if( (cmt = strchr(linebuf, '#')) )
+            *cmt = '\0';
+
+        // Remove newline as well, prevent double newline in logging.
+        if( (cmt = strchr(linebuf, '\n')) )
+            *cmt = '\0';
+
+        if ( *linebuf == '\0' )
+            continue;
+
+        if ( snort_pton(linebuf, &address) < 1 )
+        {
+            if (invalid_count++ < MAX_MSGS_TO_PRINT)
+                _dpd.errMsg("      (%d) => Invalid address: \'%s\'\n", addrline, linebuf);
+            continue;
+        }
+
+        /*A host that stays covered by a network of the list keeps the
+         *list, which can't be told apart from its own entry in the table*/
+        if (!add && ((address.family == AF_INET) ? (address.bits == 32) :
+                    (address.bits == 128)))
+        {
+            int i;
+
+            if ((num_networks < 0) &&
+                    ((num_networks = LoadListNetworks(filename, &networks)) < 0))
+            {
+                _dpd.errMsg("Reputation preprocessor: Unable to read the networks of %s\n",
+                    filename);
+                iRet = -1;
+                break;
+            }
+
+            for (i = 0; i < num_networks; i++)
+            {
+                if (sfip_contains(&networks[i], &address) == SFIP_CONTAINS)
+                    break;
+            }
+
+            if (i < num_networks)
+            {
+                _dpd.logMsg("    (%d) => Address \'%s\' is still covered by a network of the list\n",
+                    addrline, linebuf);
+                iRet = -1;
+                break;
+            }
+        }
+
+        if (address.family == AF_INET)
+        {
+            if (address.bits != 32)
+                iRet = -1;
+            address.ip32[0] = ntohl(address.ip32[0]);
+        }
+        else
+        {
+            int i;
+            if (address.bits != 128)
+                iRet = -1;
+            for(i = 0; i < 4 ; i++)
+                address.ip32[i] = ntohl(address.ip32[i]);
+        }
+
+        /*Networks can overlap other entries in many places, leave them to
+         *a full load*/
+        if (iRet)
+        {
+            _dpd.logMsg("    (%d) => Network address \'%s\' can't be applied as a delta\n",
+                addrline, linebuf);
+            break;
+        }
+
+        switch (UpdateHostInList(&address, listIndex, add, table))
+        {
+        case IP_INSERT_SUCCESS:
+            changed_count++;
+            break;
+
+        case IP_INSERT_DUPLICATE:
+        case IP_NOT_LISTED:
+            unchanged_count++;
+            break;
+
+        case IP_MEM_ALLOC_FAILURE:
+            _dpd.errMsg("WARNING: %s(%d) => No room left in shared memory for IP Address: %s\n",
+                delta_filename, addrline, linebuf);
+            iRet = -1;
+            break;
+
+        default:
+            _dpd.errMsg("      (%d) => Failed to update address: \'%s\'\n", addrline, linebuf);
+            iRet = -1;
+            break;
+        }
+
+        if (iRet)
+            break;
+    }
+
+    fclose(fp);
+
+    if (networks)
+        free(networks);
+
+    if (iRet)
+        return iRet;
+
+    total_invalids += invalid_count;
+    total_duplicates += unchanged_count;
+    if (invalid_count > MAX_MSGS_TO_PRINT)
+        _dpd.errMsg("    Additional invalid addresses were not listed.\n");
+
+    _dpd.logMsg("    Reputation entries %s: %u, unchanged: %u, invalid: %u (from file %s)\n",
+            add ? "added" : "removed", changed_count, unchanged_count,
+            invalid_count, delta_filename);
+
+    return 0;
+}
+
+/* ********************************************************************
+ * Function: LoadDeltaFilesIntoShmem
+ *
+ * Call back function for shared memory
+ * This is called when the version file has a DELTA_BASE equal to the
+ * version of the active segment. For each list file, the addresses in
+ * "<list file>.del" are removed from the list and the ones in
+ * "<list file>.add" are added, in the table in the active segment.
+ * Updates are published together at the end, see sfrt_flat_publish().
+ *
+ * Arguments:
+ *
+ * void* ptrSegment: start of the active shared memory segment.
+ * uint32_t size: size of the segment
+ * ShmemDataFileList** file_list: the list of whitelist/blacklist files
+ * int num_files: number of files
+ * uint32_t version: the delta version of this update
+ * uint32_t released_version: all readers have seen this delta version
+ *
+ * RETURNS:
+ *     0: success
+ *     other value fails, and all files need to be loaded
+ *********************************************************************/
+
+int LoadDeltaFilesIntoShmem(void* ptrSegment, uint32_t size,
+        ShmemDataFileList** file_list, int num_files,
+        uint32_t version, uint32_t released_version)
+{
+    table_flat_t *table = (table_flat_t *)ptrSegment;
+    ListInfo *listInfo;
+    uint32_t num_retired;
+    uint32_t num_free_slots;
+    uint32_t num_ent;
+    int i;
+
+    if (num_files > MAX_IPLIST_FILES)
+        num_files = MAX_IPLIST_FILES;
+
+    /*The segment allocator must still be the one that loaded this segment*/
+    if ((ptrSegment != delta_state.segment) || (ptrSegment != segment_basePtr()))
+        return -1;
+
+    listInfo = (ListInfo *)((uint8_t *)ptrSegment + table->list_info);
+
+    if (num_files != delta_state.numLists)
+    {
+        _dpd.logMsg("Reputation Preprocessor: IP lists have changed, delta files are ignored.\n");
+        return -1;
+    }
+
+    for (i = 0; i < num_files; i++)
+    {
+        if ((listInfo[i].listType != (uint8_t)file_list[i]->filetype) ||
+                (listInfo[i].listId != file_list[i]->listid) ||
+                memcmp(listInfo[i].zones, file_list[i]->zones, MAX_NUM_ZONES))
+        {
+            _dpd.logMsg("Reputation Preprocessor: IP lists have changed, delta files are ignored.\n");
+            return -1;
+        }
+    }
+
+    ReleaseDeltaMemory(released_version);
+
+    /*Whatever this update allocates is given back if it is discarded*/
+    segment_mark();
+
+    delta_state.version = version;
+    num_retired = delta_state.numRetired;
+    num_free_slots = delta_state.numFreeSlots;
+    num_ent = table->num_ent;
+
+    _dpd.logMsg("Reputation Preprocessor: applying delta files to shared memory\n");
+
+    total_invalids = 0;
+    total_duplicates = 0;
+    for (i = 0; i < num_files; i++)
+    {
+        if (LoadDeltaFile(file_list[i]->filename, DELTA_DEL_SUFFIX,
+                    listInfo[i].listIndex, false, table) ||
+                LoadDeltaFile(file_list[i]->filename, DELTA_ADD_SUFFIX,
+                    listInfo[i].listIndex, true, table))
+        {
+            /*Readers never saw any of it; what was retired is still in use*/
+            sfrt_flat_discard(table);
+            segment_rollback();
+            delta_state.numRetired = num_retired;
+            delta_state.numFreeSlots = num_free_slots;
+            table->num_ent = num_ent;
+            _dpd.logMsg("Reputation Preprocessor: delta files not applied, loading all IP lists.\n");
+            return -1;
+        }
+    }
+
+    segment_unmark();
+    sfrt_flat_publish(table, &RetireDeltaMemory);
+
+    reputation_shmem_config->iplist = table;
+    reputation_shmem_config->listInfo = listInfo;
+    reputation_shmem_config->memsize = size;
+    reputation_shmem_config->memCapReached = false;
+
+    _dpd.logMsg("Reputation Preprocessor shared memory summary:\n");
+    DisplayIPlistStats(reputation_shmem_config);
+    return 0;
+}
+#endif
+
 /********************************************************************
  * Function: Reputation_FreeConfig
  *
@@ -39,4 +39,8 @@
 #define VERSION_FILENAME "IPRVersion.dat"
 #define MANIFEST_FILENAME "zone.info"
 
+/* Appended to the name of a list file to get its delta files */
+#define DELTA_ADD_SUFFIX ".add"
+#define DELTA_DEL_SUFFIX ".del"
+
 #endif
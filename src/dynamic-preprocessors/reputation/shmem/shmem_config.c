@@ -97,7 +97,8 @@ exit:
 int InitShmemDataMgmtFunctions (
     CreateMallocZero create_malloc_zero,
     GetDataSize get_data_size,
-    LoadData load_data)
+    LoadData load_data,
+    UpdateData update_data)
 {
     if ((dmfunc_ptr = (ShmemDataMgmtFunctions*)
                       malloc(sizeof(ShmemDataMgmtFunctions))) == NULL)
@@ -109,6 +110,7 @@ int InitShmemDataMgmtFunctions (
     dmfunc_ptr->CreatePerProcessZeroSegment = create_malloc_zero;   
     dmfunc_ptr->GetSegmentSize = get_data_size;
     dmfunc_ptr->LoadShmemData  = load_data;
+    dmfunc_ptr->UpdateShmemData = update_data;
 
     return SF_SUCCESS;
 }
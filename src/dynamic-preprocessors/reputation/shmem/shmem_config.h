@@ -88,11 +88,14 @@ typedef struct shmemDataManagmentFunctions {
     int (*CreatePerProcessZeroSegment)(void*** data_ptr);
     uint32_t (*GetSegmentSize)(ShmemDataFileList** file_list, int file_count);
     int (*LoadShmemData)(void* data_ptr, ShmemDataFileList** file_list, int file_count);
+    int (*UpdateShmemData)(void* data_ptr, uint32_t size, ShmemDataFileList** file_list,
+        int file_count, uint32_t delta_version, uint32_t released_version);
 } ShmemDataMgmtFunctions;
 
 typedef int      (*CreateMallocZero)(void***);
 typedef uint32_t (*GetDataSize)(ShmemDataFileList**, int);
 typedef int      (*LoadData)(void*,ShmemDataFileList**,int);
+typedef int      (*UpdateData)(void*,uint32_t,ShmemDataFileList**,int,uint32_t,uint32_t);
 
 extern ShmemDataMgmtFunctions *dmfunc_ptr; 
 extern ShmemUserInfo *shmusr_ptr;
@@ -105,7 +108,7 @@ int InitShmemUser(
 
 int InitShmemDataMgmtFunctions(
     CreateMallocZero create_malloc_zero, GetDataSize get_data_size,
-    LoadData load_data);
+    LoadData load_data, UpdateData update_data);
 
 void FreeShmemUser(void);
 void FreeShmemDataMgmtFunctions(void);
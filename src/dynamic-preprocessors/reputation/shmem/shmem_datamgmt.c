@@ -485,14 +485,12 @@ int GetSortedListOfShmemDataFiles()
     return SF_SUCCESS;
 }
 
-//valid version values are 1 through UINT_MAX
-int GetLatestShmemDataSetVersionOnDisk(uint32_t* shmemVersion)
+static int GetShmemDataSetValueOnDisk(const char* key, uint32_t* shmemVersion)
 {
     unsigned long tmpVersion;
     FILE *fp;
     char line[PATH_MAX];
     char version_file[PATH_MAX];
-    const char *const key = "VERSION";
     char* keyend_ptr      = NULL;
 
     snprintf(version_file, sizeof(version_file),
@@ -540,11 +538,23 @@ int GetLatestShmemDataSetVersionOnDisk(uint32_t* shmemVersion)
     fclose(fp);
 
     DEBUG_WRAP(DebugMessage(DEBUG_REPUTATION,
-            "version information being returned is %u\n", *shmemVersion););
+            "%s information being returned is %u\n", key, *shmemVersion););
 
     return SF_SUCCESS;
 }
 
+//valid version values are 1 through UINT_MAX
+int GetLatestShmemDataSetVersionOnDisk(uint32_t* shmemVersion)
+{
+    return GetShmemDataSetValueOnDisk("VERSION", shmemVersion);
+}
+
+//version the delta files in the list directory apply to, if any
+int GetShmemDataSetDeltaBaseOnDisk(uint32_t* baseVersion)
+{
+    return GetShmemDataSetValueOnDisk("DELTA_BASE", baseVersion);
+}
+
 #ifdef DEBUG_MSGS
 void PrintListInfo (bool *zones, uint32_t listid)
 {
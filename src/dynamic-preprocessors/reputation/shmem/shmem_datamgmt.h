@@ -59,6 +59,7 @@ extern int filelist_count;
 /* Functions ****************************************************************/
 int GetSortedListOfShmemDataFiles(void);
 int GetLatestShmemDataSetVersionOnDisk(uint32_t*);
+int GetShmemDataSetDeltaBaseOnDisk(uint32_t*);
 void FreeShmemDataFileList(void);
 
 #ifdef DEBUG_MSGS
@@ -58,6 +58,7 @@ static void SetShmemMgmtVariables(int value, uint32_t instance_num)
     mgmt_ptr->instance[instance_num].version                   =  0;
     mgmt_ptr->instance[instance_num].activeSegment             = NO_DATASEG;
     mgmt_ptr->instance[instance_num].prevSegment               = NO_DATASEG;
+    mgmt_ptr->instance[instance_num].deltaVersion              = mgmt_ptr->deltaVersion;
     mgmt_ptr->instance[instance_num].updateTime                = time(NULL);
 
     mgmt_ptr->instance[instance_num].shmemCurrPtr              = temp_zerosegptr;
@@ -82,6 +83,7 @@ static void InitShmemDataSegmentMgmtVariables()
 {
     int i;
     mgmt_ptr->activeSegment = NO_DATASEG;
+    mgmt_ptr->deltaVersion  = 0;
 
     for (i=0; i<MAX_SEGMENTS; i++)
     {
@@ -129,6 +131,17 @@ static void DoHeartbeat()
     return;
 }
 
+// called by the packet thread between packets, when no lookup is in
+// progress, so any later lookup starts from the latest published tables
+void MarkShmemQuiescent()
+{
+    if (mgmt_ptr && shmusr_ptr)
+    {
+        mgmt_ptr->instance[shmusr_ptr->instance_num].deltaVersion =
+            mgmt_ptr->deltaVersion;
+    }
+}
+
 void ForceShutdown()
 {
     int currActiveSegment;
@@ -371,13 +384,64 @@ exit:
     return segment_num;
 }
 
+// latest delta version that every active instance has seen while quiescent
+static uint32_t FindDeltaVersionSeenByAll()
+{
+    uint32_t version = mgmt_ptr->deltaVersion;
+    int i;
+
+    for (i=0; i<MAX_INSTANCES; i++)
+    {
+        if (mgmt_ptr->instance[i].active && !mgmt_ptr->instance[i].goInactive)
+        {
+            if ((int32_t)(mgmt_ptr->instance[i].deltaVersion - version) < 0)
+                version = mgmt_ptr->instance[i].deltaVersion;
+        }
+    }
+    return version;
+}
+
+// writer side
+// apply the delta files to the active segment in place instead of loading
+// all files into a new one.  memory replaced by an earlier delta update is
+// released once every instance has been quiescent since it was replaced.
+static int UpdateSharedMemDataSegmentForWriter(uint32_t disk_version)
+{
+    int segment_num = mgmt_ptr->activeSegment;
+    uint32_t delta_version = mgmt_ptr->deltaVersion + 1;
+
+    if (segment_num < 0 ||
+        mgmt_ptr->instance[shmusr_ptr->instance_num].activeSegment != segment_num)
+        return NO_DATASEG;
+
+    if (dmfunc_ptr->UpdateShmemData((void *)(
+        mgmt_ptr->instance[shmusr_ptr->instance_num].shmemSegmentPtr[segment_num]),
+        mgmt_ptr->segment[segment_num].size, filelist_ptr, filelist_count,
+        delta_version, FindDeltaVersionSeenByAll()) != SF_SUCCESS)
+    {
+        DEBUG_WRAP(DebugMessage(DEBUG_REPUTATION,
+            "Delta update of segment %d failed, reloading all files\n",segment_num););
+        return NO_DATASEG;
+    }
+
+    // the updated tables have been published before the version is
+    __sync_synchronize();
+    mgmt_ptr->deltaVersion = delta_version;
+    mgmt_ptr->segment[segment_num].version = disk_version;
+
+    DEBUG_WRAP(DebugMessage(DEBUG_REPUTATION,
+        "Segment %d updated to version %u, delta version %u\n",
+        segment_num,disk_version,delta_version););
+
+    return segment_num;
+}
 
 int LoadSharedMemDataSegmentForWriter(int startup)
 {
     int segment_num = NO_DATASEG;
     int rval;
     uint32_t size;
-    uint32_t disk_version, shmem_version;
+    uint32_t disk_version, shmem_version, delta_base;
 
     if ( !mgmt_ptr )
         return NO_DATASEG;
@@ -410,6 +474,14 @@ int LoadSharedMemDataSegmentForWriter(int startup)
     PrintDataFiles();
 #endif
 
+    if (!startup && shmem_version && dmfunc_ptr->UpdateShmemData &&
+        (GetShmemDataSetDeltaBaseOnDisk(&delta_base) == SF_SUCCESS) &&
+        (delta_base == shmem_version))
+    {
+        if ((segment_num = UpdateSharedMemDataSegmentForWriter(disk_version)) >= 0)
+            goto exit;
+    }
+
     if ((size = dmfunc_ptr->GetSegmentSize(filelist_ptr, filelist_count)) != ZEROSEG)
     {
         segment_num = InitSharedMemDataSegmentForWriter(size,disk_version);
@@ -669,7 +741,8 @@ void ShmemMgmtInfo(char *buf, int bufLen)
     }
 
     writed = snprintf(index, len, 
-        "active segment:%d\n\n",mgmt_ptr->activeSegment);
+        "active segment:%d delta version:%u\n\n",
+        mgmt_ptr->activeSegment,mgmt_ptr->deltaVersion);
     /* returning either way */
 }
 
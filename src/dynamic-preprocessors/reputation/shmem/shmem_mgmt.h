@@ -37,6 +37,7 @@ typedef struct _shmemInstance {
     time_t          updateTime;
     int             activeSegment;
     int             prevSegment;
+    uint32_t        deltaVersion;   // delta version seen while quiescent
     int             shmemSegActiveFlag[MAX_SEGMENTS];
     void*           shmemSegmentPtr[MAX_SEGMENTS];
     void*           shmemCurrPtr;
@@ -53,6 +54,7 @@ typedef struct _shmemMgmtData {
     shmemInstance   instance[MAX_INSTANCES];
     shmemSegment    segment[MAX_SEGMENTS];
     int             activeSegment;
+    uint32_t        deltaVersion;   // incremented by each delta update
 } ShmemMgmtData;
 
 extern void *zeroseg_ptr;
@@ -68,6 +70,7 @@ int   LoadSharedMemDataSegmentForWriter(int startup);
 void  SwitchToActiveSegment(int segment_num,void*** data_ptr);
 void  UnmapInactiveSegments(void);
 void  ManageUnusedSegments(void);
+void  MarkShmemQuiescent(void);
 int   ShutdownSharedMemory(void);
 void ShmemMgmtInfo(char *buf, int bufLen);
 void  PrintShmemMgmtInfo(void);
@@ -392,6 +392,10 @@ static void ReputationMaintenanceCheck(int signal, void *data)
 /*Switch for idle*/
 static void ReputationShmemSwitch(void)
 {
+    /*No lookup is in progress here, let the writer know which delta
+     *updates this instance has seen*/
+    MarkShmemQuiescent();
+
     if (switch_state == NO_SWITCH)
         return;
 
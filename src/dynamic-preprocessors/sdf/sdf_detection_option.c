@@ -148,6 +148,7 @@ int SDFOtnHandler(struct _SnortConfig *sc, void *potn)
     PreprocessorOptionInfo *preproc_info = NULL;
     tSfPolicyUserContextId context_to_use = sdf_context->context_id;
     sdf_tree_node *head_node_to_use = sdf_context->head_node;
+    sdf_prefilter *prefilter_to_use = &sdf_context->prefilter;
     uint32_t *num_patterns_to_use = &sdf_context->num_patterns;
     int sdf_option_added = 0;
 
@@ -160,6 +161,7 @@ int SDFOtnHandler(struct _SnortConfig *sc, void *potn)
     {
         context_to_use = sdf_swap_context->context_id;
         head_node_to_use = sdf_swap_context->head_node;
+        prefilter_to_use = &sdf_swap_context->prefilter;
         num_patterns_to_use = &sdf_swap_context->num_patterns;
     }
 #endif
@@ -202,6 +204,7 @@ int SDFOtnHandler(struct _SnortConfig *sc, void *potn)
 
         /* Add the pattern to the SDF pattern-matching tree */
         AddPii(head_node_to_use, sdf_data);
+        BuildPiiPrefilter(head_node_to_use, prefilter_to_use);
         sdf_data->counter_index = (*num_patterns_to_use)++;
 
         AddPortsToConf(sc, config, otn);
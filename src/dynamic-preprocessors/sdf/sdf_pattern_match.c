@@ -483,6 +483,218 @@ int FreePiiTree(sdf_tree_node *node)
     return 0;
 }
 
+/* Fill "bytes" with the set of bytes that the pattern element at "pattern"
+ * matches, exactly as FindPiiRecursively() evaluates it. Returns the
+ * number of pattern characters the element takes up, not counting a
+ * trailing '?'. */
+static int PiiElementClass(const char *pattern, uint8_t *bytes)
+{
+    int c;
+
+    if (pattern[0] == '\\' && pattern[1] != '\0')
+    {
+        for (c = 0; c < 256; c++)
+        {
+            switch (pattern[1])
+            {
+                case '\\':
+                case '{':
+                case '}':
+                case '?':
+                    bytes[c] = ((char)c == pattern[1]);
+                    break;
+                case 'd':
+                    bytes[c] = (isdigit((int)(char)c) != 0);
+                    break;
+                case 'D':
+                    bytes[c] = (isdigit((int)(char)c) == 0);
+                    break;
+                case 'w':
+                    bytes[c] = (isalnum((int)(char)c) != 0);
+                    break;
+                case 'W':
+                    bytes[c] = (isalnum((int)(char)c) == 0);
+                    break;
+                case 'l':
+                    bytes[c] = (isalpha((int)(char)c) != 0);
+                    break;
+                case 'L':
+                    bytes[c] = (isalpha((int)(char)c) == 0);
+                    break;
+                default:
+                    /* Unknown escapes don't constrain the match */
+                    bytes[c] = 1;
+                    break;
+            }
+        }
+        return 2;
+    }
+
+    for (c = 0; c < 256; c++)
+        bytes[c] = ((char)c == pattern[0]);
+
+    return 1;
+}
+
+/* Pick the element of a top-level node's pattern that matches the fewest
+ * bytes, among those at a fixed offset (i.e. before any optional element).
+ * Returns 0 if no such element exists. */
+static int PiiNodeAnchor(sdf_tree_node *node, uint16_t *offset, uint8_t *bytes)
+{
+    const char *pattern = node->pattern;
+    uint8_t element[256];
+    uint16_t element_offset = 0;
+    int best_count = 257;
+
+    while (*pattern != '\0')
+    {
+        int len, c, count = 0;
+
+        len = PiiElementClass(pattern, element);
+        pattern += len;
+
+        if (*pattern == '?')
+            break;
+
+        for (c = 0; c < 256; c++)
+            count += element[c];
+
+        if (count < best_count)
+        {
+            best_count = count;
+            *offset = element_offset;
+            memcpy(bytes, element, sizeof(element));
+        }
+
+        element_offset++;
+    }
+
+    return (best_count < 256);
+}
+
+/* Build the prefilter from the top-level nodes of the pattern tree. This is
+ * rebuilt whenever a pattern is added. */
+void BuildPiiPrefilter(sdf_tree_node *head, sdf_prefilter *prefilter)
+{
+    uint16_t i, j;
+    int c;
+
+    if (head == NULL || prefilter == NULL)
+        return;
+
+    memset(prefilter, 0, sizeof(*prefilter));
+
+    for (i = 0; i < head->num_children; i++)
+    {
+        uint16_t offset = 0;
+        uint8_t bytes[256];
+        sdf_anchor *anchor = NULL;
+
+        if (!PiiNodeAnchor(head->children[i], &offset, bytes))
+        {
+            prefilter->num_anchors = 0;
+            return;
+        }
+
+        for (j = 0; j < prefilter->num_anchors; j++)
+        {
+            if (prefilter->anchors[j].offset == offset)
+            {
+                anchor = &prefilter->anchors[j];
+                break;
+            }
+        }
+
+        if (anchor == NULL)
+        {
+            if (prefilter->num_anchors == SDF_MAX_ANCHORS)
+            {
+                prefilter->num_anchors = 0;
+                return;
+            }
+            anchor = &prefilter->anchors[prefilter->num_anchors++];
+            anchor->offset = offset;
+        }
+
+        for (c = 0; c < 256; c++)
+            anchor->bytes[c] |= bytes[c];
+    }
+
+    for (j = 0; j < prefilter->num_anchors; j++)
+    {
+        sdf_anchor *anchor = &prefilter->anchors[j];
+
+        anchor->digits_only = 1;
+        for (c = 0; c < 256; c++)
+        {
+            if (anchor->bytes[c] && !isdigit((int)(char)c))
+                anchor->digits_only = 0;
+        }
+    }
+}
+
+/* Nonzero if any byte of the 64-bit word x is an ASCII digit. */
+#define SDF_BYTES(n) (0x0101010101010101ULL * (n))
+#define SDF_HAS_DIGIT(x) \
+    (((SDF_BYTES(127 + '9' + 1) - ((x) & SDF_BYTES(127))) & ~(x) & \
+      (((x) & SDF_BYTES(127)) + SDF_BYTES(127 - ('0' - 1)))) & SDF_BYTES(128))
+
+/* Returns the first position at or after "position" where a pattern could
+ * begin, or "end" if there is none. Positions too close to the end of the
+ * buffer for the anchor byte to be present are always candidates, since
+ * FindPii() accepts a pattern cut short by the end of the buffer. */
+char * FindPiiCandidate(sdf_prefilter *prefilter, char *position, char *end)
+{
+    const uint8_t *p, *stop = (const uint8_t *)end;
+    sdf_anchor *anchor;
+    uint16_t i;
+
+    if (prefilter == NULL || prefilter->num_anchors == 0)
+        return position;
+
+    if (prefilter->num_anchors > 1)
+    {
+        for (; position < end; position++)
+        {
+            for (i = 0; i < prefilter->num_anchors; i++)
+            {
+                anchor = &prefilter->anchors[i];
+                if (anchor->offset >= end - position ||
+                    anchor->bytes[(uint8_t)position[anchor->offset]])
+                    return position;
+            }
+        }
+        return end;
+    }
+
+    anchor = &prefilter->anchors[0];
+    if (anchor->offset >= end - position)
+        return position;
+
+    p = (const uint8_t *)position + anchor->offset;
+
+    /* Skip over runs without a digit a word at a time. */
+    if (anchor->digits_only)
+    {
+        while (p + sizeof(uint64_t) <= stop)
+        {
+            uint64_t word;
+            memcpy(&word, p, sizeof(word));
+            if (SDF_HAS_DIGIT(word))
+                break;
+            p += sizeof(word);
+        }
+    }
+
+    for (; p < stop; p++)
+    {
+        if (anchor->bytes[*p])
+            return (char *)p - anchor->offset;
+    }
+
+    return end - anchor->offset;
+}
+
 /* Returns an sdf_tree_node that matches the pattern */
 static sdf_tree_node * FindPiiRecursively(sdf_tree_node *node, char *buf, uint16_t *buf_index, uint16_t buflen, SDFConfig *config)
 {
@@ -31,6 +31,9 @@ int SplitNode(sdf_tree_node *node, uint16_t split_index);
 sdf_tree_node * AddChild(sdf_tree_node *node, SDFOptionData *data, char *pattern);
 int FreePiiTree(sdf_tree_node *head);
 
+void BuildPiiPrefilter(sdf_tree_node *head, sdf_prefilter *prefilter);
+char * FindPiiCandidate(sdf_prefilter *prefilter, char *position, char *end);
+
 sdf_tree_node * FindPii(sdf_tree_node *head, char *buf, uint16_t *buf_index, uint16_t buflen, SDFConfig *config);
 
 #endif /* SDF_PATTERN_MATCH__H */
@@ -270,6 +270,12 @@ static void SDFSearch(SDFConfig *config, SFSnortPacket *packet,
         int index;
         sdf_tree_node *matched_node = NULL;
 
+        /* Skip ahead to the next position where a pattern could start */
+        position = FindPiiCandidate(&sdf_context->prefilter, position, end);
+        if (position >= end)
+            break;
+        buflen = (uint16_t)(end - position);
+
         /* Traverse the pattern tree and match PII against our data */
         matched_node = FindPii(sdf_context->head_node, position, &match_length,
                                buflen, config);
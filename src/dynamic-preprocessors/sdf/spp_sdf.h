@@ -52,6 +52,26 @@ typedef struct _sdf_tree_node
     SDFOptionData **option_data_list;
 } sdf_tree_node;
 
+/* Pre-scan for the pattern tree. Every top-level pattern has an "anchor":
+   its most selective element at a fixed offset from the start of the
+   pattern. A buffer position can only begin a match if the byte at an
+   anchor's offset is in that anchor's class, so FindPii() is skipped
+   everywhere else. Anchors at the same offset share one class table. */
+#define SDF_MAX_ANCHORS 4
+
+typedef struct _sdf_anchor
+{
+    uint16_t offset;
+    uint8_t digits_only;
+    uint8_t bytes[256];
+} sdf_anchor;
+
+typedef struct _sdf_prefilter
+{
+    uint16_t num_anchors;   /* 0: no prefilter, try every position */
+    sdf_anchor anchors[SDF_MAX_ANCHORS];
+} sdf_prefilter;
+
 typedef struct _SDFSessionData
 {
     uint32_t num_patterns, global_counter;
@@ -63,6 +83,7 @@ typedef struct _SDFContext
 {
     tSfPolicyUserContextId context_id;
     sdf_tree_node *head_node;
+    sdf_prefilter prefilter;
     uint32_t num_patterns;
 } SDFContext;
 
@@ -46,10 +46,19 @@ static int SIP_processResponse(SIPMsg *, SIP_DialogData *, SIP_DialogList *, SFS
 static int SIP_ignoreChannels( SIP_DialogData *, SFSnortPacket *p);
 static SIP_DialogData* SIP_addDialog(SIPMsg *, SIP_DialogData *, SIP_DialogList *);
 static int SIP_deleteDialog(SIP_DialogData *, SIP_DialogList *);
+static SIP_DialogData* SIP_findDialog(uint32_t, SIP_DialogList *);
+static void SIP_indexDialogs(SIP_DialogList *, uint32_t);
 #ifdef DEBUG_MSGS
 void SIP_displayMedias(SIP_MediaList *dList);
 #endif
 
+/* Short dialog lists are simply walked; once a session carries this many
+ * dialogs they are also indexed by Call-ID hash. The index is grown to keep
+ * no more than two dialogs per bucket on average.*/
+#define SIP_DIALOG_INDEX_THRESHOLD    8
+#define SIP_DIALOG_INDEX_MIN_BUCKETS  16
+
+#define SIP_DIALOG_BUCKET(dList, callIdHash) ((callIdHash) & ((dList)->num_buckets - 1))
 
 
 /********************************************************************
@@ -375,6 +384,8 @@ static int SIP_checkMediaChange(SIPMsg *sipMsg, SIP_DialogData *dialog)
 static int SIP_ignoreChannels( SIP_DialogData *dialog, SFSnortPacket *p)
 {
 	SIP_MediaData *mdataA,*mdataB;
+	const StreamSessionKey *key;
+	uint32_t tunnelId = 0;
 
 	if (0 == sip_eval_config->ignoreChannel)
     	return SIP_FAILURE;
@@ -392,6 +403,10 @@ static int SIP_ignoreChannels( SIP_DialogData *dialog, SFSnortPacket *p)
 	mdataA = dialog->mediaSessions->medias;
 	mdataB = dialog->mediaSessions->nextS->medias;
 	sip_stats.ignoreSessions++;
+	// media in the same GTP tunnel as the signaling can be found directly
+	if (p->stream_session_ptr &&
+	        (key = _dpd.streamAPI->get_key_from_session_ptr(p->stream_session_ptr)))
+		tunnelId = key->tunnelId;
 	while((NULL != mdataA)&&(NULL != mdataB))
     {
         void *ssn;
@@ -401,7 +416,7 @@ static int SIP_ignoreChannels( SIP_DialogData *dialog, SFSnortPacket *p)
     			sfip_to_str(&mdataB->maddress), mdataB->mport););
     	/* Call into Streams to mark data channel as something to ignore. */
     	if ((ssn = _dpd.streamAPI->get_session_ptr_from_ip_port(&mdataA->maddress,mdataA->mport, &mdataB->maddress,
-    	        mdataB->mport, IPPROTO_UDP, 0, 0, 0)))
+    	        mdataB->mport, IPPROTO_UDP, 0, 0, 0, tunnelId)))
     	{
     	    _dpd.streamAPI->set_ignore_direction(ssn, SSN_DIR_BOTH);
     	}
@@ -591,13 +606,32 @@ static SIP_DialogData* SIP_addDialog(SIPMsg *sipMsg, SIP_DialogData *currDialog,
 		// The first dialog
 		dialog->prevD = NULL;
 		dList->head = dialog;
+		dList->tail = dialog;
 	}
 	dialog->dlgID = sipMsg->dlgID;
 	dialog->creator = sipMsg->methodFlag;
 	dialog->state = SIP_DLG_CREATE;
 
+	/* Dialogs sharing a Call-ID are always added in front of the existing
+	 * ones, so adding at the bucket head keeps the list order within a bucket*/
+	if (NULL != dList->buckets)
+	{
+		uint32_t bucket = SIP_DIALOG_BUCKET(dList, dialog->dlgID.callIdHash);
+		dialog->nextH = dList->buckets[bucket];
+		dList->buckets[bucket] = dialog;
+	}
+
 	SIP_updateMedias(sipMsg->mediaSession, &dialog->mediaSessions);
     dList->num_dialogs++;
+
+	if (NULL == dList->buckets)
+	{
+		if (dList->num_dialogs >= SIP_DIALOG_INDEX_THRESHOLD)
+			SIP_indexDialogs(dList, SIP_DIALOG_INDEX_MIN_BUCKETS);
+	}
+	else if (dList->num_dialogs > (dList->num_buckets << 1))
+		SIP_indexDialogs(dList, dList->num_buckets << 1);
+
 	return dialog;
 
 }
@@ -622,16 +656,23 @@ static int SIP_deleteDialog(SIP_DialogData *currDialog, SIP_DialogList *dList)
     		currDialog->dlgID.callIdHash,currDialog->dlgID.fromTagHash,currDialog->dlgID.toTagHash));
     // If this is the header
     if(NULL ==  currDialog->prevD)
-    {
-    	if(NULL != currDialog->nextD)
-    		currDialog->nextD->prevD = NULL;
     	dList->head = currDialog->nextD;
-    }
     else
-    {
     	currDialog->prevD->nextD = currDialog->nextD;
-    	if(NULL != currDialog->nextD)
-    		currDialog->nextD->prevD = currDialog->prevD;
+
+    if(NULL == currDialog->nextD)
+    	dList->tail = currDialog->prevD;
+    else
+    	currDialog->nextD->prevD = currDialog->prevD;
+
+    if (NULL != dList->buckets)
+    {
+    	SIP_DialogData **link = &dList->buckets[SIP_DIALOG_BUCKET(dList, currDialog->dlgID.callIdHash)];
+
+    	while ((NULL != *link) && (currDialog != *link))
+    		link = &(*link)->nextH;
+    	if (NULL != *link)
+    		*link = currDialog->nextH;
     }
     sip_freeMediaList(currDialog->mediaSessions);
     free(currDialog);
@@ -639,6 +680,78 @@ static int SIP_deleteDialog(SIP_DialogData *currDialog, SIP_DialogList *dList)
         dList->num_dialogs--;
 	return SIP_SUCCESS;
 }
+/********************************************************************
+ * Function: SIP_findDialog
+ *
+ * Find the first dialog in the list with the given Call-ID
+ *
+ * Arguments:
+ *  uint32_t         - hash of the Call-ID
+ *  SIP_DialogList * - the dialog list.
+ *
+ * Returns:
+ *  SIP_DialogData * - the dialog found, NULL if none.
+ *
+ ********************************************************************/
+static SIP_DialogData* SIP_findDialog(uint32_t callIdHash, SIP_DialogList *dList)
+{
+	SIP_DialogData* dialog;
+
+	if (NULL != dList->buckets)
+	{
+		dialog = dList->buckets[SIP_DIALOG_BUCKET(dList, callIdHash)];
+		while ((NULL != dialog) && (callIdHash != dialog->dlgID.callIdHash))
+			dialog = dialog->nextH;
+		return dialog;
+	}
+
+	dialog = dList->head;
+	while(NULL != dialog)
+	{
+		DEBUG_WRAP(DebugMessage(DEBUG_SIP, "Dialog id: %u, From: %u, To: %u\n",
+				dialog->dlgID.callIdHash,dialog->dlgID.fromTagHash,dialog->dlgID.toTagHash));
+		if (callIdHash == dialog->dlgID.callIdHash)
+			break;
+		dialog = dialog->nextD;
+	}
+	return dialog;
+}
+/********************************************************************
+ * Function: SIP_indexDialogs
+ *
+ * (Re)build the Call-ID index of a dialog list
+ *
+ * Arguments:
+ *  SIP_DialogList * - the dialog list.
+ *  uint32_t         - number of buckets, a power of 2
+ *
+ * Returns: None. The current index, if any, is kept if memory runs out.
+ *
+ ********************************************************************/
+static void SIP_indexDialogs(SIP_DialogList *dList, uint32_t num_buckets)
+{
+	SIP_DialogData **buckets;
+	SIP_DialogData *dialog;
+
+	buckets = (SIP_DialogData **) calloc(num_buckets, sizeof(*buckets));
+	if (NULL == buckets)
+		return;
+
+	free(dList->buckets);
+	dList->buckets = buckets;
+	dList->num_buckets = num_buckets;
+
+	/* Walk from the tail so each bucket ends up in list order */
+	for (dialog = dList->tail; NULL != dialog; dialog = dialog->prevD)
+	{
+		uint32_t bucket = SIP_DIALOG_BUCKET(dList, dialog->dlgID.callIdHash);
+		dialog->nextH = buckets[bucket];
+		buckets[bucket] = dialog;
+	}
+
+	DEBUG_WRAP(DebugMessage(DEBUG_SIP, "Indexed %u dialogs in %u buckets\n",
+			dList->num_dialogs, num_buckets));
+}
 /********************************************************************
  * Function: SIP_updateDialog()
  *
@@ -656,7 +769,6 @@ static int SIP_deleteDialog(SIP_DialogData *currDialog, SIP_DialogList *dList)
 int SIP_updateDialog(SIPMsg *sipMsg, SIP_DialogList *dList, SFSnortPacket *p)
 {
    	SIP_DialogData* dialog;
-   	SIP_DialogData* oldDialog = NULL;
    	int ret;
 
    	if ((NULL == sipMsg)||(0 == sipMsg->dlgID.callIdHash))
@@ -665,30 +777,19 @@ int SIP_updateDialog(SIPMsg *sipMsg, SIP_DialogList *dList, SFSnortPacket *p)
    	DEBUG_WRAP(DebugMessage(DEBUG_SIP, "Updating Dialog id: %u, From: %u, To: %u\n",
    			sipMsg->dlgID.callIdHash,sipMsg->dlgID.fromTagHash,sipMsg->dlgID.toTagHash));
 
-   	dialog = dList->head;
-
    	/*Find out the dialog in the dialog list*/
-
-   	while(NULL != dialog)
+   	dialog = SIP_findDialog(sipMsg->dlgID.callIdHash, dList);
+   	if (NULL != dialog)
    	{
-   		DEBUG_WRAP(DebugMessage(DEBUG_SIP, "Dialog id: %u, From: %u, To: %u\n",
+   		DEBUG_WRAP(DebugMessage(DEBUG_SIP, "Found Dialog id: %u, From: %u, To: %u\n",
    				dialog->dlgID.callIdHash,dialog->dlgID.fromTagHash,dialog->dlgID.toTagHash));
-   		if (sipMsg->dlgID.callIdHash == dialog->dlgID.callIdHash)
-   		{
-   			DEBUG_WRAP(DebugMessage(DEBUG_SIP, "Found Dialog id: %u, From: %u, To: %u\n",
-   			   				dialog->dlgID.callIdHash,dialog->dlgID.fromTagHash,dialog->dlgID.toTagHash));
-   			break;
-
-   		}
-   		oldDialog = dialog;
-   		dialog = dialog->nextD;
    	}
 
    	/*If the number of dialogs exceeded, release the oldest one*/
    	if((dList->num_dialogs >= sip_eval_config->maxNumDialogsInSession) && (!dialog))
    	{
    	    ALERT(SIP_EVENT_MAX_DIALOGS_IN_A_SESSION, SIP_EVENT_MAX_DIALOGS_IN_A_SESSION_STR);
-   	    SIP_deleteDialog(oldDialog, dList);
+   	    SIP_deleteDialog(dList->tail, dList);
    	}
 
    	/*Update the  dialog information*/
@@ -730,5 +831,9 @@ void sip_freeDialogs (SIP_DialogList *list)
 		free(curNode);
 		curNode = nextNode;
 	}
+	free(list->buckets);
+	list->buckets = NULL;
+	list->num_buckets = 0;
+
 
 }
@@ -121,6 +121,18 @@ SIPheaderField headerFields[] =
 		{NULL, 0, NULL, NULL}
 };
 
+/*
+ * Header field name lookup table, filled in by sip_parser_init().
+ * Both the full and the short form of every name in headerFields hash to
+ * their own slot, so a lookup costs one hash and at most one compare.
+ */
+#define SIP_HEADER_HASH_SIZE  64
+#define SIP_HEADER_HASH(name, len) \
+    ((((len) << 1) + tolower((int)(name)[0]) + (tolower((int)(name)[(len) - 1]) << 1)) \
+     & (SIP_HEADER_HASH_SIZE - 1))
+
+static int8_t headerFieldIndex[SIP_HEADER_HASH_SIZE];
+
 /*
  * body field name, field processing function
  */
@@ -150,10 +162,11 @@ SIPbodyField bodyFields[] =
  ********************************************************************/
 static int sip_process_headField(SIPMsg *msg, const char *start, const char *end, int *lastFieldIndex)
 {
-	int findex =0;
+	int findex;
 	int length = end -start;
 	char *colonIndex;
-    char *newStart, *newEnd, newLength;
+    char *newStart, *newEnd;
+    int newLength;
 	DEBUG_WRAP(DebugMessage(DEBUG_SIP, "process line: %.*s\n", length, start));
 
 	// If this is folding
@@ -177,25 +190,22 @@ static int sip_process_headField(SIPMsg *msg, const char *start, const char *end
 	newLength =  newEnd - newStart;
 
 	/*Find out whether the field name needs to process*/
-	while (NULL != headerFields[findex].fname)
+	findex = headerFieldIndex[SIP_HEADER_HASH(newStart, newLength)];
+	if (findex >= 0)
 	{
 		//Use the full name to check
-		if ((headerFields[findex].fnameLen == newLength)&&
-				(0 == strncasecmp(headerFields[findex].fname, newStart, newLength)))
+		if ((headerFields[findex].fnameLen != newLength)||
+				(0 != strncasecmp(headerFields[findex].fname, newStart, newLength)))
 		{
-			break;
+			//Use short name to check
+			if ((NULL == headerFields[findex].shortName) ||
+					( 1 != newLength)||
+					(tolower((int)headerFields[findex].shortName[0]) != tolower((int)newStart[0])))
+				findex = SIP_PARSE_NOFOLDING;
 		}
-		//Use short name to check
-		else if ((NULL != headerFields[findex].shortName) &&
-				( 1 == newLength)&&
-				(0 == strncasecmp(headerFields[findex].shortName, newStart, newLength)))
-		{
-			break;
-		}
-		findex++;
 	}
 
-	if (NULL != headerFields[findex].fname)
+	if (findex >= 0)
 	{
 		// Found the field name, evaluate the value
 		SIP_TrimSP(colonIndex + 1, end, &newStart, &newEnd);
@@ -205,6 +215,41 @@ static int sip_process_headField(SIPMsg *msg, const char *start, const char *end
 	*lastFieldIndex = SIP_PARSE_NOFOLDING;
 	return SIP_PARSE_SUCCESS;
 }
+/********************************************************************
+ * Function: sip_parser_init()
+ *
+ * Build the header field name lookup table
+ *
+ * Arguments:
+ *  None
+ * Returns:
+ *  None
+ ********************************************************************/
+void sip_parser_init(void)
+{
+	int findex;
+	unsigned int slot;
+
+	memset(headerFieldIndex, SIP_PARSE_NOFOLDING, sizeof(headerFieldIndex));
+
+	for (findex = 0; NULL != headerFields[findex].fname; findex++)
+	{
+		slot = SIP_HEADER_HASH(headerFields[findex].fname, headerFields[findex].fnameLen);
+		if (headerFieldIndex[slot] >= 0)
+			DynamicPreprocessorFatalMessage("SIP header field %s collides with %s in the lookup table.\n",
+					headerFields[findex].fname, headerFields[headerFieldIndex[slot]].fname);
+		headerFieldIndex[slot] = findex;
+
+		if (NULL == headerFields[findex].shortName)
+			continue;
+
+		slot = SIP_HEADER_HASH(headerFields[findex].shortName, 1);
+		if (headerFieldIndex[slot] >= 0)
+			DynamicPreprocessorFatalMessage("SIP header field %s collides with %s in the lookup table.\n",
+					headerFields[findex].shortName, headerFields[headerFieldIndex[slot]].fname);
+		headerFieldIndex[slot] = findex;
+	}
+}
 /********************************************************************
  * Function: sip_process_bodyField()
  *
@@ -33,6 +33,7 @@
 #include "sf_ip.h"
 
 
+void sip_parser_init(void);
 int sip_parse(SIPMsg *, const char *, char *);
 void sip_freeMsg (SIPMsg *msg);
 void sip_freeMediaSession (SIP_MediaSession*);
@@ -110,6 +110,10 @@ SIP_Stats sip_stats;
 SIPConfig *sip_eval_config;
 tSfPolicyUserContextId sip_config;
 
+/* The header field lookup table is shared by all configurations and is
+ * read while packets are processed, so it is only built once. */
+static int sip_parser_initialized = 0;
+
 #ifdef SNORT_RELOAD
 static void SIPReload(struct _SnortConfig *, char *, void **);
 static int SIPReloadVerify(struct _SnortConfig *, void *);
@@ -177,6 +181,11 @@ static void SIPInit(struct _SnortConfig *sc, char *argp)
                     "for SIP config.\n");
         }
 
+        if (!sip_parser_initialized)
+        {
+            sip_parser_init();
+            sip_parser_initialized = 1;
+        }
         _dpd.addPreprocConfCheck(sc, SIPCheckConfig);
         _dpd.registerPreprocStats(SIP_NAME, SIP_PrintStats);
         _dpd.addPreprocExit(SIPCleanExit, NULL, PRIORITY_LAST, PP_SIP);
@@ -743,6 +752,12 @@ static void SIPReload(struct _SnortConfig *sc, char *args, void **new_config)
                     "for SIP config.\n");
         }
         *new_config = (void *)sip_swap_config;
+        /* Only if SIP was not configured at startup, so nothing is using it yet. */
+        if (!sip_parser_initialized)
+        {
+            sip_parser_init();
+            sip_parser_initialized = 1;
+        }
     }
 
     sfPolicyUserPolicySet (sip_swap_config, policy_id);
@@ -109,11 +109,15 @@ typedef struct _SIP_DialogData
 	SIP_MediaList mediaSessions;
 	struct _SIP_DialogData *nextD;
 	struct _SIP_DialogData *prevD;
+	struct _SIP_DialogData *nextH;   /* next dialog in the same Call-ID bucket */
 } SIP_DialogData;
 
 typedef struct _SIP_DialogList
 {
     SIP_DialogData* head;
+    SIP_DialogData* tail;
+    SIP_DialogData** buckets;    /* Call-ID index, NULL while the list is short */
+    uint32_t num_buckets;
     uint32_t num_dialogs;
 }SIP_DialogList;
 
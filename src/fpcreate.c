@@ -33,6 +33,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
@@ -67,6 +68,7 @@
 #include "snort.h"
 #include "sp_clientserver.h"
 #include "sfutil/sfportobject.h"
+#include "sfutil/sfghash.h"
 #include "sfutil/sfrim.h"
 #include "detection_options.h"
 #include "sfPolicy.h"
@@ -118,6 +120,18 @@ static const char *pm_type_strings[PM_TYPE__MAX] =
     "HTTP Method content",
 };
 
+/* Incremented for each set of port groups built so that matcher state
+ * carried on sessions across a reload is not used with the new groups */
+static unsigned int fp_carry_gen = 0;
+
+/*
+**  Port group dump read by tools/mpse_bench.  It is only open while
+**  the port groups and rule maps are built.
+*/
+static FILE *fp_dump = NULL;
+static SFGHASH *fp_dump_groups = NULL;
+static unsigned int fp_dump_group_count = 0;
+
 /*
 #define LOCAL_DEBUG
 */
@@ -481,6 +495,14 @@ void free_detection_option_root(void **existing_tree)
 void free_detection_option_tree(detection_option_tree_node_t *node)
 {
     int i;
+
+    /* a flattened tree is one allocation starting at its root */
+    if (node->is_flat)
+    {
+        free(node);
+        return;
+    }
+
     for (i=0;i<node->num_children;i++)
     {
         free_detection_option_tree(node->children[i]);
@@ -505,16 +527,22 @@ int finalize_detection_option_tree(SnortConfig *sc, detection_option_tree_root_t
     for (i=0;i<root->num_children;i++)
     {
         node = root->children[i];
+
+        /* Either way this tree is replaced, by an equal one or by its
+         * flattened copy */
         if (add_detection_option_tree(sc, node, &dup_node) == DETECTION_OPTION_EQUAL)
         {
-            free_detection_option_tree(node);
-            root->children[i] = (detection_option_tree_node_t *)dup_node;
             //num_dup_trees++;
         }
         else
         {
             //num_trees++;
         }
+        if (dup_node != node)
+        {
+            free_detection_option_tree(node);
+            root->children[i] = (detection_option_tree_node_t *)dup_node;
+        }
 #ifdef DEBUG_OPTION_TREE
         print_option_tree(root->children[i], 0);
 #endif
@@ -804,6 +832,9 @@ void fpSetDefaults(FastPatternConfig *fp)
     if (fp == NULL)
         return;
 
+    if (fp->pattern_dump_file != NULL)
+        free(fp->pattern_dump_file);
+
     memset(fp, 0, sizeof(FastPatternConfig));
 
     fp->inspect_stream_insert = 1;
@@ -817,6 +848,9 @@ void FastPatternConfigFree(FastPatternConfig *fp)
     if (fp == NULL)
         return;
 
+    if (fp->pattern_dump_file != NULL)
+        free(fp->pattern_dump_file);
+
     free(fp);
 }
 
@@ -889,6 +923,15 @@ void fpDetectSetDebugPrintFastPatterns(FastPatternConfig *fp, int flag)
 {
     fp->debug_print_fast_pattern = flag;
 }
+
+void fpSetPatternDumpFile(FastPatternConfig *fp, const char *file)
+{
+    if (fp->pattern_dump_file != NULL)
+        free(fp->pattern_dump_file);
+
+    fp->pattern_dump_file = SnortStrdup(file);
+}
+
 void fpSetDetectSearchOpt(FastPatternConfig *fp, int flag)
 {
     fp->search_opt = flag;
@@ -998,6 +1041,19 @@ void fpDetectSetSplitAnyAny(FastPatternConfig *fp, int enable)
     }
 }
 
+void fpDetectSetCarryState(FastPatternConfig *fp, int enable)
+{
+    if (enable)
+    {
+        fp->carry_state = 1;
+        LogMessage("    Carry search state across packets = enabled\n");
+    }
+    else
+    {
+        fp->carry_state = 0;
+    }
+}
+
 /*
 **  Set the debug mode for the detection engine.
 */
@@ -1445,6 +1501,123 @@ static int UsePreprocOptFastPatterns(PatternMatchData *pmd, PatternMatchData *pr
     return 0;
 }
 
+/*
+**  The dump is plain text, one item per line:
+**
+**    pattern <group> <pm type> <nocase> <negated> <hex bytes>
+**    src|dst <proto> <port> <group>
+**    any <proto> <group>
+**
+**  Groups are numbered as their first pattern is written, so groups
+**  without fast patterns never appear.  For ip and icmp the port is the
+**  ip protocol and icmp type respectively.
+*/
+static void fpDumpOpen(FastPatternConfig *fp)
+{
+    if (fp->pattern_dump_file == NULL)
+        return;
+
+    fp_dump = fopen(fp->pattern_dump_file, "w");
+
+    if (fp_dump == NULL)
+    {
+        FatalError("Could not open pattern group dump file %s: %s\n",
+                   fp->pattern_dump_file, strerror(errno));
+    }
+
+    fp_dump_groups = sfghash_new(1024, sizeof(PORT_GROUP *), 0, NULL);
+
+    if (fp_dump_groups == NULL)
+        FatalError("Could not allocate pattern group dump table\n");
+
+    fp_dump_group_count = 0;
+
+    fprintf(fp_dump, "# snort port group fast patterns\n");
+    fprintf(fp_dump, "split-any-any %d\n", fpDetectSplitAnyAny(fp) ? 1 : 0);
+}
+
+static unsigned int fpDumpFindGroup(PORT_GROUP *pg)
+{
+    return (unsigned int)(uintptr_t)sfghash_find(fp_dump_groups, &pg);
+}
+
+static void fpDumpPattern(PORT_GROUP *pg, PmType pm_type,
+        PatternMatchData *pmd, const char *pattern, int pattern_length)
+{
+    unsigned int id = fpDumpFindGroup(pg);
+    int i;
+
+    if (id == 0)
+    {
+        id = ++fp_dump_group_count;
+
+        if (sfghash_add(fp_dump_groups, &pg, (void *)(uintptr_t)id) != SFGHASH_OK)
+            FatalError("Could not add port group to pattern group dump\n");
+    }
+
+    fprintf(fp_dump, "pattern %u %d %d %d ", id, (int)pm_type,
+            pmd->nocase ? 1 : 0, pmd->exception_flag ? 1 : 0);
+
+    for (i = 0; i < pattern_length; i++)
+        fprintf(fp_dump, "%02x", (uint8_t)pattern[i]);
+
+    fprintf(fp_dump, "\n");
+}
+
+static void fpDumpRuleMap(const char *proto, PORT_RULE_MAP *prm)
+{
+    unsigned int id;
+    int i;
+
+    if (prm == NULL)
+        return;
+
+    for (i = 0; i < MAX_PORTS; i++)
+    {
+        if ((prm->prmSrcPort[i] != NULL)
+                && ((id = fpDumpFindGroup(prm->prmSrcPort[i])) != 0))
+        {
+            fprintf(fp_dump, "src %s %d %u\n", proto, i, id);
+        }
+
+        if ((prm->prmDstPort[i] != NULL)
+                && ((id = fpDumpFindGroup(prm->prmDstPort[i])) != 0))
+        {
+            fprintf(fp_dump, "dst %s %d %u\n", proto, i, id);
+        }
+    }
+
+    if ((prm->prmGeneric != NULL) && (prm->prmGeneric->pgCount > 0)
+            && ((id = fpDumpFindGroup(prm->prmGeneric)) != 0))
+    {
+        fprintf(fp_dump, "any %s %u\n", proto, id);
+    }
+}
+
+static void fpDumpClose(SnortConfig *sc)
+{
+    if (fp_dump == NULL)
+        return;
+
+    fpDumpRuleMap("tcp", sc->prmTcpRTNX);
+    fpDumpRuleMap("udp", sc->prmUdpRTNX);
+    fpDumpRuleMap("icmp", sc->prmIcmpRTNX);
+    fpDumpRuleMap("ip", sc->prmIpRTNX);
+
+    if (fclose(fp_dump) != 0)
+    {
+        FatalError("Could not write pattern group dump file %s: %s\n",
+                   sc->fast_pattern_config->pattern_dump_file, strerror(errno));
+    }
+
+    LogMessage("Wrote %u port groups to %s\n", fp_dump_group_count,
+               sc->fast_pattern_config->pattern_dump_file);
+
+    sfghash_delete(fp_dump_groups);
+    fp_dump_groups = NULL;
+    fp_dump = NULL;
+}
+
 static int fpFinishPortGroupRule(SnortConfig *sc, PORT_GROUP *pg, PmType pm_type,
         OptTreeNode *otn, PatternMatchData *pmd_list, FastPatternConfig *fp)
 {
@@ -1490,6 +1663,9 @@ static int fpFinishPortGroupRule(SnortConfig *sc, PORT_GROUP *pg, PmType pm_type
         if (fpGetFinalPattern(fp, pmd, &pattern, &pattern_length) == -1)
             return -1;
 
+        if (fp_dump != NULL)
+            fpDumpPattern(pg, pm_type, pmd, pattern, pattern_length);
+
         /* create a rule_node */
         rn = (RULE_NODE *)SnortAlloc(sizeof(RULE_NODE));
         rn->rnRuleData = otn;
@@ -3093,11 +3269,15 @@ int fpCreateFastPacketDetection(SnortConfig *sc)
     if ((port_tables == NULL) || (fp == NULL))
         return 0;
 
+    fp->carry_gen = ++fp_carry_gen;
+
 #ifdef INTEL_SOFT_CPM
     if (fp->search_method == MPSE_INTEL_CPM)
         IntelPmStartInstance();
 #endif
 
+    fpDumpOpen(fp);
+
     /* Use PortObjects to create PORT_GROUPs */
     if (fpDetectGetDebugPrintRuleGroupBuildDetails(fp))
         LogMessage("Creating Port Groups....\n");
@@ -3118,6 +3298,8 @@ int fpCreateFastPacketDetection(SnortConfig *sc)
     if (fpDetectGetDebugPrintRuleGroupBuildDetails(fp))
         LogMessage("Rule Maps Done....\n");
 
+    fpDumpClose(sc);
+
 #ifndef TARGET_BASED
     LogMessage("\n");
     LogMessage("[ Port Based Pattern Matching Memory ]\n" );
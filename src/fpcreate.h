@@ -101,6 +101,9 @@ typedef struct _FastPatternConfig
     int num_patterns_truncated;  /* due to max_pattern_len */
     int num_patterns_trimmed;    /* due to zero byte prefix */
     int debug_print_fast_pattern;
+    int carry_state;             /* carry matcher state across packets */
+    unsigned int carry_gen;      /* identifies the port groups built */
+    char *pattern_dump_file;     /* port group patterns for mpse_bench */
 
 } FastPatternConfig;
 
@@ -176,6 +179,7 @@ void fpSetDebugMode(FastPatternConfig *);
 void fpSetStreamInsert(FastPatternConfig *);
 void fpSetMaxQueueEvents(FastPatternConfig *, unsigned int);
 void fpDetectSetSplitAnyAny(FastPatternConfig *, int);
+void fpDetectSetCarryState(FastPatternConfig *, int);
 void fpSetMaxPatternLen(FastPatternConfig *, unsigned int);
 
 void fpDetectSetSingleRuleGroup(FastPatternConfig *);
@@ -186,6 +190,7 @@ void fpDetectSetDebugPrintRuleGroupBuildDetails(FastPatternConfig *);
 void fpDetectSetDebugPrintRuleGroupsCompiled(FastPatternConfig *);
 void fpDetectSetDebugPrintRuleGroupsUnCompiled(FastPatternConfig *);
 void fpDetectSetDebugPrintFastPatterns(FastPatternConfig *, int);
+void fpSetPatternDumpFile(FastPatternConfig *, const char *);
 
 int  fpDetectGetSingleRuleGroup(FastPatternConfig *);
 int  fpDetectGetBleedOverPortLimit(FastPatternConfig *);
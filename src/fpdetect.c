@@ -515,7 +515,7 @@ int fpEvalRTN(RuleTreeNode *rtn, Packet *p, int check_ports)
     DEBUG_WRAP(DebugMessage(DEBUG_DETECT, "[*] Rule Head %d\n",
                 rtn->head_node_number);)
 
-    if(!rtn->rule_func->RuleHeadFunc(p, rtn, rtn->rule_func, check_ports))
+    if(!CheckRuleHeader(p, rtn, check_ports))
     {
         DEBUG_WRAP(DebugMessage(DEBUG_DETECT,
                     "   => Header check failed, checking next node\n"););
@@ -699,43 +699,29 @@ static int rule_tree_match( void * id, void *tree, int index, void * data, void
     return 0;
 }
 
-static int sortOrderByPriority(const void *e1, const void *e2)
+/*
+**  Returns < 0 if otn1 is to be queued before otn2 in the configured
+**  event order.
+*/
+static inline int fpEventOrder(int order, OptTreeNode *otn1, OptTreeNode *otn2)
 {
-    OptTreeNode *otn1;
-    OptTreeNode *otn2;
-
-    if (!e1 || !e2)
-        return 0;
-
-    otn1 = *(OptTreeNode **)e1;
-    otn2 = *(OptTreeNode **)e2;
-
-    if( otn1->sigInfo.priority < otn2->sigInfo.priority )
-        return -1;
-
-    if( otn1->sigInfo.priority > otn2->sigInfo.priority )
-        return +1;
-
-    /* This improves stability of repeated tests */
-    if( otn1->sigInfo.id < otn2->sigInfo.id )
-        return -1;
+    if (order == SNORT_EVENTQ_PRIORITY)
+    {
+        if( otn1->sigInfo.priority < otn2->sigInfo.priority )
+            return -1;
 
-    if( otn1->sigInfo.id > otn2->sigInfo.id )
-        return +1;
+        if( otn1->sigInfo.priority > otn2->sigInfo.priority )
+            return +1;
 
-    return 0;
-}
+        /* This improves stability of repeated tests */
+        if( otn1->sigInfo.id < otn2->sigInfo.id )
+            return -1;
 
-static int sortOrderByContentLength(const void *e1, const void *e2)
-{
-    OptTreeNode *otn1;
-    OptTreeNode *otn2;
+        if( otn1->sigInfo.id > otn2->sigInfo.id )
+            return +1;
 
-    if (!e1 || !e2)
         return 0;
-
-    otn1 = *(OptTreeNode **)e1;
-    otn2 = *(OptTreeNode **)e2;
+    }
 
     if (otn1->longestPatternLen < otn2->longestPatternLen)
         return +1;
@@ -753,6 +739,35 @@ static int sortOrderByContentLength(const void *e1, const void *e2)
     return 0;
 }
 
+/*
+**  Moves the first of the events at j and after, in the configured order,
+**  to j.  Matches are only appended by fpAddMatch() and are ordered here
+**  one at a time as they are queued, so that when only the first few of
+**  many matches get queued the rest are never sorted.
+*/
+static inline OptTreeNode *fpSelectNextEvent(MATCH_INFO *mi, int j, int order)
+{
+    OptTreeNode **events = mi->MatchArray;
+    OptTreeNode *tmp;
+    int best = j;
+    int k;
+
+    for (k = j + 1; k < mi->iMatchCount; k++)
+    {
+        if (fpEventOrder(order, events[k], events[best]) < 0)
+            best = k;
+    }
+
+    if (best != j)
+    {
+        tmp = events[j];
+        events[j] = events[best];
+        events[best] = tmp;
+    }
+
+    return events[j];
+}
+
 
 /*
 **
@@ -857,26 +872,17 @@ static inline int fpFinalSelectEvent(OTNX_MATCH_DATA *o, Packet *p)
              * built in drop/sdrop/reject comes before alert/pass/log as
              * part of the natural ordering....Jan '06..
              */
-            /* Sort the rules in this action group */
-            if (eq->order == SNORT_EVENTQ_PRIORITY)
-            {
-                qsort(o->matchInfo[i].MatchArray, o->matchInfo[i].iMatchCount,
-                      sizeof(void *), sortOrderByPriority);
-            }
-            else if (eq->order == SNORT_EVENTQ_CONTENT_LEN)
-            {
-                qsort(o->matchInfo[i].MatchArray, o->matchInfo[i].iMatchCount,
-                      sizeof(void*), sortOrderByContentLength);
-            }
-            else
+            if ((eq->order != SNORT_EVENTQ_PRIORITY) &&
+                (eq->order != SNORT_EVENTQ_CONTENT_LEN))
             {
                 FatalError("fpdetect: Order function for event queue is invalid.\n");
             }
 
-            /* Process each event in the action (alert,drop,log,...) groups */
+            /* Process each event in the action (alert,drop,log,...) groups,
+             * selecting them in order as we go */
             for(j=0; j < o->matchInfo[i].iMatchCount; j++)
             {
-                otn = o->matchInfo[i].MatchArray[j];
+                otn = fpSelectNextEvent(&o->matchInfo[i], j, eq->order);
                 rtn = getRtnFromOtn(otn, getRuntimePolicy());
 
                 if ((otn != NULL) && (rtn != NULL) && (rtn->type == RULE_TYPE__PASS))
@@ -1048,6 +1054,114 @@ void printRuleFmt1( SnortConfig *sc, OptTreeNode * otn )
 }
 #endif
 
+/*
+**  Pattern matcher state carried between the payloads of consecutive
+**  packets of a flow, so that fast patterns which span two packets that
+**  aren't reassembled are still found.  A packet is searched with the
+**  matchers of up to three port groups (src, dst and generic), so a state
+**  is kept per direction for each of them.  The state is only valid for
+**  the matcher and detection config it came from, and for tcp only if the
+**  next segment starts where the last one ended.
+**
+**  The detection engine is not a preprocessor, so the session data uses
+**  an application data id above the preprocessor id range.
+*/
+#define FP_CARRY_APP_DATA_ID  0x10000
+#define FP_CARRY_GROUPS       3
+
+typedef struct _FpCarryDir
+{
+    void *so;
+    unsigned int gen;
+    int state;
+    uint32_t next_seq;
+
+} FpCarryDir;
+
+typedef struct _FpCarryState
+{
+    FpCarryDir dir[2][FP_CARRY_GROUPS];
+    uint8_t next[2];
+
+} FpCarryState;
+
+static void fpCarryStateFree(void *data)
+{
+    free(data);
+    stream_api->update_memory_in_use(-(int32_t)sizeof(FpCarryState));
+}
+
+/* Returns the state carried for the matcher, or the one to replace */
+static inline FpCarryDir *fpGetCarryDir(FpCarryState *cs, int dir, void *so)
+{
+    FpCarryDir *cd = cs->dir[dir];
+    int i;
+
+    for (i = 0; i < FP_CARRY_GROUPS; i++)
+    {
+        if (cd[i].so == so)
+            return &cd[i];
+    }
+
+    i = cs->next[dir];
+    cs->next[dir] = (i + 1) % FP_CARRY_GROUPS;
+
+    return &cd[i];
+}
+
+static inline int fpSearchPayload(FastPatternConfig *fp, void *so, Packet *p,
+        uint16_t len, OTNX_MATCH_DATA *omd)
+{
+    FpCarryState *cs;
+    FpCarryDir *cd;
+    int start_state = 0;
+    int ret;
+
+    if (!fp->carry_state || !stream_api || !p->ssnptr ||
+        (p->packet_flags & (PKT_REBUILT_STREAM | PKT_IP_RULE)) ||
+        (!p->tcph && !p->udph) || !mpseCanCarryState(so))
+    {
+        return mpseSearch(so, p->data, len, rule_tree_match, omd, &start_state);
+    }
+
+    cs = (FpCarryState *)stream_api->get_application_data(p->ssnptr, FP_CARRY_APP_DATA_ID);
+
+    if (cs == NULL)
+    {
+        if (stream_api->update_memory_in_use(sizeof(FpCarryState)) != 0)
+            return mpseSearch(so, p->data, len, rule_tree_match, omd, &start_state);
+
+        cs = (FpCarryState *)SnortAlloc(sizeof(FpCarryState));
+
+        if (stream_api->set_application_data(p->ssnptr, FP_CARRY_APP_DATA_ID,
+                    cs, fpCarryStateFree) != 0)
+        {
+            fpCarryStateFree(cs);
+            return mpseSearch(so, p->data, len, rule_tree_match, omd, &start_state);
+        }
+    }
+
+    cd = fpGetCarryDir(cs, (p->packet_flags & PKT_FROM_SERVER) ? 1 : 0, so);
+
+    if ((cd->so == so) && (cd->gen == fp->carry_gen) &&
+        (!p->tcph || (ntohl(p->tcph->th_seq) == cd->next_seq)))
+    {
+        start_state = cd->state;
+    }
+
+    ret = mpseSearchCarry(so, p->data, len, rule_tree_match, omd, &start_state);
+
+    /* only carry over the end of the payload */
+    cd->so = so;
+    cd->gen = fp->carry_gen;
+    cd->state = (len == p->dsize) ? start_state : 0;
+
+    if (p->tcph)
+        cd->next_seq = ntohl(p->tcph->th_seq) + p->dsize;
+
+    return ret;
+}
+
 /*
 **
 **  NAME
@@ -1263,9 +1377,7 @@ static inline int fpEvalHeaderSW(PORT_GROUP *port_group, Packet *p,
                     if ( IsLimitedDetect(p) && (p->alt_dsize < p->dsize) )
                         pattern_match_size = p->alt_dsize;
 
-                    start_state = 0;
-                    mpseSearch(so, p->data, pattern_match_size,
-                            rule_tree_match, omd, &start_state);
+                    fpSearchPayload(fp, so, p, pattern_match_size, omd);
 #ifdef PPM_MGR
                     /* Bail if we spent too much time already */
                     if (PPM_PACKET_ABORT_FLAG())
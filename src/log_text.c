@@ -75,6 +75,195 @@ void LogTimeStamp(TextLog* log, Packet* p)
     TextLog_Puts(log, timestamp);
 }
 
+int LogFormatUInt(char* buf, uint32_t u)
+{
+    char tmp[10];
+    int n = 0, len;
+
+    do
+    {
+        tmp[n++] = '0' + (u % 10);
+        u /= 10;
+    } while ( u );
+
+    len = n;
+
+    while ( n )
+        *buf++ = tmp[--n];
+
+    return len;
+}
+
+int LogFormatIp(char* buf, sfip_t* ip)
+{
+    if ( sfip_family(ip) == AF_INET )
+    {
+        char* s = buf;
+        int i;
+
+        for ( i = 0; i < 4; i++ )
+        {
+            if ( i )
+                *s++ = '.';
+            s += LogFormatUInt(s, ip->ip8[i]);
+        }
+        return s - buf;
+    }
+    sfip_ntop(ip, buf, INET6_ADDRSTRLEN);
+    return strlen(buf);
+}
+
+static inline int LogFormatObfuscatedIp(char* buf, sfip_t* ip)
+{
+    const char* s = ObfuscateIpToText(ip);
+    int len = strlen(s);
+    memcpy(buf, s, len);
+    return len;
+}
+
+int LogFormatIpAddrs(char* buf, Packet* p)
+{
+    int (*fmt)(char*, sfip_t*) = ScObfuscate() ? LogFormatObfuscatedIp : LogFormatIp;
+    bool ports = !p->frag_flag
+        && ((GET_IPH_PROTO(p) == IPPROTO_TCP) || (GET_IPH_PROTO(p) == IPPROTO_UDP));
+    char* s = buf;
+
+    s += fmt(s, GET_SRC_ADDR(p));
+
+    if ( ports )
+    {
+        *s++ = ':';
+        s += LogFormatUInt(s, p->sp);
+    }
+    memcpy(s, " -> ", 4);
+    s += 4;
+
+    s += fmt(s, GET_DST_ADDR(p));
+
+    if ( ports )
+    {
+        *s++ = ':';
+        s += LogFormatUInt(s, p->dp);
+    }
+    return s - buf;
+}
+
+/*--------------------------------------------------------------------
+ * alert templates
+ *--------------------------------------------------------------------
+ */
+static AlertTemplate* LogNewAlertTemplate(
+    OptTreeNode* otn, const char* msg, Event* event)
+{
+    const char* cls = NULL;
+    AlertTemplate* t;
+    size_t size;
+    char* s;
+
+    if ( otn && otn->sigInfo.classType )
+        cls = otn->sigInfo.classType->name;
+
+    /* the fixed text and three numbers of each piece */
+    size = sizeof(*t) + 3*10 + 5 + 20 + 10 + 14;
+
+    if ( cls )
+        size += strlen(cls) + 19;
+
+    t = (AlertTemplate*)SnortAlloc(size);
+    size -= sizeof(*t);
+    s = t->text;
+
+    /* empty pieces point at the text too */
+    t->sig = t->cls = t->pri = s;
+
+    t->msg = msg;
+    t->msg_len = msg ? strlen(msg) : 0;
+
+    if ( event )
+    {
+        t->gid = event->sig_generator;
+        t->sid = event->sig_id;
+        t->rev = event->sig_rev;
+        t->has_sig = true;
+
+        t->sig = s;
+        t->sig_len = snprintf(s, size, "[%lu:%lu:%lu] ",
+            (unsigned long)t->gid, (unsigned long)t->sid, (unsigned long)t->rev);
+        s += t->sig_len;
+        size -= t->sig_len;
+    }
+    if ( cls )
+    {
+        t->cls = s;
+        t->cls_len = snprintf(s, size, "[Classification: %s] ", cls);
+        s += t->cls_len;
+        size -= t->cls_len;
+    }
+    if ( otn )
+    {
+        t->priority = otn->sigInfo.priority;
+        t->pri = s;
+        t->pri_len = snprintf(s, size, "[Priority: %d] ", otn->sigInfo.priority);
+    }
+    return t;
+}
+
+static inline bool LogAlertTemplateMatches(
+    const AlertTemplate* t, const char* msg, Event* event)
+{
+    if ( t->msg != msg )
+        return false;
+
+    if ( !event )
+        return !t->has_sig;
+
+    return t->has_sig &&
+        (t->gid == event->sig_generator) &&
+        (t->sid == event->sig_id) &&
+        (t->rev == event->sig_rev);
+}
+
+/*--------------------------------------------------------------------
+ * Function: LogGetAlertTemplate()
+ *
+ * Purpose: Gets the static alert text for the current rule.  It is built
+ *          the first time the rule alerts and kept with the rule, so each
+ *          later alert only has to format the packet fields.  Alerts that
+ *          don't come from otn_tmp with its own message and signature get
+ *          a template that is only good until the next call.
+ *
+ * Arguments: msg => the alert message
+ *            event => the alert event, may be NULL
+ *
+ * Returns: the template, never NULL
+ *--------------------------------------------------------------------
+ */
+const AlertTemplate* LogGetAlertTemplate(const char* msg, Event* event)
+{
+    static AlertTemplate* scratch = NULL;
+    OptTreeNode* otn = otn_tmp;
+
+    if ( otn && otn->alert_template &&
+        LogAlertTemplateMatches(otn->alert_template, msg, event) )
+        return otn->alert_template;
+
+    if ( otn && !otn->alert_template && event &&
+        (msg == otn->sigInfo.message) &&
+        (event->sig_generator == otn->sigInfo.generator) &&
+        (event->sig_id == otn->sigInfo.id) &&
+        (event->sig_rev == otn->sigInfo.rev) )
+    {
+        otn->alert_template = LogNewAlertTemplate(otn, msg, event);
+        return otn->alert_template;
+    }
+
+    if ( scratch )
+        free(scratch);
+
+    scratch = LogNewAlertTemplate(otn, msg, event);
+    return scratch;
+}
+
 /*--------------------------------------------------------------------
  * alert stuff cloned from log.c
  *--------------------------------------------------------------------
@@ -92,17 +281,15 @@ void LogTimeStamp(TextLog* log, Packet* p)
  */
 void LogPriorityData(TextLog* log, bool doNewLine)
 {
+    const AlertTemplate* t;
+
     if (otn_tmp == NULL)
         return;
 
-    if ((otn_tmp->sigInfo.classType != NULL)
-            && (otn_tmp->sigInfo.classType->name != NULL))
-    {
-        TextLog_Print(log, "[Classification: %s] ",
-                otn_tmp->sigInfo.classType->name);
-    }
+    t = LogGetAlertTemplate(otn_tmp->sigInfo.message, &otn_tmp->event_data);
 
-    TextLog_Print(log, "[Priority: %d] ", otn_tmp->sigInfo.priority);
+    TextLog_Write(log, t->cls, t->cls_len);
+    TextLog_Write(log, t->pri, t->pri_len);
 
     if (doNewLine)
         TextLog_NewLine(log);
@@ -531,45 +718,12 @@ static void LogIpOptions(TextLog*  log, Packet * p)
  */
 void LogIpAddrs(TextLog *log, Packet *p)
 {
+    char buf[LOG_IP_ADDRS_SIZE];
+
     if (!IPH_IS_VALID(p))
         return;
 
-    if (p->frag_flag
-            || ((GET_IPH_PROTO(p) != IPPROTO_TCP)
-                && (GET_IPH_PROTO(p) != IPPROTO_UDP)))
-    {
-        char *ip_fmt = "%s -> %s";
-
-        if (ScObfuscate())
-        {
-            TextLog_Print(log, ip_fmt,
-                    ObfuscateIpToText(GET_SRC_ADDR(p)),
-                    ObfuscateIpToText(GET_DST_ADDR(p)));
-        }
-        else
-        {
-            TextLog_Print(log, ip_fmt,
-                    inet_ntoax(GET_SRC_ADDR(p)),
-                    inet_ntoax(GET_DST_ADDR(p)));
-        }
-    }
-    else
-    {
-        char *ip_fmt = "%s:%d -> %s:%d";
-
-        if (ScObfuscate())
-        {
-            TextLog_Print(log, ip_fmt,
-                    ObfuscateIpToText(GET_SRC_ADDR(p)), p->sp,
-                    ObfuscateIpToText(GET_DST_ADDR(p)), p->dp);
-        }
-        else
-        {
-            TextLog_Print(log, ip_fmt,
-                    inet_ntoax(GET_SRC_ADDR(p)), p->sp,
-                    inet_ntoax(GET_DST_ADDR(p)), p->dp);
-        }
-    }
+    TextLog_Write(log, buf, LogFormatIpAddrs(buf, p));
 }
 
 /*--------------------------------------------------------------------
@@ -35,6 +35,42 @@
 
 #include "sfutil/sf_textlog.h"
 
+/* The parts of an alert that only depend on the rule.  Each piece is
+ * formatted once and written as is; the pieces are not null terminated.
+ * Empty pieces have zero length; pri is empty when there is no rule. */
+typedef struct _AlertTemplate
+{
+    /* what the template was built for */
+    const char* msg;
+    uint32_t gid, sid, rev;
+    bool has_sig;
+
+    unsigned msg_len;        /* strlen(msg) */
+    uint32_t priority;
+
+    const char* sig;         /* "[gid:sid:rev] " */
+    unsigned sig_len;
+
+    const char* cls;         /* "[Classification: name] " */
+    unsigned cls_len;
+
+    const char* pri;         /* "[Priority: n] " */
+    unsigned pri_len;
+
+    char text[1];
+} AlertTemplate;
+
+/* returns the template for the current rule (otn_tmp), msg and event */
+const AlertTemplate* LogGetAlertTemplate(const char* msg, Event*);
+
+/* Formatters for the fields that change with each alert.  They write
+ * at buf without a terminating null and return the length written. */
+#define LOG_IP_ADDRS_SIZE (2*INET6_ADDRSTRLEN + 16)
+
+int LogFormatUInt(char* buf, uint32_t);
+int LogFormatIp(char* buf, sfip_t*);           /* INET6_ADDRSTRLEN */
+int LogFormatIpAddrs(char* buf, Packet*);      /* LOG_IP_ADDRS_SIZE */
+
 void LogPriorityData(TextLog*, bool doNewLine);
 void LogXrefs(TextLog*, bool doNewLine);
 
@@ -149,6 +149,7 @@ static void AlertFastInit(struct _SnortConfig *sc, char *args)
 static void AlertFast(Packet *p, char *msg, void *arg, Event *event)
 {
     SpoAlertFastData *data = (SpoAlertFastData *)arg;
+    const AlertTemplate *t = LogGetAlertTemplate(msg, event);
 
     LogTimeStamp(data->log, p);
 
@@ -174,13 +175,7 @@ static void AlertFast(Packet *p, char *msg, void *arg, Event *event)
         TextLog_Puts(data->log, " [**] ");
 #endif
 
-        if(event != NULL)
-        {
-            TextLog_Print(data->log, "[%lu:%lu:%lu] ",
-                    (unsigned long) event->sig_generator,
-                    (unsigned long) event->sig_id,
-                    (unsigned long) event->sig_rev);
-        }
+        TextLog_Write(data->log, t->sig, t->sig_len);
 
         if (ScAlertInterface())
         {
@@ -189,7 +184,7 @@ static void AlertFast(Packet *p, char *msg, void *arg, Event *event)
 
         if (msg != NULL)
         {
-            TextLog_Puts(data->log, msg);
+            TextLog_Write(data->log, msg, t->msg_len);
             TextLog_Puts(data->log, " [**] ");
         }
         else
@@ -201,8 +196,11 @@ static void AlertFast(Packet *p, char *msg, void *arg, Event *event)
     /* print the packet header to the alert file */
     if ((p != NULL) && IPH_IS_VALID(p))
     {
-        LogPriorityData(data->log, 0);
-        TextLog_Print(data->log, "{%s} ", protocol_names[GET_IPH_PROTO(p)]);
+        TextLog_Write(data->log, t->cls, t->cls_len);
+        TextLog_Write(data->log, t->pri, t->pri_len);
+        TextLog_Putc(data->log, '{');
+        TextLog_Puts(data->log, protocol_names[GET_IPH_PROTO(p)]);
+        TextLog_Puts(data->log, "} ");
         LogIpAddrs(data->log, p);
     }
 
@@ -130,17 +130,11 @@ static void AlertFullInit(struct _SnortConfig *sc, char *args)
 static void AlertFull(Packet *p, char *msg, void *arg, Event *event)
 {
     SpoAlertFullData *data = (SpoAlertFullData *)arg;
+    const AlertTemplate *t = LogGetAlertTemplate(msg, event);
 
     {
         TextLog_Puts(data->log, "[**] ");
-
-        if(event != NULL)
-        {
-                TextLog_Print(data->log, "[%lu:%lu:%lu] ",
-                        (unsigned long) event->sig_generator,
-                        (unsigned long) event->sig_id,
-                        (unsigned long) event->sig_rev);
-        }
+        TextLog_Write(data->log, t->sig, t->sig_len);
 
         if (ScAlertInterface())
         {
@@ -150,7 +144,7 @@ static void AlertFull(Packet *p, char *msg, void *arg, Event *event)
 
         if(msg != NULL)
         {
-            TextLog_Puts(data->log, msg);
+            TextLog_Write(data->log, msg, t->msg_len);
             TextLog_Puts(data->log, " [**]\n");
         }
         else
@@ -159,9 +153,11 @@ static void AlertFull(Packet *p, char *msg, void *arg, Event *event)
         }
     }
 
-    if(p && IPH_IS_VALID(p))
+    if(p && IPH_IS_VALID(p) && t->pri_len)
     {
-        LogPriorityData(data->log, TRUE);
+        TextLog_Write(data->log, t->cls, t->cls_len);
+        TextLog_Write(data->log, t->pri, t->pri_len);
+        TextLog_NewLine(data->log);
     }
 
     DEBUG_WRAP(DebugMessage(DEBUG_LOG, "Logging Alert data!\n"););
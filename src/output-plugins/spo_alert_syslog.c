@@ -72,8 +72,7 @@
 #include "util_net.h"
 #include "snort.h"
 #include "sfdaq.h"
-
-extern OptTreeNode *otn_tmp;
+#include "log_text.h"
 
 typedef struct _SyslogData
 {
@@ -499,6 +498,16 @@ static SyslogData *ParseSyslogArgs(struct _SnortConfig *sc, char *args)
 }
 
 
+static inline char *SyslogAppend(
+    char *s, const char *end, const char *str, unsigned len)
+{
+    if (len > (unsigned)(end - s))
+        len = end - s;
+
+    memcpy(s, str, len);
+    return s + len;
+}
+
 /*
  * Function: PreprocFunction(Packet *)
  *
@@ -516,97 +525,52 @@ static void AlertSyslog(Packet *p, char *msg, void *arg, Event *event)
 {
     SyslogData *data = (SyslogData *)arg;
     char event_string[STD_BUF];
+    char *s = event_string;
+    const char *end = event_string + sizeof(event_string) - 1;
 
     if (data == NULL)
         return;
 
-    event_string[0] = '\0';
-
     if ((p != NULL) && IPH_IS_VALID(p))
     {
-        if (event != NULL)
-        {
-            SnortSnprintfAppend(event_string, sizeof(event_string),
-                    "[%lu:%lu:%lu] ",
-                    (unsigned long)event->sig_generator,
-                    (unsigned long)event->sig_id,
-                    (unsigned long)event->sig_rev);
-        }
+        const AlertTemplate *t = LogGetAlertTemplate(msg, event);
+        const char *proto = protocol_names[GET_IPH_PROTO(p)];
+        char buf[LOG_IP_ADDRS_SIZE];
+
+        s = SyslogAppend(s, end, t->sig, t->sig_len);
 
         if (msg != NULL)
-            SnortSnprintfAppend(event_string, sizeof(event_string), "%s ", msg);
+        {
+            s = SyslogAppend(s, end, msg, t->msg_len);
+            s = SyslogAppend(s, end, " ", 1);
+        }
         else
-            SnortSnprintfAppend(event_string, sizeof(event_string), "ALERT ");
+            s = SyslogAppend(s, end, "ALERT ", 6);
 
-        if (otn_tmp != NULL)
-        {
-            if ((otn_tmp->sigInfo.classType != NULL)
-                    && (otn_tmp->sigInfo.classType->name != NULL))
-            {
-                SnortSnprintfAppend(event_string, sizeof(event_string),
-                        "[Classification: %s] ",
-                        otn_tmp->sigInfo.classType->name);
-            }
+        s = SyslogAppend(s, end, t->cls, t->cls_len);
 
-            if (otn_tmp->sigInfo.priority != 0)
-            {
-                SnortSnprintfAppend(event_string, sizeof(event_string),
-                        "[Priority: %d] ", otn_tmp->sigInfo.priority);
-            }
-        }
+        if (t->priority != 0)
+            s = SyslogAppend(s, end, t->pri, t->pri_len);
 
         if (ScAlertInterface())
         {
-            SnortSnprintfAppend(event_string, sizeof(event_string),
-                    "<%s> ", PRINT_INTERFACE(DAQ_GetInterfaceSpec()));
-        }
+            const char *iface = PRINT_INTERFACE(DAQ_GetInterfaceSpec());
 
-        if (protocol_names[GET_IPH_PROTO(p)] != NULL)
-        {
-            SnortSnprintfAppend(event_string, sizeof(event_string),
-                    "{%s} ", protocol_names[GET_IPH_PROTO(p)]);
-        }
-        else
-        {
-            SnortSnprintfAppend(event_string, sizeof(event_string),
-                    "{%d} ", GET_IPH_PROTO(p));
+            s = SyslogAppend(s, end, "<", 1);
+            s = SyslogAppend(s, end, iface, strlen(iface));
+            s = SyslogAppend(s, end, "> ", 2);
         }
 
-        if (p->frag_flag
-                || ((GET_IPH_PROTO(p) != IPPROTO_TCP)
-                    && (GET_IPH_PROTO(p) != IPPROTO_UDP)))
-        {
-            char *ip_fmt = "%s -> %s";
+        s = SyslogAppend(s, end, "{", 1);
 
-            if (ScObfuscate())
-            {
-                SnortSnprintfAppend(event_string, sizeof(event_string), ip_fmt,
-                        ObfuscateIpToText(GET_SRC_ADDR(p)),
-                        ObfuscateIpToText(GET_DST_ADDR(p)));
-            }
-            else
-            {
-                SnortSnprintfAppend(event_string, sizeof(event_string), ip_fmt,
-                        inet_ntoax(GET_SRC_ADDR(p)), inet_ntoax(GET_DST_ADDR(p)));
-            }
-        }
+        if (proto != NULL)
+            s = SyslogAppend(s, end, proto, strlen(proto));
         else
-        {
-            char *ip_fmt = "%s:%d -> %s:%d";
+            s = SyslogAppend(s, end, buf, LogFormatUInt(buf, GET_IPH_PROTO(p)));
 
-            if (ScObfuscate())
-            {
-                SnortSnprintfAppend(event_string, sizeof(event_string), ip_fmt,
-                        ObfuscateIpToText(GET_SRC_ADDR(p)), p->sp,
-                        ObfuscateIpToText(GET_DST_ADDR(p)), p->dp);
-            }
-            else
-            {
-                SnortSnprintfAppend(event_string, sizeof(event_string), ip_fmt,
-                        inet_ntoax(GET_SRC_ADDR(p)), p->sp,
-                        inet_ntoax(GET_DST_ADDR(p)), p->dp);
-            }
-        }
+        s = SyslogAppend(s, end, "} ", 2);
+        s = SyslogAppend(s, end, buf, LogFormatIpAddrs(buf, p));
+        *s = '\0';
 
         syslog(data->priority, "%s", event_string);
     }
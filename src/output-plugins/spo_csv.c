@@ -80,12 +80,90 @@ typedef struct _AlertCSVConfig
     struct _AlertCSVConfig *next;
 } AlertCSVConfig;
 
+/* the fields are looked up once when configured, not for each alert */
+typedef enum _CSVField
+{
+    CSV_NONE,
+    CSV_TIMESTAMP,
+    CSV_SIG_GENERATOR,
+    CSV_SIG_ID,
+    CSV_SIG_REV,
+    CSV_MSG,
+    CSV_PROTO,
+    CSV_ETHSRC,
+    CSV_ETHDST,
+    CSV_ETHTYPE,
+    CSV_UDPLENGTH,
+    CSV_ETHLEN,
+    CSV_TRHEADER,
+    CSV_SRCPORT,
+    CSV_DSTPORT,
+    CSV_SRC,
+    CSV_DST,
+    CSV_ICMPTYPE,
+    CSV_ICMPCODE,
+    CSV_ICMPID,
+    CSV_ICMPSEQ,
+    CSV_TTL,
+    CSV_TOS,
+    CSV_ID,
+    CSV_IPLEN,
+    CSV_DGMLEN,
+    CSV_TCPSEQ,
+    CSV_TCPACK,
+    CSV_TCPLEN,
+    CSV_TCPWINDOW,
+    CSV_TCPFLAGS
+} CSVField;
+
+static const struct
+{
+    const char* name;
+    CSVField field;
+} csv_fields[] =
+{
+    { "timestamp", CSV_TIMESTAMP },
+    { "sig_generator", CSV_SIG_GENERATOR },
+    { "sig_id", CSV_SIG_ID },
+    { "sig_rev", CSV_SIG_REV },
+    { "msg", CSV_MSG },
+    { "proto", CSV_PROTO },
+    { "ethsrc", CSV_ETHSRC },
+    { "ethdst", CSV_ETHDST },
+    { "ethtype", CSV_ETHTYPE },
+    { "udplength", CSV_UDPLENGTH },
+    { "ethlen", CSV_ETHLEN },
+#ifndef NO_NON_ETHER_DECODER
+    { "trheader", CSV_TRHEADER },
+#endif
+    { "srcport", CSV_SRCPORT },
+    { "dstport", CSV_DSTPORT },
+    { "src", CSV_SRC },
+    { "dst", CSV_DST },
+    { "icmptype", CSV_ICMPTYPE },
+    { "icmpcode", CSV_ICMPCODE },
+    { "icmpid", CSV_ICMPID },
+    { "icmpseq", CSV_ICMPSEQ },
+    { "ttl", CSV_TTL },
+    { "tos", CSV_TOS },
+    { "id", CSV_ID },
+    { "iplen", CSV_IPLEN },
+    { "dgmlen", CSV_DGMLEN },
+    { "tcpseq", CSV_TCPSEQ },
+    { "tcpack", CSV_TCPACK },
+    { "tcplen", CSV_TCPLEN },
+    { "tcpwindow", CSV_TCPWINDOW },
+    { "tcpflags", CSV_TCPFLAGS },
+    { NULL, CSV_NONE }
+};
+
 typedef struct _AlertCSVData
 {
     TextLog* log;
     char * csvargs;
     char ** args;
     int numargs;
+    CSVField *fields;
     AlertCSVConfig *config;
 } AlertCSVData;
 
@@ -96,7 +174,7 @@ static AlertCSVData *AlertCSVParseArgs(struct _SnortConfig *, char *);
 static void AlertCSV(Packet *, char *, void *, Event *);
 static void AlertCSVCleanExit(int, void *);
 static void RealAlertCSV(
-    Packet*, char* msg, char **args, int numargs, Event*, TextLog*
+    Packet*, char* msg, CSVField *fields, int numargs, Event*, TextLog*
 );
 
 /*
@@ -227,6 +305,19 @@ static AlertCSVData *AlertCSVParseArgs(struct _SnortConfig *sc, char *args)
 
     data->args = toks;
     data->numargs = num_toks;
+    data->fields = (CSVField *)SnortAlloc((num_toks + 1) * sizeof(CSVField));
+
+    for (i = 0; i < num_toks; i++)
+    {
+        int j;
+
+        for (j = 0; csv_fields[j].name; j++)
+        {
+            if (!strcasecmp(csv_fields[j].name, toks[i]))
+                break;
+        }
+        data->fields[i] = csv_fields[j].field;
+    }
 
     DEBUG_WRAP(DebugMessage(
         DEBUG_INIT, "alert_csv: '%s' '%s' %ld\n", filename, data->csvargs, limit
@@ -246,6 +337,7 @@ static void AlertCSVCleanup(int signal, void *arg, const char* msg)
     if(data)
     {
         mSplitFree(&data->args, data->numargs);
+        free(data->fields);
         if (data->log) TextLog_Term(data->log);
         free(data->csvargs);
         /* free memory from SpoCSVData */
@@ -261,29 +353,29 @@ static void AlertCSVCleanExit(int signal, void *arg)
 static void AlertCSV(Packet *p, char *msg, void *arg, Event *event)
 {
     AlertCSVData *data = (AlertCSVData *)arg;
-    RealAlertCSV(p, msg, data->args, data->numargs, event, data->log);
+    RealAlertCSV(p, msg, data->fields, data->numargs, event, data->log);
 }
 
 /*
  *
- * Function: RealAlertCSV(Packet *, char *, FILE *, char *, numargs const int)
+ * Function: RealAlertCSV(Packet *, char *, CSVField *, numargs const int)
  *
  * Purpose: Write a user defined CSV message
  *
  * Arguments:     p => packet. (could be NULL)
  *              msg => the message to send
- *             args => CSV output arguements
- *          numargs => number of arguements
+ *           fields => CSV output fields
+ *          numargs => number of fields
  *             log => Log
  * Returns: void function
  *
  */
-static void RealAlertCSV(Packet * p, char *msg, char **args,
+static void RealAlertCSV(Packet * p, char *msg, CSVField *fields,
         int numargs, Event *event, TextLog* log)
 {
     int num;
-    char *type;
     char tcpFlags[9];
+    char buf[INET6_ADDRSTRLEN];
 
     if(p == NULL)
         return;
@@ -292,211 +384,201 @@ static void RealAlertCSV(Packet * p, char *msg, char **args,
 
     for (num = 0; num < numargs; num++)
     {
-        type = args[num];
-
-        DEBUG_WRAP(DebugMessage(DEBUG_LOG, "CSV Got type %s %d\n", type, num););
+        DEBUG_WRAP(DebugMessage(DEBUG_LOG, "CSV Got field %d %d\n", fields[num], num););
 
-        if (!strcasecmp("timestamp", type))
-        {
-            LogTimeStamp(log, p);
-        }
-        else if (!strcasecmp("sig_generator", type))
+        switch (fields[num])
         {
-            if (event != NULL)
-                TextLog_Print(log, "%lu",  (unsigned long) event->sig_generator);
-        }
-        else if (!strcasecmp("sig_id", type))
-        {
-            if (event != NULL)
-                TextLog_Print(log, "%lu",  (unsigned long) event->sig_id);
-        }
-        else if (!strcasecmp("sig_rev", type))
-        {
-            if (event != NULL)
-                TextLog_Print(log, "%lu",  (unsigned long) event->sig_rev);
-        }
-        else if (!strcasecmp("msg", type))
-        {
-            TextLog_Quote(log, msg);  /* Don't fatal */
-        }
-        else if (!strcasecmp("proto", type))
-        {
-            if (IPH_IS_VALID(p))
-            {
-                switch (GET_IPH_PROTO(p))
+            case CSV_TIMESTAMP:
+                LogTimeStamp(log, p);
+                break;
+
+            case CSV_SIG_GENERATOR:
+                if (event != NULL)
+                    TextLog_Write(log, buf, LogFormatUInt(buf, event->sig_generator));
+                break;
+
+            case CSV_SIG_ID:
+                if (event != NULL)
+                    TextLog_Write(log, buf, LogFormatUInt(buf, event->sig_id));
+                break;
+
+            case CSV_SIG_REV:
+                if (event != NULL)
+                    TextLog_Write(log, buf, LogFormatUInt(buf, event->sig_rev));
+                break;
+
+            case CSV_MSG:
+                TextLog_Quote(log, msg);  /* Don't fatal */
+                break;
+
+            case CSV_PROTO:
+                if (IPH_IS_VALID(p))
                 {
-                    case IPPROTO_UDP:
-                        TextLog_Puts(log, "UDP");
-                        break;
-                    case IPPROTO_TCP:
-                        TextLog_Puts(log, "TCP");
-                        break;
-                    case IPPROTO_ICMP:
-                        TextLog_Puts(log, "ICMP");
-                        break;
-                    default:
-                        break;
+                    switch (GET_IPH_PROTO(p))
+                    {
+                        case IPPROTO_UDP:
+                            TextLog_Puts(log, "UDP");
+                            break;
+                        case IPPROTO_TCP:
+                            TextLog_Puts(log, "TCP");
+                            break;
+                        case IPPROTO_ICMP:
+                            TextLog_Puts(log, "ICMP");
+                            break;
+                        default:
+                            break;
+                    }
                 }
-            }
-        }
-        else if (!strcasecmp("ethsrc", type))
-        {
-            if (p->eh != NULL)
-            {
-                TextLog_Print(log, "%02X:%02X:%02X:%02X:%02X:%02X", p->eh->ether_src[0],
-                        p->eh->ether_src[1], p->eh->ether_src[2], p->eh->ether_src[3],
-                        p->eh->ether_src[4], p->eh->ether_src[5]);
-            }
-        }
-        else if (!strcasecmp("ethdst", type))
-        {
-            if (p->eh != NULL)
-            {
-                TextLog_Print(log, "%02X:%02X:%02X:%02X:%02X:%02X", p->eh->ether_dst[0],
-                        p->eh->ether_dst[1], p->eh->ether_dst[2], p->eh->ether_dst[3],
-                        p->eh->ether_dst[4], p->eh->ether_dst[5]);
-            }
-        }
-        else if (!strcasecmp("ethtype", type))
-        {
-            if (p->eh != NULL)
-                TextLog_Print(log, "0x%X", ntohs(p->eh->ether_type));
-        }
-        else if (!strcasecmp("udplength", type))
-        {
-            if (p->udph != NULL)
-                TextLog_Print(log, "%d", ntohs(p->udph->uh_len));
-        }
-        else if (!strcasecmp("ethlen", type))
-        {
-            if (p->eh != NULL)
-                TextLog_Print(log, "0x%X", p->pkth->pktlen);
-        }
+                break;
+
+            case CSV_ETHSRC:
+                if (p->eh != NULL)
+                {
+                    TextLog_Print(log, "%02X:%02X:%02X:%02X:%02X:%02X", p->eh->ether_src[0],
+                            p->eh->ether_src[1], p->eh->ether_src[2], p->eh->ether_src[3],
+                            p->eh->ether_src[4], p->eh->ether_src[5]);
+                }
+                break;
+
+            case CSV_ETHDST:
+                if (p->eh != NULL)
+                {
+                    TextLog_Print(log, "%02X:%02X:%02X:%02X:%02X:%02X", p->eh->ether_dst[0],
+                            p->eh->ether_dst[1], p->eh->ether_dst[2], p->eh->ether_dst[3],
+                            p->eh->ether_dst[4], p->eh->ether_dst[5]);
+                }
+                break;
+
+            case CSV_ETHTYPE:
+                if (p->eh != NULL)
+                    TextLog_Print(log, "0x%X", ntohs(p->eh->ether_type));
+                break;
+
+            case CSV_UDPLENGTH:
+                if (p->udph != NULL)
+                    TextLog_Write(log, buf, LogFormatUInt(buf, ntohs(p->udph->uh_len)));
+                break;
+
+            case CSV_ETHLEN:
+                if (p->eh != NULL)
+                    TextLog_Print(log, "0x%X", p->pkth->pktlen);
+                break;
+
 #ifndef NO_NON_ETHER_DECODER
-        else if (!strcasecmp("trheader", type))
-        {
-            if (p->trh != NULL)
-                LogTrHeader(log, p);
-        }
+            case CSV_TRHEADER:
+                if (p->trh != NULL)
+                    LogTrHeader(log, p);
+                break;
 #endif
-        else if (!strcasecmp("srcport", type))
-        {
-            if (IPH_IS_VALID(p))
-            {
-                switch (GET_IPH_PROTO(p))
+
+            case CSV_SRCPORT:
+            case CSV_DSTPORT:
+                if (IPH_IS_VALID(p))
                 {
-                    case IPPROTO_UDP:
-                    case IPPROTO_TCP:
-                        TextLog_Print(log, "%d", p->sp);
-                        break;
-                    default:
-                        break;
+                    switch (GET_IPH_PROTO(p))
+                    {
+                        case IPPROTO_UDP:
+                        case IPPROTO_TCP:
+                            TextLog_Write(log, buf, LogFormatUInt(buf,
+                                (fields[num] == CSV_SRCPORT) ? p->sp : p->dp));
+                            break;
+                        default:
+                            break;
+                    }
                 }
-            }
-        }
-        else if (!strcasecmp("dstport", type))
-        {
-            if (IPH_IS_VALID(p))
-            {
-                switch (GET_IPH_PROTO(p))
+                break;
+
+            case CSV_SRC:
+                if (IPH_IS_VALID(p))
+                    TextLog_Write(log, buf, LogFormatIp(buf, GET_SRC_ADDR(p)));
+                break;
+
+            case CSV_DST:
+                if (IPH_IS_VALID(p))
+                    TextLog_Write(log, buf, LogFormatIp(buf, GET_DST_ADDR(p)));
+                break;
+
+            case CSV_ICMPTYPE:
+                if (p->icmph != NULL)
+                    TextLog_Write(log, buf, LogFormatUInt(buf, p->icmph->type));
+                break;
+
+            case CSV_ICMPCODE:
+                if (p->icmph != NULL)
+                    TextLog_Write(log, buf, LogFormatUInt(buf, p->icmph->code));
+                break;
+
+            case CSV_ICMPID:
+                if (p->icmph != NULL)
+                    TextLog_Write(log, buf, LogFormatUInt(buf, ntohs(p->icmph->s_icmp_id)));
+                break;
+
+            case CSV_ICMPSEQ:
+                if (p->icmph != NULL)
+                    TextLog_Write(log, buf, LogFormatUInt(buf, ntohs(p->icmph->s_icmp_seq)));
+                break;
+
+            case CSV_TTL:
+                if (IPH_IS_VALID(p))
+                    TextLog_Write(log, buf, LogFormatUInt(buf, GET_IPH_TTL(p)));
+                break;
+
+            case CSV_TOS:
+                if (IPH_IS_VALID(p))
+                    TextLog_Write(log, buf, LogFormatUInt(buf, GET_IPH_TOS(p)));
+                break;
+
+            case CSV_ID:
+                if (IPH_IS_VALID(p))
                 {
-                    case IPPROTO_UDP:
-                    case IPPROTO_TCP:
-                        TextLog_Print(log, "%d", p->dp);
-                        break;
-                    default:
-                        break;
+                    TextLog_Write(log, buf, LogFormatUInt(buf, IS_IP6(p) ? ntohl(GET_IPH_ID(p))
+                            : ntohs((uint16_t)GET_IPH_ID(p))));
                 }
-            }
-        }
-        else if (!strcasecmp("src", type))
-        {
-            if (IPH_IS_VALID(p))
-                TextLog_Puts(log, inet_ntoa(GET_SRC_ADDR(p)));
-        }
-        else if (!strcasecmp("dst", type))
-        {
-            if (IPH_IS_VALID(p))
-                TextLog_Puts(log, inet_ntoa(GET_DST_ADDR(p)));
-        }
-        else if (!strcasecmp("icmptype", type))
-        {
-            if (p->icmph != NULL)
-                TextLog_Print(log, "%d", p->icmph->type);
-        }
-        else if (!strcasecmp("icmpcode", type))
-        {
-            if (p->icmph != NULL)
-                TextLog_Print(log, "%d", p->icmph->code);
-        }
-        else if (!strcasecmp("icmpid", type))
-        {
-            if (p->icmph != NULL)
-                TextLog_Print(log, "%d", ntohs(p->icmph->s_icmp_id));
-        }
-        else if (!strcasecmp("icmpseq", type))
-        {
-            if (p->icmph != NULL)
-                TextLog_Print(log, "%d", ntohs(p->icmph->s_icmp_seq));
-        }
-        else if (!strcasecmp("ttl", type))
-        {
-            if (IPH_IS_VALID(p))
-                TextLog_Print(log, "%d", GET_IPH_TTL(p));
-        }
-        else if (!strcasecmp("tos", type))
-        {
-            if (IPH_IS_VALID(p))
-                TextLog_Print(log, "%d", GET_IPH_TOS(p));
-        }
-        else if (!strcasecmp("id", type))
-        {
-            if (IPH_IS_VALID(p))
-            {
-                TextLog_Print(log, "%u", IS_IP6(p) ? ntohl(GET_IPH_ID(p))
-                        : ntohs((uint16_t)GET_IPH_ID(p)));
-            }
-        }
-        else if (!strcasecmp("iplen", type))
-        {
-            if (IPH_IS_VALID(p))
-                TextLog_Print(log, "%d", GET_IPH_LEN(p) << 2);
-        }
-        else if (!strcasecmp("dgmlen", type))
-        {
-            if (IPH_IS_VALID(p))
-            {
-                // XXX might cause a bug when IPv6 is printed?
-                TextLog_Print(log, "%d", ntohs(GET_IPH_LEN(p)));
-            }
-        }
-        else if (!strcasecmp("tcpseq", type))
-        {
-            if (p->tcph != NULL)
-                TextLog_Print(log, "0x%lX", (u_long)ntohl(p->tcph->th_seq));
-        }
-        else if (!strcasecmp("tcpack", type))
-        {
-            if (p->tcph != NULL)
-                TextLog_Print(log, "0x%lX", (u_long)ntohl(p->tcph->th_ack));
-        }
-        else if (!strcasecmp("tcplen", type))
-        {
-            if (p->tcph != NULL)
-                TextLog_Print(log, "%d", TCP_OFFSET(p->tcph) << 2);
-        }
-        else if (!strcasecmp("tcpwindow", type))
-        {
-            if (p->tcph != NULL)
-                TextLog_Print(log, "0x%X", ntohs(p->tcph->th_win));
-        }
-        else if (!strcasecmp("tcpflags",type))
-        {
-            if (p->tcph != NULL)
-            {
-                CreateTCPFlagString(p, tcpFlags);
-                TextLog_Print(log, "%s", tcpFlags);
-            }
+                break;
+
+            case CSV_IPLEN:
+                if (IPH_IS_VALID(p))
+                    TextLog_Print(log, "%d", GET_IPH_LEN(p) << 2);
+                break;
+
+            case CSV_DGMLEN:
+                if (IPH_IS_VALID(p))
+                {
+                    // XXX might cause a bug when IPv6 is printed?
+                    TextLog_Print(log, "%d", ntohs(GET_IPH_LEN(p)));
+                }
+                break;
+
+            case CSV_TCPSEQ:
+                if (p->tcph != NULL)
+                    TextLog_Print(log, "0x%lX", (u_long)ntohl(p->tcph->th_seq));
+                break;
+
+            case CSV_TCPACK:
+                if (p->tcph != NULL)
+                    TextLog_Print(log, "0x%lX", (u_long)ntohl(p->tcph->th_ack));
+                break;
+
+            case CSV_TCPLEN:
+                if (p->tcph != NULL)
+                    TextLog_Write(log, buf, LogFormatUInt(buf, TCP_OFFSET(p->tcph) << 2));
+                break;
+
+            case CSV_TCPWINDOW:
+                if (p->tcph != NULL)
+                    TextLog_Print(log, "0x%X", ntohs(p->tcph->th_win));
+                break;
+
+            case CSV_TCPFLAGS:
+                if (p->tcph != NULL)
+                {
+                    CreateTCPFlagString(p, tcpFlags);
+                    TextLog_Puts(log, tcpFlags);
+                }
+                break;
+
+            default:
+                break;
         }
 
         if (num < numargs - 1)
@@ -506,4 +588,3 @@ static void RealAlertCSV(Packet * p, char *msg, char **args,
     TextLog_NewLine(log);
     TextLog_Flush(log);
 }
-
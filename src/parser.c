@@ -95,6 +95,7 @@
 #include "sfutil/sfportobject.h"
 #include "sfutil/strvec.h"
 #include "active.h"
+#include "bypass.h"
 #include "file_config.h"
 #include "file_service_config.h"
 #include "dynamic-plugins/sp_dynamic.h"
@@ -220,6 +221,7 @@
 
 #define DETECTION_OPT__BLEEDOVER_PORT_LIMIT                  "bleedover-port-limit"
 #define DETECTION_OPT__BLEEDOVER_WARNINGS_ENABLED            "bleedover-warnings-enabled"
+#define DETECTION_OPT__CARRY_SEARCH_STATE                    "carry-search-state"
 #define DETECTION_OPT__DEBUG                                 "debug"
 #define DETECTION_OPT__DEBUG_PRINT_NOCONTENT_RULE_TESTS      "debug-print-nocontent-rule-tests"
 #define DETECTION_OPT__DEBUG_PRINT_RULE_GROUP_BUILD_DETAILS  "debug-print-rule-group-build-details"
@@ -233,6 +235,7 @@
 #define DETECTION_OPT__SPLIT_ANY_ANY                         "split-any-any"
 #define DETECTION_OPT__MAX_PATTERN_LEN                       "max-pattern-len"
 #define DETECTION_OPT__DEBUG_PRINT_FAST_PATTERN              "debug-print-fast-pattern"
+#define DETECTION_OPT__DUMP_PATTERN_GROUPS                   "dump-pattern-groups"
 
 #define EVENT_QUEUE_OPT__LOG                 "log"
 #define EVENT_QUEUE_OPT__MAX_QUEUE           "max_queue"
@@ -300,6 +303,7 @@
 #define RESPONSE_OPT__ATTEMPTS  "attempts"
 #define RESPONSE_OPT__DEVICE    "device"
 #define RESPONSE_OPT__DST_MAC   "dst_mac"
+#define RESPONSE_OPT__BATCH     "batch"
 #endif
 
 #define ERR_PAIR_COUNT \
@@ -610,6 +614,8 @@ static const ConfigFunc config_opts[] =
     { CONFIG_OPT__ASN1, 1, 1, 1, ConfigAsn1 },
     { CONFIG_OPT__BINDING, 1, 0, 1, ConfigBinding },
     { CONFIG_OPT__BPF_FILE, 1, 1, 1, ConfigBpfFile },
+    { CONFIG_OPT__BYPASS_FLOWS, 1, 1, 1, ConfigBypassFlows },
+    { CONFIG_OPT__BYPASS_TIMEOUT, 1, 1, 1, ConfigBypassTimeout },
     { CONFIG_OPT__CHECKSUM_DROP, 0, 0, 0, ConfigChecksumDrop },
     { CONFIG_OPT__CHECKSUM_MODE, 0, 0, 0, ConfigChecksumMode },
     { CONFIG_OPT__CHROOT_DIR, 1, 1, 1, ConfigChrootDir },
@@ -644,6 +650,7 @@ static const ConfigFunc config_opts[] =
     { CONFIG_OPT__ENABLE_DECODE_OVERSIZED_DROPS, 0, 1, 1, ConfigEnableDecodeOversizedDrops },
     { CONFIG_OPT__ENABLE_DEEP_TEREDO_INSPECTION, 0, 1, 1, ConfigEnableDeepTeredoInspection },
     { CONFIG_OPT__ENABLE_GTP_DECODING, 0, 1, 1, ConfigEnableGTPDecoding },
+    { CONFIG_OPT__ENABLE_GTP_OVERLAPPING_IP, 0, 1, 1, ConfigEnableGTPOverlappingIp },
     { CONFIG_OPT__ENABLE_IP_OPT_DROPS, 0, 1, 1, ConfigEnableIpOptDrops },
 #ifdef MPLS
     { CONFIG_OPT__ENABLE_MPLS_MULTICAST, 0, 1, 1, ConfigEnableMplsMulticast },
@@ -823,6 +830,7 @@ static void DestroyRuleTreeNode(RuleTreeNode *rtn);
 static void AddrToFunc(RuleTreeNode *, int);
 static void PortToFunc(RuleTreeNode *, int, int, int);
 static void SetupRTNFuncList(RuleTreeNode *);
+static RulePortRange * CompileRulePorts(PortObject *, unsigned int *);
 static void DisallowCrossTableDuplicateVars(SnortConfig *, char *, VarType);
 static int mergeDuplicateOtn(SnortConfig *, OptTreeNode *, OptTreeNode *, RuleTreeNode *);
 #if 0
@@ -1869,6 +1877,96 @@ static void SetupRTNFuncList(RuleTreeNode * rtn)
 
     /* tack the end (success) function to the list */
     AddRuleFuncToList(RuleListEnd, rtn);
+
+    /* The same checks, compiled for CheckRuleHeader() */
+    if (rtn->flags & BIDIRECTIONAL)
+    {
+        rtn->header_checks = RULE_HDR_CHECK_BIDIRECTIONAL;
+        return;
+    }
+
+    rtn->header_checks = 0;
+
+    if (!(rtn->flags & ANY_DST_PORT))
+    {
+        rtn->header_checks |= (rtn->flags & EXCEPT_DST_PORT) ?
+            RULE_HDR_CHECK_DST_PORT_NOT : RULE_HDR_CHECK_DST_PORT;
+        rtn->dst_ports = CompileRulePorts(rtn->dst_portobject, &rtn->num_dst_ports);
+    }
+
+    if (!(rtn->flags & ANY_SRC_PORT))
+    {
+        rtn->header_checks |= (rtn->flags & EXCEPT_SRC_PORT) ?
+            RULE_HDR_CHECK_SRC_PORT_NOT : RULE_HDR_CHECK_SRC_PORT;
+        rtn->src_ports = CompileRulePorts(rtn->src_portobject, &rtn->num_src_ports);
+    }
+
+    if (!(rtn->flags & ANY_SRC_IP))
+        rtn->header_checks |= RULE_HDR_CHECK_SRC_IP;
+
+    if (!(rtn->flags & ANY_DST_IP))
+        rtn->header_checks |= RULE_HDR_CHECK_DST_IP;
+}
+
+/****************************************************************************
+ *
+ * Function: CompileRulePorts(PortObject *, unsigned int *)
+ *
+ * Purpose: Flattens a rule header port object into an array of port ranges
+ *          that matches exactly the ports PortObjectHasPort() would.
+ *
+ * Arguments: po => the port object
+ *            num_ranges => set to the number of ranges returned
+ *
+ * Returns: the array of ranges, NULL if there are none
+ *
+ ***************************************************************************/
+static RulePortRange * CompileRulePorts(PortObject *po, unsigned int *num_ranges)
+{
+    PortObjectItem *poi;
+    RulePortRange *ranges;
+    unsigned int n = 0;
+
+    *num_ranges = 0;
+
+    if ((po == NULL) || (sflist_count(po->item_list) == 0))
+        return NULL;
+
+    ranges = (RulePortRange *)SnortAlloc(
+        sflist_count(po->item_list) * sizeof(RulePortRange));
+
+    for (poi = (PortObjectItem *)sflist_first(po->item_list);
+         poi != NULL;
+         poi = (PortObjectItem *)sflist_next(po->item_list))
+    {
+        if (poi->type == PORT_OBJECT_ANY)
+            break;  /* no match past an any item */
+
+        if ((poi->type != PORT_OBJECT_PORT) && (poi->type != PORT_OBJECT_RANGE))
+            continue;
+
+        if (poi->flags & PORT_OBJECT_NOT_FLAG)
+        {
+            /* a negated item matches every port */
+            ranges[n].lport = 0;
+            ranges[n].hport = 0xffff;
+            n++;
+            break;
+        }
+
+        ranges[n].lport = poi->lport;
+        ranges[n].hport = (poi->type == PORT_OBJECT_PORT) ? poi->lport : poi->hport;
+        n++;
+    }
+
+    if (n == 0)
+    {
+        free(ranges);
+        return NULL;
+    }
+
+    *num_ranges = n;
+    return ranges;
 }
 
 /****************************************************************************
@@ -2762,6 +2860,12 @@ static void FreeRuleTreeNode(RuleTreeNode *rtn)
         idx = idx->next;
         free(tmp);
     }
+
+    if (rtn->src_ports)
+        free(rtn->src_ports);
+
+    if (rtn->dst_ports)
+        free(rtn->dst_ports);
 }
 
 static void DestroyRuleTreeNode(RuleTreeNode *rtn)
@@ -6711,6 +6815,10 @@ void ConfigDetection(SnortConfig *sc, char *args)
         {
             fpDetectSetSplitAnyAny(fp, 1);
         }
+        else if (strcasecmp(toks[i], DETECTION_OPT__CARRY_SEARCH_STATE) == 0)
+        {
+            fpDetectSetCarryState(fp, 1);
+        }
         else if (strcasecmp(toks[i], DETECTION_OPT__MAX_PATTERN_LEN) == 0)
         {
             i++;
@@ -6736,6 +6844,18 @@ void ConfigDetection(SnortConfig *sc, char *args)
         {
             fpDetectSetDebugPrintFastPatterns(fp, 1);
         }
+        else if (strcasecmp(toks[i], DETECTION_OPT__DUMP_PATTERN_GROUPS) == 0)
+        {
+            i++;
+            if (i < num_toks)
+            {
+                fpSetPatternDumpFile(fp, toks[i]);
+            }
+            else
+            {
+                ParseError("Missing file name argument to 'dump-pattern-groups'.");
+            }
+        }
         else
         {
             ParseError("'%s' is an invalid option to the 'config detection' "
@@ -7013,6 +7133,20 @@ void ConfigEnableGTPDecoding(SnortConfig *sc, char *args)
     }
 }
 
+void ConfigEnableGTPOverlappingIp(SnortConfig *sc, char *args)
+{
+    if (sc == NULL)
+        return;
+
+    if (!sc->enable_gtp)
+    {
+        ParseError("config %s requires config %s to be set first.",
+                CONFIG_OPT__ENABLE_GTP_OVERLAPPING_IP, CONFIG_OPT__ENABLE_GTP_DECODING);
+    }
+
+    sc->gtp_overlapping_ip = 1;
+}
+
 void ConfigEnableEspDecoding(SnortConfig *sc, char *args)
 {
     int ret;
@@ -7383,6 +7517,27 @@ void ConfigResponse (SnortConfig *sc, char *args)
                     "layer responses or 'eth0' etc. for link layer responses.");
             }
         }
+        else if ( !strcasecmp(toks[i], RESPONSE_OPT__BATCH) )
+        {
+            if ( ++i < num_toks )
+            {
+                char *endptr;
+                long int value = strtol(toks[i], &endptr, 0);
+
+                if ((errno == ERANGE) || (*endptr != '\0') ||
+                    (value < 0) || (value > 1024))
+                {
+                    ParseError("Invalid argument for batch: %s.  "
+                        "Argument must be between 0 and 1024 inclusive.", toks[i]);
+                }
+                sc->respond_batch = (uint16_t)value;
+            }
+            else
+            {
+                ParseError("No argument to 'batch'.  "
+                    "Argument must be between 0 and 1024 inclusive.");
+            }
+        }
         else if ( !strcasecmp(toks[i], RESPONSE_OPT__DST_MAC) )
         {
             if ( ++i < num_toks )
@@ -7989,6 +8144,48 @@ void ConfigPafMax (SnortConfig *sc, char *args)
     }
 }
 
+void ConfigBypassFlows(SnortConfig *sc, char *args)
+{
+    long int value;
+    char *endptr;
+
+    if ((sc == NULL) || (args == NULL))
+        return;
+
+    value = SnortStrtoulRange(args, &endptr, 0, 0, MAX_BYPASS_FLOWS);
+
+    if ( (errno == ERANGE) || (*endptr != '\0') )
+    {
+        ParseError(
+            "Invalid argument to '%s' configuration: %s.  "
+            "Must be between 0 (off) and %u (max).",
+            CONFIG_OPT__BYPASS_FLOWS, args, MAX_BYPASS_FLOWS);
+    }
+
+    sc->bypass_flows = (uint32_t)value;
+}
+
+void ConfigBypassTimeout(SnortConfig *sc, char *args)
+{
+    long int value;
+    char *endptr;
+
+    if ((sc == NULL) || (args == NULL))
+        return;
+
+    value = SnortStrtoulRange(args, &endptr, 0, 1, MAX_BYPASS_TIMEOUT);
+
+    if ( (errno == ERANGE) || (*endptr != '\0') )
+    {
+        ParseError(
+            "Invalid argument to '%s' configuration: %s.  "
+            "Must be between 1 and %u seconds.",
+            CONFIG_OPT__BYPASS_TIMEOUT, args, MAX_BYPASS_TIMEOUT);
+    }
+
+    sc->bypass_timeout = (uint32_t)value;
+}
+
 void ConfigRuleListOrder(SnortConfig *sc, char *args)
 {
     OrderRuleLists(sc, args);
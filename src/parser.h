@@ -87,6 +87,8 @@
 #define CONFIG_OPT__ASN1                            "asn1"
 #define CONFIG_OPT__BINDING                         "binding"
 #define CONFIG_OPT__BPF_FILE                        "bpf_file"
+#define CONFIG_OPT__BYPASS_FLOWS                    "bypass_flows"
+#define CONFIG_OPT__BYPASS_TIMEOUT                  "bypass_timeout"
 #define CONFIG_OPT__CHECKSUM_DROP                   "checksum_drop"
 #define CONFIG_OPT__CHECKSUM_MODE                   "checksum_mode"
 #define CONFIG_OPT__CHROOT_DIR                      "chroot"
@@ -121,6 +123,7 @@
 #define CONFIG_OPT__ENABLE_DECODE_OVERSIZED_DROPS   "enable_decode_oversized_drops"
 #define CONFIG_OPT__ENABLE_DEEP_TEREDO_INSPECTION   "enable_deep_teredo_inspection"
 #define CONFIG_OPT__ENABLE_GTP_DECODING             "enable_gtp"
+#define CONFIG_OPT__ENABLE_GTP_OVERLAPPING_IP       "enable_gtp_overlapping_ip"
 #define CONFIG_OPT__ENABLE_IP_OPT_DROPS             "enable_ipopt_drops"
 #ifdef MPLS
 # define CONFIG_OPT__ENABLE_MPLS_MULTICAST          "enable_mpls_multicast"
@@ -289,6 +292,7 @@ void ConfigEnableDecodeOversizedAlerts(SnortConfig *, char *);
 void ConfigEnableDecodeOversizedDrops(SnortConfig *, char *);
 void ConfigEnableDeepTeredoInspection(SnortConfig *sc, char *args);
 void ConfigEnableGTPDecoding(SnortConfig *sc, char *args);
+void ConfigEnableGTPOverlappingIp(SnortConfig *sc, char *args);
 void ConfigEnableEspDecoding(SnortConfig *sc, char *args);
 void ConfigEnableIpOptDrops(SnortConfig *, char *);
 #ifdef MPLS
@@ -345,6 +349,8 @@ void ConfigNoPromiscuous(SnortConfig *, char *);
 void ConfigObfuscate(SnortConfig *, char *);
 void ConfigObfuscationMask(SnortConfig *, char *);
 void ConfigPafMax(SnortConfig *, char *);
+void ConfigBypassFlows(SnortConfig *, char *);
+void ConfigBypassTimeout(SnortConfig *, char *);
 void ConfigRateFilter(SnortConfig *, char *);
 void ConfigRuleListOrder(SnortConfig *, char *);
 void ConfigPacketCount(SnortConfig *, char *);
@@ -0,0 +1,559 @@
+/****************************************************************************
+ *
+ * Copyright (C) 2013 Sourcefire, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 2 as
+ * published by the Free Software Foundation.  You may not use, modify or
+ * distribute this program under any other version of the GNU General
+ * Public License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ ****************************************************************************/
+
+// @file    pcap_workers.c
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#ifndef WIN32
+
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "pcap_workers.h"
+#include "decode.h"
+#include "snort.h"
+#include "util.h"
+
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+#define WORKER_DIR "worker"
+#define WORKER_LOG "snort.log"
+
+#define ETH_HDR_LEN  14
+#define VLAN_HDR_LEN  4
+#define SLL_HDR_LEN  16
+
+// each worker leaves its totals here for the parent
+typedef struct _PcapWorkerStats
+{
+    PacketCount pc;
+    DAQ_Stats_t daq;
+    int reported;
+} PcapWorkerStats;
+
+unsigned pcap_worker_flows = 0;
+
+static unsigned s_index = 0;
+static PcapWorkerStats* s_stats = NULL;
+
+//--------------------------------------------------------------------
+// packet ownership
+// only the addresses are hashed, ordered so that both directions agree.
+// anything that isn't plain ip over ethernet, sll, or raw goes to
+// worker 0.
+//--------------------------------------------------------------------
+
+static inline uint16_t get16 (const uint8_t* p)
+{
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static const uint8_t* PcapWorkers_GetIp (
+    const DAQ_PktHdr_t* pkth, const uint8_t* pkt, uint16_t* type)
+{
+    const uint8_t* end = pkt + pkth->caplen;
+    const uint8_t* l3;
+
+    switch ( DAQ_GetBaseProtocol() )
+    {
+    case DLT_EN10MB:
+        if ( end - pkt < ETH_HDR_LEN )
+            return NULL;
+
+        *type = get16(pkt + 12);
+        l3 = pkt + ETH_HDR_LEN;
+
+        while ( *type == ETHERNET_TYPE_8021Q )
+        {
+            if ( end - l3 < VLAN_HDR_LEN )
+                return NULL;
+
+            *type = get16(l3 + 2);
+            l3 += VLAN_HDR_LEN;
+        }
+        break;
+
+#ifdef DLT_LINUX_SLL
+    case DLT_LINUX_SLL:
+        if ( end - pkt < SLL_HDR_LEN )
+            return NULL;
+
+        *type = get16(pkt + 14);
+        l3 = pkt + SLL_HDR_LEN;
+        break;
+#endif
+
+    case DLT_RAW:
+    case DLT_IPV4:
+    case DLT_IPV6:
+        if ( end == pkt )
+            return NULL;
+
+        *type = ((pkt[0] >> 4) == 6) ? ETHERNET_TYPE_IPV6 : ETHERNET_TYPE_IP;
+        l3 = pkt;
+        break;
+
+    default:
+        return NULL;
+    }
+
+    if ( *type == ETHERNET_TYPE_IP )
+        return ( end - l3 >= IP_HEADER_LEN ) ? l3 : NULL;
+
+    if ( *type == ETHERNET_TYPE_IPV6 )
+        return ( end - l3 >= IP6_HDR_LEN ) ? l3 : NULL;
+
+    return NULL;
+}
+
+static inline uint32_t PcapWorkers_Hash (const uint8_t* a, const uint8_t* b, int len)
+{
+    uint32_t h = 2166136261U;
+    int i;
+
+    if ( memcmp(a, b, len) > 0 )
+    {
+        const uint8_t* t = a;
+        a = b;
+        b = t;
+    }
+    for ( i = 0; i < len; i++ )
+        h = (h ^ a[i]) * 16777619U;
+
+    for ( i = 0; i < len; i++ )
+        h = (h ^ b[i]) * 16777619U;
+
+    return h;
+}
+
+int PcapWorkers_Check (const DAQ_PktHdr_t* pkth, const uint8_t* pkt)
+{
+    uint16_t type;
+    const uint8_t* ip = PcapWorkers_GetIp(pkth, pkt, &type);
+    uint32_t h;
+
+    if ( !ip )
+        return s_index != 0;
+
+    if ( type == ETHERNET_TYPE_IP )
+        h = PcapWorkers_Hash(ip + 12, ip + 16, 4);
+    else
+        h = PcapWorkers_Hash(ip + 8, ip + 24, 16);
+
+    return (h % pcap_worker_flows) != s_index;
+}
+
+//--------------------------------------------------------------------
+// worker side
+//--------------------------------------------------------------------
+
+static void PcapWorkers_Dir (
+    const SnortConfig* sc, unsigned idx, char* buf, size_t len)
+{
+    if ( SnortSnprintf(buf, len, "%s/%s.%u", sc->log_dir, WORKER_DIR, idx)
+        != SNORT_SNPRINTF_SUCCESS )
+        FatalError("Log directory name is too long for pcap workers.\n");
+}
+
+static void PcapWorkers_Init (SnortConfig* sc, unsigned idx, const char* dir)
+{
+    char path[PATH_MAX];
+    size_t len = strlen(sc->log_dir);
+    int fd;
+
+    SnortSnprintf(path, sizeof(path), "%s/%s", dir, WORKER_LOG);
+    fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+
+    if ( fd < 0 )
+        FatalError("Can't create %s: %s\n", path, strerror(errno));
+
+    dup2(fd, STDOUT_FILENO);
+    dup2(fd, STDERR_FILENO);
+    close(fd);
+
+    // the alert file was already put in the log directory
+    if ( sc->alert_file && !strncmp(sc->alert_file, sc->log_dir, len) &&
+        sc->alert_file[len] == '/' )
+    {
+        SnortSnprintf(path, sizeof(path), "%s%s", dir, sc->alert_file + len);
+        free(sc->alert_file);
+        sc->alert_file = SnortStrdup(path);
+    }
+    free(sc->log_dir);
+    sc->log_dir = SnortStrdup(dir);
+
+    // keep event ids unique across workers unless the user set the log id
+    if ( !sc->event_log_id )
+        sc->event_log_id = idx << 16;
+
+    s_index = idx;
+}
+
+void PcapWorkers_Report (const PacketCount* pkts, const DAQ_Stats_t* daq)
+{
+    if ( !s_stats )
+        return;
+
+    s_stats[s_index].pc = *pkts;
+    s_stats[s_index].daq = *daq;
+    s_stats[s_index].reported = 1;
+}
+
+//--------------------------------------------------------------------
+// parent side
+//--------------------------------------------------------------------
+
+static int PcapWorkers_IsPcap (const char* path)
+{
+    FILE* fp = fopen(path, "rb");
+    uint8_t m[4];
+    int is_pcap = 0;
+
+    if ( !fp )
+        return 0;
+
+    if ( fread(m, sizeof(m), 1, fp) == 1 )
+    {
+        // standard and nanosecond magic in either byte order
+        is_pcap =
+            (m[0] == 0xa1 && m[1] == 0xb2 && (m[2] == 0xc3 || m[2] == 0x3c)) ||
+            (m[3] == 0xa1 && m[2] == 0xb2 && (m[1] == 0xc3 || m[1] == 0x3c));
+    }
+    fclose(fp);
+    return is_pcap;
+}
+
+// the name less any trailing .<time stamp>
+static size_t PcapWorkers_KeyLen (const char* name)
+{
+    size_t len = strlen(name);
+    size_t n = len;
+
+    while ( n > 0 && isdigit((int)name[n-1]) )
+        n--;
+
+    if ( n > 0 && n < len && name[n-1] == '.' )
+        return n - 1;
+
+    return len;
+}
+
+static int PcapWorkers_Append (const char* dst, const char* src)
+{
+    char buf[65536];
+    FILE* in = fopen(src, "rb");
+    FILE* out;
+    size_t n;
+    int ret = 0;
+
+    if ( !in )
+        return -1;
+
+    out = fopen(dst, "ab");
+
+    if ( !out )
+    {
+        fclose(in);
+        return -1;
+    }
+    while ( (n = fread(buf, 1, sizeof(buf), in)) > 0 )
+    {
+        if ( fwrite(buf, 1, n, out) != n )
+        {
+            ret = -1;
+            break;
+        }
+    }
+    if ( ferror(in) )
+        ret = -1;
+
+    fclose(in);
+
+    if ( fclose(out) )
+        ret = -1;
+
+    return ret;
+}
+
+static void* PcapWorkers_Grow (void* p, size_t size)
+{
+    p = realloc(p, size);
+
+    if ( !p )
+        FatalError("Out of memory merging pcap worker output\n");
+
+    return p;
+}
+
+static int PcapWorkers_NameCmp (const void* a, const void* b)
+{
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+static void PcapWorkers_MergeDir (
+    const SnortConfig* sc, const char* dir, char*** merged, unsigned* num)
+{
+    DIR* d = opendir(dir);
+    struct dirent* de;
+    char** names = NULL;
+    unsigned i, j, count = 0, max = 0;
+
+    if ( !d )
+        return;
+
+    while ( (de = readdir(d)) )
+    {
+        if ( de->d_name[0] == '.' || !strcmp(de->d_name, WORKER_LOG) )
+            continue;
+
+        if ( count == max )
+        {
+            max = max ? 2 * max : 32;
+            names = (char**)PcapWorkers_Grow(names, max * sizeof(*names));
+        }
+        names[count++] = SnortStrdup(de->d_name);
+    }
+    closedir(d);
+
+    // readdir order is arbitrary; time stamped names sort by time
+    qsort(names, count, sizeof(*names), PcapWorkers_NameCmp);
+
+    for ( i = 0; i < count; i++ )
+    {
+        char src[PATH_MAX], dst[PATH_MAX];
+        const char* name = names[i];
+        size_t klen = PcapWorkers_KeyLen(name);
+        struct stat st;
+
+        SnortSnprintf(src, sizeof(src), "%s/%s", dir, name);
+
+        if ( stat(src, &st) || !S_ISREG(st.st_mode) || PcapWorkers_IsPcap(src) )
+        {
+            free(names[i]);
+            continue;
+        }
+
+        // earlier workers decide the merged file's name
+        for ( j = 0; j < *num; j++ )
+        {
+            if ( PcapWorkers_KeyLen((*merged)[j]) == klen &&
+                !strncmp((*merged)[j], name, klen) )
+            {
+                name = (*merged)[j];
+                break;
+            }
+        }
+        if ( j == *num )
+        {
+            *merged = (char**)PcapWorkers_Grow(*merged, (*num + 1) * sizeof(**merged));
+            (*merged)[(*num)++] = SnortStrdup(name);
+        }
+        SnortSnprintf(dst, sizeof(dst), "%s/%s", sc->log_dir, name);
+
+        if ( PcapWorkers_Append(dst, src) )
+            ErrorMessage("Could not merge %s into %s: %s\n", src, dst, strerror(errno));
+        else
+            unlink(src);
+
+        free(names[i]);
+    }
+    free(names);
+}
+
+static void PcapWorkers_Merge (const SnortConfig* sc, unsigned n)
+{
+    char** merged = NULL;
+    unsigned i, num = 0;
+
+    for ( i = 0; i < n; i++ )
+    {
+        char dir[PATH_MAX];
+        PcapWorkers_Dir(sc, i, dir, sizeof(dir));
+        PcapWorkers_MergeDir(sc, dir, &merged, &num);
+    }
+    for ( i = 0; i < num; i++ )
+    {
+        LogMessage("Merged worker output into %s/%s\n", sc->log_dir, merged[i]);
+        free(merged[i]);
+    }
+    free(merged);
+}
+
+static void PcapWorkers_Totals (unsigned n, int by_flow)
+{
+    PacketCount sum;
+    DAQ_Stats_t daq;
+    unsigned i, j;
+
+    memset(&sum, 0, sizeof(sum));
+    memset(&daq, 0, sizeof(daq));
+
+    for ( i = 0; i < n; i++ )
+    {
+        const PcapWorkerStats* ws = s_stats + i;
+        uint64_t* s = (uint64_t*)&sum;
+        const uint64_t* w = (const uint64_t*)&ws->pc;
+
+        if ( !ws->reported )
+            continue;
+
+        for ( j = 0; j < sizeof(sum) / sizeof(*s); j++ )
+            s[j] += w[j];
+
+        daq.hw_packets_received += ws->daq.hw_packets_received;
+        daq.hw_packets_dropped += ws->daq.hw_packets_dropped;
+        daq.packets_received += ws->daq.packets_received;
+        daq.packets_filtered += ws->daq.packets_filtered;
+        daq.packets_injected += ws->daq.packets_injected;
+
+        for ( j = 0; j < MAX_DAQ_VERDICT; j++ )
+            daq.verdicts[j] += ws->daq.verdicts[j];
+    }
+
+    if ( by_flow )
+    {
+        // every worker read every packet but analyzed only its own;
+        // the rest were passed without being counted
+        uint64_t skipped = daq.packets_received - daq.packets_received / n;
+
+        daq.hw_packets_received /= n;
+        daq.hw_packets_dropped /= n;
+        daq.packets_filtered /= n;
+        daq.packets_received -= skipped;
+
+        if ( daq.verdicts[DAQ_VERDICT_PASS] >= skipped )
+            daq.verdicts[DAQ_VERDICT_PASS] -= skipped;
+    }
+    pc = sum;
+    DAQ_SetStats(&daq);
+
+    LogMessage("Totals for %u pcap workers:\n", n);
+    DropStats(2);
+}
+
+static void PcapWorkers_Finish (
+    const SnortConfig* sc, const pid_t* pids, unsigned n, int by_flow)
+{
+    unsigned i, failed = 0;
+
+    for ( i = 0; i < n; i++ )
+    {
+        int status = 0;
+        pid_t ret;
+
+        do
+            ret = waitpid(pids[i], &status, 0);
+        while ( ret < 0 && errno == EINTR );
+
+        if ( ret < 0 || !WIFEXITED(status) || WEXITSTATUS(status) ||
+            !s_stats[i].reported )
+        {
+            char dir[PATH_MAX];
+            PcapWorkers_Dir(sc, i, dir, sizeof(dir));
+            ErrorMessage("pcap worker %u failed; see %s/%s\n", i, dir, WORKER_LOG);
+            failed++;
+        }
+    }
+    PcapWorkers_Merge(sc, n);
+    PcapWorkers_Totals(n, by_flow);
+
+    LogMessage("Snort exiting\n");
+    exit(failed ? 1 : 0);
+}
+
+unsigned PcapWorkers_Start (
+    SnortConfig* sc, unsigned workers, unsigned num_pcaps,
+    unsigned* first, unsigned* count)
+{
+    pid_t pids[MAX_PCAP_WORKERS];
+    int by_flow = (num_pcaps < workers);
+    unsigned i;
+
+    s_stats = (PcapWorkerStats*)mmap(
+        NULL, workers * sizeof(*s_stats), PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+    if ( s_stats == MAP_FAILED )
+        FatalError("Can't map pcap worker stats: %s\n", strerror(errno));
+
+    LogMessage("Starting %u pcap workers, %s\n", workers,
+        by_flow ? "sharing flows" : "sharing pcaps");
+
+    // don't let the workers inherit buffered output
+    fflush(stdout);
+    fflush(stderr);
+
+    for ( i = 0; i < workers; i++ )
+    {
+        char dir[PATH_MAX];
+        PcapWorkers_Dir(sc, i, dir, sizeof(dir));
+
+        if ( mkdir(dir, 0700) && errno != EEXIST )
+            FatalError("Can't create %s: %s\n", dir, strerror(errno));
+
+        pids[i] = fork();
+
+        if ( pids[i] < 0 )
+        {
+            while ( i-- > 0 )
+                kill(pids[i], SIGTERM);
+
+            FatalError("Can't fork pcap worker: %s\n", strerror(errno));
+        }
+        if ( !pids[i] )
+        {
+            PcapWorkers_Init(sc, i, dir);
+
+            if ( by_flow )
+            {
+                pcap_worker_flows = workers;
+                *first = 0;
+                *count = num_pcaps;
+            }
+            else
+            {
+                *first = i * num_pcaps / workers;
+                *count = (i + 1) * num_pcaps / workers - *first;
+            }
+            return i;
+        }
+    }
+    PcapWorkers_Finish(sc, pids, workers, by_flow);
+    return 0;  // not reached
+}
+
+#endif // WIN32
+
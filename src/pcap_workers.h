@@ -0,0 +1,74 @@
+/****************************************************************************
+ *
+ * Copyright (C) 2013 Sourcefire, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 2 as
+ * published by the Free Software Foundation.  You may not use, modify or
+ * distribute this program under any other version of the GNU General
+ * Public License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ ****************************************************************************/
+
+// @file    pcap_workers.h
+
+// Offline analysis with --pcap-workers <n>.  Snort forks n worker
+// processes once the pcap list is known; each finishes initialization on
+// its own and so has completely independent state.
+//
+// With at least n pcaps the list is split into n contiguous shards.  With
+// fewer, every worker reads every pcap and analyzes only the packets whose
+// address pair hashes to it, so both directions of a flow and all of its
+// fragments stay together.
+//
+// Worker i logs to <log dir>/worker.<i>, including its console output in
+// snort.log.  When all workers are done the parent appends their output
+// files, in worker order, to the files of the same name (less any time
+// stamp suffix) in the log directory and prints the summed packet counts.
+
+#ifndef __PCAP_WORKERS_H__
+#define __PCAP_WORKERS_H__
+
+#ifndef WIN32
+
+#include "sfdaq.h"
+#include "snort.h"
+
+#define MAX_PCAP_WORKERS 256
+
+// fork the workers.  returns the index of this worker and the number of
+// pcaps it should read (*count) starting at the *first one in the list.
+// the parent does not return.
+unsigned PcapWorkers_Start(
+    SnortConfig*, unsigned workers, unsigned num_pcaps,
+    unsigned* first, unsigned* count);
+
+// called by each worker as it prints its statistics
+void PcapWorkers_Report(const PacketCount*, const DAQ_Stats_t*);
+
+int PcapWorkers_Check(const DAQ_PktHdr_t*, const uint8_t*);
+
+extern unsigned pcap_worker_flows;
+
+// returns 1 if the packet belongs to another worker
+static inline int PcapWorkers_Skip (const DAQ_PktHdr_t* pkth, const uint8_t* pkt)
+{
+    if ( !pcap_worker_flows )
+        return 0;
+
+    return PcapWorkers_Check(pkth, pkt);
+}
+
+#endif // WIN32
+
+#endif // __PCAP_WORKERS_H__
+
@@ -97,6 +97,13 @@ typedef int (*LOOKUP_FCN)(HI_SESSION *, const u_char *, const u_char *, const u_
 **  (like whitespace and the HTTP delimiter \r and \n).
 */
 LOOKUP_FCN lookup_table[256];
+
+/*
+**  Nonzero for the characters that have a lookup_table function, so that
+**  runs of ordinary characters can be skipped with a byte compare.
+*/
+static u_char lookup_special[256];
+
 int NextNonWhiteSpace(HI_SESSION *Session, const u_char *start,
         const u_char *end, const u_char **ptr, URI_PTR *uri_ptr);
 extern const u_char *extract_http_transfer_encoding(HI_SESSION *, HttpSessionData *,
@@ -1612,6 +1619,22 @@ static inline int hi_client_extract_uri(
 
     while(hi_util_in_bounds(start, end, ptr))
     {
+        /*
+        **  Most of a URI is ordinary characters that need nothing done,
+        **  so skip ahead to the next one that has a function or is
+        **  whitespace.  Non-ASCII characters always have a function.
+        */
+        if(!lookup_special[*ptr] && !ServerConf->whitespace[*ptr])
+        {
+            do
+            {
+                ptr++;
+            } while((ptr < end) && !lookup_special[*ptr] && !ServerConf->whitespace[*ptr]);
+
+            if(ptr == end)
+                break;
+        }
+
         if(!ServerConf->extended_ascii_uri)
         {
             /* isascii returns non-zero if it is ascii */
@@ -2533,6 +2556,9 @@ static inline const u_char *hi_client_extract_header(
         }
         if ( *p == '\n') continue;
         p++;
+
+        /* nothing else in the field matters here; go to the next line */
+        SkipToLF(start, end, &p);
     }
 
     /* Never observed an end-of-field.  Maybe it's not there, but the header is long anyway: */
@@ -3115,6 +3141,11 @@ int hi_client_init(HTTPINSPECT_GLOBAL_CONF *GlobalConf)
 
     }
 
+    for(iCtr = 0; iCtr <= 0xff; iCtr++)
+    {
+        lookup_special[iCtr] = (lookup_table[iCtr] != NULL);
+    }
+
     return HI_SUCCESS;
 }
 
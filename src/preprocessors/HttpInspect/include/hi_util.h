@@ -101,6 +101,19 @@ static inline void SkipBlankAndNewLine(const u_char *start, const u_char *end,
             ( **ptr == ' ' || **ptr == '\t') && (**ptr != '\n')  ) {(*ptr)++;}
 }
 
+/* Advances to the next LF, or to end if there isn't one */
+static inline void SkipToLF(const u_char *start, const u_char *end,
+                const u_char **ptr)
+{
+    const u_char *lf;
+
+    if(!hi_util_in_bounds(start, end, *ptr))
+        return;
+
+    lf = (const u_char *)memchr(*ptr, '\n', end - *ptr);
+    *ptr = lf ? lf : end;
+}
+
 static inline void SkipCRLF(const u_char *start, const u_char *end,
                 const u_char **ptr)
 {
@@ -742,6 +742,9 @@ static inline const u_char *hi_server_extract_header(
         }
         if ( *p == '\n') continue;
         p++;
+
+        /* nothing else in the field matters here; go to the next line */
+        SkipToLF(start, end, &p);
     }
 
     header_ptr->header.uri_end = p;
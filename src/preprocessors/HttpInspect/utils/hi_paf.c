@@ -205,8 +205,20 @@ typedef struct {
 
 typedef struct {
     Cell cell[256];
+    uint8_t run;        // RUN_* below
+    uint8_t stop[256];  // bytes that end a run
 } State;
 
+// most bytes of a request uri, status message, or header value just
+// loop back to the same state with no action.  these run states are
+// marked when the fsm is compiled so that hi_paf() can jump to the
+// next byte that matters instead of scanning the run byte-by-byte.
+#define RUN_NONE 0  // no run
+#define RUN_EOL  1  // only \n ends the run (use memchr)
+#define RUN_ANY  2  // a few bytes end the run (use stop[])
+
+#define MAX_RUN_STOP 4
+
 static State* hi_fsm = NULL;
 static unsigned hi_fsm_size = 0;
 
@@ -533,6 +545,44 @@ static void hi_link_check (void)
     }
 }
 
+static void hi_run_mark (void)
+{
+    unsigned i, c;
+
+    for ( i = 0; i < hi_fsm_size; i++ )
+    {
+        State* m = hi_fsm + i;
+        unsigned nstop = 0;
+
+        m->run = RUN_NONE;
+
+        // abort states must see the next byte
+        if ( i == RSP_ABORT_STATE || i == REQ_ABORT_STATE )
+            continue;
+
+        for ( c = 0; c < 256; c++ )
+        {
+            // \n is handled by hi_scan_msg() and \r is ignored there
+            if ( c == '\r' )
+                m->stop[c] = 0;
+
+            else if ( c == '\n' )
+                m->stop[c] = 1;
+
+            else
+                m->stop[c] =
+                    (m->cell[c].next != i || m->cell[c].action != ACT_NOP);
+
+            nstop += m->stop[c];
+        }
+        if ( nstop == 1 )
+            m->run = RUN_EOL;
+
+        else if ( nstop <= MAX_RUN_STOP )
+            m->run = RUN_ANY;
+    }
+}
+
 static bool hi_fsm_compile (void)
 {
     unsigned i = 0, j;
@@ -583,6 +633,7 @@ static bool hi_fsm_compile (void)
     }
     hi_link_check();
     assert(max + extra == next);
+    hi_run_mark();
     return true;
 }
 
@@ -970,6 +1021,42 @@ static inline PAF_Status hi_scan_msg (
 // utility
 //--------------------------------------------------------------------
 
+// returns the offset of the next byte at or after n that hi_scan_msg()
+// must see, or len if there is none.  the bytes skipped are exactly
+// those that would leave the state unchanged without any action.
+static inline uint32_t hi_skip (
+    Hi5State* s, const uint8_t* data, uint32_t n, uint32_t len)
+{
+    const uint8_t* lf;
+    const State* m;
+
+    switch ( s->msg )
+    {
+    case 0:
+        m = hi_fsm + s->fsm;
+
+        if ( m->run == RUN_ANY )
+        {
+            while ( n < len && !m->stop[data[n]] )
+                n++;
+
+            return n;
+        }
+        if ( m->run == RUN_NONE )
+            return n;
+        break;
+
+    case 4:
+        // trailer line
+        break;
+
+    default:
+        return n;
+    }
+    lf = memchr(data+n, '\n', len-n);
+    return lf ? (uint32_t)(lf - data) : len;
+}
+
 static void hi_reset (Hi5State* s, uint32_t flags)
 {
     s->len = s->msg = 0;
@@ -1031,17 +1118,12 @@ static PAF_Status hi_paf (
 
     while ( n < len )
     {
-        // jump ahead to next linefeed when possible
-        if ( (hip->msg == 0) && (hip->fsm == MSG_EOL_STATE) )
-        {
-            uint8_t* lf = memchr(data+n, '\n', len-n);
-            if ( !lf )
-            {
-                n = len;
-                break;
-            }
-            n += (lf - (data + n));
-        }
+        // jump ahead to next byte that matters when possible
+        n = hi_skip(hip, data, n, len);
+
+        if ( n == len )
+            break;
+
         paf = hi_scan_msg(hip, data[n++], fp, ssn);
 
         if ( paf != PAF_SEARCH )
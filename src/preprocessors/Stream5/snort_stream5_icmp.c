@@ -354,6 +354,10 @@ static int ProcessIcmpUnreach(Packet *p)
     else
         skey.vlan_tag = 0;
 
+    /* The error travels like a reply, so it is in the tunnel of the
+     * reply direction of the original session */
+    skey.tunnelId = GetLWSessionTunnelId(p);
+
     switch (skey.protocol)
     {
     case IPPROTO_TCP:
@@ -52,6 +52,7 @@
 #include "bitop_funcs.h"
 #include "sp_flowbits.h"
 #include "packet_time.h"
+#include "bypass.h"
 
 #ifndef WIN32
 # include <sys/socket.h>
@@ -110,6 +111,7 @@ int GetLWSessionKeyFromIpPort(
                     uint16_t vlan,
                     uint32_t mplsId,
                     uint16_t addressSpaceId,
+                    uint32_t tunnelId,
                     SessionKey *key)
 {
     uint16_t sport;
@@ -304,9 +306,222 @@ int GetLWSessionKeyFromIpPort(
     key->addressSpaceId = 0;
 #endif
     key->addressSpaceIdPad1 = 0;
+    key->tunnelId = tunnelId;
     return 1;
 }
 
+/* Subscribers behind different GTP tunnels may have the same private
+ * address, so with enable_gtp_overlapping_ip the session key includes
+ * the tunnel.  A TEID is allocated by the receiving end of a tunnel, so
+ * the two directions of a bearer carry different TEIDs.  The tunnel id
+ * of a bearer is the TEID of the first direction seen; the TEID of the
+ * other direction is mapped to it when the first reply arrives.
+ *
+ * Packets of the first direction find their session without the map,
+ * but replies depend on it, so every session seeing replies holds the
+ * reply TEID's mapping and a held mapping is never recycled.  The maps
+ * are sized from the Stream5 session limits: a mapping for each
+ * direction of every session, and a pending reply for every session. */
+
+/* TEID of one direction of a bearer, and the end that allocated it */
+typedef struct _GTPTunnelKey
+{
+    uint32_t receiver[4];
+    uint32_t teid;
+} GTPTunnelKey;
+
+typedef struct _GTPTunnel
+{
+    uint32_t tunnel_id;
+    uint32_t sessions;      /* sessions holding this mapping */
+} GTPTunnel;
+
+/* A session whose reply direction hasn't been seen yet, and the end the
+ * reply will be sent to */
+typedef struct _GTPPendingKey
+{
+    SessionKey key;
+    uint32_t receiver[4];
+} GTPPendingKey;
+
+static SFXHASH *gtp_tunnel_map = NULL;
+static SFXHASH *gtp_pending_map = NULL;
+
+static inline void GTPCopyAddr(uint32_t *dst, const sfip_t *ip)
+{
+    if (IS_IP4(ip))
+    {
+        dst[0] = ip->ip32[0];
+        dst[1] = dst[2] = dst[3] = 0;
+    }
+    else
+    {
+        COPY4(dst, ip->ip32);
+    }
+}
+
+/* ANR callback: only recycle mappings no session holds */
+static int GTPTunnelInUse(void *key, void *data)
+{
+    return ((GTPTunnel *)data)->sessions != 0;
+}
+
+static void InitLWSessionTunnels(void)
+{
+    Stream5Config *config;
+    uint32_t max_sessions = 0;
+    int rows;
+
+    config = (Stream5Config *)sfPolicyUserDataGet(s5_config, getDefaultPolicy());
+
+    if (config && config->global_config)
+    {
+        max_sessions = config->global_config->max_tcp_sessions
+            + config->global_config->max_udp_sessions
+            + config->global_config->max_icmp_sessions
+            + config->global_config->max_ip_sessions;
+    }
+
+    if (max_sessions == 0)
+        max_sessions = 1;
+
+    rows = (max_sessions / 4) + 1;
+
+    gtp_tunnel_map = sfxhash_new(rows, sizeof(GTPTunnelKey),
+            sizeof(GTPTunnel), 0, 1, GTPTunnelInUse, NULL, 1);
+
+    gtp_pending_map = sfxhash_new(rows, sizeof(GTPPendingKey),
+            sizeof(GTPTunnelKey), 0, 1, NULL, NULL, 1);
+
+    if (!gtp_tunnel_map || !gtp_pending_map)
+        FatalError("Stream5: Failed to create the GTP tunnel tables.\n");
+
+    sfxhash_set_max_nodes(gtp_tunnel_map, 2 * max_sessions);
+    sfxhash_set_max_nodes(gtp_pending_map, max_sessions);
+}
+
+void FreeLWSessionTunnels(void)
+{
+    if (gtp_tunnel_map)
+    {
+        sfxhash_delete(gtp_tunnel_map);
+        gtp_tunnel_map = NULL;
+    }
+
+    if (gtp_pending_map)
+    {
+        sfxhash_delete(gtp_pending_map);
+        gtp_pending_map = NULL;
+    }
+}
+
+static inline bool GetLWSessionTunnelKey(const Packet *p, GTPTunnelKey *tkey)
+{
+    if (!ScGTPOverlappingIp() || !(p->proto_bits & PROTO_BIT__GTP)
+            || (p->outer_family == NO_IP))
+        return false;
+
+    if (!GetGTPTeid(p, &tkey->teid) || !tkey->teid)
+        return false;
+
+    GTPCopyAddr(tkey->receiver, GET_OUTER_DST_IP(p));
+
+    if (!gtp_tunnel_map)
+        InitLWSessionTunnels();
+
+    return true;
+}
+
+/* Returns the tunnel id for p without learning anything from it */
+uint32_t GetLWSessionTunnelId(const Packet *p)
+{
+    GTPTunnelKey tkey;
+    GTPTunnel *tunnel;
+
+    if (!GetLWSessionTunnelKey(p, &tkey))
+        return 0;
+
+    if ((tunnel = sfxhash_find(gtp_tunnel_map, &tkey)))
+        return tunnel->tunnel_id;
+
+    return tkey.teid;
+}
+
+/* Hold the mapping of a reply TEID for a session keyed on the tunnel id
+ * it maps to, so the mapping lives as long as the session does. */
+static void HoldLWSessionTunnel(Stream5LWSession *ssn, const Packet *p)
+{
+    GTPTunnelKey tkey;
+    GTPTunnel *tunnel;
+
+    if (ssn->gtp_tunnel || !ssn->key->tunnelId)
+        return;
+
+    if (!GetLWSessionTunnelKey(p, &tkey) || (tkey.teid == ssn->key->tunnelId))
+        return;
+
+    tunnel = sfxhash_find(gtp_tunnel_map, &tkey);
+
+    if (tunnel && (tunnel->tunnel_id == ssn->key->tunnelId))
+    {
+        tunnel->sessions++;
+        ssn->gtp_tunnel = tunnel;
+    }
+}
+
+static inline void ReleaseLWSessionTunnel(Stream5LWSession *ssn)
+{
+    if (ssn->gtp_tunnel)
+    {
+        ssn->gtp_tunnel->sessions--;
+        ssn->gtp_tunnel = NULL;
+    }
+}
+
+/* Returns the tunnel id for p, pairing its TEID with the one of the other
+ * direction if p is the first reply of a session.  key is the session key
+ * of p without the tunnel. */
+static uint32_t LearnLWSessionTunnelId(const Packet *p, const SessionKey *key)
+{
+    GTPTunnelKey tkey;
+    GTPTunnelKey *first;
+    GTPPendingKey pkey;
+    GTPTunnel *tunnel;
+
+    if (!GetLWSessionTunnelKey(p, &tkey))
+        return 0;
+
+    if ((tunnel = sfxhash_find(gtp_tunnel_map, &tkey)))
+        return tunnel->tunnel_id;
+
+    memset(&pkey, 0, sizeof(pkey));
+    pkey.key = *key;
+    COPY4(pkey.receiver, tkey.receiver);
+
+    if ((first = sfxhash_find(gtp_pending_map, &pkey)) && (first->teid != tkey.teid))
+    {
+        GTPTunnel new_tunnel;
+
+        new_tunnel.tunnel_id = first->teid;
+        new_tunnel.sessions = 0;
+
+        /* map both directions so neither is pending again */
+        sfxhash_add(gtp_tunnel_map, first, &new_tunnel);
+        sfxhash_add(gtp_tunnel_map, &tkey, &new_tunnel);
+        sfxhash_remove(gtp_pending_map, &pkey);
+
+        return new_tunnel.tunnel_id;
+    }
+
+    /* The reply to p will be sent back to p's sender */
+    GTPCopyAddr(pkey.receiver, GET_OUTER_SRC_IP(p));
+
+    if (!sfxhash_find(gtp_pending_map, &pkey))
+        sfxhash_add(gtp_pending_map, &pkey, &tkey);
+
+    return tkey.teid;
+}
+
 int GetLWSessionKey(Packet *p, SessionKey *key)
 {
     char proto = GET_IPH_PROTO(p);
@@ -331,9 +546,13 @@ int GetLWSessionKey(Packet *p, SessionKey *key)
         /* ICMP */
         sport = p->icmph->type;
     }
-    return GetLWSessionKeyFromIpPort(GET_SRC_IP(p), sport,
+    if (!GetLWSessionKeyFromIpPort(GET_SRC_IP(p), sport,
         GET_DST_IP(p), p->dp,
-        proto, vlanId, mplsId, addressSpaceId, key);
+        proto, vlanId, mplsId, addressSpaceId, 0, key))
+        return 0;
+
+    key->tunnelId = LearnLWSessionTunnelId(p, key);
+    return 1;
 }
 
 void GetLWPacketDirection(Packet *p, Stream5LWSession *ssn)
@@ -487,6 +706,8 @@ Stream5LWSession *GetLWSession(Stream5SessionCache *sessionCache, Packet *p, Ses
         {
             returned->last_data_seen = p->pkth->ts.tv_sec;
         }
+        if (returned && key->tunnelId)
+            HoldLWSessionTunnel(returned, p);
     }
     return returned;
 }
@@ -514,6 +735,19 @@ Stream5LWSession *GetLWSessionFromKey(Stream5SessionCache *sessionCache, const S
 void FreeLWApplicationData(Stream5LWSession *ssn)
 {
     Stream5AppData *tmpData, *appData = ssn->appDataList;
+    unsigned i;
+
+    for (i = 0; i < ssn->appDataSlots; i++)
+    {
+        if (ssn->appData[i].freeFunc && ssn->appData[i].dataPointer)
+        {
+            ssn->appData[i].freeFunc(ssn->appData[i].dataPointer);
+        }
+        ssn->appData[i].dataPointer = NULL;
+        ssn->appData[i].freeFunc = NULL;
+    }
+    ssn->appDataSlots = 0;
+
     while (appData)
     {
         if (appData->freeFunc && appData->dataPointer)
@@ -534,8 +768,10 @@ static int RemoveLWSession(Stream5SessionCache *sessionCache, Stream5LWSession *
     SFXHASH_NODE *hnode;
     Stream5Config *pPolicyConfig = NULL;
     tSfPolicyId policy_id = ssn->policy_id;
-    mempool_free(&s5FlowMempool, ssn->flowdata);
-    ssn->flowdata = NULL;
+    if (ssn->flowdata)
+        Stream5FreeFlowData(ssn);
+
+    ReleaseLWSessionTunnel(ssn);
 
     pPolicyConfig = (Stream5Config *)sfPolicyUserDataGet(ssn->config, policy_id);
 
@@ -598,6 +834,8 @@ int DeleteLWSession(Stream5SessionCache *sessionCache,
         Stream5HANotifyDeletion(ssn);
 #endif
 
+    Bypass_RemoveSession(ssn->key, IS_IP6(&client_ip));
+
     /*
      * Call callback to cleanup the protocol (TCP/UDP/ICMP)
      * specific session details
@@ -882,7 +1120,6 @@ Stream5LWSession *NewLWSession(Stream5SessionCache *sessionCache, Packet *p,
     Stream5LWSession *retSsn = NULL;
     Stream5Config *pLWSPolicyConfig;
     SFXHASH_NODE *hnode;
-    StreamFlowData *flowdata;
     time_t timestamp = p ? p->pkth->ts.tv_sec : packet_time();
 
     hnode = sfxhash_get_node(sessionCache->hashTable, key);
@@ -917,10 +1154,9 @@ Stream5LWSession *NewLWSession(Stream5SessionCache *sessionCache, Packet *p,
 
         retSsn->protocol = key->protocol;
         retSsn->last_data_seen = timestamp;
-        retSsn->flowdata = mempool_alloc(&s5FlowMempool);
-        flowdata = retSsn->flowdata->data;
-        boInitStaticBITOP(&(flowdata->boFlowbits), getFlowbitSizeInBytes(),
-                          flowdata->flowb);
+
+        if (p && key->tunnelId)
+            HoldLWSessionTunnel(retSsn, p);
 
         retSsn->policy = policy;
         retSsn->config = s5_config;
@@ -960,6 +1196,7 @@ uint32_t HashFunc(SFHASHFCN *p, unsigned char *d, int n)
 #ifdef HAVE_DAQ_ADDRESS_SPACE_ID
     uint32_t tmp2 = 0;
 #endif
+    uint32_t tmp3 = 0;
 
     a = *(uint32_t*)d;         /* IPv6 lo[0] */
     b = *(uint32_t*)(d+4);     /* IPv6 lo[1] */
@@ -995,6 +1232,12 @@ uint32_t HashFunc(SFHASHFCN *p, unsigned char *d, int n)
     tmp2 = *(uint32_t*)(d+offset); /* after offset that has been moved */
     c += tmp2; /* address space id and 16bits of zero'd pad */
 #endif
+    tmp3 = ((SessionKey *)d)->tunnelId;
+    if( tmp3 )
+    {
+        mix(a,b,c);
+        a += tmp3;  /* gtp tunnel */
+    }
     final(a,b,c);
 
     return c;
@@ -1113,6 +1356,9 @@ int HashKeyCmp(const void *s1, const void *s2, size_t n)
 #endif
 #endif /* SPARCV9 */
 
+    if (((const SessionKey *)s1)->tunnelId != ((const SessionKey *)s2)->tunnelId)
+        return 1;               /* Compares GTP tunnel */
+
     return 0;
 }
 
@@ -1296,4 +1542,56 @@ void checkLWSessionTimeout(uint32_t flowCount, time_t cur_time)
 
 }
 
+/* Packets answered from the bypass table never reach stream.  This is
+ * called for them (at most once a second, which is as fine as sessions
+ * track time) so that the session stays as fresh as its flow.  Returns
+ * 0 if the flow no longer has a session. */
+int refreshLWSession(snort_ip_p srcIP, uint16_t srcPort,
+        snort_ip_p dstIP, uint16_t dstPort, char proto,
+        uint16_t vlan, uint16_t addressSpaceId, time_t cur_time)
+{
+    Stream5SessionCache *cache;
+    Stream5LWSession *lwssn;
+    SFXHASH_NODE *hnode;
+    SessionKey key;
+
+    switch (proto)
+    {
+        case IPPROTO_TCP:
+            cache = tcp_lws_cache;
+            break;
+        case IPPROTO_UDP:
+            cache = udp_lws_cache;
+            break;
+        default:
+            return 0;
+    }
+
+    if (!cache)
+        return 0;
+
+    if (!GetLWSessionKeyFromIpPort(srcIP, srcPort, dstIP, dstPort, proto,
+            vlan, 0, addressSpaceId, 0, &key))
+        return 0;
+
+    /* Also moves the session to the front of the LRU list. */
+    hnode = sfxhash_find_node(cache->hashTable, &key);
+
+    if (!hnode || !hnode->data)
+        return 0;
+
+    lwssn = (Stream5LWSession *)hnode->data;
+
+    if (lwssn->last_data_seen < cur_time)
+    {
+        /* Push a protocol expiration out by the time the flow spent in
+         * the bypass table since the session last saw a packet. */
+        if (lwssn->expire_time)
+            lwssn->expire_time += (uint64_t)(cur_time - lwssn->last_data_seen) * TCP_HZ;
+
+        lwssn->last_data_seen = cur_time;
+    }
+    return 1;
+}
+
 
@@ -73,7 +73,10 @@ int GetLWSessionKeyFromIpPort(
                     uint16_t vlan,
                     uint32_t mplsId,
                     uint16_t addressSpaceId,
+                    uint32_t tunnelId,
                     SessionKey *key);
+uint32_t GetLWSessionTunnelId(const Packet *);
+void FreeLWSessionTunnels(void);
 Stream5LWSession *GetLWSessionFromKey(Stream5SessionCache *, const SessionKey *);
 Stream5LWSession *NewLWSession(Stream5SessionCache *, Packet *, const SessionKey *, void *);
 int DeleteLWSession(Stream5SessionCache *, Stream5LWSession *, char *reason);
@@ -353,29 +353,14 @@ typedef struct _StreamSegment
 
 } StreamSegment;
 
+// the fields used on every packet come first so that they share as few
+// cache lines as possible; history and statistics go at the end.
 typedef struct _StreamTracker
 {
     StateMgr  s_mgr;        /* state tracking goodies */
     FlushMgr  flush_mgr;    /* please flush twice, it's a long way to
                              * the bitbucket... */
 
-    // this is intended to be private to s5_paf but is included
-    // directly to avoid the need for allocation; do not directly
-    // manipulate within this module.
-    PAF_State paf_state;    // for tracking protocol aware flushing
-
-    Stream5AlertInfo alerts[MAX_SESSION_ALERTS]; /* history of alerts */
-
-    Stream5TcpPolicy *tcp_policy;
-    StreamSegment *seglist;       /* first queued segment */
-    StreamSegment *seglist_tail;  /* last queued segment */
-
-    // TBD move out of here since only used per packet?
-    StreamSegment* seglist_next;  /* next queued segment to flush */
-
-#ifdef DEBUG
-    int segment_ordinal;
-#endif
     /* Local in the context of these variables means the local part
      * of the connection.  For example, if this particular StreamTracker
      * was tracking the client side of a connection, the l_unackd value
@@ -393,39 +378,56 @@ typedef struct _StreamTracker
     uint32_t ts_last;      /* last timestamp (for PAWS) */
     uint32_t ts_last_pkt;  /* last packet timestamp we got */
 
+    uint16_t wscale;       /* window scale setting */
+    uint16_t mss;          /* max segment size */
+
+    uint16_t os_policy;
+    uint16_t reassembly_policy;
+
+    Stream5TcpPolicy *tcp_policy;
+    StreamSegment *seglist;       /* first queued segment */
+    StreamSegment *seglist_tail;  /* last queued segment */
+
+    // TBD move out of here since only used per packet?
+    StreamSegment* seglist_next;  /* next queued segment to flush */
+
     uint32_t seglist_base_seq;   /* seq of first queued segment */
     uint32_t seg_count;          /* number of current queued segments */
     uint32_t seg_bytes_total;    /* total bytes currently queued */
     uint32_t seg_bytes_logical;  /* logical bytes queued (total - overlaps) */
+    uint32_t flush_count;        /* number of flushed queued segments */
+    uint32_t small_seg_count;
+
+    uint8_t  flags;        /* bitmap flags (TF_xxx) */
+    uint8_t  alert_count;  /* number alerts stored (up to MAX_SESSION_ALERTS) */
+    uint8_t  mac_addr[6];  /* here only because it fits */
+
+    // this is intended to be private to s5_paf but is included
+    // directly to avoid the need for allocation; do not directly
+    // manipulate within this module.
+    PAF_State paf_state;    // for tracking protocol aware flushing
+
+    /* cold: life of session counts and history */
     uint32_t total_bytes_queued; /* total bytes queued (life of session) */
     uint32_t total_segs_queued;  /* number of segments queued (life) */
     uint32_t overlap_count;      /* overlaps encountered */
-    uint32_t small_seg_count;
-    uint32_t flush_count;        /* number of flushed queued segments */
     uint32_t xtradata_mask;      /* extra data available to log */
 
-    uint16_t os_policy;
-    uint16_t reassembly_policy;
-
-    uint16_t wscale;       /* window scale setting */
-    uint16_t mss;          /* max segment size */
-
-    uint8_t  mac_addr[6];
-    uint8_t  flags;        /* bitmap flags (TF_xxx) */
+#ifdef DEBUG
+    int segment_ordinal;
+#endif
 
-    uint8_t  alert_count;  /* number alerts stored (up to MAX_SESSION_ALERTS) */
+    Stream5AlertInfo alerts[MAX_SESSION_ALERTS]; /* history of alerts */
 
 } StreamTracker;
 
 typedef struct _TcpSession
 {
+    Stream5LWSession *lwssn;
     StreamTracker client;
     StreamTracker server;
-    Stream5LWSession *lwssn;
 
-#ifdef DEBUG
-    struct timeval ssn_time;
-#endif
+    uint8_t ecn;
 
 #ifdef HAVE_DAQ_ADDRESS_SPACE_ID
     int32_t ingress_index;  /* Index of the inbound interface. */
@@ -436,7 +438,9 @@ typedef struct _TcpSession
     uint16_t address_space_id;
 #endif
 
-    uint8_t ecn;
+#ifdef DEBUG
+    struct timeval ssn_time;
+#endif
 
 } TcpSession;
 
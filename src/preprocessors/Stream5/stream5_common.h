@@ -134,6 +134,17 @@
 /*  D A T A   S T R U C T U R E S  **********************************/
 typedef StreamSessionKey SessionKey;
 
+/* A session rarely carries application data for more than two or three
+ * protocols, so the first few are kept in slots inside the session and
+ * only the rest are allocated and linked on appDataList. */
+#define S5_APP_DATA_SLOTS 4
+
+typedef struct _Stream5AppSlot
+{
+    void        *dataPointer;
+    StreamAppDataFree freeFunc;
+} Stream5AppSlot;
+
 typedef struct _Stream5AppData
 {
     uint32_t   protocol;
@@ -157,47 +168,57 @@ typedef struct _Stream5HAState
 
 } Stream5HAState;
 
-// this struct is organized by member size for compactness
+// this struct is ordered by how often the members are used: lookup and
+// per packet state first, then the endpoints and application data, then
+// what is only needed for responses and HA.  within each group members
+// are organized by size for compactness.  the key is allocated in the
+// same hash node as the session.
 typedef struct _Stream5LWSession
 {
     SessionKey *key;
 
     MemBucket  *proto_specific_data;
-    Stream5AppData *appDataList;
-
-    MemBucket *flowdata; /* add flowbits */
-
-    void *policy;
 
     long       last_data_seen;
     uint64_t   expire_time;
 
-    tSfPolicyUserContextId config;
-    tSfPolicyId policy_id;
-
     Stream5HAState ha_state;
 
     uint16_t   session_state;
 
-    snort_ip    client_ip; // FIXTHIS family and bits should be changed to uint16_t
-    snort_ip    server_ip; // or uint8_t to reduce sizeof from 24 to 20
-
     uint16_t    client_port;
     uint16_t    server_port;
 
     uint8_t     protocol;
+    uint8_t     appDataSlots;   /* appData[] entries in use */
 
-#ifdef ACTIVE_RESPONSE
-    uint8_t     response_count;
-#endif
+    tSfPolicyId policy_id;
+    tSfPolicyUserContextId config;
+    void *policy;
+
+    MemBucket *flowdata; /* add flowbits */
+
+    snort_ip    client_ip;
+    snort_ip    server_ip;
+
+    Stream5AppSlot appData[S5_APP_DATA_SLOTS];
+    uint32_t   appDataProtocol[S5_APP_DATA_SLOTS];
+    Stream5AppData *appDataList;
+
+    struct _GTPTunnel *gtp_tunnel;  /* reply TEID mapping held for the session */
 
     uint8_t     inner_client_ttl, inner_server_ttl;
     uint8_t     outer_client_ttl, outer_server_ttl;
 
+#ifdef ACTIVE_RESPONSE
+    uint8_t     response_count;
+#endif
+
 #ifdef ENABLE_HA
-    struct timeval  ha_next_update;
     uint8_t         ha_pending_mask;
     uint8_t         ha_flags;
+    uint32_t        ha_sync_epoch;
+    struct timeval  ha_next_update;
 #endif
 
 } Stream5LWSession;
@@ -364,6 +385,8 @@ typedef struct _Stream5HAConfig
 {
     struct timeval min_session_lifetime;
     struct timeval min_sync_interval;
+    struct timeval max_batch_delay;
+    uint16_t max_batch_size;
     char *startup_input_file;
     char *runtime_output_file;
     char *shutdown_output_file;
@@ -481,17 +504,6 @@ int isPacketFilterDiscard(
         int ignore_any_rules
         );
 
-static inline void Stream5ResetFlowBits(Stream5LWSession *lwssn)
-{
-    StreamFlowData *flowdata;
-
-    if ((lwssn == NULL) || (lwssn->flowdata == NULL))
-        return;
-
-    flowdata = (StreamFlowData *)lwssn->flowdata->data;
-    boResetBITOP(&(flowdata->boFlowbits));
-}
-
 #ifdef ENABLE_HA
 static inline void Stream5SetHABit(Stream5LWSession *lwssn, unsigned int ha_func_idx)
 {
@@ -504,6 +516,17 @@ void checkLWSessionTimeout(
         time_t cur_time
         );
 
+int refreshLWSession(
+        snort_ip_p srcIP,
+        uint16_t srcPort,
+        snort_ip_p dstIP,
+        uint16_t dstPort,
+        char proto,
+        uint16_t vlan,
+        uint16_t addressSpaceId,
+        time_t cur_time
+        );
+
 // shared stream state
 extern Stream5Stats s5stats;
 extern uint32_t firstPacketTime;
@@ -518,4 +541,23 @@ extern Stream5IpConfig *s5_ip_eval_config;
 extern tSfPolicyUserContextId s5_config;
 extern tSfActionQueueId decoderActionQ;
 
+/* Hand the flowbits back to the pool, along with the bitmap if they
+ * were converted to one; they are allocated again on the next set. */
+static inline void Stream5FreeFlowData(Stream5LWSession *lwssn)
+{
+    StreamFlowData *flowdata = (StreamFlowData *)lwssn->flowdata->data;
+
+    boFreeBITOP(&(flowdata->boFlowbits));
+    mempool_free(&s5FlowMempool, lwssn->flowdata);
+    lwssn->flowdata = NULL;
+}
+
+static inline void Stream5ResetFlowBits(Stream5LWSession *lwssn)
+{
+    if ((lwssn == NULL) || (lwssn->flowdata == NULL))
+        return;
+
+    Stream5FreeFlowData(lwssn);
+}
+
 #endif /* STREAM5_COMMON_H_ */
@@ -38,6 +38,7 @@
 #include <unistd.h>
 #include <assert.h>
 
+#include "idle_processing_funcs.h"
 #include "mstring.h"
 #include "packet_time.h"
 #include "parser.h"
@@ -51,14 +52,29 @@
 /*
  * Stream5 HA messages will have the following format:
  *
- * <message>  ::= <header> <has-rec> <psd-rec>
+ * <message>  ::= <header> <has-rec> <psd-rec> | <resync>
  * <header>   ::= <event> version <message length> <key>
  * <event>    ::= HA_EVENT_UPDATE | HA_EVENT_DELETE
+ * <resync>   ::= HA_EVENT_RESYNC version <message length> HA_TYPE_KEY 0
  * <key>      ::= <ipv4-key> | <ipv6-key>
  * <ipv4-key> ::= HA_TYPE_KEY sizeof(ipv4-key) ipv4-key
  * <ipv6-key> ::= HA_TYPE_KEY sizeof(ipv6-key) ipv6-key
  * <has-rec>  ::= HA_TYPE_HAS sizeof(has-rec) has-rec | (null)
  * <psd-rec>  ::= HA_TYPE_PSD sizeof(psd-rec) psd-preprocid psd-subcode psd-rec <psd-rec> | (null)
+ *
+ * The <has-rec> is only sent when the lightweight session state has changed
+ * since the flow was last synchronized, and a <psd-rec> only for preprocessors
+ * with pending changes.
+ *
+ * A <resync> is sent over the side channel when Snort starts up.  The peer
+ * answers it with an update carrying the <has-rec> and every preprocessor's
+ * <psd-rec> for each active flow it has already synchronized, so a standby
+ * that (re)joins late still learns about existing sessions.
+ *
+ * When max_batch_size is configured, several <message>s are concatenated
+ * into a single side channel message (or a single runtime output file write):
+ *
+ * <batch>    ::= <message> <batch> | <message>
  */
 
 typedef struct _StreamHAFuncsNode
@@ -121,8 +137,29 @@ typedef struct
     uint32_t update_messages_sent_normally;
     uint32_t delete_messages_sent;
     uint32_t delete_messages_not_sent;
+    uint32_t session_records_suppressed;
+    uint32_t batched_messages;
+    uint32_t batches_sent;
+    uint32_t send_errors;
+    uint32_t resync_requests_sent;
+    uint32_t resync_requests_received;
+    uint32_t resync_updates_sent;
 } Stream5HAStats;
 
+typedef void (*HABatchFlushFunc)(const uint8_t *data, uint32_t length);
+
+typedef struct _HAMessageBatch
+{
+    uint8_t *buffer;
+    uint32_t size;                  // 0 if batching is disabled
+    uint32_t length;
+    uint32_t count;
+    struct timeval deadline;
+    HABatchFlushFunc flush;
+} HAMessageBatch;
+
+typedef uint32_t (*HAMessageGenerator)(uint8_t *msg, uint32_t msg_size, Stream5LWSession *lwssn);
+
 typedef struct _HADebugSessionConstraints
 {
     sfip_t sip;
@@ -133,12 +170,25 @@ typedef struct _HADebugSessionConstraints
 } HADebugSessionConstraints;
 
 #define MAX_STREAM_HA_FUNCS 8  // depends on sizeof(Stream5LWSession.ha_pending_mask)
-#define HA_MESSAGE_VERSION  0x81
+#define HA_MESSAGE_VERSION  0x82
 static StreamHAFuncsNode *stream_ha_funcs[MAX_STREAM_HA_FUNCS];
 static int n_stream_ha_funcs = 0;
 static int runtime_output_fd = -1;
 static uint8_t file_io_buffer[UINT16_MAX];
+static HAMessageBatch runtime_output_batch;
+#ifdef SIDE_CHANNEL
+static HAMessageBatch sc_batch;
+#endif
+static struct timeval max_batch_delay;
 static Stream5HAStats s5ha_stats;
+/* Bumped whenever an HA message may have been lost.  A flow's session record
+    is only left out of an update if the flow was last synchronized in the
+    current epoch; new sessions start out at 0. */
+static uint32_t ha_sync_epoch = 1;
+static ThrottleInfo ha_error_throttleInfo = {0,60,0};
+/* Set while answering a resync request, when every registered preprocessor
+    is asked for its data whether or not it has anything to report. */
+static bool ha_resyncing = false;
 
 /* Runtime debugging stuff. */
 #define HA_DEBUG_SESSION_ID_SIZE    (39+1+5+5+39+1+5+1+3+1) /* "<IPv6 address>:<port> <-> <IPv6 address>:<port> <ipproto>\0" */
@@ -514,6 +564,49 @@ static void Stream5ParseHAArgs(SnortConfig *sc, Stream5HAConfig *config, char *a
             }
             config->min_sync_interval.tv_usec = value * 1000;
         }
+        else if (!strcmp(stoks[0], "max_batch_size"))
+        {
+            if (stoks[1])
+                value = strtoul(stoks[1], &endPtr, 10);
+            else
+                value = 0;
+
+            if (!stoks[1] || (endPtr == &stoks[1][0]))
+            {
+                FatalError("%s(%d) => Invalid '%s' in config file. Requires integer parameter.\n",
+                           file_name, file_line, stoks[0]);
+            }
+
+            if (value > UINT16_MAX)
+            {
+                FatalError("%s(%d) => '%s %lu' invalid: value must be between 0 and %d bytes.\n",
+                           file_name, file_line, stoks[0], value, UINT16_MAX);
+            }
+
+            config->max_batch_size = (uint16_t) value;
+        }
+        else if (!strcmp(stoks[0], "max_batch_delay"))
+        {
+            if (stoks[1])
+                value = strtoul(stoks[1], &endPtr, 10);
+            else
+                value = 0;
+
+            if (!stoks[1] || (endPtr == &stoks[1][0]))
+            {
+                FatalError("%s(%d) => Invalid '%s' in config file. Requires integer parameter.\n",
+                           file_name, file_line, stoks[0]);
+            }
+
+            if (value > UINT16_MAX)
+            {
+                FatalError("%s(%d) => '%s %lu' invalid: value must be between 0 and %d milliseconds.\n",
+                           file_name, file_line, stoks[0], value, UINT16_MAX);
+            }
+
+            config->max_batch_delay.tv_sec = value / 1000;
+            config->max_batch_delay.tv_usec = (value % 1000) * 1000;
+        }
         else if (!strcmp(stoks[0], "startup_input_file"))
         {
             if (!stoks[1])
@@ -600,6 +693,12 @@ static void Stream5PrintHAConfig(Stream5HAConfig *config)
                 config->min_session_lifetime.tv_sec * 1000 + config->min_session_lifetime.tv_usec / 1000);
     LogMessage("    Minimum Sync Interval: %lu milliseconds\n",
                 config->min_sync_interval.tv_sec * 1000 + config->min_sync_interval.tv_usec / 1000);
+    if (config->max_batch_size)
+    {
+        LogMessage("    Maximum Batch Size:    %hu bytes\n", config->max_batch_size);
+        LogMessage("    Maximum Batch Delay:   %lu milliseconds\n",
+                    config->max_batch_delay.tv_sec * 1000 + config->max_batch_delay.tv_usec / 1000);
+    }
     if (config->startup_input_file)
         LogMessage("    Startup Input File:    %s\n", config->startup_input_file);
     if (config->runtime_output_file)
@@ -624,6 +723,13 @@ void Stream5PrintHAStats(void)
     LogMessage("     Updates Sent Normally: %u\n", s5ha_stats.update_messages_sent_normally);
     LogMessage("            Deletions Sent: %u\n", s5ha_stats.delete_messages_sent);
     LogMessage("        Deletions Not Sent: %u\n", s5ha_stats.delete_messages_not_sent);
+    LogMessage("  Session Records Skipped: %u\n", s5ha_stats.session_records_suppressed);
+    LogMessage("          Messages Batched: %u\n", s5ha_stats.batched_messages);
+    LogMessage("              Batches Sent: %u\n", s5ha_stats.batches_sent);
+    LogMessage("               Send Errors: %u\n", s5ha_stats.send_errors);
+    LogMessage("      Resync Requests Sent: %u\n", s5ha_stats.resync_requests_sent);
+    LogMessage("  Resync Requests Received: %u\n", s5ha_stats.resync_requests_received);
+    LogMessage("       Resync Updates Sent: %u\n", s5ha_stats.resync_updates_sent);
     for (i = 0; i < n_stream_ha_funcs; i++)
     {
         node = stream_ha_funcs[i];
@@ -686,6 +792,8 @@ void Stream5HAInit(struct _SnortConfig *sc, char *args)
     {
         pCurrentPolicyConfig->ha_config->min_session_lifetime = pDefaultPolicyConfig->ha_config->min_session_lifetime;
         pCurrentPolicyConfig->ha_config->min_sync_interval = pDefaultPolicyConfig->ha_config->min_sync_interval;
+        pCurrentPolicyConfig->ha_config->max_batch_size = pDefaultPolicyConfig->ha_config->max_batch_size;
+        pCurrentPolicyConfig->ha_config->max_batch_delay = pDefaultPolicyConfig->ha_config->max_batch_delay;
     }
 
 #ifdef PERF_PROFILING
@@ -887,6 +995,12 @@ static int ConsumeHAMessage(const uint8_t *msg, uint32_t msglen)
         goto consume_exit;
     }
 
+    if (msg_hdr->version != HA_MESSAGE_VERSION)
+    {
+        ErrorMessage("Stream5 HA message has unsupported version: 0x%02hhx!\n", msg_hdr->version);
+        goto consume_exit;
+    }
+
     if (msg_hdr->event != HA_EVENT_UPDATE && msg_hdr->event != HA_EVENT_DELETE)
     {
         ErrorMessage("Stream5 HA message has unknown event type: %hhu!\n", msg_hdr->event);
@@ -1203,6 +1317,7 @@ static uint32_t WriteHASession(Stream5LWSession *lwssn, uint8_t *msg)
     has = (Stream5HASession *) (msg + offset);
     offset += sizeof(*has);
     has->ha_state = lwssn->ha_state;
+    has->flags = 0;
 
     if (!IsClientLower(&lwssn->client_ip, lwssn->client_port, &lwssn->server_ip, lwssn->server_port, lwssn->key->protocol))
         has->flags |= HA_SESSION_FLAG_LOW;
@@ -1229,12 +1344,33 @@ static uint32_t WritePreprocDataRecord(Stream5LWSession *lwssn, StreamHAFuncsNod
     psd_hdr->subcode = node->subcode;
 
     rec_hdr->length = node->produce(lwssn, msg + offset);
+    if (!rec_hdr->length && ha_resyncing)
+        return 0;
     offset += rec_hdr->length;
     node->produced++;
 
     return offset;
 }
 
+/* The session record goes out with every update unless the standby is known
+    to have the flow: it was synchronized in the current epoch and the
+    lightweight session state has not changed since.  Stream5ProcessHA() folds
+    the epoch check into HA_FLAG_MODIFIED so the answer can't change between
+    sizing and generating a message. */
+static inline bool HASessionRecordNeeded(const Stream5LWSession *lwssn)
+{
+    return (lwssn->ha_flags & (HA_FLAG_NEW | HA_FLAG_MODIFIED)) != 0;
+}
+
+static void HAMessageLost(const char *where, int err)
+{
+    s5ha_stats.send_errors++;
+    if (++ha_sync_epoch == 0)
+        ha_sync_epoch = 1;
+    ErrorMessageThrottled(&ha_error_throttleInfo, "Stream5 HA message could not be %s: %s (%d)\n",
+            where, strerror(err), err);
+}
+
 static uint32_t CalculateHAMessageSize(uint8_t event, Stream5LWSession *lwssn)
 {
     StreamHAFuncsNode *node;
@@ -1254,7 +1390,7 @@ static uint32_t CalculateHAMessageSize(uint8_t event, Stream5LWSession *lwssn)
     if (event == HA_EVENT_UPDATE)
     {
         /* HA Session record */
-        //if (lwssn->ha_flags & HA_FLAG_MODIFIED)
+        if (HASessionRecordNeeded(lwssn))
             msg_size += sizeof(RecordHeader) + sizeof(Stream5HASession);
 
         /* Preprocessor data records */
@@ -1273,6 +1409,105 @@ static uint32_t CalculateHAMessageSize(uint8_t event, Stream5LWSession *lwssn)
     return msg_size;
 }
 
+/*
+ * Message batching
+ */
+static void FlushHAMessageBatch(HAMessageBatch *batch)
+{
+    if (!batch->count)
+        return;
+
+    batch->flush(batch->buffer, batch->length);
+    batch->length = 0;
+    batch->count = 0;
+    s5ha_stats.batches_sent++;
+}
+
+static inline bool HAMessageBatchExpired(const HAMessageBatch *batch, const struct timeval *now)
+{
+    return batch->count && !timercmp(now, &batch->deadline, <);
+}
+
+/* Returns where a message of up to msg_size bytes should be generated in
+    the batch, or NULL if it has to be sent on its own. */
+static uint8_t *ReserveHAMessageBatch(HAMessageBatch *batch, uint32_t msg_size)
+{
+    struct timeval now;
+
+    /* Keep the messages in order if this one has to go out on its own. */
+    if (msg_size > batch->size)
+    {
+        FlushHAMessageBatch(batch);
+        return NULL;
+    }
+
+    if (batch->length + msg_size > batch->size)
+        FlushHAMessageBatch(batch);
+
+    if (!batch->count)
+    {
+        packet_gettimeofday(&now);
+        timeradd(&now, &max_batch_delay, &batch->deadline);
+    }
+
+    return batch->buffer + batch->length;
+}
+
+static inline void CommitHAMessageBatch(HAMessageBatch *batch, uint32_t msglen)
+{
+    batch->length += msglen;
+    batch->count++;
+    s5ha_stats.batched_messages++;
+}
+
+static void FlushHAMessageBatches(void)
+{
+    FlushHAMessageBatch(&runtime_output_batch);
+#ifdef SIDE_CHANNEL
+    FlushHAMessageBatch(&sc_batch);
+#endif
+}
+
+static void CheckHAMessageBatches(void)
+{
+    struct timeval now;
+
+    if (!runtime_output_batch.count
+#ifdef SIDE_CHANNEL
+        && !sc_batch.count
+#endif
+       )
+        return;
+
+    packet_gettimeofday(&now);
+    if (HAMessageBatchExpired(&runtime_output_batch, &now))
+        FlushHAMessageBatch(&runtime_output_batch);
+#ifdef SIDE_CHANNEL
+    if (HAMessageBatchExpired(&sc_batch, &now))
+        FlushHAMessageBatch(&sc_batch);
+#endif
+}
+
+static void WriteHABatchToFile(const uint8_t *data, uint32_t length)
+{
+    if (Write(runtime_output_fd, data, length) == -1)
+        HAMessageLost("written to the runtime output file", errno);
+}
+
+static void WriteHAMessageToFile(Stream5LWSession *lwssn, uint32_t msg_size, HAMessageGenerator generate)
+{
+    uint8_t *msg;
+
+    if ((msg = ReserveHAMessageBatch(&runtime_output_batch, msg_size)) != NULL)
+    {
+        CommitHAMessageBatch(&runtime_output_batch, generate(msg, msg_size, lwssn));
+        return;
+    }
+
+    msg_size = generate(file_io_buffer, msg_size, lwssn);
+    WriteHABatchToFile(file_io_buffer, msg_size);
+}
+
 static uint32_t GenerateHADeletionMessage(uint8_t *msg, uint32_t msg_size, Stream5LWSession *lwssn)
 {
     uint32_t msglen;
@@ -1288,28 +1523,85 @@ static uint32_t GenerateHADeletionMessage(uint8_t *msg, uint32_t msg_size, Strea
 }
 
 #ifdef SIDE_CHANNEL
-static void SendSCDeletionMessage(Stream5LWSession *lwssn, uint32_t msg_size)
+static void SendSCBatch(const uint8_t *data, uint32_t length)
 {
     SCMsgHdr *sc_hdr;
     void *msg_handle;
     uint8_t *msg;
     int rval;
 
+    /* Allocate space for the message. */
+    if ((rval = SideChannelPreallocMessageTX(length, &sc_hdr, &msg, &msg_handle)) != 0)
+    {
+        HAMessageLost("queued to the side channel", rval);
+        return;
+    }
+
+    memcpy(msg, data, length);
+
+    /* Send the message. */
+    sc_hdr->type = SC_MSG_TYPE_FLOW_STATE_TRACKING;
+    sc_hdr->timestamp = packet_time();
+    SideChannelEnqueueMessageTX(sc_hdr, msg, length, msg_handle, NULL);
+}
+
+static void SendSCMessage(Stream5LWSession *lwssn, uint32_t msg_size, HAMessageGenerator generate)
+{
+    SCMsgHdr *sc_hdr;
+    void *msg_handle;
+    uint8_t *msg;
+    int rval;
+
+    if ((msg = ReserveHAMessageBatch(&sc_batch, msg_size)) != NULL)
+    {
+        CommitHAMessageBatch(&sc_batch, generate(msg, msg_size, lwssn));
+        return;
+    }
+
     /* Allocate space for the message. */
     if ((rval = SideChannelPreallocMessageTX(msg_size, &sc_hdr, &msg, &msg_handle)) != 0)
     {
-        /* TODO: Error stuff goes here. */
+        HAMessageLost("queued to the side channel", rval);
         return;
     }
 
     /* Generate the message. */
-    msg_size = GenerateHADeletionMessage(msg, msg_size, lwssn);
+    msg_size = generate(msg, msg_size, lwssn);
 
     /* Send the message. */
     sc_hdr->type = SC_MSG_TYPE_FLOW_STATE_TRACKING;
     sc_hdr->timestamp = packet_time();
     SideChannelEnqueueMessageTX(sc_hdr, msg, msg_size, msg_handle, NULL);
 }
+
+static void SendHAResyncRequest(void)
+{
+    SCMsgHdr *sc_hdr;
+    MsgHeader *msg_hdr;
+    void *msg_handle;
+    uint8_t *msg;
+    int rval;
+
+    if ((rval = SideChannelPreallocMessageTX(sizeof(*msg_hdr), &sc_hdr, &msg, &msg_handle)) != 0)
+    {
+        ErrorMessage("Stream5 HA resync request could not be queued to the side channel: %s (%d)\n",
+                strerror(rval), rval);
+        return;
+    }
+
+    msg_hdr = (MsgHeader *) msg;
+    msg_hdr->event = HA_EVENT_RESYNC;
+    msg_hdr->version = HA_MESSAGE_VERSION;
+    msg_hdr->total_length = sizeof(*msg_hdr);
+    msg_hdr->key_type = HA_TYPE_KEY;
+    msg_hdr->key_size = 0;
+
+    sc_hdr->type = SC_MSG_TYPE_FLOW_STATE_TRACKING;
+    sc_hdr->timestamp = packet_time();
+    SideChannelEnqueueMessageTX(sc_hdr, msg, sizeof(*msg_hdr), msg_handle, NULL);
+
+    s5ha_stats.resync_requests_sent++;
+}
 #endif
 
 void Stream5HANotifyDeletion(Stream5LWSession *lwssn)
@@ -1351,18 +1643,12 @@ void Stream5HANotifyDeletion(Stream5LWSession *lwssn)
     msg_size = CalculateHAMessageSize(HA_EVENT_DELETE, lwssn);
 
     if (runtime_output_fd >= 0)
-    {
-        msg_size = GenerateHADeletionMessage(file_io_buffer, msg_size, lwssn);
-        if (Write(runtime_output_fd, file_io_buffer, msg_size) == -1)
-        {
-            /* TODO: Error stuff here. */
-        }
-    }
+        WriteHAMessageToFile(lwssn, msg_size, GenerateHADeletionMessage);
 
 #ifdef SIDE_CHANNEL
     if (pLWSPolicyConfig->ha_config->use_side_channel)
     {
-        SendSCDeletionMessage(lwssn, msg_size);
+        SendSCMessage(lwssn, msg_size, GenerateHADeletionMessage);
     }
 #endif
 
@@ -1383,7 +1669,8 @@ static uint32_t GenerateHAUpdateMessage(uint8_t *msg, uint32_t msg_size, Stream5
     PREPROC_PROFILE_START(s5HAProducePerfStats);
 
     offset = WriteHAMessageHeader(HA_EVENT_UPDATE, msg_size, lwssn->key, msg);
-    offset += WriteHASession(lwssn, msg + offset);
+    if (HASessionRecordNeeded(lwssn))
+        offset += WriteHASession(lwssn, msg + offset);
     for (idx = 0; idx < n_stream_ha_funcs; idx++)
     {
         if (lwssn->ha_pending_mask & (1 << idx))
@@ -1402,42 +1689,20 @@ static uint32_t GenerateHAUpdateMessage(uint8_t *msg, uint32_t msg_size, Stream5
     return offset;
 }
 
-#ifdef SIDE_CHANNEL
-static void SendSCUpdateMessage(Stream5LWSession *lwssn, uint32_t msg_size)
-{
-    SCMsgHdr *schdr;
-    void *msg_handle;
-    uint8_t *msg;
-    int rval;
-
-    /* Allocate space for the message. */
-    if ((rval = SideChannelPreallocMessageTX(msg_size, &schdr, &msg, &msg_handle)) != 0)
-    {
-        /* TODO: Error stuff goes here. */
-        return;
-    }
-
-    /* Gnerate the message. */
-    msg_size = GenerateHAUpdateMessage(msg, msg_size, lwssn);
-
-    /* Send the message. */
-    schdr->type = SC_MSG_TYPE_FLOW_STATE_TRACKING;
-    schdr->timestamp = packet_time();
-    SideChannelEnqueueMessageTX(schdr, msg, msg_size, msg_handle, NULL);
-}
-#endif
-
 void Stream5ProcessHA(void *ssnptr)
 {
     struct timeval pkt_time;
     Stream5LWSession *lwssn = (Stream5LWSession*) ssnptr;
     Stream5Config *pLWSPolicyConfig;
     uint32_t msg_size;
+    uint32_t epoch;
     bool debug_flag;
     PROFILE_VARS;
 
     PREPROC_PROFILE_START(s5HAPerfStats);
 
+    CheckHAMessageBatches();
+
     if (!lwssn || (!lwssn->ha_pending_mask && !(lwssn->ha_flags & HA_FLAG_MODIFIED)))
     {
         PREPROC_PROFILE_END(s5HAPerfStats);
@@ -1488,33 +1753,49 @@ void Stream5ProcessHA(void *ssnptr)
                     lwssn->ha_state.application_protocol, lwssn->ha_state.direction, lwssn->ha_state.ignore_direction,
                     lwssn->ha_pending_mask, lwssn->ha_flags);
 
+    /* Resend the session record if the standby might not have the flow. */
+    epoch = ha_sync_epoch;
+    if (lwssn->ha_sync_epoch != epoch)
+        lwssn->ha_flags |= HA_FLAG_MODIFIED;
+    else if (!HASessionRecordNeeded(lwssn))
+        s5ha_stats.session_records_suppressed++;
+
     /* Calculate the size of the update message. */
     msg_size = CalculateHAMessageSize(HA_EVENT_UPDATE, lwssn);
 
     if (runtime_output_fd >= 0)
-    {
-        msg_size = GenerateHAUpdateMessage(file_io_buffer, msg_size, lwssn);
-        if (Write(runtime_output_fd, file_io_buffer, msg_size) == -1)
-        {
-            /* TODO: Error stuff here. */
-        }
-    }
+        WriteHAMessageToFile(lwssn, msg_size, GenerateHAUpdateMessage);
 
 #ifdef SIDE_CHANNEL
     if (pLWSPolicyConfig->ha_config->use_side_channel)
     {
-        SendSCUpdateMessage(lwssn, msg_size);
+        SendSCMessage(lwssn, msg_size, GenerateHAUpdateMessage);
     }
 #endif
 
-    /* Calculate the next update threshold. */
-    lwssn->ha_next_update.tv_usec += pLWSPolicyConfig->ha_config->min_session_lifetime.tv_usec;
-    if (lwssn->ha_next_update.tv_usec > 1000000)
+    /* Critical changes should not sit in a batch waiting for company. */
+    if (lwssn->ha_flags & HA_FLAG_CRITICAL_CHANGE)
+        FlushHAMessageBatches();
+
+    /* A batch that fails to go out later bumps the epoch again. */
+    if (epoch == ha_sync_epoch)
+        lwssn->ha_sync_epoch = epoch;
+
+    /* Calculate the next update threshold.  Once a flow has been synchronized,
+        a minimum sync interval holds off further updates so that changes made
+        within it are coalesced into a single message. */
+    if (timerisset(&pLWSPolicyConfig->ha_config->min_sync_interval))
+        timeradd(&pkt_time, &pLWSPolicyConfig->ha_config->min_sync_interval, &lwssn->ha_next_update);
+    else
     {
-        lwssn->ha_next_update.tv_usec -= 1000000;
-        lwssn->ha_next_update.tv_sec++;
+        lwssn->ha_next_update.tv_usec += pLWSPolicyConfig->ha_config->min_session_lifetime.tv_usec;
+        if (lwssn->ha_next_update.tv_usec > 1000000)
+        {
+            lwssn->ha_next_update.tv_usec -= 1000000;
+            lwssn->ha_next_update.tv_sec++;
+        }
+        lwssn->ha_next_update.tv_sec += pLWSPolicyConfig->ha_config->min_session_lifetime.tv_sec;
     }
-    lwssn->ha_next_update.tv_sec += pLWSPolicyConfig->ha_config->min_session_lifetime.tv_sec;
 
     /* Clear the modified/new flags and pending preprocessor updates. */
     lwssn->ha_flags &= ~(HA_FLAG_NEW|HA_FLAG_MODIFIED|HA_FLAG_MAJOR_CHANGE|HA_FLAG_CRITICAL_CHANGE);
@@ -1524,14 +1805,120 @@ void Stream5ProcessHA(void *ssnptr)
 }
 
 #ifdef SIDE_CHANNEL
+extern Stream5SessionCache *tcp_lws_cache, *udp_lws_cache, *ip_lws_cache;
+
+static void ResyncHASessionCache(Stream5SessionCache *cache, uint8_t pending_mask)
+{
+    Stream5LWSession *lwssn;
+    Stream5Config *pLWSPolicyConfig;
+    SFXHASH_NODE *hnode;
+    uint32_t epoch;
+
+    if (!cache)
+        return;
+
+    for (hnode = sfxhash_ghead(cache->hashTable); hnode; hnode = sfxhash_gnext(hnode))
+    {
+        lwssn = (Stream5LWSession *) hnode->data;
+
+        /* Flows that have never been synchronized go out on their own schedule. */
+        if (lwssn->ha_flags & (HA_FLAG_NEW|HA_FLAG_STANDBY|HA_FLAG_DELETED))
+            continue;
+
+        pLWSPolicyConfig = (Stream5Config *) sfPolicyUserDataGet(lwssn->config, lwssn->policy_id);
+        if (!pLWSPolicyConfig || !pLWSPolicyConfig->global_config || !pLWSPolicyConfig->global_config->enable_ha ||
+            !pLWSPolicyConfig->ha_config || !pLWSPolicyConfig->ha_config->use_side_channel)
+            continue;
+
+        /* Send everything; any pending changes are folded into this update. */
+        lwssn->ha_flags |= HA_FLAG_MODIFIED;
+        lwssn->ha_pending_mask |= pending_mask;
+
+        epoch = ha_sync_epoch;
+        SendSCMessage(lwssn, CalculateHAMessageSize(HA_EVENT_UPDATE, lwssn), GenerateHAUpdateMessage);
+        if (epoch == ha_sync_epoch)
+            lwssn->ha_sync_epoch = epoch;
+
+        lwssn->ha_flags &= ~(HA_FLAG_MODIFIED|HA_FLAG_MAJOR_CHANGE|HA_FLAG_CRITICAL_CHANGE);
+        lwssn->ha_pending_mask = 0;
+        s5ha_stats.resync_updates_sent++;
+    }
+}
+
+/* A peer has (re)started and knows nothing about the flows we are tracking.
+    Runs in the Snort main thread (or holding snort_process_lock), so the
+    session caches can be walked directly. */
+static int ConsumeHAResyncRequest(const MsgHeader *msg_hdr)
+{
+    uint8_t pending_mask = 0;
+    int idx;
+
+    if (msg_hdr->version != HA_MESSAGE_VERSION)
+    {
+        ErrorMessage("Stream5 HA message has unsupported version: 0x%02hhx!\n", msg_hdr->version);
+        return 1;
+    }
+
+    if (msg_hdr->total_length != sizeof(*msg_hdr) || msg_hdr->key_size != 0)
+    {
+        ErrorMessage("Stream5 HA resync request is malformed! (%hu bytes, %hhu byte key)\n",
+                msg_hdr->total_length, msg_hdr->key_size);
+        return 1;
+    }
+
+    s5ha_stats.resync_requests_received++;
+
+    for (idx = 0; idx < n_stream_ha_funcs; idx++)
+    {
+        if (stream_ha_funcs[idx])
+            pending_mask |= stream_ha_funcs[idx]->mask;
+    }
+
+    ha_resyncing = true;
+    ResyncHASessionCache(tcp_lws_cache, pending_mask);
+    ResyncHASessionCache(udp_lws_cache, pending_mask);
+    ResyncHASessionCache(ip_lws_cache, pending_mask);
+    ha_resyncing = false;
+
+    FlushHAMessageBatch(&sc_batch);
+
+    return 0;
+}
+
 static int Stream5HASCMsgHandler(SCMsgHdr *hdr, const uint8_t *msg, uint32_t msglen)
 {
-    int rval;
+    MsgHeader msg_hdr;
+    int rval = 0;
     PROFILE_VARS;
 
     PREPROC_PROFILE_START(s5HAPerfStats);
 
-    rval = ConsumeHAMessage(msg, msglen);
+    /* The message may be a batch of concatenated HA messages. */
+    while (msglen > 0)
+    {
+        if (msglen < sizeof(msg_hdr))
+        {
+            ErrorMessage("Stream5 HA message length shorter than header length! (%u)\n", msglen);
+            rval = 1;
+            break;
+        }
+        memcpy(&msg_hdr, msg, sizeof(msg_hdr));
+        if (msg_hdr.total_length < sizeof(msg_hdr) || msg_hdr.total_length > msglen)
+        {
+            ErrorMessage("Stream5 HA message header's total length is invalid! (%hu of %u)\n",
+                    msg_hdr.total_length, msglen);
+            rval = 1;
+            break;
+        }
+        if (msg_hdr.event == HA_EVENT_RESYNC)
+            rval = ConsumeHAResyncRequest(&msg_hdr);
+        else
+            rval = ConsumeHAMessage(msg, msg_hdr.total_length);
+        if (rval != 0)
+            break;
+        msg += msg_hdr.total_length;
+        msglen -= msg_hdr.total_length;
+    }
 
     PREPROC_PROFILE_END(s5HAPerfStats);
 
@@ -1564,6 +1951,12 @@ void Stream5HAPostConfigInit(struct _SnortConfig *sc, int unused, void *arg)
             FatalError("Could not open %s for writing HA messages to: %s (%d)\n",
                         pDefaultPolicyConfig->ha_config->runtime_output_file, strerror(errno), errno);
         }
+        if (pDefaultPolicyConfig->ha_config->max_batch_size)
+        {
+            runtime_output_batch.size = pDefaultPolicyConfig->ha_config->max_batch_size;
+            runtime_output_batch.buffer = (uint8_t *) SnortAlloc(runtime_output_batch.size);
+            runtime_output_batch.flush = WriteHABatchToFile;
+        }
     }
 
 #ifdef SIDE_CHANNEL
@@ -1573,8 +1966,23 @@ void Stream5HAPostConfigInit(struct _SnortConfig *sc, int unused, void *arg)
         {
             /* TODO: Fatal error here or something. */
         }
+        if (pDefaultPolicyConfig->ha_config->max_batch_size)
+        {
+            sc_batch.size = pDefaultPolicyConfig->ha_config->max_batch_size;
+            sc_batch.buffer = (uint8_t *) SnortAlloc(sc_batch.size);
+            sc_batch.flush = SendSCBatch;
+        }
+        /* Ask the peer for the flows it already has in case we are joining late. */
+        SendHAResyncRequest();
     }
 #endif
+
+    if (pDefaultPolicyConfig->ha_config->max_batch_size)
+    {
+        max_batch_delay = pDefaultPolicyConfig->ha_config->max_batch_delay;
+        /* Nothing else is coming along to push out a partial batch when idle. */
+        IdleProcessingRegisterHandler(FlushHAMessageBatches);
+    }
 }
 
 void Stream5CleanHA(void)
@@ -1589,6 +1997,21 @@ void Stream5CleanHA(void)
             stream_ha_funcs[i] = NULL;
         }
     }
+    /* The side channel batch was flushed from the idle handlers before the
+        side channel was shut down; it can't be sent anymore. */
+    FlushHAMessageBatch(&runtime_output_batch);
+    if (runtime_output_batch.buffer)
+    {
+        free(runtime_output_batch.buffer);
+        memset(&runtime_output_batch, 0, sizeof(runtime_output_batch));
+    }
+#ifdef SIDE_CHANNEL
+    if (sc_batch.buffer)
+    {
+        free(sc_batch.buffer);
+        memset(&sc_batch, 0, sizeof(sc_batch));
+    }
+#endif
     if (runtime_output_fd >= 0)
     {
         close(runtime_output_fd);
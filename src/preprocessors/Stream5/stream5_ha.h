@@ -44,6 +44,7 @@ typedef enum
 {
     HA_EVENT_UPDATE,
     HA_EVENT_DELETE,
+    HA_EVENT_RESYNC,
     HA_EVENT_MAX
 } HA_Event;
 
@@ -138,6 +138,7 @@ int InitBaseStats(SFBASE *sfBase)
 
     sfBase->total_blocked_packets = 0;
     sfBase->total_injected_packets = 0;
+    sfBase->total_bypassed_packets = 0;
     sfBase->total_wire_packets = 0;
     sfBase->total_ipfragmented_packets = 0;
     sfBase->total_ipreassembled_packets = 0;
@@ -973,6 +974,7 @@ static int CalculateBasePerfStats(SFBASE *sfBase, SFBASE_STATS *sfBaseStats, int
 
     sfBaseStats->total_blocked_packets = sfBase->total_blocked_packets;
     sfBaseStats->total_injected_packets = sfBase->total_injected_packets;
+    sfBaseStats->total_bypassed_packets = sfBase->total_bypassed_packets;
     sfBaseStats->total_mpls_packets = sfBase->total_mpls_packets;
     sfBaseStats->total_mpls_bytes = sfBase->total_mpls_bytes;
     sfBaseStats->total_blocked_mpls_packets = sfBase->total_blocked_mpls_packets;
@@ -1411,7 +1413,10 @@ static void LogBasePerfStats(SFBASE_STATS *sfBaseStats,  FILE * fh )
         CSVu64, sfBaseStats->stream5_mem_in_use);
 
     size += SafeSnprintf(buff + size, sizeof(buff) - size, 
-        "%.3f", sfBaseStats->total_alerts_per_second);
+        "%.3f,", sfBaseStats->total_alerts_per_second);
+
+    size += SafeSnprintf(buff + size, sizeof(buff) - size, 
+        STDu64, sfBaseStats->total_bypassed_packets);
 
     size += SafeSnprintf(buff + size, sizeof(buff) - size, "\n");
 
@@ -1604,6 +1609,9 @@ void LogBasePerfHeader (FILE* fh)
     fprintf(fh, ",%s",
         "total_alerts_per_second");
 
+    fprintf(fh, ",%s",
+        "total_bypassed_packets");
+
     fprintf(fh,"\n");
     fflush(fh);
 }
@@ -1642,6 +1650,7 @@ static void DisplayBasePerfStatsConsole(SFBASE_STATS *sfBaseStats, int max_stats
 
     LogMessage("Blocked:     " STDu64 "\n", sfBaseStats->total_blocked_packets);
     LogMessage("Injected:    " STDu64 "\n", sfBaseStats->total_injected_packets);
+    LogMessage("Bypassed:    " STDu64 "\n", sfBaseStats->total_bypassed_packets);
     LogMessage("Pkts Filtered TCP:     " STDu64 "\n", sfBaseStats->total_tcp_filtered_packets);
     LogMessage("Pkts Filtered UDP:     " STDu64 "\n\n", sfBaseStats->total_udp_filtered_packets);
 
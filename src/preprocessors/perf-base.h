@@ -87,6 +87,7 @@ typedef struct _SFBASE
                               */
     uint64_t   total_blocked_packets;
     uint64_t   total_injected_packets;  // due to normalize_ip4: trim blocks
+    uint64_t   total_bypassed_packets;  // answered from the bypass table
 
     uint64_t   total_rebuilt_packets;
     uint64_t   total_wire_bytes;
@@ -239,6 +240,7 @@ typedef struct _SFBASE_STATS {
     uint64_t   total_blocked_packets;
     uint64_t   total_blocked_bytes;
     uint64_t   total_injected_packets;
+    uint64_t   total_bypassed_packets;
 
     uint64_t   total_udp_sessions;
     uint64_t   max_udp_sessions;
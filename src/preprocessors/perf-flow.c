@@ -65,6 +65,8 @@ static void DisplayFlowStats(SFFLOW_STATS *sfFlowStats);
 static void WriteFlowStats(SFFLOW_STATS *, FILE *);
 static void DisplayFlowIPStats(SFFLOW *sfFlow);
 static void WriteFlowIPStats(SFFLOW *sfFlow, FILE *fp);
+static void DisplayFlowGTPStats(SFFLOW *sfFlow);
+static void WriteFlowGTPStats(SFFLOW *sfFlow, FILE *fp);
 
 typedef struct _sfSingleFlowStatsKey
 {
@@ -88,6 +90,20 @@ typedef struct _sfSingleFlowStatsValue
     uint32_t stateChanges[SFS_STATE_MAX];
 } sfSFSValue;
 
+/* A TEID is allocated by the receiving end of a GTP tunnel, so it is
+ * unique only together with that endpoint's address */
+typedef struct _sfGTPTunnelStatsKey
+{
+    snort_ip endpoint;
+    uint32_t teid;
+} sfGTPKey;
+
+typedef struct _sfGTPTunnelStatsValue
+{
+    uint64_t packets;
+    uint64_t bytes;
+} sfGTPValue;
+
 /*
 *  Allocate Memory, initialize arrays, etc...
 */
@@ -149,6 +165,25 @@ int InitFlowIPStats(SFFLOW *sfFlow)
     return 0;
 }
 
+int InitFlowGTPStats(SFFLOW *sfFlow)
+{
+    static char first = 1;
+
+    if (first)
+    {
+        sfFlow->gtpMap = sfxhash_new(1021, sizeof(sfGTPKey), sizeof(sfGTPValue),
+                perfmon_config->flowgtp_memcap, 1, NULL, NULL, 1);
+
+        first = 0;
+    }
+    else
+    {
+        sfxhash_make_empty(sfFlow->gtpMap);
+    }
+
+    return 0;
+}
+
 void FreeFlowStats(SFFLOW *sfFlow)
 {
     if (sfFlow->pktLenCnt != NULL)
@@ -192,6 +227,12 @@ void FreeFlowStats(SFFLOW *sfFlow)
         sfxhash_delete(sfFlow->ipMap);
         sfFlow->ipMap = NULL;
     }
+
+    if (sfFlow->gtpMap != NULL)
+    {
+        sfxhash_delete(sfFlow->gtpMap);
+        sfFlow->gtpMap = NULL;
+    }
 }
 
 int UpdateTCPFlowStats(SFFLOW *sfFlow, int sport, int dport, int len)
@@ -362,6 +403,33 @@ int UpdateFlowIPState(SFFLOW *sfFlow, snort_ip_p src_addr, snort_ip_p dst_addr,
     return 0;
 }
 
+int UpdateFlowGTPStats(SFFLOW *sfFlow, snort_ip_p endpoint, uint32_t teid, int len)
+{
+    SFXHASH_NODE *node;
+    sfGTPKey key;
+    sfGTPValue *value;
+
+    IP_COPY_VALUE(key.endpoint, endpoint);
+    key.teid = teid;
+
+    value = sfxhash_find(sfFlow->gtpMap, &key);
+    if (!value)
+    {
+        node = sfxhash_get_node(sfFlow->gtpMap, &key);
+        if (!node)
+        {
+            DEBUG_WRAP(DebugMessage(DEBUG_STREAM, "Key/Value pair didn't exist in the GTP stats table and we couldn't add it!\n"););
+            return 1;
+        }
+        memset(node->data, 0, sizeof(sfGTPValue));
+        value = node->data;
+    }
+    value->packets++;
+    value->bytes += len;
+
+    return 0;
+}
+
 /*
 *   Add in stats for this packet
 *
@@ -862,3 +930,61 @@ static void WriteFlowIPStats(SFFLOW *sfFlow, FILE *fp)
 
     fflush(fp);
 }
+
+void ProcessFlowGTPStats(SFFLOW *sfFlow, FILE *fh, int console)
+{
+    if (console)
+        DisplayFlowGTPStats(sfFlow);
+
+    if (fh != NULL)
+        WriteFlowGTPStats(sfFlow, fh);
+}
+
+static void DisplayFlowGTPStats(SFFLOW *sfFlow)
+{
+    SFXHASH_NODE *node;
+    sfGTPKey *key;
+    sfGTPValue *stats;
+    char ip[41];
+    uint64_t total = 0;
+
+    LogMessage("\n");
+    LogMessage("\n");
+    LogMessage("GTP Tunnels (%d unique tunnels)\n", sfxhash_count(sfFlow->gtpMap));
+    LogMessage(    "---------------\n");
+    for (node = sfxhash_findfirst(sfFlow->gtpMap); node; node = sfxhash_findnext(sfFlow->gtpMap))
+    {
+        key = (sfGTPKey *) node->key;
+        stats = (sfGTPValue *) node->data;
+
+        sfip_raw_ntop(key->endpoint.family, key->endpoint.ip32, ip, sizeof(ip));
+        LogMessage("[%s teid 0x%08X]: " STDu64 " bytes in " STDu64 " packets\n",
+                ip, key->teid, stats->bytes, stats->packets);
+        total += stats->packets;
+    }
+    LogMessage("Classified " STDu64 " packets.\n", total);
+}
+
+static void WriteFlowGTPStats(SFFLOW *sfFlow, FILE *fp)
+{
+    SFXHASH_NODE *node;
+    sfGTPKey *key;
+    sfGTPValue *stats;
+    char ip[41];
+
+    if (!fp)
+        return;
+
+    fprintf(fp, "%u,%u\n", (uint32_t)time(NULL), sfxhash_count(sfFlow->gtpMap));
+    for (node = sfxhash_findfirst(sfFlow->gtpMap); node; node = sfxhash_findnext(sfFlow->gtpMap))
+    {
+        key = (sfGTPKey *) node->key;
+        stats = (sfGTPValue *) node->data;
+
+        sfip_raw_ntop(key->endpoint.family, key->endpoint.ip32, ip, sizeof(ip));
+        fprintf(fp, "%s,%u," CSVu64 STDu64 "\n",
+                ip, key->teid, stats->packets, stats->bytes);
+    }
+
+    fflush(fp);
+}
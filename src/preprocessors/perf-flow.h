@@ -91,6 +91,7 @@ typedef struct _sfflow {
     uint64_t    typeIcmpTotal;
 
     SFXHASH     *ipMap;
+    SFXHASH     *gtpMap;
 }  SFFLOW;
 
 typedef struct _sfflow_stats {
@@ -128,6 +129,9 @@ void ProcessFlowStats(SFFLOW *sfFlow, FILE *fh, int console);
 void ProcessFlowIPStats(SFFLOW *sfFlow, FILE *fh, int console);
 int UpdateFlowIPStats(SFFLOW *, snort_ip_p src_addr, snort_ip_p dst_addr, int len, SFSType type);
 int UpdateFlowIPState(SFFLOW *, snort_ip_p src_addr, snort_ip_p dst_addr, SFSState state);
+int InitFlowGTPStats(SFFLOW *sfFlow);
+void ProcessFlowGTPStats(SFFLOW *sfFlow, FILE *fh, int console);
+int UpdateFlowGTPStats(SFFLOW *, snort_ip_p endpoint, uint32_t teid, int len);
 void FreeFlowStats(SFFLOW *sfFlow);
 void LogFlowPerfHeader(FILE *);
 
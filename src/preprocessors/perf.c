@@ -61,8 +61,10 @@ static inline bool sfCheckFileSize(FILE *, uint32_t);
 static inline void sfProcessBaseStats(SFPERF *);
 static inline void sfProcessFlowStats(SFPERF *);
 static inline void sfProcessFlowIpStats(SFPERF *);
+static inline void sfProcessFlowGtpStats(SFPERF *);
 static inline void sfProcessEventStats(SFPERF *);
 static inline int sfRotateFlowIPStatsFile(SFPERF *);
+static inline int sfRotateFlowGTPStatsFile(SFPERF *);
 static int sfRotateFile(const char *, FILE *, const char *, uint32_t);
 
 void sfInitPerformanceStatistics(SFPERF *sfPerf)
@@ -74,6 +76,7 @@ void sfInitPerformanceStatistics(SFPERF *sfPerf)
     sfPerf->pkt_cnt = 10000;
     sfPerf->max_file_size = MAX_PERF_FILE_SIZE;
     sfPerf->flowip_memcap = 50*1024*1024;
+    sfPerf->flowgtp_memcap = 50*1024*1024;
     sfPerf->base_reset = 1;
 
 #ifdef LINUX_SMP
@@ -215,6 +218,41 @@ void sfCloseFlowIPStatsFile(SFPERF *sfPerf)
     sfPerf->flowip_fh = NULL;
 }
 
+FILE * sfOpenFlowGTPStatsFile(const char *file)
+{
+    static bool start_up = true;
+    FILE *fh = NULL;
+#ifndef WIN32
+    // This file needs to be readable by everyone
+    mode_t old_umask = umask(022);
+#endif
+
+    if (file != NULL)
+    {
+        // Append to the existing file if just starting up, otherwise we've
+        // rotated so start a new one.
+        fh = fopen(file, start_up ? "a" : "w");
+    }
+
+#ifndef WIN32
+    umask(old_umask);
+#endif
+
+    if (start_up)
+        start_up = false;
+
+    return fh;
+}
+
+void sfCloseFlowGTPStatsFile(SFPERF *sfPerf)
+{
+    if (sfPerf->flowgtp_fh == NULL)
+        return;
+
+    fclose(sfPerf->flowgtp_fh);
+    sfPerf->flowgtp_fh = NULL;
+}
+
 static int sfRotateFile(const char *old_file, FILE *old_fh,
         const char *rotate_prefix, uint32_t max_file_size)
 {
@@ -465,6 +503,24 @@ static inline int sfRotateFlowIPStatsFile(SFPERF *sfPerf)
     return 0;
 }
 
+static inline int sfRotateFlowGTPStatsFile(SFPERF *sfPerf)
+{
+    if ((sfPerf != NULL) && (sfPerf->flowgtp_file != NULL))
+    {
+        int ret = sfRotateFile(sfPerf->flowgtp_file, sfPerf->flowgtp_fh, "flow-gtp", sfPerf->max_file_size);
+        if (ret != 0)
+            return ret;
+
+        if ((sfPerf->flowgtp_fh = sfOpenFlowGTPStatsFile(sfPerf->flowgtp_file)) == NULL)
+        {
+            FatalError("Perfmonitor: Cannot open flow-gtp stats file \"%s\": %s.\n",
+                    sfPerf->flowgtp_file, strerror(errno));
+        }
+    }
+
+    return 0;
+}
+
 void sfPerformanceStats(SFPERF *sfPerf, Packet *p)
 {
     // Update stats first since other stats from various places like frag3 and
@@ -501,6 +557,13 @@ void sfPerformanceStats(SFPERF *sfPerf, Packet *p)
                     InitFlowIPStats(&sfFlow);
                 }
 
+                if ((sfPerf->perf_flags & SFPERF_FLOWGTP)
+                        && !(sfPerf->perf_flags & SFPERF_SUMMARY_FLOWGTP))
+                {
+                    sfProcessFlowGtpStats(sfPerf);
+                    InitFlowGTPStats(&sfFlow);
+                }
+
                 if (!(sfPerf->perf_flags & SFPERF_SUMMARY_EVENT))
                 {
                     sfProcessEventStats(sfPerf);
@@ -563,6 +626,9 @@ void InitPerfStats(SFPERF *sfPerf)
     if (sfPerf->perf_flags & SFPERF_FLOWIP)
         InitFlowIPStats(&sfFlow);
 
+    if (sfPerf->perf_flags & SFPERF_FLOWGTP)
+        InitFlowGTPStats(&sfFlow);
+
     if (sfPerf->perf_flags & SFPERF_EVENT)
         InitEventStats(&sfEvent);
 }
@@ -588,6 +654,21 @@ static void UpdatePerfStats(SFPERF *sfPerf, Packet *p)
 
         UpdateFlowIPStats(&sfFlow, GET_SRC_IP(p), GET_DST_IP(p), p->pkth->caplen, type);
     }
+
+    if ((sfPerf->perf_flags & SFPERF_FLOWGTP) && (p->proto_bits & PROTO_BIT__GTP)
+            && IsIP(p) && !rebuilt)
+    {
+        uint32_t teid;
+
+        // the tunnel is identified by its receiving end, which is the
+        // outer destination unless the payload wasn't IP
+        if (GetGTPTeid(p, &teid))
+        {
+            UpdateFlowGTPStats(&sfFlow,
+                    (p->outer_family != NO_IP) ? GET_OUTER_DST_IP(p) : GET_DST_IP(p),
+                    teid, p->pkth->caplen);
+        }
+    }
 }
 
 static inline bool sfCheckFileSize(FILE *fh, uint32_t max_file_size)
@@ -652,6 +733,21 @@ static inline void sfProcessFlowIpStats(SFPERF *sfPerf)
     }
 }
 
+static inline void sfProcessFlowGtpStats(SFPERF *sfPerf)
+{
+    if (!(sfPerf->perf_flags & SFPERF_FLOWGTP))
+        return;
+
+    ProcessFlowGTPStats(&sfFlow, sfPerf->flowgtp_fh,
+            sfPerf->perf_flags & SFPERF_CONSOLE);
+
+    if ((sfPerf->flowgtp_fh != NULL)
+            && sfCheckFileSize(sfPerf->flowgtp_fh, sfPerf->max_file_size))
+    {
+        sfRotateFlowGTPStatsFile(sfPerf);
+    }
+}
+
 static inline void sfProcessEventStats(SFPERF *sfPerf)
 {
     if (!(sfPerf->perf_flags & SFPERF_EVENT))
@@ -675,6 +771,9 @@ void sfPerfStatsSummary(SFPERF *sfPerf)
     if (sfPerf->perf_flags & SFPERF_SUMMARY_FLOWIP)
         sfProcessFlowIpStats(sfPerf);
 
+    if (sfPerf->perf_flags & SFPERF_SUMMARY_FLOWGTP)
+        sfProcessFlowGtpStats(sfPerf);
+
     if (sfPerf->perf_flags & SFPERF_SUMMARY_EVENT)
         sfProcessEventStats(sfPerf);
 }
@@ -67,13 +67,16 @@
 #define SFPERF_FLOWIP           0x00000040
 #define SFPERF_TIME_COUNT       0x00000080
 #define SFPERF_MAX_BASE_STATS   0x00000100
+#define SFPERF_FLOWGTP          0x00000200
 
 #define SFPERF_SUMMARY_BASE     0x00001000
 #define SFPERF_SUMMARY_FLOW     0x00002000
 #define SFPERF_SUMMARY_FLOWIP   0x00004000
 #define SFPERF_SUMMARY_EVENT    0x00008000
+#define SFPERF_SUMMARY_FLOWGTP  0x00010000
 #define SFPERF_SUMMARY \
-    (SFPERF_SUMMARY_BASE|SFPERF_SUMMARY_FLOW|SFPERF_SUMMARY_FLOWIP|SFPERF_SUMMARY_EVENT)
+    (SFPERF_SUMMARY_BASE|SFPERF_SUMMARY_FLOW|SFPERF_SUMMARY_FLOWIP|SFPERF_SUMMARY_EVENT| \
+     SFPERF_SUMMARY_FLOWGTP)
 
 #define ROLLOVER_THRESH     512
 #define MAX_PERF_FILE_SIZE  INT32_MAX
@@ -96,6 +99,9 @@ typedef struct _SFPERF
     char *flowip_file;
     FILE *flowip_fh;
     uint32_t flowip_memcap;
+    char *flowgtp_file;
+    FILE *flowgtp_fh;
+    uint32_t flowgtp_memcap;
 } SFPERF;
 
 
@@ -112,6 +118,8 @@ FILE * sfOpenFlowStatsFile(const char *);
 void sfCloseFlowStatsFile(SFPERF *sfPerf);
 FILE * sfOpenFlowIPStatsFile(const char *);
 void sfCloseFlowIPStatsFile(SFPERF *sfPerf);
+FILE * sfOpenFlowGTPStatsFile(const char *);
+void sfCloseFlowGTPStatsFile(SFPERF *sfPerf);
 int sfRotateBaseStatsFile(SFPERF *sfPerf);
 int sfRotateFlowStatsFile(SFPERF *sfPerf);
 void sfPerformanceStats(SFPERF *, Packet *);
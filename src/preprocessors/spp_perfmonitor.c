@@ -55,6 +55,7 @@
 //#define PERFMON_ARG__BASE          "base"
 #define PERFMON_ARG__FLOW          "flow"
 #define PERFMON_ARG__FLOW_IP       "flow-ip"
+#define PERFMON_ARG__FLOW_GTP      "flow-gtp"
 #define PERFMON_ARG__EVENTS        "events"
 
 // Logging
@@ -62,6 +63,7 @@
 #define PERFMON_ARG__LOG_DIR_FILE   "snortfile"
 #define PERFMON_ARG__FLOW_FILE      "flow-file"
 #define PERFMON_ARG__FLOW_IP_FILE   "flow-ip-file"
+#define PERFMON_ARG__FLOW_GTP_FILE  "flow-gtp-file"
 #define PERFMON_ARG__CONSOLE        "console"
 #define PERFMON_ARG__MAX_FILE_SIZE  "max_file_size"
 
@@ -72,6 +74,7 @@
 #define PERFMON_SUMMARY_OPT__BASE     "base-stats"
 #define PERFMON_SUMMARY_OPT__FLOW     "flow-stats"
 #define PERFMON_SUMMARY_OPT__FLOW_IP  "flow-ip-stats"
+#define PERFMON_SUMMARY_OPT__FLOW_GTP "flow-gtp-stats"
 #define PERFMON_SUMMARY_OPT__EVENTS   "events-stats"
 
 // Misc
@@ -80,6 +83,7 @@
 #define PERFMON_ARG__RESET           "reset"
 #define PERFMON_ARG__MAX_STATS       "max"
 #define PERFMON_ARG__FLOW_IP_MEMCAP  "flow-ip-memcap"
+#define PERFMON_ARG__FLOW_GTP_MEMCAP "flow-gtp-memcap"
 
 
 SFPERF *perfmon_config = NULL;
@@ -324,6 +328,48 @@ static void ParsePerfMonitorArgs(struct _SnortConfig *sc, SFPERF *pconfig, char
             pconfig->flowip_memcap = value;
             pconfig->perf_flags |= SFPERF_FLOWIP;
         }
+        else if (strcasecmp(toks[i], PERFMON_ARG__FLOW_GTP) == 0)
+        {
+            // Per tunnel traffic for GTP user plane packets
+            pconfig->perf_flags |= SFPERF_FLOWGTP;
+        }
+        else if (strcasecmp(toks[i], PERFMON_ARG__FLOW_GTP_FILE) == 0)
+        {
+            if (pconfig->flowgtp_file != NULL)
+                free(pconfig->flowgtp_file);
+
+            // Requires a file name/path argument
+            if (i == (num_toks - 1))
+            {
+                ParseError("Perfmonitor:  Missing file name/path argument "
+                        "to \"%s\".", PERFMON_ARG__FLOW_GTP_FILE);
+            }
+
+            pconfig->perf_flags |= SFPERF_FLOWGTP;
+            pconfig->flowgtp_file = ProcessFileOption(sc, toks[++i]);
+        }
+        else if (strcasecmp(toks[i], PERFMON_ARG__FLOW_GTP_MEMCAP) == 0)
+        {
+            uint32_t value = 0;
+
+            // Requires an integer argument
+            if (i == (num_toks - 1))
+            {
+                ParseError("Perfmonitor:  Missing argument to \"%s\".  The "
+                        "value must be a positive integer.", PERFMON_ARG__FLOW_GTP_MEMCAP);
+            }
+
+            if ((SnortStrToU32(toks[++i], &endptr, &value, 10) != 0)
+                    || (value == 0) || *endptr || (errno == ERANGE))
+            {
+                ParseError("Perfmonitor:  Invalid argument to \"%s\".  The "
+                        "value must be a positive integer between 1 and %u.",
+                        PERFMON_ARG__FLOW_GTP_MEMCAP, UINT32_MAX);
+            }
+
+            pconfig->flowgtp_memcap = value;
+            pconfig->perf_flags |= SFPERF_FLOWGTP;
+        }
         else if (strcasecmp(toks[i], PERFMON_ARG__TIME) == 0)
         {
             uint32_t value = 0;
@@ -474,6 +520,10 @@ static void ParsePerfMonitorArgs(struct _SnortConfig *sc, SFPERF *pconfig, char
                 {
                     summary_flags |= SFPERF_SUMMARY_FLOWIP;
                 }
+                else if (strcasecmp(toks[i], PERFMON_SUMMARY_OPT__FLOW_GTP) == 0)
+                {
+                    summary_flags |= SFPERF_SUMMARY_FLOWGTP;
+                }
                 else if (strcasecmp(toks[i], PERFMON_SUMMARY_OPT__EVENTS) == 0)
                 {
                     summary_flags |= SFPERF_SUMMARY_EVENT;
@@ -555,6 +605,15 @@ static void ParsePerfMonitorArgs(struct _SnortConfig *sc, SFPERF *pconfig, char
         LogMessage("    Flow IP File:     %s\n",
                 (pconfig->flowip_file != NULL) ? pconfig->flowip_file : "INACTIVE");
     }
+    LogMessage("  Flow GTP Stats:   %s%s\n",
+            pconfig->perf_flags & SFPERF_FLOWGTP ? "ACTIVE" : "INACTIVE",
+            pconfig->perf_flags & SFPERF_SUMMARY_FLOWGTP ? " (SUMMARY)" : "");
+    if (pconfig->perf_flags & SFPERF_FLOWGTP)
+    {
+        LogMessage("    Flow GTP Memcap:  %u\n", pconfig->flowgtp_memcap);
+        LogMessage("    Flow GTP File:    %s\n",
+                (pconfig->flowgtp_file != NULL) ? pconfig->flowgtp_file : "INACTIVE");
+    }
     LogMessage("  Console Mode:     %s\n",
             (pconfig->perf_flags & SFPERF_CONSOLE) ? "ACTIVE" : "INACTIVE");
 }
@@ -626,6 +685,7 @@ static void PerfMonitorCleanExit(int signal, void *foo)
     sfCloseBaseStatsFile(perfmon_config);
     sfCloseFlowStatsFile(perfmon_config);
     sfCloseFlowIPStatsFile(perfmon_config);
+    sfCloseFlowGTPStatsFile(perfmon_config);
     FreeFlowStats(&sfFlow);
 #ifdef LINUX_SMP
     FreeProcPidStats(&sfBase.sfProcPidStats);
@@ -649,6 +709,9 @@ static void PerfMonitorFreeConfig(SFPERF *config)
     if (config->flowip_file != NULL)
         free(config->flowip_file);
 
+    if (config->flowgtp_file != NULL)
+        free(config->flowgtp_file);
+
     free(config);
 }
 
@@ -751,6 +814,31 @@ static void PerfMonitorChangeLogFilesPermission(void)
             }
         }
     }
+
+    if (perfmon_config->flowgtp_file != NULL)
+    {
+        /*Check file before change permission*/
+        if (stat(perfmon_config->flowgtp_file, &pt) == 0)
+        {
+            /*Only change permission for file owned by root*/
+            if ((0 == pt.st_uid) || (0 == pt.st_gid))
+            {
+                if (chmod(perfmon_config->flowgtp_file, mode) != 0)
+                {
+                    ParseError("Perfmonitor: Unable to change mode of "
+                            "flow-gtp stats file \"%s\" to mode:%d: %s.",
+                            perfmon_config->flowgtp_file, mode, strerror(errno));
+                }
+
+                if (chown(perfmon_config->flowgtp_file, ScUid(), ScGid()) != 0)
+                {
+                    ParseError("Perfmonitor: Unable to change permissions of "
+                            "flow-gtp stats file \"%s\" to user:%d and group:%d: %s.",
+                            perfmon_config->flowgtp_file, ScUid(), ScGid(), strerror(errno));
+                }
+            }
+        }
+    }
 }
 #endif
 /* This function opens the perfmon log files.
@@ -779,6 +867,12 @@ static void PerfMonitorOpenLogFiles(struct _SnortConfig *sc, void *data)
     {
         ParseError("Perfmonitor: Cannot open flow-ip stats file \"%s\".", perfmon_config->flowip_file);
     }
+
+    if ((perfmon_config->flowgtp_file != NULL)
+            && ((perfmon_config->flowgtp_fh = sfOpenFlowGTPStatsFile(perfmon_config->flowgtp_file)) == NULL))
+    {
+        ParseError("Perfmonitor: Cannot open flow-gtp stats file \"%s\".", perfmon_config->flowgtp_file);
+    }
 }
 
 #ifdef SNORT_RELOAD
@@ -818,6 +912,10 @@ static void PerfMonitorReload(struct _SnortConfig *sc, char *args, void **new_co
     if (perfmon_config->flow_fh != NULL)
         perfmon_swap_config->flow_fh = perfmon_config->flow_fh;
 
+    /* And the GTP tunnel stats file */
+    if (perfmon_config->flowgtp_fh != NULL)
+        perfmon_swap_config->flowgtp_fh = perfmon_config->flowgtp_fh;
+
     AddFuncToPreprocList(sc, ProcessPerfMonitor, PRIORITY_SCANNER, PP_PERFMONITOR, PROTO_BIT__ALL);
 }
 
@@ -872,6 +970,20 @@ static int PerfmonReloadVerify(struct _SnortConfig *sc, void *swap_config)
         return -1;
     }
 
+    if ((perfmon_config->flowgtp_file != NULL) && (perfmon_swap_config->flowgtp_file != NULL))
+    {
+        if (strcmp(perfmon_config->flowgtp_file, perfmon_swap_config->flowgtp_file) != 0)
+        {
+            ErrorMessage("Perfmonitor Reload: Changing the FlowGTP log file requires a restart.\n");
+            return -1;
+        }
+    }
+    else if (perfmon_config->flowgtp_file != perfmon_swap_config->flowgtp_file)
+    {
+        ErrorMessage("Perfmonitor Reload: Changing the FlowGTP log file requires a restart.\n");
+        return -1;
+    }
+
     return 0;
 }
 
@@ -258,6 +258,7 @@ static void *Stream5GetApplicationDataFromIpPort(
                     uint16_t vlan,
                     uint32_t mplsId,
                     uint16_t addressSpaceId,
+                    uint32_t tunnelId,
                     uint32_t protocol);
 static uint32_t Stream5SetSessionFlags(
                     void *ssnptr,
@@ -299,6 +300,7 @@ static int Stream5GetStreamSegments(
         void *userdata);
 
 static StreamFlowData *Stream5GetFlowData(Packet *p);
+static StreamFlowData *Stream5GetSparseFlowData(Packet *p, bool alloc);
 static int Stream5SetApplicationProtocolIdExpected(
                     snort_ip_p srcIP,
                     uint16_t srcPort,
@@ -360,7 +362,8 @@ static void *Stream5GetSessionPtrFromIpPort(
                     char ip_protocol,
                     uint16_t vlan,
                     uint32_t mplsId,
-                    uint16_t addressSpaceId);
+                    uint16_t addressSpaceId,
+                    uint32_t tunnelId);
 
 static const StreamSessionKey *Stream5GetKeyFromSessionPtr(const void *ssnptr);
 
@@ -395,9 +398,10 @@ static void Stream5SetExtraData(void* ssn, Packet*, uint32_t);
 static void Stream5ClearExtraData(void* ssn, Packet*, uint32_t);
 
 static void Stream5ForceSessionExpiration(void *ssnptr);
+static int Stream5UpdateMemoryInUse(int32_t delta);
 
 StreamAPI s5api = {
-    /* .version = */ STREAM_API_VERSION5,
+    /* .version = */ STREAM_API_VERSION7,
     /* .alert_inline_midstream_drops = */ Stream5MidStreamDropAlert,
     /* .update_direction = */ Stream5UpdateDirection,
     /* .get_packet_direction = */ Stream5GetPacketDirection,
@@ -470,6 +474,8 @@ StreamAPI s5api = {
     /* .set_extra_data = */ Stream5SetExtraData,
     /* .clear_extra_data = */ Stream5ClearExtraData,
     /* .expire_session = */ Stream5ForceSessionExpiration,
+    /* .get_sparse_flow_data = */ Stream5GetSparseFlowData,
+    /* .update_memory_in_use = */ Stream5UpdateMemoryInUse,
 };
 
 void SetupStream5(void)
@@ -1298,6 +1304,8 @@ static void Stream5CleanExit(int signal, void *foo)
     /* Free up the ignore data that was queued */
     StreamExpectCleanup();
 
+    FreeLWSessionTunnels();
+
     Stream5FreeConfigs(s5_config);
     s5_config = NULL;
 }
@@ -1490,10 +1498,9 @@ static int Stream5VerifyConfig(struct _SnortConfig *sc)
         LogMessage("IP tracking disabled, no IP sessions allocated\n");
     }
 
-    /* Initialize the memory pool for Flowbits Data */
-    /* use giFlowbitSize - 1, since there is already 1 byte in the
-     * StreamFlowData structure */
-    obj_size = sizeof(StreamFlowData) + getFlowbitSizeInBytes() - 1;
+    /* Initialize the memory pool for Flowbits Data.  Only the sparse
+     * list is pooled; the bitmap is allocated when a session needs it. */
+    obj_size = sizeof(StreamFlowData);
 
     if (obj_size % sizeof(long) != 0)
     {
@@ -1798,6 +1805,21 @@ static inline int IsEligible(Packet *p)
 }
 
 /*************************** API Implementations *******************/
+static inline void Stream5ReplaceAppData(
+                    void **dataPointer,
+                    StreamAppDataFree *freeFunc,
+                    void *data,
+                    StreamAppDataFree free_func)
+{
+    /* If changing the pointer to the data, free old one */
+    if (*freeFunc && *dataPointer && (*dataPointer != data))
+        (*freeFunc)(*dataPointer);
+
+    /* This will reset free_func if it already exists */
+    *freeFunc = free_func;
+    *dataPointer = data;
+}
+
 static int Stream5SetApplicationData(
                     void *ssnptr,
                     uint32_t protocol,
@@ -1806,48 +1828,54 @@ static int Stream5SetApplicationData(
 {
     Stream5LWSession *ssn;
     Stream5AppData *appData = NULL;
+    unsigned i;
+
     if (ssnptr)
     {
         ssn = (Stream5LWSession*)ssnptr;
+
+        for (i = 0; i < ssn->appDataSlots; i++)
+        {
+            if (ssn->appDataProtocol[i] == protocol)
+            {
+                Stream5ReplaceAppData(&ssn->appData[i].dataPointer,
+                    &ssn->appData[i].freeFunc, data, free_func);
+                return 0;
+            }
+        }
+
         appData = ssn->appDataList;
         while (appData)
         {
             if (appData->protocol == protocol)
             {
-                /* If changing the pointer to the data, free old one */
-                if ((appData->freeFunc) && (appData->dataPointer != data))
-                {
-                    if ( appData->dataPointer )
-                        appData->freeFunc(appData->dataPointer);
-                }
-                else
-                {
-                    /* Same pointer, same protocol.  Go away */
-                    break;
-                }
-
-                appData->dataPointer = NULL;
-                break;
+                Stream5ReplaceAppData(&appData->dataPointer,
+                    &appData->freeFunc, data, free_func);
+                return 0;
             }
-
             appData = appData->next;
         }
 
-        /* If there isn't one for this protocol, allocate */
-        if (!appData)
+        /* If there isn't one for this protocol, take a free slot */
+        if (ssn->appDataSlots < S5_APP_DATA_SLOTS)
         {
-            appData = SnortAlloc(sizeof(Stream5AppData));
+            i = ssn->appDataSlots++;
+            ssn->appDataProtocol[i] = protocol;
+            ssn->appData[i].freeFunc = free_func;
+            ssn->appData[i].dataPointer = data;
+            return 0;
+        }
 
-            /* And add it to the list */
-            if (ssn->appDataList)
-            {
-                ssn->appDataList->prev = appData;
-            }
-            appData->next = ssn->appDataList;
-            ssn->appDataList = appData;
+        /* Or allocate and add it to the list */
+        appData = SnortAlloc(sizeof(Stream5AppData));
+
+        if (ssn->appDataList)
+        {
+            ssn->appDataList->prev = appData;
         }
+        appData->next = ssn->appDataList;
+        ssn->appDataList = appData;
 
-        /* This will reset free_func if it already exists */
         appData->protocol = protocol;
         appData->freeFunc = free_func;
         appData->dataPointer = data;
@@ -1863,22 +1891,28 @@ static void *Stream5GetApplicationData(
 {
     Stream5LWSession *ssn;
     Stream5AppData *appData = NULL;
-    void *data = NULL;
+    unsigned i;
+
     if (ssnptr)
     {
         ssn = (Stream5LWSession*)ssnptr;
+
+        for (i = 0; i < ssn->appDataSlots; i++)
+        {
+            if (ssn->appDataProtocol[i] == protocol)
+                return ssn->appData[i].dataPointer;
+        }
+
         appData = ssn->appDataList;
         while (appData)
         {
             if (appData->protocol == protocol)
-            {
-                data = appData->dataPointer;
-                break;
-            }
+                return appData->dataPointer;
+
             appData = appData->next;
         }
     }
-    return data;
+    return NULL;
 }
 
 static inline void * Stream5GetSessionPtr(const SessionKey *key)
@@ -1913,11 +1947,13 @@ static void * Stream5GetSessionPtrFromIpPort(
                     char ip_protocol,
                     uint16_t vlan,
                     uint32_t mplsId,
-                    uint16_t addressSpaceId)
+                    uint16_t addressSpaceId,
+                    uint32_t tunnelId)
 {
     SessionKey key;
 
-    GetLWSessionKeyFromIpPort(srcIP, srcPort, dstIP, dstPort, ip_protocol, vlan, mplsId, addressSpaceId, &key);
+    GetLWSessionKeyFromIpPort(srcIP, srcPort, dstIP, dstPort, ip_protocol,
+            vlan, mplsId, addressSpaceId, tunnelId, &key);
 
     return (void*)Stream5GetSessionPtr(&key);
 }
@@ -1945,7 +1981,8 @@ static void Stream5PopulateSessionKey(Packet *p, StreamSessionKey *key)
         GET_IPH_PROTO(p),
         p->vh ? VTH_VLAN(p->vh) : 0,
         p->mplsHdr.label,
-        addressSpaceId, key);
+        addressSpaceId,
+        GetLWSessionTunnelId(p), key);
 }
 
 static StreamSessionKey * Stream5GetSessionKey(Packet *p)
@@ -1976,12 +2013,13 @@ static void * Stream5GetApplicationDataFromIpPort(
                     uint16_t vlan,
                     uint32_t mplsId,
                     uint16_t addressSpaceID,
+                    uint32_t tunnelId,
                     uint32_t protocol)
 {
     Stream5LWSession *ssn;
 
     ssn = (Stream5LWSession *) Stream5GetSessionPtrFromIpPort(srcIP,srcPort,dstIP,dstPort,
-            ip_protocol,vlan,mplsId, addressSpaceID);
+            ip_protocol,vlan,mplsId, addressSpaceID, tunnelId);
 
     return Stream5GetApplicationData(ssn, protocol);
 }
@@ -2515,11 +2553,43 @@ static StreamFlowData *Stream5GetFlowData(Packet *p)
 
     return (StreamFlowData *)flowdata;
 #endif
+    StreamFlowData *flowdata = Stream5GetSparseFlowData(p, true);
+
+    /* Callers of this interface work on boFlowbits directly. */
+    if (flowdata && !flowdata->boFlowbits.pucBitBuffer && (flowbitsMakeDense(flowdata) != 0))
+        return NULL;
+
+    return flowdata;
+}
+
+/* Flowbits are not allocated with the session; most sessions never
+ * set one.  The bucket is taken from the pool on the first set and
+ * starts out in sparse form, without a bitmap. */
+static StreamFlowData *Stream5GetSparseFlowData(Packet *p, bool alloc)
+{
     Stream5LWSession *ssn = (Stream5LWSession*)p->ssnptr;
+    StreamFlowData *flowdata;
 
     if (!ssn)
         return NULL;
 
+    if (!ssn->flowdata)
+    {
+        if (!alloc)
+            return NULL;
+
+        ssn->flowdata = mempool_alloc(&s5FlowMempool);
+        if (!ssn->flowdata)
+            return NULL;
+
+        flowdata = (StreamFlowData *)ssn->flowdata->data;
+        flowdata->boFlowbits.pucBitBuffer = NULL;
+        flowdata->boFlowbits.uiBitBufferSize = 0;
+        flowdata->boFlowbits.uiMaxBits = 0;
+        flowdata->num_sparse = 0;
+        return flowdata;
+    }
+
     return (StreamFlowData *)ssn->flowdata->data;
 }
 
@@ -3175,6 +3245,22 @@ static void Stream5ForceSessionExpiration(void *ssnptr)
     }
 }
 
+/* Memory that other subsystems keep with a session is charged to the
+ * memcap, but unlike segments it is not worth pruning sessions for. */
+static int Stream5UpdateMemoryInUse(int32_t delta)
+{
+    if ((delta > 0) && s5_global_eval_config &&
+        ((mem_in_use + (uint32_t)delta) > s5_global_eval_config->memcap))
+    {
+        pc.str_mem_faults++;
+        sfBase.iStreamFaults++;
+        return -1;
+    }
+
+    mem_in_use += delta;
+    return 0;
+}
+
 #ifdef SNORT_RELOAD
 static void Stream5GlobalReload(struct _SnortConfig *sc, char *args, void **new_config)
 {
@@ -116,6 +116,8 @@ typedef enum {
 #define UNKNOWN_PORT 0
 
 #define STREAM_API_VERSION5 5
+#define STREAM_API_VERSION6 6
+#define STREAM_API_VERSION7 7
 
 typedef struct _StreamSessionKey
 {
@@ -130,6 +132,7 @@ typedef struct _StreamSessionKey
     uint32_t   mplsLabel; /* MPLS label */
     uint16_t   addressSpaceId;
     uint16_t   addressSpaceIdPad1;
+    uint32_t   tunnelId; /* GTP TEID - 0 unless enable_gtp_overlapping_ip */
 /* XXX If this data structure changes size, HashKeyCmp must be updated! */
 } StreamSessionKey;
 
@@ -151,10 +154,17 @@ typedef int (*StreamSegmentIterator)
      void *      /* user-defined data pointer */
     );
 
+/* Flowbits are kept as a short list of set bit ids until more than
+ * STREAM_FLOWBITS_SPARSE_MAX are set at once; only then is the bitmap
+ * allocated (see boInitBITOP) and boFlowbits pointed at it.
+ * get_flow_data always returns the bitmap form. */
+#define STREAM_FLOWBITS_SPARSE_MAX 6
+
 typedef struct _StreamFlowData
 {
-    BITOP boFlowbits;
-    unsigned char flowb[1];
+    BITOP boFlowbits;   /* pucBitBuffer is NULL while sparse */
+    uint16_t num_sparse;
+    uint16_t sparse_ids[STREAM_FLOWBITS_SPARSE_MAX];
 } StreamFlowData;
 
 // for protocol aware flushing (PAF):
@@ -703,12 +713,13 @@ typedef struct _stream_api
      *     VLAN ID
      *     MPLS ID
      *     Address Space ID
+     *     GTP TEID (0 if not tunneled)
      *     Preprocessor ID
      *
      * Returns
      *     Application Data reference (pointer)
      */
-    void *(*get_application_data_from_ip_port)(snort_ip_p, uint16_t, snort_ip_p, uint16_t, char, uint16_t, uint32_t, uint16_t, uint32_t);
+    void *(*get_application_data_from_ip_port)(snort_ip_p, uint16_t, snort_ip_p, uint16_t, char, uint16_t, uint32_t, uint16_t, uint32_t, uint32_t);
 
     //Register callbacks for extra data logging
     uint32_t (*reg_xtra_data_cb)(LogFunction );
@@ -742,11 +753,12 @@ typedef struct _stream_api
      *     VLAN ID
      *     MPLS ID
      *     Address Space ID
+     *     GTP TEID (0 if not tunneled)
      *
      * Returns
      *     Stream session pointer
      */
-    void *(*get_session_ptr_from_ip_port)(snort_ip_p, uint16_t, snort_ip_p, uint16_t, char, uint16_t, uint32_t, uint16_t);
+    void *(*get_session_ptr_from_ip_port)(snort_ip_p, uint16_t, snort_ip_p, uint16_t, char, uint16_t, uint32_t, uint16_t, uint32_t);
 
     /** Retrieve the session key given a stream session pointer.
      *
@@ -804,6 +816,30 @@ typedef struct _stream_api
      *     Session Ptr
      */
     void (*expire_session)(void *);
+
+    /* Get Flowbits data as it is kept, which may be the sparse list
+     *
+     * Parameters
+     *     Packet
+     *     Allocate the flowbits if none have been set on the session
+     *
+     * Returns
+     *     Ptr to Flowbits Data
+     *     NULL if there is no session or no flowbits memory, or if
+     *       nothing has been set yet and no allocation was asked for
+     */
+    StreamFlowData *(*get_sparse_flow_data)(Packet *p, bool alloc);
+
+    /* Account for session memory allocated outside of Stream5
+     *
+     * Parameters
+     *     Bytes allocated (positive) or freed (negative)
+     *
+     * Returns
+     *     0 success
+     *     -1 the Stream5 memcap would be exceeded; nothing is accounted
+     */
+    int (*update_memory_in_use)(int32_t);
 } StreamAPI;
 
 /* To be set by Stream5 */
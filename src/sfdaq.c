@@ -30,6 +30,7 @@
 #endif
 
 #include "sfdaq.h"
+#include "sfdaq_mmap.h"
 #include "snort.h"
 #include "util.h"
 #include "sfutil/strvec.h"
@@ -61,7 +62,12 @@ static int loaded = 0;
 static int s_error = DAQ_SUCCESS;
 static DAQ_Stats_t daq_stats, tot_stats;
 
+// --daq mmap selects the built-in reader in sfdaq_mmap.c instead of a
+// DAQ module; daq_hand is then the MmapDaq and daq_mod is NULL
+static int use_mmap = 0;
+
 static void DAQ_Accumulate(void);
+static const char* DAQ_GetError(void);
 
 //--------------------------------------------------------------------
 
@@ -118,6 +124,8 @@ int DAQ_PrintTypes (FILE* f)
         fprintf(f, "\n");
     }
     daq_free_module_list(list, nMods);
+
+    fprintf(f, "%s(builtin): readback inline unpriv\n", MMAP_DAQ_NAME);
     return 0;
 }
 
@@ -166,9 +174,17 @@ DAQ_Mode DAQ_GetMode (const SnortConfig* sc)
 
 //--------------------------------------------------------------------
 
+static uint32_t DAQ_GetCapabilities (void)
+{
+    if ( use_mmap )
+        return MMAP_DAQ_CAPS;
+
+    return daq_get_capabilities(daq_mod, daq_hand);
+}
+
 static int DAQ_ValidateModule (DAQ_Mode mode)
 {
-    uint32_t have = daq_get_type(daq_mod);
+    uint32_t have = use_mmap ? MMAP_DAQ_TYPE : daq_get_type(daq_mod);
     uint32_t need = 0;
 
     if ( mode == DAQ_MODE_READ_FILE )
@@ -185,7 +201,7 @@ static int DAQ_ValidateModule (DAQ_Mode mode)
 
 static int DAQ_ValidateInstance ()
 {
-    uint32_t caps = daq_get_capabilities(daq_mod, daq_hand);
+    uint32_t caps = DAQ_GetCapabilities();
 
     if ( !ScAdapterInlineMode() )
         return 1;
@@ -242,15 +258,22 @@ static void DAQ_PostControl(uint16_t type, void *old_config, struct _THREAD_ELEM
 void DAQ_Init (const SnortConfig* sc)
 {
     const char* type = DAQ_DEFAULT;
-    if ( !loaded )
-        DAQ_Load(sc);
 
     if ( sc->daq_type ) type = sc->daq_type;
 
-    daq_mod = daq_find_module(type);
+    if ( !strcasecmp(type, MMAP_DAQ_NAME) )
+        use_mmap = 1;
 
-    if ( !daq_mod )
-        FatalError("Can't find %s DAQ!\n", type);
+    else
+    {
+        if ( !loaded )
+            DAQ_Load(sc);
+
+        daq_mod = daq_find_module(type);
+
+        if ( !daq_mod )
+            FatalError("Can't find %s DAQ!\n", type);
+    }
 
     snap = ( sc->pkt_snaplen > 0 ) ? sc->pkt_snaplen : PKT_SNAPLEN;
     daq_mode = DAQ_GetMode(sc);
@@ -304,6 +327,9 @@ const char* DAQ_GetInterfaceSpec (void)
 
 const char* DAQ_GetType(void)
 {
+    if ( use_mmap )
+        return MMAP_DAQ_NAME;
+
     return daq_mod ? daq_get_name(daq_mod) : "error";
 }
 
@@ -327,28 +353,31 @@ int DAQ_GetBaseProtocol (void)
 
 int DAQ_Unprivileged (void)
 {
+    if ( use_mmap )
+        return 1;
+
     return !( daq_get_type(daq_mod) & DAQ_TYPE_NO_UNPRIV );
 }
 
 int DAQ_UnprivilegedStart (void)
 {
-    return ( daq_get_capabilities(daq_mod, daq_hand) & DAQ_CAPA_UNPRIV_START );
+    return ( DAQ_GetCapabilities() & DAQ_CAPA_UNPRIV_START );
 }
 
 int DAQ_CanReplace (void)
 {
-    return ( daq_get_capabilities(daq_mod, daq_hand) & DAQ_CAPA_REPLACE );
+    return ( DAQ_GetCapabilities() & DAQ_CAPA_REPLACE );
 }
 
 int DAQ_CanInject (void)
 {
-    return ( daq_get_capabilities(daq_mod, daq_hand) & DAQ_CAPA_INJECT );
+    return ( DAQ_GetCapabilities() & DAQ_CAPA_INJECT );
 }
 
 int DAQ_CanWhitelist (void)
 {
 #ifdef DAQ_CAPA_WHITELIST
-    return ( daq_get_capabilities(daq_mod, daq_hand) & DAQ_CAPA_WHITELIST );
+    return ( DAQ_GetCapabilities() & DAQ_CAPA_WHITELIST );
 #else
     return 0;
 #endif
@@ -357,25 +386,38 @@ int DAQ_CanWhitelist (void)
 
 int DAQ_RawInjection (void)
 {
-    return ( daq_get_capabilities(daq_mod, daq_hand) & DAQ_CAPA_INJECT_RAW );
+    return ( DAQ_GetCapabilities() & DAQ_CAPA_INJECT_RAW );
 }
 
 int DAQ_SetFilter(const char* bpf)
 {
     int err = 0;
 
-    if ( bpf )
+    if ( !bpf )
+        return 0;
+
+    if ( use_mmap )
+        err = MmapDaq_SetFilter((MmapDaq*)daq_hand, bpf);
+    else
         err = daq_set_filter(daq_mod, daq_hand, bpf);
 
     if ( err )
         FatalError("Can't set DAQ BPF filter to '%s' (%s)!\n",
-            bpf, daq_get_error(daq_mod, daq_hand));
+            bpf, DAQ_GetError());
 
     return err;
 }
 
 //--------------------------------------------------------------------
 
+static const char* DAQ_GetError (void)
+{
+    if ( use_mmap )
+        return MmapDaq_GetError((MmapDaq*)daq_hand);
+
+    return daq_get_error(daq_mod, daq_hand);
+}
+
 static void DAQ_LoadVars (DAQ_Config_t* cfg, const SnortConfig* sc)
 {
     unsigned i = 0;
@@ -420,19 +462,72 @@ static int DAQ_Config (DAQ_Config_t* cfg)
     return err;
 }
 
+// the only variable is prefetch=<megabytes> to read ahead with madvise()
+static size_t DAQ_MmapPrefetch (const SnortConfig* sc)
+{
+    unsigned i = 0;
+    size_t prefetch = 0;
+    char* key;
+
+    while ( (key = StringVector_Get(sc->daq_vars, i++)) )
+    {
+        char* end = NULL;
+        unsigned long mb;
+
+        if ( strncasecmp(key, "prefetch=", 9) )
+        {
+            LogMessage("WARNING: %s DAQ ignoring variable '%s'.\n",
+                MMAP_DAQ_NAME, key);
+            continue;
+        }
+        mb = strtoul(key + 9, &end, 10);
+
+        if ( !*(key + 9) || *end || mb > 4096 )
+            FatalError("Bad %s DAQ variable '%s' (prefetch=0..4096).\n",
+                MMAP_DAQ_NAME, key);
+
+        prefetch = (size_t)mb << 20;
+    }
+    return prefetch;
+}
+
+static void DAQ_NewMmap (const SnortConfig* sc, const char* intf)
+{
+    char buf[256] = "";
+
+    if ( !*intf || !strcmp(intf, "-") )
+        FatalError("%s DAQ can't read from stdin.\n", MMAP_DAQ_NAME);
+
+    daq_hand = MmapDaq_New(intf, snap, DAQ_MmapPrefetch(sc), buf, sizeof(buf));
+
+    if ( !daq_hand )
+        FatalError("Can't initialize DAQ %s - %s\n", MMAP_DAQ_NAME, buf);
+
+    daq_dlt = MmapDaq_GetDatalinkType((MmapDaq*)daq_hand);
+    LogMessage("Acquiring network traffic from \"%s\".\n", intf);
+
+    DAQ_SetFilter(sc->bpf_filter);
+}
+
 //--------------------------------------------------------------------
 
 int DAQ_New (const SnortConfig* sc, const char* intf)
 {
     DAQ_Config_t cfg;
 
-    if ( !daq_mod )
+    if ( !daq_mod && !use_mmap )
         FatalError("DAQ_Init not called!\n");
 
     if ( intf )
         interface_spec = SnortStrdup(intf);
     intf = DAQ_GetInterfaceSpec();
 
+    if ( use_mmap )
+    {
+        DAQ_NewMmap(sc, intf);
+        return 0;
+    }
+
     memset(&cfg, 0, sizeof(cfg));
     cfg.name = (char*)intf;
     cfg.snaplen = snap;
@@ -473,7 +568,12 @@ int DAQ_Delete(void)
     if ( daq_hand )
     {
         DAQ_Accumulate();
-        daq_shutdown(daq_mod, daq_hand);
+
+        if ( use_mmap )
+            MmapDaq_Delete((MmapDaq*)daq_hand);
+        else
+            daq_shutdown(daq_mod, daq_hand);
+
         daq_hand = NULL;
     }
     if ( interface_spec )
@@ -488,11 +588,16 @@ int DAQ_Delete(void)
 
 int DAQ_Start ()
 {
-    int err = daq_start(daq_mod, daq_hand);
+    int err;
+
+    if ( use_mmap )
+        return MmapDaq_Start((MmapDaq*)daq_hand);
+
+    err = daq_start(daq_mod, daq_hand);
 
     if ( err )
         FatalError("Can't start DAQ (%d) - %s!\n",
-            err, daq_get_error(daq_mod, daq_hand));
+            err, DAQ_GetError());
 
     else if ( !DAQ_UnprivilegedStart() )
         daq_dlt = daq_get_datalink_type(daq_mod, daq_hand);
@@ -504,21 +609,33 @@ int DAQ_WasStarted (void)
 {
     DAQ_State s;
 
-    if ( !daq_mod || !daq_hand )
+    if ( !daq_hand )
         return 0;
 
-    s = daq_check_status(daq_mod, daq_hand);
+    if ( use_mmap )
+        s = MmapDaq_CheckStatus((MmapDaq*)daq_hand);
+
+    else if ( daq_mod )
+        s = daq_check_status(daq_mod, daq_hand);
+
+    else
+        return 0;
 
     return ( DAQ_STATE_STARTED == s );
 }
 
 int DAQ_Stop ()
 {
-    int err = daq_stop(daq_mod, daq_hand);
+    int err;
+
+    if ( use_mmap )
+        return MmapDaq_Stop((MmapDaq*)daq_hand);
+
+    err = daq_stop(daq_mod, daq_hand);
 
     if ( err )
         LogMessage("Can't stop DAQ (%d) - %s!\n",
-            err, daq_get_error(daq_mod, daq_hand));
+            err, DAQ_GetError());
 
     return err;
 }
@@ -535,15 +652,20 @@ void DAQ_Set_MetaCallback(DAQ_Meta_Func_t meta_callback)
 
 int DAQ_Acquire (int max, DAQ_Analysis_Func_t callback, uint8_t* user)
 {
+    int err;
+
+    if ( use_mmap )
+        err = MmapDaq_Acquire((MmapDaq*)daq_hand, max, callback, user);
+    else
 #if HAVE_DAQ_ACQUIRE_WITH_META
-    int err = daq_acquire_with_meta(daq_mod, daq_hand, max, callback, daq_meta_callback, user);
+        err = daq_acquire_with_meta(daq_mod, daq_hand, max, callback, daq_meta_callback, user);
 #else
-    int err = daq_acquire(daq_mod, daq_hand, max, callback, user);
+        err = daq_acquire(daq_mod, daq_hand, max, callback, user);
 #endif
 
     if ( err && err != DAQ_READFILE_EOF )
         LogMessage("Can't acquire (%d) - %s!\n",
-            err, daq_get_error(daq_mod, daq_hand));
+            err, DAQ_GetError());
 
     if ( s_error != DAQ_SUCCESS )
     {
@@ -555,11 +677,16 @@ int DAQ_Acquire (int max, DAQ_Analysis_Func_t callback, uint8_t* user)
 
 int DAQ_Inject(const DAQ_PktHdr_t* h, int rev, const uint8_t* buf, uint32_t len)
 {
-    int err = daq_inject(daq_mod, daq_hand, (DAQ_PktHdr_t*)h, buf, len, rev);
+    int err;
+
+    if ( use_mmap )
+        return DAQ_ERROR_NOTSUP;
+
+    err = daq_inject(daq_mod, daq_hand, (DAQ_PktHdr_t*)h, buf, len, rev);
 #ifdef DEBUG
     if ( err )
         LogMessage("Can't inject (%d) - %s!\n",
-            err, daq_get_error(daq_mod, daq_hand));
+            err, DAQ_GetError());
 #endif
     return err;
 }
@@ -567,6 +694,10 @@ int DAQ_Inject(const DAQ_PktHdr_t* h, int rev, const uint8_t* buf, uint32_t len)
 int DAQ_BreakLoop (int error)
 {
     s_error = error;
+
+    if ( use_mmap )
+        return ( MmapDaq_BreakLoop((MmapDaq*)daq_hand) == DAQ_SUCCESS );
+
     return ( daq_breakloop(daq_mod, daq_hand) == DAQ_SUCCESS );
 }
 
@@ -598,11 +729,14 @@ const DAQ_Stats_t* DAQ_GetStats (void)
     if ( !daq_hand )
         return &daq_stats;
 
-    err = daq_get_stats(daq_mod, daq_hand, &daq_stats);
+    if ( use_mmap )
+        err = MmapDaq_GetStats((MmapDaq*)daq_hand, &daq_stats);
+    else
+        err = daq_get_stats(daq_mod, daq_hand, &daq_stats);
 
     if ( err )
         LogMessage("Can't get DAQ stats (%d) - %s!\n",
-            err, daq_get_error(daq_mod, daq_hand));
+            err, DAQ_GetError());
 
     if ( !daq_stats.hw_packets_received )
         // some DAQs don't provide hw numbers
@@ -614,6 +748,12 @@ const DAQ_Stats_t* DAQ_GetStats (void)
     return &daq_stats;
 }
 
+void DAQ_SetStats (const DAQ_Stats_t* ps)
+{
+    tot_stats = *ps;
+    daq_stats = *ps;
+}
+
 //--------------------------------------------------------------------
 
 int DAQ_ModifyFlow(const void* h, uint32_t id)
@@ -622,6 +762,9 @@ int DAQ_ModifyFlow(const void* h, uint32_t id)
     const DAQ_PktHdr_t *hdr = (DAQ_PktHdr_t*) h;
     DAQ_ModFlow_t mod;
 
+    if ( use_mmap )
+        return -1;
+
     mod.opaque = id;
     return daq_modify_flow(daq_mod, daq_hand, hdr, &mod);
 #else
@@ -86,5 +86,8 @@ static inline uint16_t DAQ_GetAddressSpaceID(const DAQ_PktHdr_t *h)
 // returns statically allocated stats - don't free
 const DAQ_Stats_t* DAQ_GetStats(void);
 
+// replaces the stats reported after the DAQ is gone (pcap workers)
+void DAQ_SetStats(const DAQ_Stats_t*);
+
 #endif // __DAQ_H__
 
@@ -0,0 +1,781 @@
+/****************************************************************************
+ *
+ * Copyright (C) 2013 Sourcefire, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 2 as
+ * published by the Free Software Foundation.  You may not use, modify or
+ * distribute this program under any other version of the GNU General
+ * Public License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ ****************************************************************************/
+
+// @file    sfdaq_mmap.c
+
+// Reads classic pcap files (either byte order, micro or nanosecond time
+// stamps) and pcapng files (enhanced, simple and obsolete packet blocks
+// from any number of sections).  All packets must have the same link
+// type since Snort decodes everything with one base protocol.
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <pcap.h>
+
+#ifndef WIN32
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+#include "sfdaq_mmap.h"
+
+#define PCAP_MAGIC          0xa1b2c3d4
+#define PCAP_MAGIC_NSEC     0xa1b23c4d
+#define PCAP_HDR_LEN        24
+#define PCAP_REC_LEN        16
+
+#define PCAPNG_SHB          0x0a0d0d0a
+#define PCAPNG_IDB          0x00000001
+#define PCAPNG_OPB          0x00000002
+#define PCAPNG_SPB          0x00000003
+#define PCAPNG_EPB          0x00000006
+#define PCAPNG_BOM          0x1a2b3c4d
+#define PCAPNG_MIN_BLOCK    12
+#define PCAPNG_OPT_TSRESOL  9
+
+// same bound libpcap applies to record lengths; anything larger means
+// the file is corrupt
+#define MMAP_MAX_CAPLEN     0x40000
+
+#define LINKTYPE_RAW        101
+#define LINKTYPE_LOOP       108
+
+#define SWAP16(v) ((uint16_t)(((v) >> 8) | ((v) << 8)))
+#define SWAP32(v) \
+    ((((v) >> 24) & 0xff) | (((v) >> 8) & 0xff00) | \
+     (((v) & 0xff00) << 8) | (((v) & 0xff) << 24))
+
+typedef struct
+{
+    int dlt;
+    uint32_t snaplen;
+    uint64_t units;     // time stamp ticks per second
+} MmapIntf;
+
+struct _MmapDaq
+{
+    const uint8_t* base;
+    size_t size;
+    size_t pos;         // offset of the next record or block
+    size_t advised;     // prefetch again when pos gets here
+    size_t released;    // pages before this were given back
+    size_t prefetch;
+    size_t page;
+
+    int (*next)(MmapDaq*, DAQ_PktHdr_t*, const uint8_t**);
+
+    int swap;
+    int dlt;
+    uint32_t snaplen;
+    uint64_t units;     // classic pcap ticks per second
+
+    MmapIntf* intf;     // interfaces of the current pcapng section
+    unsigned num_intf;
+    unsigned max_intf;
+    struct timeval last;
+
+    struct bpf_program fcode;
+    int filter;
+
+#ifdef WORDS_MUSTALIGN
+    uint8_t* buf;
+#endif
+
+    volatile int brk;
+    DAQ_State state;
+    DAQ_Stats_t stats;
+    char error[256];
+};
+
+//--------------------------------------------------------------------
+// helpers
+//--------------------------------------------------------------------
+
+static int MmapDaq_Error (MmapDaq* m, const char* fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(m->error, sizeof(m->error), fmt, ap);
+    va_end(ap);
+    return -1;
+}
+
+static inline uint16_t MmapDaq_Get16 (const MmapDaq* m, const uint8_t* p)
+{
+    uint16_t v;
+    memcpy(&v, p, sizeof(v));
+    return m->swap ? SWAP16(v) : v;
+}
+
+static inline uint32_t MmapDaq_Get32 (const MmapDaq* m, const uint8_t* p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return m->swap ? SWAP32(v) : v;
+}
+
+// the file holds LINKTYPE_ values; these match the DLT_ values Snort
+// decodes except for the few that libpcap translates
+static int MmapDaq_GetDlt (uint32_t linktype)
+{
+    switch ( linktype )
+    {
+    case LINKTYPE_RAW:
+        return DLT_RAW;
+    case LINKTYPE_LOOP:
+        return DLT_LOOP;
+    }
+    return (int)linktype;
+}
+
+static void MmapDaq_SetTime (struct timeval* tv, uint64_t t, uint64_t units)
+{
+    uint64_t frac = t % units;
+    tv->tv_sec = (time_t)(t / units);
+
+    if ( units <= 1000000 )
+        tv->tv_usec = (long)(frac * 1000000 / units);
+
+    else if ( !(units % 1000000) )
+        tv->tv_usec = (long)(frac / (units / 1000000));
+
+    else
+        tv->tv_usec = (long)((double)frac * 1000000 / units);
+}
+
+//--------------------------------------------------------------------
+// classic pcap
+//--------------------------------------------------------------------
+
+static int MmapDaq_NextPcap (
+    MmapDaq* m, DAQ_PktHdr_t* h, const uint8_t** data)
+{
+    const uint8_t* p = m->base + m->pos;
+    size_t left = m->size - m->pos;
+    uint64_t t;
+
+    if ( !left )
+        return 0;
+
+    if ( left < PCAP_REC_LEN )
+        return MmapDaq_Error(m, "truncated packet header at %lu",
+            (unsigned long)m->pos);
+
+    h->caplen = MmapDaq_Get32(m, p + 8);
+    h->pktlen = MmapDaq_Get32(m, p + 12);
+
+    if ( h->caplen > MMAP_MAX_CAPLEN )
+        return MmapDaq_Error(m, "bogus caplen %u at %lu",
+            h->caplen, (unsigned long)m->pos);
+
+    if ( h->caplen > left - PCAP_REC_LEN )
+        return MmapDaq_Error(m, "truncated packet at %lu",
+            (unsigned long)m->pos);
+
+    t = (uint64_t)MmapDaq_Get32(m, p) * m->units + MmapDaq_Get32(m, p + 4);
+    MmapDaq_SetTime(&h->ts, t, m->units);
+
+    *data = p + PCAP_REC_LEN;
+    m->pos += PCAP_REC_LEN + h->caplen;
+    return 1;
+}
+
+static int MmapDaq_OpenPcap (MmapDaq* m)
+{
+    uint32_t magic;
+
+    memcpy(&magic, m->base, sizeof(magic));
+
+    if ( magic == SWAP32(PCAP_MAGIC) || magic == SWAP32(PCAP_MAGIC_NSEC) )
+    {
+        m->swap = 1;
+        magic = SWAP32(magic);
+    }
+    m->units = (magic == PCAP_MAGIC_NSEC) ? 1000000000 : 1000000;
+    m->snaplen = MmapDaq_Get32(m, m->base + 16);
+    m->dlt = MmapDaq_GetDlt(MmapDaq_Get32(m, m->base + 20) & 0x0fffffff);
+
+    m->pos = PCAP_HDR_LEN;
+    m->next = MmapDaq_NextPcap;
+    return 0;
+}
+
+//--------------------------------------------------------------------
+// pcapng
+//--------------------------------------------------------------------
+
+static int MmapDaq_Section (MmapDaq* m, const uint8_t* p, size_t left)
+{
+    uint32_t bom;
+
+    if ( left < PCAPNG_MIN_BLOCK )
+        return MmapDaq_Error(m, "truncated section header at %lu",
+            (unsigned long)m->pos);
+
+    memcpy(&bom, p + 8, sizeof(bom));
+
+    if ( bom == PCAPNG_BOM )
+        m->swap = 0;
+
+    else if ( bom == SWAP32(PCAPNG_BOM) )
+        m->swap = 1;
+
+    else
+        return MmapDaq_Error(m, "bad byte order magic at %lu",
+            (unsigned long)m->pos);
+
+    // interface ids are per section
+    m->num_intf = 0;
+    return 0;
+}
+
+static int MmapDaq_Interface (MmapDaq* m, const uint8_t* p, uint32_t len)
+{
+    MmapIntf* intf;
+    uint32_t off = 8;
+
+    if ( len < 8 )
+        return MmapDaq_Error(m, "short interface block at %lu",
+            (unsigned long)m->pos);
+
+    if ( m->num_intf == m->max_intf )
+    {
+        unsigned max = m->max_intf ? 2 * m->max_intf : 4;
+        intf = (MmapIntf*)realloc(m->intf, max * sizeof(*intf));
+
+        if ( !intf )
+            return MmapDaq_Error(m, "can't allocate interfaces");
+
+        m->intf = intf;
+        m->max_intf = max;
+    }
+    intf = m->intf + m->num_intf++;
+
+    intf->dlt = MmapDaq_GetDlt(MmapDaq_Get16(m, p));
+    intf->snaplen = MmapDaq_Get32(m, p + 4);
+    intf->units = 1000000;
+
+    while ( off + 4 <= len )
+    {
+        uint16_t code = MmapDaq_Get16(m, p + off);
+        uint16_t olen = MmapDaq_Get16(m, p + off + 2);
+        off += 4;
+
+        if ( !code || olen > len - off )
+            break;
+
+        if ( code == PCAPNG_OPT_TSRESOL && olen >= 1 )
+        {
+            uint8_t res = p[off];
+            unsigned exp = res & 0x7f;
+
+            if ( res & 0x80 )
+                intf->units = (exp < 64) ? ((uint64_t)1 << exp) : 0;
+
+            else if ( exp < 20 )
+            {
+                intf->units = 1;
+                while ( exp-- )
+                    intf->units *= 10;
+            }
+            else
+                intf->units = 0;
+
+            if ( !intf->units )
+                return MmapDaq_Error(m, "unsupported time stamp resolution "
+                    "0x%02x at %lu", res, (unsigned long)m->pos);
+        }
+        off += (olen + 3) & ~3;
+    }
+
+    if ( m->dlt < 0 )
+    {
+        m->dlt = intf->dlt;
+        m->snaplen = intf->snaplen;
+    }
+    else if ( intf->dlt != m->dlt )
+        return MmapDaq_Error(m, "link type %d differs from the first "
+            "interface (%d)", intf->dlt, m->dlt);
+
+    return 0;
+}
+
+// returns the interface for id or NULL after setting the error
+static const MmapIntf* MmapDaq_GetIntf (MmapDaq* m, uint32_t id, size_t at)
+{
+    if ( id < m->num_intf )
+        return m->intf + id;
+
+    MmapDaq_Error(m, "packet block at %lu refers to undefined "
+        "interface %u", (unsigned long)at, id);
+    return NULL;
+}
+
+static int MmapDaq_Short (MmapDaq* m, size_t at)
+{
+    return MmapDaq_Error(m, "short packet block at %lu", (unsigned long)at);
+}
+
+static int MmapDaq_NextPcapng (
+    MmapDaq* m, DAQ_PktHdr_t* h, const uint8_t** data)
+{
+    while ( 1 )
+    {
+        const uint8_t* p = m->base + m->pos;
+        size_t left = m->size - m->pos;
+        size_t at = m->pos;
+        const MmapIntf* intf;
+        uint32_t type, len, max;
+        uint64_t t = 0;
+
+        if ( !left )
+            return 0;
+
+        if ( left < PCAPNG_MIN_BLOCK )
+            return MmapDaq_Error(m, "truncated block at %lu",
+                (unsigned long)at);
+
+        memcpy(&type, p, sizeof(type));
+
+        // the section header sets the byte order for everything that
+        // follows, including its own length
+        if ( type == PCAPNG_SHB && MmapDaq_Section(m, p, left) )
+            return -1;
+
+        type = MmapDaq_Get32(m, p);
+        len = MmapDaq_Get32(m, p + 4);
+
+        if ( len < PCAPNG_MIN_BLOCK || (len & 3) )
+            return MmapDaq_Error(m, "bad block length %u at %lu",
+                len, (unsigned long)at);
+
+        if ( len > left )
+            return MmapDaq_Error(m, "truncated block at %lu",
+                (unsigned long)at);
+
+        m->pos += len;
+        len -= PCAPNG_MIN_BLOCK;
+        p += 8;
+
+        switch ( type )
+        {
+        case PCAPNG_IDB:
+            if ( MmapDaq_Interface(m, p, len) )
+                return -1;
+            continue;
+
+        case PCAPNG_EPB:
+            if ( len < 20 )
+                return MmapDaq_Short(m, at);
+
+            if ( !(intf = MmapDaq_GetIntf(m, MmapDaq_Get32(m, p), at)) )
+                return -1;
+
+            t = ((uint64_t)MmapDaq_Get32(m, p + 4) << 32) |
+                MmapDaq_Get32(m, p + 8);
+            h->caplen = MmapDaq_Get32(m, p + 12);
+            h->pktlen = MmapDaq_Get32(m, p + 16);
+            max = len - 20;
+            *data = p + 20;
+            break;
+
+        case PCAPNG_OPB:
+            if ( len < 20 )
+                return MmapDaq_Short(m, at);
+
+            if ( !(intf = MmapDaq_GetIntf(m, MmapDaq_Get16(m, p), at)) )
+                return -1;
+
+            t = ((uint64_t)MmapDaq_Get32(m, p + 4) << 32) |
+                MmapDaq_Get32(m, p + 8);
+            h->caplen = MmapDaq_Get32(m, p + 12);
+            h->pktlen = MmapDaq_Get32(m, p + 16);
+            max = len - 20;
+            *data = p + 20;
+            break;
+
+        case PCAPNG_SPB:
+            if ( len < 4 )
+                return MmapDaq_Short(m, at);
+
+            if ( !(intf = MmapDaq_GetIntf(m, 0, at)) )
+                return -1;
+
+            // simple packets have no time stamp; keep the last one
+            h->ts = m->last;
+            h->pktlen = MmapDaq_Get32(m, p);
+            h->caplen = h->pktlen;
+
+            if ( intf->snaplen && h->caplen > intf->snaplen )
+                h->caplen = intf->snaplen;
+
+            max = len - 4;
+
+            if ( h->caplen > max )
+                h->caplen = max;
+
+            *data = p + 4;
+            break;
+
+        default:
+            // statistics, name resolution, custom blocks, etc.
+            continue;
+        }
+
+        if ( h->caplen > max || h->caplen > MMAP_MAX_CAPLEN )
+            return MmapDaq_Error(m, "bogus caplen %u at %lu",
+                h->caplen, (unsigned long)at);
+
+        if ( intf->dlt != m->dlt )
+            return MmapDaq_Error(m, "link type %d at %lu differs from the "
+                "first interface (%d)", intf->dlt, (unsigned long)at, m->dlt);
+
+        if ( type != PCAPNG_SPB )
+        {
+            MmapDaq_SetTime(&h->ts, t, intf->units);
+            m->last = h->ts;
+        }
+        return 1;
+    }
+}
+
+static int MmapDaq_OpenPcapng (MmapDaq* m)
+{
+    m->dlt = -1;
+    m->next = MmapDaq_NextPcapng;
+
+    // the link type must be known before the first packet is read so
+    // process the leading section and interface blocks now
+    while ( m->dlt < 0 && m->pos < m->size )
+    {
+        const uint8_t* p = m->base + m->pos;
+        size_t left = m->size - m->pos;
+        uint32_t type, len;
+
+        if ( left < PCAPNG_MIN_BLOCK )
+            break;
+
+        memcpy(&type, p, sizeof(type));
+
+        if ( type == PCAPNG_SHB && MmapDaq_Section(m, p, left) )
+            return -1;
+
+        type = MmapDaq_Get32(m, p);
+        len = MmapDaq_Get32(m, p + 4);
+
+        if ( (type != PCAPNG_SHB && type != PCAPNG_IDB) ||
+            len < PCAPNG_MIN_BLOCK || (len & 3) || len > left )
+            break;
+
+        m->pos += len;
+
+        if ( type == PCAPNG_IDB &&
+            MmapDaq_Interface(m, p + 8, len - PCAPNG_MIN_BLOCK) )
+            return -1;
+    }
+    if ( m->dlt < 0 )
+        return MmapDaq_Error(m, "no interface description precedes "
+            "the first packet");
+
+    return 0;
+}
+
+//--------------------------------------------------------------------
+// mapping
+//--------------------------------------------------------------------
+
+#ifndef WIN32
+static int MmapDaq_Map (MmapDaq* m, const char* file)
+{
+    struct stat st;
+    void* map;
+    int fd = open(file, O_RDONLY);
+
+    if ( fd < 0 )
+        return MmapDaq_Error(m, "can't open %s: %s", file, strerror(errno));
+
+    if ( fstat(fd, &st) || !S_ISREG(st.st_mode) )
+    {
+        close(fd);
+        return MmapDaq_Error(m, "%s is not a regular file", file);
+    }
+    if ( (uint64_t)st.st_size > (size_t)-1 )
+    {
+        close(fd);
+        return MmapDaq_Error(m, "%s is too large to map", file);
+    }
+    m->size = (size_t)st.st_size;
+
+    if ( !m->size )
+    {
+        close(fd);
+        return MmapDaq_Error(m, "%s is empty", file);
+    }
+    // private and writable so in place changes never reach the file
+    map = mmap(NULL, m->size, PROT_READ|PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if ( map == MAP_FAILED )
+        return MmapDaq_Error(m, "can't map %s: %s", file, strerror(errno));
+
+    madvise(map, m->size, MADV_SEQUENTIAL);
+
+    m->base = (const uint8_t*)map;
+    m->page = (size_t)sysconf(_SC_PAGESIZE);
+    return 0;
+}
+
+static void MmapDaq_Unmap (MmapDaq* m)
+{
+    if ( m->base )
+        munmap((void*)m->base, m->size);
+
+    m->base = NULL;
+}
+
+// ask for the next window to be read in and drop the pages behind the
+// current packet so a long run doesn't crowd out everything else
+static void MmapDaq_Advise (MmapDaq* m)
+{
+    size_t start = m->pos & ~(m->page - 1);
+    size_t len = m->prefetch;
+
+    if ( len > m->size - start )
+        len = m->size - start;
+
+    madvise((void*)(m->base + start), len, MADV_WILLNEED);
+
+    if ( start > m->released )
+    {
+        madvise((void*)(m->base + m->released), start - m->released,
+            MADV_DONTNEED);
+        m->released = start;
+    }
+    m->advised = start + len / 2;
+}
+
+#else
+static int MmapDaq_Map (MmapDaq* m, const char* file)
+{
+    return MmapDaq_Error(m, "mmap DAQ is not supported on this platform");
+}
+
+static void MmapDaq_Unmap (MmapDaq* m) { }
+static void MmapDaq_Advise (MmapDaq* m) { }
+#endif
+
+//--------------------------------------------------------------------
+// api
+//--------------------------------------------------------------------
+
+MmapDaq* MmapDaq_New (
+    const char* file, uint32_t snaplen, size_t prefetch, char* errbuf, size_t len)
+{
+    uint32_t magic;
+    int err;
+    MmapDaq* m = (MmapDaq*)calloc(1, sizeof(*m));
+
+    if ( !m )
+    {
+        snprintf(errbuf, len, "can't allocate mmap DAQ");
+        return NULL;
+    }
+    m->state = DAQ_STATE_UNINITIALIZED;
+
+    err = MmapDaq_Map(m, file);
+
+    if ( !err && m->size < PCAP_HDR_LEN )
+        err = MmapDaq_Error(m, "%s is too short for a capture file", file);
+
+    if ( !err )
+    {
+        memcpy(&magic, m->base, sizeof(magic));
+
+        if ( magic == PCAPNG_SHB )
+            err = MmapDaq_OpenPcapng(m);
+
+        else if ( magic == PCAP_MAGIC || magic == PCAP_MAGIC_NSEC ||
+            magic == SWAP32(PCAP_MAGIC) || magic == SWAP32(PCAP_MAGIC_NSEC) )
+            err = MmapDaq_OpenPcap(m);
+
+        else
+            err = MmapDaq_Error(m, "%s is not a pcap or pcapng file", file);
+    }
+#ifdef WORDS_MUSTALIGN
+    if ( !err && !(m->buf = (uint8_t*)malloc(MMAP_MAX_CAPLEN)) )
+        err = MmapDaq_Error(m, "can't allocate packet buffer");
+#endif
+
+    if ( err )
+    {
+        snprintf(errbuf, len, "%s", m->error);
+        MmapDaq_Delete(m);
+        return NULL;
+    }
+    if ( prefetch )
+    {
+        m->prefetch = (prefetch + m->page - 1) & ~(m->page - 1);
+        m->advised = m->pos;
+    }
+    if ( !m->snaplen || m->snaplen > snaplen )
+        m->snaplen = snaplen;
+
+    m->state = DAQ_STATE_INITIALIZED;
+    return m;
+}
+
+void MmapDaq_Delete (MmapDaq* m)
+{
+    if ( m->filter )
+        pcap_freecode(&m->fcode);
+
+    MmapDaq_Unmap(m);
+
+#ifdef WORDS_MUSTALIGN
+    if ( m->buf )
+        free(m->buf);
+#endif
+    if ( m->intf )
+        free(m->intf);
+
+    free(m);
+}
+
+int MmapDaq_SetFilter (MmapDaq* m, const char* bpf)
+{
+    struct bpf_program fcode;
+
+    if ( pcap_compile_nopcap(
+        (int)m->snaplen, m->dlt, &fcode, (char*)bpf, 1, 0) < 0 )
+    {
+        MmapDaq_Error(m, "can't compile filter for link type %d", m->dlt);
+        return DAQ_ERROR;
+    }
+    if ( m->filter )
+        pcap_freecode(&m->fcode);
+
+    m->fcode = fcode;
+    m->filter = 1;
+    return DAQ_SUCCESS;
+}
+
+int MmapDaq_Start (MmapDaq* m)
+{
+    m->state = DAQ_STATE_STARTED;
+    return DAQ_SUCCESS;
+}
+
+int MmapDaq_Stop (MmapDaq* m)
+{
+    m->state = DAQ_STATE_STOPPED;
+    return DAQ_SUCCESS;
+}
+
+int MmapDaq_BreakLoop (MmapDaq* m)
+{
+    m->brk = 1;
+    return DAQ_SUCCESS;
+}
+
+int MmapDaq_Acquire (
+    MmapDaq* m, int max, DAQ_Analysis_Func_t callback, void* user)
+{
+    DAQ_PktHdr_t h;
+    const uint8_t* data;
+    int n = 0;
+
+    memset(&h, 0, sizeof(h));
+    h.ingress_index = DAQ_PKTHDR_UNKNOWN;
+    h.egress_index = DAQ_PKTHDR_UNKNOWN;
+    h.ingress_group = DAQ_PKTHDR_UNKNOWN;
+    h.egress_group = DAQ_PKTHDR_UNKNOWN;
+
+    m->brk = 0;
+
+    while ( !m->brk && (max <= 0 || n < max) )
+    {
+        DAQ_Verdict v;
+        int rval;
+
+        if ( m->prefetch && m->pos >= m->advised )
+            MmapDaq_Advise(m);
+
+        rval = m->next(m, &h, &data);
+
+        if ( rval <= 0 )
+            return rval ? DAQ_ERROR : DAQ_READFILE_EOF;
+
+        m->stats.hw_packets_received++;
+
+        if ( m->filter &&
+            !bpf_filter(m->fcode.bf_insns, data, h.pktlen, h.caplen) )
+        {
+            m->stats.packets_filtered++;
+            continue;
+        }
+#ifdef WORDS_MUSTALIGN
+        memcpy(m->buf, data, h.caplen);
+        data = m->buf;
+#endif
+        m->stats.packets_received++;
+        n++;
+
+        v = callback(user, &h, data);
+
+        if ( v >= MAX_DAQ_VERDICT )
+            v = DAQ_VERDICT_PASS;
+
+        m->stats.verdicts[v]++;
+    }
+    return DAQ_SUCCESS;
+}
+
+DAQ_State MmapDaq_CheckStatus (MmapDaq* m)
+{
+    return m->state;
+}
+
+int MmapDaq_GetStats (MmapDaq* m, DAQ_Stats_t* ps)
+{
+    *ps = m->stats;
+    return DAQ_SUCCESS;
+}
+
+int MmapDaq_GetDatalinkType (MmapDaq* m)
+{
+    return m->dlt;
+}
+
+const char* MmapDaq_GetError (MmapDaq* m)
+{
+    return m->error;
+}
+
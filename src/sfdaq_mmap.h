@@ -0,0 +1,67 @@
+/****************************************************************************
+ *
+ * Copyright (C) 2013 Sourcefire, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 2 as
+ * published by the Free Software Foundation.  You may not use, modify or
+ * distribute this program under any other version of the GNU General
+ * Public License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ ****************************************************************************/
+
+// @file    sfdaq_mmap.h
+
+// Built-in pcap / pcapng reader used by sfdaq.c for --daq mmap.  The file
+// is mapped into memory and each packet is passed to the analysis callback
+// straight from the mapping so nothing is copied or buffered on the way.
+// The mapping is private and writable so that normalizations and replace
+// verdicts modify a copy of the page rather than the file.
+
+#ifndef __SFDAQ_MMAP_H__
+#define __SFDAQ_MMAP_H__
+
+#include <daq.h>
+
+#define MMAP_DAQ_NAME "mmap"
+
+#define MMAP_DAQ_TYPE (DAQ_TYPE_FILE_CAPABLE | DAQ_TYPE_INLINE_CAPABLE)
+
+#define MMAP_DAQ_CAPS \
+    (DAQ_CAPA_BLOCK | DAQ_CAPA_REPLACE | DAQ_CAPA_UNPRIV_START | \
+     DAQ_CAPA_BREAKLOOP | DAQ_CAPA_BPF)
+
+typedef struct _MmapDaq MmapDaq;
+
+// prefetch is the number of bytes to ask the kernel to read ahead of the
+// current packet with madvise(); 0 leaves it to the default readahead.
+// returns NULL with a message in errbuf on failure.
+MmapDaq* MmapDaq_New(
+    const char* file, uint32_t snaplen, size_t prefetch, char* errbuf, size_t len);
+
+void MmapDaq_Delete(MmapDaq*);
+
+int MmapDaq_SetFilter(MmapDaq*, const char* bpf);
+int MmapDaq_Start(MmapDaq*);
+int MmapDaq_Stop(MmapDaq*);
+int MmapDaq_BreakLoop(MmapDaq*);
+
+// returns DAQ_READFILE_EOF once the last packet has been processed
+int MmapDaq_Acquire(MmapDaq*, int max, DAQ_Analysis_Func_t, void* user);
+
+DAQ_State MmapDaq_CheckStatus(MmapDaq*);
+int MmapDaq_GetStats(MmapDaq*, DAQ_Stats_t*);
+int MmapDaq_GetDatalinkType(MmapDaq*);
+const char* MmapDaq_GetError(MmapDaq*);
+
+#endif // __SFDAQ_MMAP_H__
+
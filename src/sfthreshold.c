@@ -259,6 +259,121 @@ static int print_thd_local(ThresholdObjects *thd_objs, PrintFormat type, unsigne
 }
 
 
+/*
+ *  Snapshot of the per address tracking state, taken with sfohash_walk():
+ *  how many addresses each table tracks and the busiest of them.
+ */
+#define THD_TRACKED_TOP 5
+
+typedef union
+{
+    THD_IP_NODE_KEY local;
+    THD_IP_GNODE_KEY global;
+} THD_TRACKED_KEY;
+
+typedef struct
+{
+    THD_TRACKED_KEY key[THD_TRACKED_TOP];
+    unsigned count[THD_TRACKED_TOP];
+    unsigned num;
+    size_t keysize;
+} THD_TRACKED_TOP_LIST;
+
+static int collect_thd_tracked(const void* key, const void* data, time_t stamp, void* user)
+{
+    THD_TRACKED_TOP_LIST* top = (THD_TRACKED_TOP_LIST*)user;
+    const THD_IP_NODE* node = (const THD_IP_NODE*)data;
+    unsigned i;
+
+    if ( top->num < THD_TRACKED_TOP )
+        i = top->num++;
+
+    else
+    {
+        unsigned j;
+
+        for ( i = 0, j = 1; j < THD_TRACKED_TOP; j++ )
+        {
+            if ( top->count[j] < top->count[i] )
+                i = j;
+        }
+        if ( node->count <= top->count[i] )
+            return 0;
+    }
+    memcpy(&top->key[i], key, top->keysize);
+    top->count[i] = node->count;
+
+    return 0;
+}
+
+static void print_thd_tracked(SFOHASH* t, const char* name, size_t keysize)
+{
+    THD_TRACKED_TOP_LIST top;
+    unsigned n, i;
+
+    memset(&top, 0, sizeof(top));
+    top.keysize = keysize;
+
+    n = sfohash_walk(t, collect_thd_tracked, &top);
+    LogMessage("| %-6s : tracked=%u\n", name, n);
+
+    while ( top.num )
+    {
+        char buf[STD_BUF+1];
+        unsigned best = 0;
+
+        for ( i = 1; i < top.num; i++ )
+        {
+            if ( top.count[i] > top.count[best] )
+                best = i;
+        }
+        memset(buf, 0, STD_BUF+1);
+
+        if ( keysize == sizeof(THD_IP_GNODE_KEY) )
+        {
+            THD_IP_GNODE_KEY* key = &top.key[best].global;
+            SnortSnprintfAppend(buf, STD_BUF, "|   gen-id=%-6u sig-id=%-10u ip=%-16s",
+                key->gen_id, key->sig_id, sfip_ntoa(&key->ip));
+        }
+        else
+        {
+            THD_IP_NODE_KEY* key = &top.key[best].local;
+            SnortSnprintfAppend(buf, STD_BUF, "|   thd-id=%-6d ip=%-16s",
+                key->thd_id, sfip_ntoa(&key->ip));
+        }
+        SnortSnprintfAppend(buf, STD_BUF, " count=%u", top.count[best]);
+        LogMessage("%s\n", buf);
+
+        top.key[best] = top.key[--top.num];
+        top.count[best] = top.count[top.num];
+    }
+}
+
+static void print_thd_tracking(THD_STRUCT* thd)
+{
+    unsigned n = 0;
+
+    if ( !thd )
+        return;
+
+    if ( thd->ip_nodes )
+        n += sfohash_count(thd->ip_nodes);
+
+    if ( thd->ip_gnodes )
+        n += sfohash_count(thd->ip_gnodes);
+
+    if ( !n )
+        return;
+
+    LogMessage("+-----------------------[event-filter-tracking]--------------------------------\n");
+
+    if ( thd->ip_nodes )
+        print_thd_tracked(thd->ip_nodes, "local", sizeof(THD_IP_NODE_KEY));
+
+    if ( thd->ip_gnodes )
+        print_thd_tracked(thd->ip_gnodes, "global", sizeof(THD_IP_GNODE_KEY));
+}
+
 /*
  *  Startup/Shutdown Display Of Thresholding
  */
@@ -364,6 +479,9 @@ void print_thresholding(ThresholdConfig *thd_config, unsigned shutdown)
         print_thd_local(thd_config->thd_objs, PRINT_SUPPRESS, &shutdown);
     }
 
+    if ( shutdown )
+        print_thd_tracking(thd_runtime);
+
     if ( !shutdown )
         LogMessage("--------------------------------------------"
                "-----------------------------------\n");
@@ -474,9 +592,9 @@ void sfthreshold_reset_active(void)
         return;
 
     if (thd_runtime->ip_nodes != NULL)
-        sfxhash_make_empty(thd_runtime->ip_nodes);
+        sfohash_make_empty(thd_runtime->ip_nodes);
 
     if (thd_runtime->ip_gnodes != NULL)
-        sfxhash_make_empty(thd_runtime->ip_gnodes);
+        sfohash_make_empty(thd_runtime->ip_gnodes);
 }
 
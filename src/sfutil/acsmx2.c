@@ -2780,6 +2780,8 @@ acsmSearchSparseDFA_Banded(ACSM_STRUCT2 * acsm, unsigned char *Tx, int n,
     }
   }
 
+  *current_state = state;
+
   return nfound;
 }
 
@@ -2842,6 +2844,8 @@ acsmSearchSparseNFA(ACSM_STRUCT2 * acsm, unsigned char *Tx, int n,
       }
   }
 
+  *current_state = state;
+
   return nfound;
 }
 
@@ -2892,6 +2896,59 @@ acsmSearch2(ACSM_STRUCT2 * acsm, unsigned char *Tx, int n,
 }
 
 
+/*
+*   Next state of a DFA for one (case translated) input byte
+*/
+static
+inline
+acstate_t
+acsmNextStateDFA2( ACSM_STRUCT2 * acsm, acstate_t state, unsigned input )
+{
+    if( acsm->acsmFormat == ACF_FULL || acsm->acsmFormat == ACF_FULLQ )
+    {
+        switch( acsm->sizeofstate )
+        {
+            case 1:
+                return ((uint8_t **)acsm->acsmNextState)[state][2u + input];
+            case 2:
+                return ((uint16_t **)acsm->acsmNextState)[state][2u + input];
+            default:
+                return acsm->acsmNextState[state][2u + input];
+        }
+    }
+    return SparseGetNextStateDFA( acsm->acsmNextState[state], state, input );
+}
+
+/*
+*   Search Function - continue from the state returned by a search of
+*   the preceding buffer.
+*
+*   The full and banded searches report the current state before taking
+*   each transition and report the final state after the last one, so a
+*   carried state has already been reported.  Take its transition on the
+*   first byte here so that it is not reported again.  The sparse and NFA
+*   searches report after each transition and resume as is.
+*/
+int
+acsmSearchCarry2(ACSM_STRUCT2 * acsm, unsigned char *Tx, int n,
+           int (*Match)(void * id, void *tree, int index, void *data, void *neg_list),
+           void *data, int* current_state )
+{
+    if ( !current_state || (n <= 0) )
+        return 0;
+
+    if ( *current_state && (acsm->acsmFSA == FSA_DFA) &&
+         ((acsm->acsmFormat == ACF_FULL) || (acsm->acsmFormat == ACF_FULLQ) ||
+          (acsm->acsmFormat == ACF_BANDED)) )
+    {
+        *current_state = acsmNextStateDFA2(acsm, *current_state, xlatcase[Tx[0]]);
+        Tx++;
+        n--;
+    }
+
+    return acsmSearch2(acsm, Tx, n, Match, data, current_state);
+}
+
 /*
 *   Free all memory
 */
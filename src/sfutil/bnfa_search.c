@@ -1758,6 +1758,7 @@ _bnfa_search_full_nfa(    bnfa_struct_t * bnfa, unsigned char *Tx, int n,
         }
     }
   }
+  *current_state = state;
   return nfound;
 }
 /*
@@ -1840,6 +1841,7 @@ _bnfa_search_full_nfa_case(    bnfa_struct_t * bnfa, unsigned char *Tx, int n,
         }
     }
   }
+  *current_state = state;
   return nfound;
 }
 /*
@@ -1921,6 +1923,7 @@ _bnfa_search_full_nfa_nocase(    bnfa_struct_t * bnfa, unsigned char *Tx, int n,
         }
     }
   }
+  *current_state = state;
   return nfound;
 }
 #endif
@@ -2268,16 +2271,16 @@ _bnfa_search_csparse_nfa_q(   bnfa_struct_t * bnfa, unsigned char *T, int n,
     unsigned char      * Tend;
     bnfa_match_node_t ** MatchList = bnfa->bnfaMatchList;
     bnfa_state_t       * transList = bnfa->bnfaTransList;
-    unsigned             last_sindex;
+    unsigned             last_sindex = 0;
 
     Tend = T + n;
 
     _init_queue(bnfa);
 
-    for(; T<Tend; T++)
+    /* last_sindex starts at 0 rather than the caller's sindex so that a
+     * carried match state reached again on the first byte is queued */
+    for(; T<Tend; last_sindex = sindex, T++)
     {
-        last_sindex = sindex;
-
         /* Transition to next state index */
         sindex = _bnfa_get_next_state_csparse_nfa(transList,sindex,xlatcase[*T]);
 
@@ -2381,6 +2384,7 @@ _bnfa_search_csparse_nfa( bnfa_struct_t * bnfa, unsigned char *Tx, int n,
             }
         }
     }
+    *current_state = sindex;
     return nfound;
 }
 /*
@@ -2446,6 +2450,7 @@ _bnfa_search_csparse_nfa_case(   bnfa_struct_t * bnfa, unsigned char *Tx, int n,
         }
     }
   }
+  *current_state = sindex;
   return nfound;
 }
 /*
@@ -2514,6 +2519,7 @@ _bnfa_search_csparse_nfa_nocase(   bnfa_struct_t * bnfa, unsigned char *Tx, int
         }
       }
   }
+  *current_state = sindex;
   return nfound;
 }
 
@@ -646,6 +646,73 @@ int mpseSearch( void *pvoid, const unsigned char * T, int n,
 
 }
 
+/*
+ * Like mpseSearch() but continue from the state returned by a search of
+ * the preceding buffer, so that patterns spanning the boundary are found.
+ * Pass *current_state = 0 to start over.  Methods that can't carry state
+ * just search the buffer from the start and return a state of 0.
+ */
+int mpseSearchCarry( void *pvoid, const unsigned char * T, int n,
+                     int ( *action )(void* id, void * tree, int index, void *data, void *neg_list),
+                     void * data, int* current_state )
+{
+  MPSE * p = (MPSE*)pvoid;
+  int ret;
+  PROFILE_VARS;
+
+  switch( p->method )
+   {
+     case MPSE_AC_BNFA:
+     case MPSE_AC_BNFA_Q:
+     case MPSE_ACF:
+     case MPSE_ACF_Q:
+     case MPSE_ACS:
+     case MPSE_ACB:
+     case MPSE_ACSB:
+      break;
+
+     default:
+      *current_state = 0;
+      return mpseSearch(pvoid, T, n, action, data, current_state);
+   }
+
+  PREPROC_PROFILE_START(mpsePerfStats);
+
+  p->bcnt += n;
+
+  if(p->inc_global_counter)
+    s_bcnt += n;
+
+  if ( (p->method == MPSE_AC_BNFA) || (p->method == MPSE_AC_BNFA_Q) )
+      ret = bnfaSearch((bnfa_struct_t*) p->obj, (unsigned char *)T, n,
+                       action, data, (unsigned)*current_state, current_state );
+  else
+      ret = acsmSearchCarry2( (ACSM_STRUCT2*) p->obj, (unsigned char *)T, n, action, data, current_state );
+
+  PREPROC_PROFILE_END(mpsePerfStats);
+  return ret;
+}
+
+int mpseCanCarryState(void *pvoid)
+{
+  MPSE * p = (MPSE*)pvoid;
+
+  switch( p->method )
+   {
+     case MPSE_AC_BNFA:
+     case MPSE_AC_BNFA_Q:
+     case MPSE_ACF:
+     case MPSE_ACF_Q:
+     case MPSE_ACS:
+     case MPSE_ACB:
+     case MPSE_ACSB:
+      return 1;
+
+     default:
+      return 0;
+   }
+}
+
 int mpseGetPatternCount(void *pvoid)
 {
     MPSE * p = (MPSE*)pvoid;
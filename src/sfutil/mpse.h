@@ -113,6 +113,12 @@ int  mpseSearch( void *pv, const unsigned char * T, int n,
                  int ( *action )(void* id, void * tree, int index, void *data, void *neg_list),
                  void * data, int* current_state );
 
+int  mpseSearchCarry( void *pv, const unsigned char * T, int n,
+                      int ( *action )(void* id, void * tree, int index, void *data, void *neg_list),
+                      void * data, int* current_state );
+
+int mpseCanCarryState(void *pv);
+
 int mpseGetPatternCount(void *pv);
 
 uint64_t mpseGetPatByteCount(void);
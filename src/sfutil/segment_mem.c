@@ -31,6 +31,38 @@ static MEM_OFFSET unused_ptr = 0;
 static size_t unused_mem = 0;
 static void *base_ptr = NULL;
 
+/*Released blocks, kept in one list per block size. The offset of the next
+ *block in a list is stored at the start of each block*/
+#define SEGMENT_FREE_LISTS   16
+
+typedef struct
+{
+    size_t size;
+    MEM_OFFSET head;
+} SegmentFreeList;
+
+static SegmentFreeList free_lists[SEGMENT_FREE_LISTS];
+static int num_free_lists = 0;
+
+/*State saved by segment_mark(). Blocks taken from the free lists since
+ *then are logged with the link each one held, since using the block
+ *overwrites it*/
+typedef struct
+{
+    MEM_OFFSET ptr;
+    MEM_OFFSET link;
+} SegmentReused;
+
+static int marked = 0;
+static MEM_OFFSET mark_unused_ptr;
+static size_t mark_unused_mem;
+static SegmentFreeList mark_free_lists[SEGMENT_FREE_LISTS];
+static int mark_num_free_lists;
+static SegmentReused *reused = NULL;
+static uint32_t num_reused = 0;
+static uint32_t max_reused = 0;
+static int reused_lost = 0;
+
 size_t segment_unusedmem(void)
 {
     return unused_mem;
@@ -46,13 +78,48 @@ int segment_meminit(uint8_t* buff, size_t mem_cap)
     base_ptr = buff;
     unused_ptr = 0;
     unused_mem = mem_cap;
+    num_free_lists = 0;
+    marked = 0;
     return 1;
 }
 
+static inline SegmentFreeList *segment_freelist(size_t size)
+{
+    int i;
+
+    for (i = 0; i < num_free_lists; i++)
+    {
+        if (free_lists[i].size == size)
+            return &free_lists[i];
+    }
+    return NULL;
+}
+
+static void segment_log_reused(MEM_OFFSET ptr, MEM_OFFSET link)
+{
+    if (num_reused == max_reused)
+    {
+        uint32_t new_max = max_reused ? max_reused * 2 : 1024;
+        SegmentReused *new_reused;
+
+        if (reused_lost || (new_max < max_reused) ||
+                !(new_reused = realloc(reused, new_max * sizeof(SegmentReused))))
+        {
+            reused_lost = 1;
+            return;
+        }
+        reused = new_reused;
+        max_reused = new_max;
+    }
+    reused[num_reused].ptr = ptr;
+    reused[num_reused].link = link;
+    num_reused++;
+}
+
 /***************************************************************************
  * allocate memory block from segment
- * todo:currently, we only allocate memory continuously. Need to reuse freed
- *      memory in the future.
+ * A block released with segment_release() is reused if it has exactly the
+ * requested size, otherwise memory is allocated continuously.
  * return:
  *    0: fail
  *    other: the offset of the allocated memory block
@@ -61,6 +128,20 @@ MEM_OFFSET segment_malloc ( size_t size )
 {
     MEM_OFFSET current_ptr = unused_ptr;
 
+    if (num_free_lists)
+    {
+        SegmentFreeList *list = segment_freelist(size);
+
+        if (list && list->head)
+        {
+            current_ptr = list->head;
+            memcpy(&list->head, (uint8_t *)base_ptr + current_ptr, sizeof(MEM_OFFSET));
+            if (marked)
+                segment_log_reused(current_ptr, list->head);
+            return current_ptr;
+        }
+    }
+
     if (unused_mem < size)
         return 0;
 
@@ -81,6 +162,97 @@ void segment_free ( MEM_OFFSET ptr )
     return;
 }
 
+/***************************************************************************
+ * Return a memory block of the given size to the segment, so that a later
+ * segment_malloc() of the same size can reuse it. The caller must make sure
+ * nothing, including readers of a shared segment, refers to the block any
+ * more. Blocks too small to hold the link, or of a new size once all the
+ * free lists are taken, are not reused.
+ **************************************************************************/
+
+void segment_release ( MEM_OFFSET ptr, size_t size )
+{
+    SegmentFreeList *list;
+
+    if (!ptr || (size < sizeof(MEM_OFFSET)))
+        return;
+
+    if (!(list = segment_freelist(size)))
+    {
+        if (num_free_lists == SEGMENT_FREE_LISTS)
+            return;
+        list = &free_lists[num_free_lists++];
+        list->size = size;
+        list->head = 0;
+    }
+
+    memcpy((uint8_t *)base_ptr + ptr, &list->head, sizeof(MEM_OFFSET));
+    list->head = ptr;
+}
+
+/***************************************************************************
+ * Remember the state of the allocator, so that everything allocated from
+ * now on can be given back at once with segment_rollback(). Memory must
+ * not be released to the segment in between, except blocks allocated
+ * after the mark.
+ **************************************************************************/
+
+void segment_mark ( void )
+{
+    marked = 1;
+    mark_unused_ptr = unused_ptr;
+    mark_unused_mem = unused_mem;
+    memcpy(mark_free_lists, free_lists, sizeof(free_lists));
+    mark_num_free_lists = num_free_lists;
+    num_reused = 0;
+    reused_lost = 0;
+}
+
+/***************************************************************************
+ * Keep what was allocated since segment_mark()
+ **************************************************************************/
+
+void segment_unmark ( void )
+{
+    marked = 0;
+}
+
+/***************************************************************************
+ * Give back everything allocated since segment_mark()
+ * return:
+ *    1: done
+ *    0: there was no mark, or the reused blocks could not all be logged,
+ *       so the memory is kept
+ **************************************************************************/
+
+int segment_rollback ( void )
+{
+    uint32_t i;
+
+    if (!marked)
+        return 0;
+
+    marked = 0;
+
+    if (reused_lost)
+        return 0;
+
+    /*A block reused more than once is logged each time; the first entry
+     *holds its original link, so it has to be written last*/
+    for (i = num_reused; i > 0; i--)
+    {
+        memcpy((uint8_t *)base_ptr + reused[i-1].ptr, &reused[i-1].link,
+                sizeof(MEM_OFFSET));
+    }
+
+    memcpy(free_lists, mark_free_lists, sizeof(free_lists));
+    num_free_lists = mark_num_free_lists;
+    unused_ptr = mark_unused_ptr;
+    unused_mem = mark_unused_mem;
+
+    return 1;
+}
+
 /***************************************************************************
  * allocate memory block from segment and initialize it to zero
  * It calls segment_malloc() to get memory.
@@ -31,6 +31,10 @@ typedef uint32_t MEM_OFFSET;
 int segment_meminit(uint8_t*, size_t);
 MEM_OFFSET segment_malloc ( size_t size );
 void segment_free (MEM_OFFSET ptr );
+void segment_release (MEM_OFFSET ptr, size_t size );
+void segment_mark ( void );
+void segment_unmark ( void );
+int segment_rollback ( void );
 MEM_OFFSET segment_calloc ( size_t num, size_t size );
 size_t segment_unusedmem();
 void * segment_basePtr();
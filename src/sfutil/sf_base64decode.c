@@ -23,6 +23,8 @@
 #include "config.h"
 #endif
 
+#include <stdlib.h>
+
 #include "sf_base64decode.h"
 
 uint8_t sf_decode64tab[256] = {
@@ -43,6 +45,127 @@ uint8_t sf_decode64tab[256] = {
         100,100,100,100,100,100,100,100,100,100,100,100,100,100,100,100,
         100,100,100,100,100,100,100,100,100,100,100,100,100,100,100,100};
 
+/* Decoder state for one output buffer.  Base64 characters are collected
+ * into groups of four; anything else in the input is skipped. */
+typedef struct _Base64Run
+{
+   uint8_t data[4];        /* base64 chars of the current group */
+   uint32_t ndata;
+   uint32_t n;             /* base64 chars taken so far */
+   uint32_t max;           /* max base64 chars whose decoding fits into out */
+   uint8_t *out;
+   uint32_t out_size;
+   uint32_t written;
+} Base64Run;
+
+static inline void base64_init(Base64Run *r, uint8_t *outbuf, uint32_t outbuf_size)
+{
+   r->ndata = 0;
+   r->n = 0;
+
+   /* This algorithm will waste up to 4 bytes but we really don't care.
+      At the end we're going to copy the exact number of bytes requested. */
+   r->max = (outbuf_size / 3) * 4 + 4; /* 4 base64 bytes gives 3 data bytes, plus
+                                          an extra 4 to take care of any rounding */
+   r->out = outbuf;
+   r->out_size = outbuf_size;
+   r->written = 0;
+}
+
+/* Decode a complete group.  Returns -1 for misplaced padding, 1 if the group
+ * was padded or the output is full, which ends the data, and 0 otherwise. */
+static inline int base64_group(Base64Run *r)
+{
+   uint8_t tableval_a, tableval_b, tableval_c, tableval_d;
+
+   if((r->data[0] == '=') || (r->data[1] == '=')) {
+      /* Error in input data */
+      return -1;
+   }
+
+   /* retrieve values from lookup table */
+   tableval_a = sf_decode64tab[r->data[0]];
+   tableval_b = sf_decode64tab[r->data[1]];
+   tableval_c = sf_decode64tab[r->data[2]];
+   tableval_d = sf_decode64tab[r->data[3]];
+
+   if(r->written < r->out_size)
+      r->out[r->written++] = (tableval_a << 2) | (tableval_b >> 4);
+
+   if((r->data[2] != '=') && (r->written < r->out_size))
+      r->out[r->written++] = (tableval_b << 4) | (tableval_c >> 2);
+   else
+      return 1;
+
+   if((r->data[3] != '=') && (r->written < r->out_size))
+      r->out[r->written++] = (tableval_c << 6) | tableval_d;
+   else
+      return 1;
+
+   /* Reset our decode pointer for the next group of four */
+   r->ndata = 0;
+   return 0;
+}
+
+/* Returns -1 on error, 1 if the data ended before inbuf did and 0 otherwise */
+static int base64_run(Base64Run *r, const uint8_t *cursor, const uint8_t *endofinbuf)
+{
+   while((cursor < endofinbuf) && (r->n < r->max)) {
+      /* Most of the input is runs of complete groups with nothing in
+       * between; decode those without staging them in data[].  Valid
+       * values are < 64 while '=' and junk both have bit 6 set. */
+      if(!r->ndata) {
+         uint32_t groups = (endofinbuf - cursor) / 4;
+         uint32_t room = (r->out_size - r->written) / 3;
+         uint32_t left = (r->max - r->n) / 4;
+         uint8_t *out = r->out + r->written;
+
+         if(groups > room)
+            groups = room;
+
+         if(groups > left)
+            groups = left;
+
+         while(groups) {
+            uint8_t a = sf_decode64tab[cursor[0]];
+            uint8_t b = sf_decode64tab[cursor[1]];
+            uint8_t c = sf_decode64tab[cursor[2]];
+            uint8_t d = sf_decode64tab[cursor[3]];
+
+            if((a | b | c | d) & 0xC0)
+               break;
+
+            out[0] = (a << 2) | (b >> 4);
+            out[1] = (b << 4) | (c >> 2);
+            out[2] = (c << 6) | d;
+            out += 3;
+            cursor += 4;
+            groups--;
+         }
+         r->n += (out - (r->out + r->written)) / 3 * 4;
+         r->written = out - r->out;
+
+         if((cursor >= endofinbuf) || (r->n >= r->max))
+            break;
+      }
+
+      if(sf_decode64tab[*cursor] != 100) {
+         r->data[r->ndata++] = *cursor;
+         r->n++;  /* Number of base64 bytes we've stored */
+
+         if(r->ndata == 4) {
+            /* We have four databytes upon which to operate */
+            int rval = base64_group(r);
+
+            if(rval)
+               return rval;
+         }
+      }
+      cursor++;
+   }
+   return 0;
+}
+
 /* base64decode assumes the input data terminates with '=' and/or at the end of the input buffer
  * at inbuf_size.  If extra characters exist within inbuf before inbuf_size is reached, it will
  * happily decode what it can and skip over what it can't.  This is consistent with other decoders
@@ -52,75 +175,30 @@ uint8_t sf_decode64tab[256] = {
 */
 int sf_base64decode(uint8_t *inbuf, uint32_t inbuf_size, uint8_t *outbuf, uint32_t outbuf_size, uint32_t *bytes_written)
 {
-   uint8_t *cursor, *endofinbuf;
-   uint8_t *outbuf_ptr;
-   uint8_t base64data[4], *base64data_ptr; /* temporary holder for current base64 chunk */
-   uint8_t tableval_a, tableval_b, tableval_c, tableval_d;
-
-   uint32_t n;
-   uint32_t max_base64_chars;  /* The max number of decoded base64 chars that fit into outbuf */
+   return sf_base64decode_cont(NULL, 0, inbuf, inbuf_size, outbuf, outbuf_size, bytes_written);
+}
 
-   int error = 0;
+/* Same as sf_base64decode() for the concatenation of prevbuf and inbuf,
+ * without having to copy inbuf after the bytes left over from the last
+ * packet. */
+int sf_base64decode_cont(const uint8_t *prevbuf, uint32_t prevbuf_size,
+   const uint8_t *inbuf, uint32_t inbuf_size,
+   uint8_t *outbuf, uint32_t outbuf_size, uint32_t *bytes_written)
+{
+   Base64Run r;
+   int rval = 0;
 
-   /* This algorithm will waste up to 4 bytes but we really don't care.
-      At the end we're going to copy the exact number of bytes requested. */
-   max_base64_chars = (outbuf_size / 3) * 4 + 4; /* 4 base64 bytes gives 3 data bytes, plus
-                                                    an extra 4 to take care of any rounding */
-
-   base64data_ptr = base64data;
-   endofinbuf = inbuf + inbuf_size;
-
-   /* Strip non-base64 chars from inbuf and decode */
-   n = 0;
-   *bytes_written = 0;
-   cursor = inbuf;
-   outbuf_ptr = outbuf;
-   while((cursor < endofinbuf) && (n < max_base64_chars)) {
-      if(sf_decode64tab[*cursor] != 100) {
-         *base64data_ptr++ = *cursor;
-         n++;  /* Number of base64 bytes we've stored */
-         if(!(n % 4)) {
-            /* We have four databytes upon which to operate */
+   base64_init(&r, outbuf, outbuf_size);
 
-            if((base64data[0] == '=') || (base64data[1] == '=')) {
-               /* Error in input data */
-               error = 1;
-               break;
-            }
-
-            /* retrieve values from lookup table */
-            tableval_a = sf_decode64tab[base64data[0]];
-            tableval_b = sf_decode64tab[base64data[1]];
-            tableval_c = sf_decode64tab[base64data[2]];
-            tableval_d = sf_decode64tab[base64data[3]];
-
-            if(*bytes_written < outbuf_size) {
-               *outbuf_ptr++ = (tableval_a << 2) | (tableval_b >> 4);
-               (*bytes_written)++;
-            }
-
-            if((base64data[2] != '=') && (*bytes_written < outbuf_size)) {
-               *outbuf_ptr++ = (tableval_b << 4) | (tableval_c >> 2);
-               (*bytes_written)++;
-            }  else {
-               break;
-            }
+   if(prevbuf_size)
+      rval = base64_run(&r, prevbuf, prevbuf + prevbuf_size);
 
-            if((base64data[3] != '=') && (*bytes_written < outbuf_size)) {
-               *outbuf_ptr++ = (tableval_c << 6) | tableval_d;
-               (*bytes_written)++;
-            }  else {
-               break;
-            }
+   if(!rval)
+      rval = base64_run(&r, inbuf, inbuf + inbuf_size);
 
-            /* Reset our decode pointer for the next group of four */
-            base64data_ptr = base64data;
-         }
-      }
-      cursor++;
-   }
+   *bytes_written = r.written;
 
-   if(error)
+   if(rval < 0)
       return(-1);
    else
       return(0);
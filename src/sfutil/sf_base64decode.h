@@ -26,5 +26,7 @@
 #include "util_unfold.h"
 
 int sf_base64decode(uint8_t*, uint32_t, uint8_t*, uint32_t, uint32_t*); 
+int sf_base64decode_cont(const uint8_t*, uint32_t, const uint8_t*, uint32_t,
+    uint8_t*, uint32_t, uint32_t*);
 
 #endif
@@ -32,6 +32,14 @@ SharedObjectAddEnds */
 
 #define UU_DECODE_CHAR(c) (((c) - 0x20) & 0x3f)
 
+static inline char sf_hexval(char c)
+{
+    if((c >= '0') && (c <= '9'))
+        return c - '0';
+
+    return (c | 0x20) - 'a' + 10;
+}
+
 int sf_qpdecode(char *src, uint32_t slen, char *dst, uint32_t dlen, uint32_t *bytes_read, uint32_t *bytes_copied )
 {
     char ch;
@@ -44,6 +52,26 @@ int sf_qpdecode(char *src, uint32_t slen, char *dst, uint32_t dlen, uint32_t *by
 
     while( (*bytes_read < slen) && (*bytes_copied < dlen))
     {
+        /* Copy everything up to the next '=' as is */
+        uint32_t run = slen - *bytes_read;
+        char *eq;
+
+        if(run > (dlen - *bytes_copied))
+            run = dlen - *bytes_copied;
+
+        eq = (char *)memchr(src + *bytes_read, '=', run);
+
+        if(eq)
+            run = eq - (src + *bytes_read);
+
+        if(run)
+        {
+            memcpy(dst + *bytes_copied, src + *bytes_read, run);
+            *bytes_read += run;
+            *bytes_copied += run;
+            continue;
+        }
+
         ch = src[*bytes_read];
         *bytes_read += 1;
         if( ch == '=' )
@@ -66,16 +94,7 @@ int sf_qpdecode(char *src, uint32_t slen, char *dst, uint32_t dlen, uint32_t *by
                     }
                     if (isxdigit((int)ch1) && isxdigit((int)ch2))
                     {
-                        char hexBuf[3];
-                        char *eptr;
-                        hexBuf[0] = ch1;
-                        hexBuf[1] = ch2;
-                        hexBuf[2] = '\0';
-                        dst[*bytes_copied]= (char)strtoul(hexBuf, &eptr, 16);
-                        if((*eptr != '\0'))
-                        {
-                            return -1;
-                        }
+                        dst[*bytes_copied]= (char)((sf_hexval(ch1) << 4) | sf_hexval(ch2));
                         *bytes_read += 2;
                         *bytes_copied +=1;
                         continue;
@@ -96,12 +115,6 @@ int sf_qpdecode(char *src, uint32_t slen, char *dst, uint32_t dlen, uint32_t *by
                 return 0;
             }
         }
-        else
-        {
-            dst[*bytes_copied] = ch;
-            *bytes_copied +=1;
-
-        }
     }
 
     return 0;
@@ -236,8 +249,9 @@ int Base64Decode(const uint8_t *start, const uint8_t *end, Email_DecodeState *ds
     uint32_t encode_avail = 0, decode_avail = 0 ;
     uint8_t *encode_buf, *decode_buf;
     uint32_t act_encode_size = 0, act_decode_size = 0;
-    uint32_t prev_bytes = 0;
-    uint32_t i = 0;
+    uint32_t prev_bytes = 0, prev_used;
+    const uint8_t *cursor, *cut;
+    uint32_t i = 0, n, tail;
 
     if (!(ds->b64_state.encode_depth))
     {
@@ -287,26 +301,55 @@ int Base64Decode(const uint8_t *start, const uint8_t *end, Email_DecodeState *ds
         }
     }
 
-    if(sf_strip_CRLF(start, (end-start), encode_buf + prev_bytes, encode_avail, &act_encode_size) != 0)
+    /* The decoder skips CRLF along with anything else that isn't base64, so
+     * the packet is decoded where it lies.  CRLF only has to be left out when
+     * counting the encoded bytes against the depth. */
+    if((uint32_t)(end - start) <= encode_avail)
     {
-        ResetEmailDecodeState(ds);
-        return DECODE_FAIL;
-    }
+        const uint8_t *eol;
 
-    act_encode_size = act_encode_size + prev_bytes;
+        n = end - start;
+        cursor = end;
 
-    i = (act_encode_size)%4 ;
+        for(eol = start; (eol = memchr(eol, '\n', end - eol)) != NULL; eol++)
+            n--;
+
+        for(eol = start; (eol = memchr(eol, '\r', end - eol)) != NULL; eol++)
+            n--;
+    }
+    else
+    {
+        for(cursor = start, n = 0; (cursor < end) && (n < encode_avail); cursor++)
+        {
+            if((*cursor != '\n') && (*cursor != '\r'))
+                n++;
+        }
+    }
 
     /* Encoded data should be in multiples of 4. Then we need to wait for the remainder encoded data to
      * successfully decode the base64 data. This happens when base64 data is spanned across packets*/
-    if(i)
+    tail = (prev_bytes + n) % 4;
+    prev_used = prev_bytes;
+    cut = cursor;
+
+    if(tail > n)
     {
-        ds->prev_encoded_bytes = i;
-        act_encode_size = act_encode_size - i;
-        ds->prev_encoded_buf = encode_buf + act_encode_size;
+        prev_used = prev_bytes - (tail - n);
+        cut = start;
+    }
+    else
+    {
+        for(i = tail; i; cut--)
+        {
+            if((cut[-1] != '\n') && (cut[-1] != '\r'))
+                i--;
+        }
     }
 
-    if(sf_base64decode(encode_buf, act_encode_size, decode_buf, decode_avail, &act_decode_size) != 0)
+    act_encode_size = prev_bytes + n - tail;
+
+    if(sf_base64decode_cont(encode_buf, prev_used, start, cut - start,
+            decode_buf, decode_avail, &act_decode_size) != 0)
     {
         ResetEmailDecodeState(ds);
         return DECODE_FAIL;
@@ -317,6 +360,22 @@ int Base64Decode(const uint8_t *start, const uint8_t *end, Email_DecodeState *ds
         return DECODE_FAIL;
     }
 
+    /* Keep the remainder at the front of the encode buffer for the next packet */
+    if(tail)
+    {
+        uint32_t from_prev = prev_bytes - prev_used;
+
+        if(from_prev)
+            memmove(encode_buf, encode_buf + prev_used, from_prev);
+
+        for(i = from_prev; cut < cursor; cut++)
+        {
+            if((*cut != '\n') && (*cut != '\r'))
+                encode_buf[i++] = *cut;
+        }
+        ds->prev_encoded_bytes = tail;
+        ds->prev_encoded_buf = encode_buf;
+    }
 
     ds->decode_present = 1;
     ds->decodePtr = decode_buf;
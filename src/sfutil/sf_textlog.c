@@ -188,19 +188,20 @@ bool TextLog_Write (TextLog* this, const char* str, int len)
         TextLog_Flush(this);
         avail = TextLog_Avail(this);
     }
-    len = snprintf(this->buf+this->pos, avail, "%s", str);
-
-    if ( len >= avail )
+    if ( len < 0 )
     {
-        this->pos = this->maxBuf - 1;
-        this->buf[this->pos] = '\0';
         return FALSE;
     }
-    else if ( len < 0 )
+    else if ( len > avail )
     {
+        memcpy(this->buf+this->pos, str, avail);
+        this->pos = this->maxBuf - 1;
+        this->buf[this->pos] = '\0';
         return FALSE;
     }
+    memcpy(this->buf+this->pos, str, len);
     this->pos += len;
+    this->buf[this->pos] = '\0';
     return TRUE;
 }
 
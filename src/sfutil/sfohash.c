@@ -0,0 +1,202 @@
+/****************************************************************************
+ *
+ * Copyright (C) 2013 Sourcefire, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 2 as
+ * published by the Free Software Foundation.  You may not use, modify or
+ * distribute this program under any other version of the GNU General
+ * Public License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ ****************************************************************************/
+
+/*!@file sfohash.c
+ *
+ *  Each entry is a small header followed by the key and the data, all in
+ *  one flat array.  A key hashes to a row and may live in any of the
+ *  SFOHASH_PROBE rows that follow.  Since entries are only ever reused,
+ *  never emptied one at a time, the first unused row in a window ends
+ *  the search for a key.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "sfohash.h"
+
+#define SFOHASH_PROBE 8
+
+#define SFOHASH_ALIGN(n) (((n) + 7) & ~7)
+
+typedef struct _sfohash_entry
+{
+    time_t stamp;   /// last time the entry was returned by sfohash_get()
+    int used;
+
+} SFOHASH_ENTRY;
+
+#define SFOHASH_HDR SFOHASH_ALIGN(sizeof(SFOHASH_ENTRY))
+
+static inline SFOHASH_ENTRY* sfohash_entry(SFOHASH* t, unsigned row)
+{
+    return (SFOHASH_ENTRY*)(t->table + (size_t)row * t->entry_size);
+}
+
+static inline void* sfohash_key(SFOHASH_ENTRY* e)
+{
+    return (unsigned char*)e + SFOHASH_HDR;
+}
+
+static inline void* sfohash_data(SFOHASH* t, SFOHASH_ENTRY* e)
+{
+    return (unsigned char*)e + SFOHASH_HDR + SFOHASH_ALIGN(t->keysize);
+}
+
+SFOHASH* sfohash_new(unsigned nbytes, size_t keysize, size_t datasize)
+{
+    SFOHASH* t;
+    unsigned nrows;
+    unsigned size = SFOHASH_HDR + SFOHASH_ALIGN(keysize) + SFOHASH_ALIGN(datasize);
+
+    /* Calc max entries for this memory */
+    nrows = nbytes / size;
+
+    if ( nrows < SFOHASH_PROBE )
+        nrows = SFOHASH_PROBE;
+
+    t = (SFOHASH*)calloc(1, sizeof(*t));
+
+    if ( !t )
+        return NULL;
+
+    t->sfhashfcn = sfhashfcn_new(nrows);
+
+    if ( !t->sfhashfcn )
+    {
+        sfohash_delete(t);
+        return NULL;
+    }
+    t->nrows = nrows;
+    t->entry_size = size;
+    t->keysize = keysize;
+    t->datasize = datasize;
+
+    return t;
+}
+
+void sfohash_delete(SFOHASH* t)
+{
+    if ( !t )
+        return;
+
+    if ( t->sfhashfcn )
+        sfhashfcn_free(t->sfhashfcn);
+
+    if ( t->table )
+        free(t->table);
+
+    free(t);
+}
+
+void sfohash_make_empty(SFOHASH* t)
+{
+    if ( !t || !t->table )
+        return;
+
+    memset(t->table, 0, (size_t)t->nrows * t->entry_size);
+    t->count = 0;
+}
+
+void* sfohash_get(SFOHASH* t, const void* key, time_t now, int* added)
+{
+    SFOHASH_ENTRY* e;
+    SFOHASH_ENTRY* oldest = NULL;
+    unsigned row, i;
+
+    if ( !t )
+        return NULL;
+
+    if ( !t->table )
+    {
+        /* the memcap is only committed once something is tracked */
+        t->table = (unsigned char*)calloc(t->nrows, t->entry_size);
+
+        if ( !t->table )
+            return NULL;
+    }
+
+    row = t->sfhashfcn->hash_fcn(
+        t->sfhashfcn, (unsigned char*)key, t->keysize) % t->nrows;
+
+    for ( i = 0; i < SFOHASH_PROBE; i++ )
+    {
+        e = sfohash_entry(t, row);
+
+        if ( !e->used )
+        {
+            t->count++;
+            break;
+        }
+        if ( !memcmp(sfohash_key(e), key, t->keysize) )
+        {
+            e->stamp = now;
+            *added = 0;
+            return sfohash_data(t, e);
+        }
+        if ( !oldest || e->stamp < oldest->stamp )
+            oldest = e;
+
+        if ( ++row == t->nrows )
+            row = 0;
+    }
+
+    if ( i == SFOHASH_PROBE )
+    {
+        /* window is full; take over the stalest entry */
+        e = oldest;
+        t->reused++;
+    }
+
+    e->stamp = now;
+    e->used = 1;
+    memcpy(sfohash_key(e), key, t->keysize);
+    memset(sfohash_data(t, e), 0, t->datasize);
+
+    *added = 1;
+    return sfohash_data(t, e);
+}
+
+unsigned sfohash_walk(SFOHASH* t, SFOHASH_WALK f, void* user)
+{
+    unsigned row, n = 0;
+
+    if ( !t || !t->table )
+        return 0;
+
+    for ( row = 0; row < t->nrows; row++ )
+    {
+        SFOHASH_ENTRY* e = sfohash_entry(t, row);
+
+        if ( !e->used )
+            continue;
+
+        n++;
+
+        if ( f(sfohash_key(e), sfohash_data(t, e), e->stamp, user) )
+            break;
+    }
+    return n;
+}
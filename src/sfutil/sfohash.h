@@ -0,0 +1,92 @@
+/****************************************************************************
+ *
+ * Copyright (C) 2013 Sourcefire, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 2 as
+ * published by the Free Software Foundation.  You may not use, modify or
+ * distribute this program under any other version of the GNU General
+ * Public License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ ****************************************************************************/
+
+/*
+*
+*  sfohash.h
+*
+*  fixed size, open addressed hash table for tracking state
+*  (thresholds, rate filters) keyed by small fixed size keys
+*
+*  The table is sized from the memcap when created and the whole of it is
+*  allocated the first time an entry is claimed, so a table that is never
+*  used costs nothing but its header.  Entries are never
+*  freed individually; when the probe window for a key is full the entry
+*  that was touched least recently is reused.  This replaces the global
+*  LRU list and per node allocations of an SFXHASH with a single time
+*  stamp per entry.
+*
+*/
+
+#ifndef _SFOHASH_
+#define _SFOHASH_
+
+#include <stdlib.h>
+#include <time.h>
+
+#include "sfhashfcn.h"
+
+typedef struct _sfohash
+{
+    SFHASHFCN* sfhashfcn;
+
+    unsigned char* table;  /// nrows entries of entry_size bytes, or NULL until used
+    unsigned nrows;
+    unsigned entry_size;
+
+    unsigned keysize;
+    unsigned datasize;
+
+    unsigned count;        /// entries in use
+    unsigned reused;       /// entries taken over from another key
+
+} SFOHASH;
+
+SFOHASH* sfohash_new(unsigned nbytes, size_t keysize, size_t datasize);
+void sfohash_delete(SFOHASH*);
+
+/* forget all entries */
+void sfohash_make_empty(SFOHASH*);
+
+/*
+*   Find the data for key, or claim an entry for it.  A newly claimed
+*   entry has its data zeroed and *added set.  The entry's time stamp
+*   is set to now either way.  Returns NULL if t is NULL or the table
+*   could not be allocated.
+*/
+void* sfohash_get(SFOHASH* t, const void* key, time_t now, int* added);
+
+/*
+*   Call f for each entry in use.  The key and data are only valid
+*   for the duration of the call; f returns non zero to stop the walk.
+*   Returns the number of entries visited.
+*/
+typedef int (*SFOHASH_WALK)(
+    const void* key, const void* data, time_t stamp, void* user);
+
+unsigned sfohash_walk(SFOHASH*, SFOHASH_WALK, void* user);
+
+static inline unsigned sfohash_count(SFOHASH* t)
+{
+    return t->count;
+}
+
+#endif
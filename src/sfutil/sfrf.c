@@ -83,7 +83,7 @@ typedef struct
 /* Tracking node for rate_filter. One node is created on fly, in tracking
  * hash for each threshold configure (identified by Tid) and source or
  * destination IP address.  For rule based tracking, IP is cleared in the
- * created node. Nodes are deleted when hash performs ANR on hash.
+ * created node. Nodes are reused by the hash when it runs out of room.
  */
 typedef struct
 {
@@ -109,7 +109,7 @@ typedef struct
 
 } tSFRFTrackingNode;
 
-SFXHASH *rf_hash = NULL;
+SFOHASH *rf_hash = NULL;
 
 // private methods ...
 static int _checkThreshold(
@@ -148,29 +148,13 @@ static void _updateDependentThresholds(
  * @param nbytes maximum memory to use for thresholding objects, in bytes.
  * @return  pointer to newly created tSFRFContext
 */
-#define SFRF_BYTES (sizeof(tSFRFTrackingNodeKey) + sizeof(tSFRFTrackingNode))
-
 static void SFRF_New( unsigned nbytes )
 {
-    int nrows;
-
-    /* Calc max ip nodes for this memory */
-    if ( nbytes < SFRF_BYTES )
-    {
-        nbytes = SFRF_BYTES;
-    }
-    nrows = nbytes / (SFRF_BYTES);
-
     /* Create global hash table for all of the IP Nodes */
-    rf_hash = sfxhash_new(
-        nrows,  /* try one node per row - for speed */
-        sizeof(tSFRFTrackingNodeKey), /* keys size */
-        sizeof(tSFRFTrackingNode),     /* data size */
-        nbytes,                  /* memcap **/
-        1,         /* ANR flag - true ?- Automatic Node Recovery=ANR */
-        0,         /* ANR callback - none */
-        0,         /* user freemem callback - none */
-        1) ;      /* Recycle nodes ?*/
+    rf_hash = sfohash_new(
+        nbytes,                        /* memcap */
+        sizeof(tSFRFTrackingNodeKey),  /* keys size */
+        sizeof(tSFRFTrackingNode));    /* data size */
 }
 
 void SFRF_Delete (void)
@@ -178,14 +162,14 @@ void SFRF_Delete (void)
     if ( !rf_hash )
         return;
 
-    sfxhash_delete(rf_hash);
+    sfohash_delete(rf_hash);
     rf_hash = NULL;
 }
 
 void SFRF_Flush (void)
 {
     if ( rf_hash )
-        sfxhash_make_empty(rf_hash);
+        sfohash_make_empty(rf_hash);
 }
 
 static void SFRF_ConfigNodeFree(void *item)
@@ -806,7 +790,7 @@ static tSFRFTrackingNode* _getSFRFTrackingNode(
 ) {
     tSFRFTrackingNode* dynNode = NULL;
     tSFRFTrackingNodeKey key;
-    SFXHASH_NODE * hnode = NULL;
+    int added;
 
     /* Setup key */
     key.ip = *(IP_PTR(ip));
@@ -816,10 +800,9 @@ static tSFRFTrackingNode* _getSFRFTrackingNode(
     /*
      * Check for any Permanent sid objects for this gid or add this one ...
      */
-    hnode = sfxhash_get_node(rf_hash, (void*)&key);
-    if ( hnode && hnode->data )
+    dynNode = (tSFRFTrackingNode*)sfohash_get(rf_hash, (void*)&key, curTime, &added);
+    if ( dynNode )
     {
-        dynNode = (tSFRFTrackingNode*)hnode->data;
 
         if ( dynNode->filterState == FS_NEW )
         {
@@ -36,7 +36,7 @@
 
 #include "sflsq.h"
 #include "sfghash.h"
-#include "sfxhash.h"
+#include "sfohash.h"
 #include "sfPolicy.h"
 
 // define to use over rate threshold
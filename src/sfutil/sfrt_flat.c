@@ -90,6 +90,8 @@ table_flat_t *sfrt_flat_new(char table_flat_type, char ip_type,  long data_size,
     /* This will point to the actual table lookup algorithm */
     table->rt = 0;
     table->rt6 = 0;
+    table->next_rt = 0;
+    table->next_rt6 = 0;
 
     /* index 0 will be used for failed lookups, so set this to 1 */
     table->num_ent = 1;
@@ -389,4 +391,137 @@ uint32_t sfrt_flat_usage(table_flat_t *table)
     return usage;
 }
 
+#ifdef SHARED_REP
+/* Point the host entry for "adr" at "index" in the updated copy of the
+ * table, which is created by the first update after a publish.  The
+ * previous index of the host, if it had its own entry, is returned in
+ * "old_index" (0 otherwise). */
+int sfrt_flat_update_host(void *adr, FLAT_INDEX index, table_flat_t *table,
+        retireMemFunc retire, FLAT_INDEX *old_index)
+{
+    sfip_t *ip;
+    TABLE_PTR rt;
+    TABLE_PTR *next;
+    int len;
+
+    if(!adr || !table || !table->data)
+    {
+        return RT_INSERT_FAILURE;
+    }
+
+    ip = adr;
+
+    if (ip->family == AF_INET)
+    {
+        rt = table->rt;
+        next = &table->next_rt;
+        len = 32;
+    }
+    else if (ip->family == AF_INET6)
+    {
+        rt = table->rt6;
+        next = &table->next_rt6;
+        len = 128;
+    }
+    else
+    {
+        return RT_INSERT_FAILURE;
+    }
+
+    if (!rt || index >= table->max_size)
+    {
+        return RT_INSERT_FAILURE;
+    }
+
+    if (!*next)
+    {
+        *next = sfrt_dir_flat_copy_root(rt);
+
+        if (!*next)
+        {
+            return MEM_ALLOC_FAILURE;
+        }
+    }
+
+    return sfrt_dir_flat_update_host(ip, len, index, *next, retire, old_index);
+}
+
+/* Lookup "adr" including the updates not yet published */
+tuple_flat_t sfrt_flat_pending_lookup(void *adr, table_flat_t *table)
+{
+    tuple_flat_t ret = { 0, 0 };
+    sfip_t *ip;
+    TABLE_PTR rt = 0;
+
+    if(!adr || !table)
+    {
+        return ret;
+    }
 
+    ip = adr;
+
+    if (ip->family == AF_INET)
+    {
+        rt = table->next_rt ? table->next_rt : table->rt;
+    }
+    else if (ip->family == AF_INET6)
+    {
+        rt = table->next_rt6 ? table->next_rt6 : table->rt6;
+    }
+
+    if (!rt)
+    {
+        return ret;
+    }
+
+    return sfrt_dir_flat_lookup(ip, rt);
+}
+
+/* Make the updated tables visible to readers.  Everything they refer to
+ * must be in memory before the root offsets are, and each root is switched
+ * with a single aligned store, so a lookup sees either all or none of the
+ * updates to an address family. */
+void sfrt_flat_publish(table_flat_t *table, retireMemFunc retire)
+{
+    TABLE_PTR old;
+
+    if(!table)
+    {
+        return;
+    }
+
+    __sync_synchronize();
+
+    if (table->next_rt)
+    {
+        old = table->rt;
+        table->rt = table->next_rt;
+        table->next_rt = 0;
+        retire(old, sizeof(dir_table_flat_t));
+    }
+
+    if (table->next_rt6)
+    {
+        old = table->rt6;
+        table->rt6 = table->next_rt6;
+        table->next_rt6 = 0;
+        retire(old, sizeof(dir_table_flat_t));
+    }
+
+    __sync_synchronize();
+}
+
+/* Forget the updates not yet published.  The memory they used is given
+ * back with segment_rollback() if the caller marked the segment before
+ * the first update. */
+void sfrt_flat_discard(table_flat_t *table)
+{
+    if(!table)
+    {
+        return;
+    }
+
+    table->next_rt = 0;
+    table->next_rt6 = 0;
+}
+#endif
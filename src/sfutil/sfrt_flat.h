@@ -47,6 +47,10 @@ typedef enum
 
 typedef int64_t (*updateEntryInfoFunc)(INFO *entryInfo, INFO newInfo,
         SaveDest saveDest, uint8_t *base);
+
+/* Called with memory that is no longer reachable from the table being
+ * updated, but might still be used by readers of the published table */
+typedef void (*retireMemFunc)(MEM_OFFSET ptr, size_t size);
 typedef struct {
     FLAT_INDEX index;
     int length;
@@ -69,6 +73,8 @@ typedef struct {
     TABLE_PTR rt; /* Actual "routing" table */
     TABLE_PTR rt6; /* Actual "routing" table */
     TABLE_PTR list_info; /* List file information table (entry information)*/
+    TABLE_PTR next_rt; /* Updated copies of rt and rt6 not yet published */
+    TABLE_PTR next_rt6;
 
 } table_flat_t;
 /*******************************************************************/
@@ -83,6 +89,18 @@ int sfrt_flat_insert(void *adr, unsigned char len, INFO ptr, int behavior,
 uint32_t sfrt_flat_usage(table_flat_t *table);
 uint32_t sfrt_flat_num_entries(table_flat_t *table);
 
+#ifdef SHARED_REP
+/* Copy-on-write updates of host entries while the table is being read.
+ * Updates made with sfrt_flat_update_host() are seen by
+ * sfrt_flat_pending_lookup() right away, and by all other lookups after
+ * sfrt_flat_publish().  sfrt_flat_discard() drops them instead. */
+int sfrt_flat_update_host(void *adr, FLAT_INDEX index, table_flat_t *table,
+        retireMemFunc retire, FLAT_INDEX *old_index);
+tuple_flat_t sfrt_flat_pending_lookup(void *adr, table_flat_t *table);
+void sfrt_flat_publish(table_flat_t *table, retireMemFunc retire);
+void sfrt_flat_discard(table_flat_t *table);
+#endif
+
 /* Perform a lookup on value contained in "ip"
  * For performance reason, we use this simplified version instead of sfrt_lookup
  * Note: this only applied to table setting: DIR_8x16 (DIR_16_8_4x2 for IPV4), DIR_8x4*/
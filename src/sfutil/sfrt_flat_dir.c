@@ -106,6 +106,8 @@ static TABLE_PTR _sub_table_flat_new(dir_table_flat_t *root, uint32_t dimension,
 
     sub->cur_num = 0;
 
+    sub->generation = root->generation;
+
     root->allocated += sizeof(dir_sub_table_flat_t) + sizeof(DIR_Entry) * sub->num_entries;
 
     root->cur_num++;
@@ -151,6 +153,8 @@ TABLE_PTR sfrt_dir_flat_new(uint32_t mem_cap, int count,...)
 
     table->cur_num = 0;
 
+    table->generation = 0;
+
     table->sub_table = _sub_table_flat_new(table, 0, 0, 0);
 
     if(!table->sub_table)
@@ -604,6 +608,198 @@ tuple_flat_t sfrt_dir_flat_lookup(snort_ip_p ip, TABLE_PTR table_ptr)
 }
 
 
+#ifdef SHARED_REP
+/* Copy-on-write updates
+ *
+ * Readers in other processes walk the tables without any locking, so a
+ * table they can reach is never modified.  Updates are made below a copy of
+ * the root with the next generation number: every sub table on the path to
+ * an updated entry that belongs to an older generation is copied first, and
+ * the copy is linked into its (already copied) parent.  The caller makes
+ * the new root visible with a single store once all updates are done.
+ * Tables replaced by copies are passed to the retire callback. */
+
+/* Copy a sub table of an older generation for the current root */
+static SUB_TABLE_PTR _sub_table_flat_copy(dir_table_flat_t *root,
+        SUB_TABLE_PTR sub_ptr, retireMemFunc retire)
+{
+    uint8_t *base = (uint8_t *)segment_basePtr();
+    dir_sub_table_flat_t *sub = (dir_sub_table_flat_t *)(&base[sub_ptr]);
+    dir_sub_table_flat_t *copy;
+    SUB_TABLE_PTR copy_ptr;
+    ENTRIES_PTR entries;
+    size_t size = sizeof(DIR_Entry) * sub->num_entries;
+
+    copy_ptr = segment_malloc(sizeof(dir_sub_table_flat_t));
+
+    if (!copy_ptr)
+    {
+        return 0;
+    }
+
+    entries = segment_malloc(size);
+
+    if (!entries)
+    {
+        segment_release(copy_ptr, sizeof(dir_sub_table_flat_t));
+        return 0;
+    }
+
+    copy = (dir_sub_table_flat_t *)(&base[copy_ptr]);
+    *copy = *sub;
+    copy->entries = entries;
+    copy->generation = root->generation;
+    memcpy(&base[entries], &base[sub->entries], size);
+
+    retire(sub->entries, size);
+    retire(sub_ptr, sizeof(dir_sub_table_flat_t));
+
+    return copy_ptr;
+}
+
+/* Copy the root to start a new generation.  The sub tables are shared with
+ * the original until they are updated. */
+TABLE_PTR sfrt_dir_flat_copy_root(TABLE_PTR table_ptr)
+{
+    uint8_t *base = (uint8_t *)segment_basePtr();
+    dir_table_flat_t *copy;
+    TABLE_PTR copy_ptr;
+
+    if (!table_ptr)
+    {
+        return 0;
+    }
+
+    copy_ptr = segment_malloc(sizeof(dir_table_flat_t));
+
+    if (!copy_ptr)
+    {
+        return 0;
+    }
+
+    copy = (dir_table_flat_t *)(&base[copy_ptr]);
+    *copy = *(dir_table_flat_t *)(&base[table_ptr]);
+    copy->generation++;
+
+    return copy_ptr;
+}
+
+/* Point a single host entry ('len' is the full address length) in the tree
+ * of a root returned by sfrt_dir_flat_copy_root() at data_index.  If the
+ * entry was already a host entry, its previous data index is returned in
+ * old_index, otherwise old_index is 0. */
+int sfrt_dir_flat_update_host(snort_ip_p ip, int len, word data_index,
+        TABLE_PTR table_ptr, retireMemFunc retire, MEM_OFFSET *old_index)
+{
+    uint8_t *base = (uint8_t *)segment_basePtr();
+    dir_table_flat_t *root;
+    SUB_TABLE_PTR *sub_ptr;
+    int cur_len = len;
+    int depth = 0;
+    int bits = 0;
+
+    *old_index = 0;
+
+    if (!table_ptr)
+    {
+        return DIR_INSERT_FAILURE;
+    }
+
+    root = (dir_table_flat_t *)(&base[table_ptr]);
+    sub_ptr = &root->sub_table;
+
+    while (*sub_ptr)
+    {
+        dir_sub_table_flat_t *sub_table = (dir_sub_table_flat_t *)(&base[*sub_ptr]);
+        DIR_Entry *entry;
+        word index;
+        uint32_t local_index, i;
+
+        if (sub_table->generation != root->generation)
+        {
+            SUB_TABLE_PTR copy = _sub_table_flat_copy(root, *sub_ptr, retire);
+
+            if (!copy)
+            {
+                return MEM_ALLOC_FAILURE;
+            }
+
+            *sub_ptr = copy;
+            sub_table = (dir_sub_table_flat_t *)(&base[copy]);
+        }
+
+        /* need to handle bits usage across multiple 32bit vals within IPv6. */
+        if (ip->family == AF_INET)
+        {
+            i = 0;
+        }
+        else if (ip->family == AF_INET6)
+        {
+            i = bits / 32;
+        }
+        else
+        {
+            return RT_INSERT_FAILURE;
+        }
+        local_index = ip->ip32[i] << (bits % 32);
+        index = local_index >> (ARCH_WIDTH - sub_table->width);
+
+        entry = (DIR_Entry *)(&base[sub_table->entries]);
+
+        /* Only whole host addresses are updated, which always end on the
+         * last bit of a table */
+        if (sub_table->width >= cur_len)
+        {
+            if (sub_table->width != cur_len)
+            {
+                return RT_INSERT_FAILURE;
+            }
+
+            if (entry[index].length == len)
+            {
+                *old_index = entry[index].value;
+            }
+
+            entry[index].value = data_index;
+            entry[index].length = (uint8_t)len;
+
+            return RT_SUCCESS;
+        }
+
+        /* The new sub table inherits the less specific entry */
+        if (!entry[index].value || entry[index].length)
+        {
+            SUB_TABLE_PTR next;
+
+            if (root->dim_size <= depth + 1)
+            {
+                return RT_INSERT_FAILURE;
+            }
+
+            next = _sub_table_flat_new(root, depth + 1,
+                    (word) entry[index].value, entry[index].length);
+
+            if (!next)
+            {
+                return MEM_ALLOC_FAILURE;
+            }
+
+            sub_table->cur_num++;
+
+            entry[index].value = next;
+            entry[index].length = 0;
+        }
+
+        sub_ptr = &entry[index].value;
+        bits += sub_table->width;
+        cur_len -= sub_table->width;
+        depth++;
+    }
+
+    return DIR_INSERT_FAILURE;
+}
+#endif
+
 uint32_t sfrt_dir_flat_usage(TABLE_PTR table_ptr)
 {
     dir_table_flat_t *table;
@@ -48,6 +48,8 @@ typedef struct
                       * are used. */
     int cur_num;     /* Present number of used nodes */
 
+    uint32_t generation; /* Generation of the root that created this table */
+
     ENTRIES_PTR entries;
 
 } dir_sub_table_flat_t;
@@ -67,6 +69,8 @@ typedef struct
 
     uint32_t allocated;
 
+    uint32_t generation; /* Incremented by each copy-on-write update */
+
     SUB_TABLE_PTR sub_table;
 } dir_table_flat_t;
 
@@ -78,6 +82,11 @@ tuple_flat_t  sfrt_dir_flat_lookup(snort_ip_p ip, TABLE_PTR table);
 int           sfrt_dir_flat_insert(snort_ip_p ip, int len, word data_index,
                                int behavior, TABLE_PTR, updateEntryInfoFunc updateEntry, INFO *data);
 uint32_t      sfrt_dir_flat_usage(TABLE_PTR);
+#ifdef SHARED_REP
+TABLE_PTR     sfrt_dir_flat_copy_root(TABLE_PTR);
+int           sfrt_dir_flat_update_host(snort_ip_p ip, int len, word data_index,
+                               TABLE_PTR, retireMemFunc retire, MEM_OFFSET *old_index);
+#endif
 
 #endif /* SFRT_DIR_FLAT_H_ */
 
@@ -47,7 +47,7 @@
 #include "parser/IpAddrSet.h"
 #include "sflsq.h"
 #include "sfghash.h"
-#include "sfxhash.h"
+#include "sfohash.h"
 
 #include "snort.h"
 #include "sfthd.h"
@@ -60,27 +60,9 @@
 // This disables adding and testing of Threshold objects
 //#define CRIPPLE
 
-SFXHASH * sfthd_new_hash(unsigned nbytes, size_t key, size_t data)
+SFOHASH * sfthd_new_hash(unsigned nbytes, size_t key, size_t data)
 {
-    size_t size = key + data;
-    int nrows;
-
-    /* Calc max ip nodes for this memory */
-    if ( nbytes < size )
-    {
-        nbytes = size;
-    }
-    nrows = nbytes / (size);
-
-    return sfxhash_new(
-        nrows,  /* try one node per row - for speed */
-        key,    /* keys size */
-        data,   /* data size */
-        nbytes, /* memcap **/
-        1,      /* ANR flag - true ?- Automatic Node Recovery=ANR */
-        0,      /* ANR callback - none */
-        0,      /* user freemem callback - none */
-        1 ) ;   /* Recycle nodes ?*/
+    return sfohash_new(nbytes, key, data);
 }
 
 /*!
@@ -94,31 +76,31 @@ SFXHASH * sfthd_new_hash(unsigned nbytes, size_t key, size_t data)
   @retval !0 valid THD_STRUCT
 */
 
-SFXHASH * sfthd_local_new(unsigned bytes)
+SFOHASH * sfthd_local_new(unsigned bytes)
 {
-    SFXHASH *local_hash =
+    SFOHASH *local_hash =
         sfthd_new_hash(bytes,
                        sizeof(THD_IP_NODE_KEY),
                        sizeof(THD_IP_NODE));
 
 #ifdef THD_DEBUG
     if (local_hash == NULL)
-        printf("Could not allocate the sfxhash table\n");
+        printf("Could not allocate the sfohash table\n");
 #endif
 
     return local_hash;
 }
 
-SFXHASH * sfthd_global_new(unsigned bytes)
+SFOHASH * sfthd_global_new(unsigned bytes)
 {
-    SFXHASH *global_hash =
+    SFOHASH *global_hash =
         sfthd_new_hash(bytes,
                        sizeof(THD_IP_GNODE_KEY),
                        sizeof(THD_IP_NODE));
 
 #ifdef THD_DEBUG
     if (global_hash == NULL)
-        printf("Could not allocate the sfxhash table\n");
+        printf("Could not allocate the sfohash table\n");
 #endif
 
     return global_hash;
@@ -137,7 +119,7 @@ THD_STRUCT * sfthd_new(unsigned lbytes, unsigned gbytes)
     if( !thd->ip_nodes )
     {
 #ifdef THD_DEBUG
-        printf("Could not allocate the sfxhash table\n");
+        printf("Could not allocate the sfohash table\n");
 #endif
         free(thd);
         return NULL;
@@ -151,9 +133,9 @@ THD_STRUCT * sfthd_new(unsigned lbytes, unsigned gbytes)
     if( !thd->ip_gnodes )
     {
 #ifdef THD_DEBUG
-        printf("Could not allocate the sfxhash table\n");
+        printf("Could not allocate the sfohash table\n");
 #endif
-        sfxhash_delete(thd->ip_nodes);
+        sfohash_delete(thd->ip_nodes);
         free(thd);
         return NULL;
     }
@@ -252,10 +234,10 @@ void sfthd_free(THD_STRUCT *thd)
 
 #ifndef CRIPPLE
     if (thd->ip_nodes != NULL)
-        sfxhash_delete(thd->ip_nodes);
+        sfohash_delete(thd->ip_nodes);
 
     if (thd->ip_gnodes != NULL)
-        sfxhash_delete(thd->ip_gnodes);
+        sfohash_delete(thd->ip_gnodes);
 #endif
 
     free(thd);
@@ -685,7 +667,7 @@ static char * printIP(unsigned u )
 }
 #endif
 
-int sfthd_test_rule(SFXHASH *rule_hash, THD_NODE *sfthd_node,
+int sfthd_test_rule(SFOHASH *rule_hash, THD_NODE *sfthd_node,
                     snort_ip_p sip, snort_ip_p dip, long curtime)
 {
     int status;
@@ -885,7 +867,7 @@ static inline int sfthd_test_non_suppress(
  *
  */
 int sfthd_test_local(
-    SFXHASH *local_hash,
+    SFOHASH *local_hash,
     THD_NODE   * sfthd_node,
     snort_ip_p   sip,
     snort_ip_p   dip,
@@ -893,7 +875,7 @@ int sfthd_test_local(
 {
     THD_IP_NODE_KEY key;
     THD_IP_NODE     data,*sfthd_ip_node;
-    int             status=0;
+    int             added;
     snort_ip_p      ip;
     tSfPolicyId policy_id = getRuntimePolicy();
 
@@ -943,31 +925,28 @@ int sfthd_test_local(
     key.ip     = IP_VAL(ip);
     key.thd_id = sfthd_node->thd_id;
 
-    /* Set up a new data element */
-    data.count  = 1;
-    data.prev   = 0;
-    data.tstart = data.tlast = curtime; /* Event time */
-
     /*
      * Check for any Permanent sig_id objects for this gen_id  or add this one ...
      */
-    status = sfxhash_add(local_hash, (void*)&key, &data);
-    if (status == SFXHASH_INTABLE)
-    {
-        /* Already in the table */
-        sfthd_ip_node = local_hash->cnode->data;
-
-        /* Increment the event count */
-        sfthd_ip_node->count++;
-    }
-    else if (status != SFXHASH_OK)
+    sfthd_ip_node = sfohash_get(local_hash, (void*)&key, curtime, &added);
+    if ( !sfthd_ip_node )
     {
         /* hash error */
         return 1; /*  check the next threshold object */
     }
+    else if ( !added )
+    {
+        /* Already in the table - increment the event count */
+        sfthd_ip_node->count++;
+    }
     else
     {
         /* Was not in the table - it was added - work with our copy of the data */
+        sfthd_ip_node->count  = 1;
+        sfthd_ip_node->prev   = 0;
+        sfthd_ip_node->tstart = sfthd_ip_node->tlast = curtime; /* Event time */
+
+        data = *sfthd_ip_node;
         sfthd_ip_node = &data;
     }
 
@@ -978,7 +957,7 @@ int sfthd_test_local(
  *   Test a global thresholding object
  */
 static inline int sfthd_test_global(
-    SFXHASH *global_hash,
+    SFOHASH *global_hash,
     THD_NODE   * sfthd_node,
     unsigned     gen_id,     /* from current event */
     unsigned     sig_id,     /* from current event */
@@ -988,7 +967,7 @@ static inline int sfthd_test_global(
 {
     THD_IP_GNODE_KEY key;
     THD_IP_NODE      data, *sfthd_ip_node;
-    int              status=0;
+    int              added;
     snort_ip_p       ip;
     tSfPolicyId policy_id = getRuntimePolicy();
 
@@ -1036,29 +1015,28 @@ static inline int sfthd_test_global(
     key.sig_id = sig_id;
     key.policyId = policy_id;
 
-    /* Set up a new data element */
-    data.count  = 1;
-    data.prev  = 0;
-    data.tstart = data.tlast = curtime; /* Event time */
-
-    /* Check for any Permanent sig_id objects for this gen_id  or add this one ...  */
-    status = sfxhash_add(global_hash, (void*)&key, &data);
-    if (status == SFXHASH_INTABLE)
-    {
-        /* Already in the table */
-        sfthd_ip_node = global_hash->cnode->data;
-
-        /* Increment the event count */
-        sfthd_ip_node->count++;
-    }
-    else if (status != SFXHASH_OK)
+    /*
+     * Check for any Permanent sig_id objects for this gen_id  or add this one ...
+     */
+    sfthd_ip_node = sfohash_get(global_hash, (void*)&key, curtime, &added);
+    if ( !sfthd_ip_node )
     {
         /* hash error */
         return 1; /*  check the next threshold object */
     }
+    else if ( !added )
+    {
+        /* Already in the table - increment the event count */
+        sfthd_ip_node->count++;
+    }
     else
     {
         /* Was not in the table - it was added - work with our copy of the data */
+        sfthd_ip_node->count  = 1;
+        sfthd_ip_node->prev   = 0;
+        sfthd_ip_node->tstart = sfthd_ip_node->tlast = curtime; /* Event time */
+
+        data = *sfthd_ip_node;
         sfthd_ip_node = &data;
     }
 
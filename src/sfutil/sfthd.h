@@ -30,7 +30,7 @@
 
 #include "sflsq.h"
 #include "sfghash.h"
-#include "sfxhash.h"
+#include "sfohash.h"
 #include "sfPolicy.h"
 #include "sfPolicyUserData.h"
 
@@ -195,8 +195,8 @@ typedef struct {
  */
 typedef struct _THD_STRUCT
 {
-    SFXHASH *ip_nodes;   /* Global hash of active IP's key=THD_IP_NODE_KEY, data=THD_IP_NODE */
-    SFXHASH *ip_gnodes;  /* Global hash of active IP's key=THD_IP_GNODE_KEY, data=THD_IP_GNODE */
+    SFOHASH *ip_nodes;   /* Global hash of active IP's key=THD_IP_NODE_KEY, data=THD_IP_NODE */
+    SFOHASH *ip_gnodes;  /* Global hash of active IP's key=THD_IP_GNODE_KEY, data=THD_IP_GNODE */
 
 } THD_STRUCT;
 
@@ -224,13 +224,13 @@ typedef struct _ThresholdObjects
 // lbytes = local threshold memcap
 // gbytes = global threshold memcap (0 to disable global)
 THD_STRUCT * sfthd_new(unsigned lbytes, unsigned gbytes);
-SFXHASH * sfthd_local_new(unsigned bytes);
-SFXHASH * sfthd_global_new(unsigned bytes);
+SFOHASH * sfthd_local_new(unsigned bytes);
+SFOHASH * sfthd_global_new(unsigned bytes);
 void sfthd_free(THD_STRUCT *);
 ThresholdObjects * sfthd_objs_new(void);
 void sfthd_objs_free(ThresholdObjects *);
 
-int sfthd_test_rule(SFXHASH *rule_hash, THD_NODE *sfthd_node,
+int sfthd_test_rule(SFOHASH *rule_hash, THD_NODE *sfthd_node,
                     snort_ip_p sip, snort_ip_p dip, long curtime);
 
 void * sfthd_create_rule_threshold(
@@ -268,10 +268,10 @@ int sfthd_test_threshold(
     long         curtime ) ;
 
 
-SFXHASH * sfthd_new_hash(unsigned, size_t, size_t);
+SFOHASH * sfthd_new_hash(unsigned, size_t, size_t);
 
 int sfthd_test_local(
-    SFXHASH *local_hash,
+    SFOHASH *local_hash,
     THD_NODE   * sfthd_node,
     snort_ip_p   sip,
     snort_ip_p   dip,
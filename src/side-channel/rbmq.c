@@ -30,8 +30,29 @@
 
 #ifndef SC_USE_DMQ
 
+/*
+ * The ring buffer message queue is a single-producer/single-consumer lock-free queue.
+ *
+ * Messages are tracked with four free-running sequence numbers into a power-of-two sized
+ * control ring: the producer reserves at prod.head and publishes everything before prod.tail,
+ * the consumer reads at cons.head and releases everything before cons.tail.  Entries between
+ * prod.tail and prod.head belong to the producer, entries between cons.tail and prod.tail belong
+ * to the consumer.  The only state shared between the two threads is prod.tail, cons.tail and
+ * the data ring read offset, each of which has exactly one writer.
+ *
+ * Both sides cache the other side's published index and only reload it when they appear to
+ * have run out of work (or space), so a burst of messages is handed over with a single
+ * acquire/release pair regardless of its size.
+ */
+
 #define RBMQ_MSG_FLAG_EXTERNAL  0x01
 
+#define RBMQ_CACHE_LINE_SIZE    64
+#define RBMQ_DATA_ALIGNMENT     8
+
+#define RBMQ_LOAD_ACQUIRE(p)        __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define RBMQ_STORE_RELEASE(p, v)    __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
 enum {
     RBMQ_MSG_STATE_UNUSED = 0,
     RBMQ_MSG_STATE_RESERVED,
@@ -44,80 +65,95 @@ enum {
 typedef struct _rbmq_msg
 {
     uint32_t length;
+    uint32_t data_offset;
+    uint32_t end_offset;
+    uint32_t prev_write_offset;
     uint8_t flags;
     uint8_t state;
     uint8_t *data;
     SCMQMsgFreeFunc msgFreeFunc;
 } RBMQ_Msg;
 
-typedef struct _rmbq_internal_data_hdr
+/* Owned and written exclusively by the producer thread. */
+typedef struct _rbmq_producer
+{
+    uint32_t head;
+    uint32_t tail;
+    uint32_t write_offset;
+    uint32_t cached_cons_tail;
+    uint32_t max_depth;
+    uint32_t reserve_failures;
+} RBMQ_Producer;
+
+/* Owned and written exclusively by the consumer thread. */
+typedef struct _rbmq_consumer
 {
-    uint32_t msg_index;
-    uint32_t prev_offset;
-} RBMQ_InternalDataHdr;
+    uint32_t head;
+    uint32_t tail;
+    uint32_t read_offset;
+    uint32_t cached_prod_tail;
+} RBMQ_Consumer;
 
-typedef struct _rbmq_msg_ring
+typedef struct _rbmq
 {
+    RBMQ_Producer prod;
+    uint8_t pad0[RBMQ_CACHE_LINE_SIZE - sizeof(RBMQ_Producer)];
+    RBMQ_Consumer cons;
+    uint8_t pad1[RBMQ_CACHE_LINE_SIZE - sizeof(RBMQ_Consumer)];
+
+    /* Read-only after allocation. */
     RBMQ_Msg *msgs;
     uint8_t *headers;
-    uint32_t last_reserved;
-    uint32_t last_read;
-    uint32_t last_acked;
+    uint8_t *data;
     uint32_t entries;
+    uint32_t mask;
+    uint32_t data_size;
     uint16_t header_size;
-} RBMQ_MsgRing;
-
-typedef struct _rbmq_data_ring
-{
-    uint8_t *data;
-    uint32_t read_offset;
-    uint32_t write_offset;
-    uint32_t size;
-} RBMQ_DataRing;
+} RBMQ;
 
-typedef struct _rbmq
+static inline RBMQ_Msg *GetMessage(RBMQ *mq, uint32_t seq)
 {
-    RBMQ_MsgRing msg_ring;
-    RBMQ_DataRing data_ring;
-} RBMQ;
+    return &mq->msgs[seq & mq->mask];
+}
 
-static inline uint32_t IncrementMessageIndex(RBMQ *mq, uint32_t index)
+static inline void *GetMessageHeader(RBMQ *mq, RBMQ_Msg *msg_info)
 {
-    return (++index == mq->msg_ring.entries) ? 0 : index;
+    if (!mq->header_size)
+        return NULL;
+    return mq->headers + ((msg_info - mq->msgs) * mq->header_size);
 }
 
-static inline uint32_t DecrementMessageIndex(RBMQ *mq, uint32_t index)
+static inline uint32_t AlignDataLength(uint32_t length)
 {
-    return (index == 0) ? (mq->msg_ring.entries - 1) : (index - 1);
+    return (length + RBMQ_DATA_ALIGNMENT - 1) & ~(RBMQ_DATA_ALIGNMENT - 1);
 }
 
 /* Returns 0 if the message handle is within bounds for the control ring, non-zero otherwise. */
 static inline int ValidateMsgHandle(RBMQ *mq, void *msg_handle)
 {
-    return (msg_handle < (void *)(&mq->msg_ring.msgs[0]) || msg_handle > (void *)(&mq->msg_ring.msgs[mq->msg_ring.entries - 1]));
+    return (msg_handle < (void *)(&mq->msgs[0]) || msg_handle > (void *)(&mq->msgs[mq->entries - 1]));
 }
 
 RBMQ *RBMQ_Alloc(uint32_t msg_ring_entries, uint16_t msg_ring_header_size, uint32_t data_ring_size)
 {
     RBMQ *mq;
+    uint32_t entries;
+
+    /* Round the control ring up to a power of two so that sequence numbers can be masked. */
+    for (entries = 1; entries < msg_ring_entries; entries <<= 1);
 
     mq = SnortAlloc(sizeof(RBMQ));
-    memset(mq, 0, sizeof(RBMQ));
 
     /* Initialize the control ring. */
-    mq->msg_ring.msgs = SnortAlloc(msg_ring_entries * sizeof(RBMQ_Msg));
-    mq->msg_ring.headers = SnortAlloc(msg_ring_entries * msg_ring_header_size);
-    mq->msg_ring.entries = msg_ring_entries;
-    mq->msg_ring.header_size = msg_ring_header_size;
-    memset(mq->msg_ring.msgs, 0, mq->msg_ring.entries * sizeof(RBMQ_Msg));
-    mq->msg_ring.last_reserved = 0;
-    mq->msg_ring.last_read = 0;
-    mq->msg_ring.last_acked = 0;
+    mq->msgs = SnortAlloc(entries * sizeof(RBMQ_Msg));
+    mq->headers = SnortAlloc(entries * msg_ring_header_size);
+    mq->entries = entries;
+    mq->mask = entries - 1;
+    mq->header_size = msg_ring_header_size;
 
     /* Initialize the data ring. */
-    mq->data_ring.data = SnortAlloc(data_ring_size);
-    mq->data_ring.size = data_ring_size;
-    memset(mq->data_ring.data, 0, mq->data_ring.size);
+    mq->data = SnortAlloc(data_ring_size);
+    mq->data_size = data_ring_size;
 
     return mq;
 }
@@ -125,83 +161,116 @@ RBMQ *RBMQ_Alloc(uint32_t msg_ring_entries, uint16_t msg_ring_header_size, uint3
 void RBMQ_Destroy(RBMQ *mq)
 {
     RBMQ_Msg *msg_info;
-    uint32_t idx;
+    uint32_t seq;
 
     /* Free the data for any unprocessed messages. */
-    idx = mq->msg_ring.last_acked;
-    while (idx != mq->msg_ring.last_reserved)
+    for (seq = mq->cons.tail; seq != mq->prod.head; seq++)
     {
-        idx++;
-        if (idx == mq->msg_ring.entries)
-            idx = 0;
-        msg_info = &mq->msg_ring.msgs[idx];
-        if (msg_info->msgFreeFunc)
+        msg_info = GetMessage(mq, seq);
+        if (msg_info->state != RBMQ_MSG_STATE_DISCARDED && msg_info->state != RBMQ_MSG_STATE_ACKED &&
+                msg_info->msgFreeFunc)
             msg_info->msgFreeFunc(msg_info->data);
     }
-    
+
     /* Release all of our resources. */
-    free(mq->data_ring.data);
-    free(mq->msg_ring.msgs);
+    free(mq->data);
+    free(mq->headers);
+    free(mq->msgs);
+    free(mq);
+}
+
+/* Producer: make every committed or discarded message at the front of the reserved range visible. */
+static inline void PublishMessages(RBMQ *mq)
+{
+    RBMQ_Msg *msg_info;
+    uint32_t tail = mq->prod.tail;
+    uint32_t depth;
+
+    while (tail != mq->prod.head)
+    {
+        msg_info = GetMessage(mq, tail);
+        if (msg_info->state != RBMQ_MSG_STATE_COMMITTED && msg_info->state != RBMQ_MSG_STATE_DISCARDED)
+            break;
+        tail++;
+    }
+
+    if (tail == mq->prod.tail)
+        return;
+
+    RBMQ_STORE_RELEASE(&mq->prod.tail, tail);
+
+    depth = tail - mq->prod.cached_cons_tail;
+    if (depth > mq->prod.max_depth)
+        mq->prod.max_depth = depth;
+}
+
+/* Producer: claim the next entry in the control ring, refreshing the consumer position only when it looks full. */
+static inline RBMQ_Msg *ClaimMessage(RBMQ *mq)
+{
+    if (mq->prod.head - mq->prod.cached_cons_tail >= mq->entries)
+    {
+        mq->prod.cached_cons_tail = RBMQ_LOAD_ACQUIRE(&mq->cons.tail);
+        if (mq->prod.head - mq->prod.cached_cons_tail >= mq->entries)
+        {
+            mq->prod.reserve_failures++;
+            return NULL;
+        }
+    }
+
+    return GetMessage(mq, mq->prod.head);
 }
 
 int RBMQ_ReserveMsg(RBMQ *mq, uint32_t length, void **hdr_ptr, uint8_t **msg_ptr, void **msg_handle)
 {
-    RBMQ_InternalDataHdr *idh;
     RBMQ_Msg *msg_info;
-    uint32_t msg_index, msg_len, start_offset;
+    uint32_t msg_len, start_offset, read_offset, write_offset;
 
     /* Find the next entry in the message ring to reserve. */
-    msg_index = IncrementMessageIndex(mq, mq->msg_ring.last_reserved);
-    msg_info = &mq->msg_ring.msgs[msg_index];
-
-    /* Bail if the entry is in use. */
-    if (msg_info->state != RBMQ_MSG_STATE_UNUSED)
+    if (!(msg_info = ClaimMessage(mq)))
         return -ENOMEM;
 
-    /* Make sure that we can reserve the requested space in the data ring. */
-    msg_len = length + sizeof(RBMQ_InternalDataHdr);
-    if (mq->data_ring.write_offset < mq->data_ring.read_offset)
+    /* Make sure that we can reserve the requested space in the data ring.  The write offset is
+        never allowed to catch up to the read offset from behind, so equal offsets mean empty. */
+    msg_len = AlignDataLength(length);
+    read_offset = RBMQ_LOAD_ACQUIRE(&mq->cons.read_offset);
+    write_offset = mq->prod.write_offset;
+    if (write_offset < read_offset)
     {
-        if ((mq->data_ring.read_offset - mq->data_ring.write_offset) < msg_len)
-            return -ENOMEM;
-        start_offset = mq->data_ring.write_offset;
+        if ((read_offset - write_offset) <= msg_len)
+            goto nomem;
+        start_offset = write_offset;
     }
-    else if ((mq->data_ring.size - mq->data_ring.write_offset) < msg_len)
+    else if ((mq->data_size - write_offset) < msg_len)
     {
-        if (mq->data_ring.read_offset < msg_len)
-            return -ENOMEM;
+        if (read_offset <= msg_len)
+            goto nomem;
         start_offset = 0;
     }
     else
-        start_offset = mq->data_ring.write_offset;
-
-    idh = (RBMQ_InternalDataHdr *) (mq->data_ring.data + start_offset);
-    idh->msg_index = msg_index;
-    idh->prev_offset = mq->data_ring.write_offset;
+        start_offset = write_offset;
 
-    /* Update the write offset in the data ring, wrapping as necessary. */
-    mq->data_ring.write_offset = start_offset + msg_len;
-    if (mq->data_ring.write_offset == mq->data_ring.size)
-        mq->data_ring.write_offset = 0;
+    mq->prod.write_offset = start_offset + msg_len;
 
     msg_info->length = length;
-    /* Type is filled in during the commit. */
+    msg_info->data_offset = start_offset;
+    msg_info->end_offset = start_offset + msg_len;
+    msg_info->prev_write_offset = write_offset;
     msg_info->flags = 0;
     msg_info->state = RBMQ_MSG_STATE_RESERVED;
-    msg_info->data = (uint8_t *) idh + sizeof(RBMQ_InternalDataHdr);
+    msg_info->data = mq->data + start_offset;
     msg_info->msgFreeFunc = NULL;
 
-    /* Update the last reservation index in the control ring. */
-    mq->msg_ring.last_reserved = msg_index;
+    mq->prod.head++;
 
-    if (mq->msg_ring.header_size)
-        *hdr_ptr = mq->msg_ring.headers + (msg_index * mq->msg_ring.header_size);
-    else
-        *hdr_ptr = NULL;
+    *hdr_ptr = GetMessageHeader(mq, msg_info);
     *msg_ptr = msg_info->data;
     *msg_handle = (void *) msg_info;
 
     return 0;
+
+nomem:
+    mq->prod.reserve_failures++;
+    return -ENOMEM;
 }
 
 int RBMQ_CommitReservedMsg(RBMQ *mq, void *msg_handle, uint32_t length, SCMQMsgFreeFunc msgFreeFunc)
@@ -227,27 +296,25 @@ int RBMQ_CommitReservedMsg(RBMQ *mq, void *msg_handle, uint32_t length, SCMQMsgF
     }
 
     /* If the committed length is less than the reserved length and it was the last message reserved,
-        truncate the internal data ring usage. */
-    if (length < msg_info->length && msg_info == &mq->msg_ring.msgs[mq->msg_ring.last_reserved])
+        give the unused tail back to the data ring. */
+    if (length < msg_info->length && msg_info == GetMessage(mq, mq->prod.head - 1))
     {
-        if (mq->data_ring.write_offset != 0)
-            mq->data_ring.write_offset -= (msg_info->length - length);
-        else
-            mq->data_ring.write_offset = mq->data_ring.size - (msg_info->length - length);
-        msg_info->length = length;
+        msg_info->end_offset = msg_info->data_offset + AlignDataLength(length);
+        mq->prod.write_offset = msg_info->end_offset;
     }
+    msg_info->length = length;
 
-    msg_info->state = RBMQ_MSG_STATE_COMMITTED;
     msg_info->msgFreeFunc = msgFreeFunc;
+    msg_info->state = RBMQ_MSG_STATE_COMMITTED;
+
+    PublishMessages(mq);
 
     return 0;
 }
 
 int RBMQ_DiscardReservedMsg(RBMQ *mq, void *msg_handle)
 {
-    RBMQ_InternalDataHdr *idh;
     RBMQ_Msg *msg_info;
-    uint32_t idx;
 
     if (ValidateMsgHandle(mq, msg_handle))
         return -EINVAL;
@@ -263,50 +330,41 @@ int RBMQ_DiscardReservedMsg(RBMQ *mq, void *msg_handle)
 
     msg_info->state = RBMQ_MSG_STATE_DISCARDED;
 
-    /* Working backward from the last entry reserved (in order), release discarded messages as allowed. 
-        Any discarded messages that we can't release here will have to wait until something gets ACK'd. */
-    idx = mq->msg_ring.last_reserved;
-    msg_info = &mq->msg_ring.msgs[idx];
-    while (msg_info->state == RBMQ_MSG_STATE_DISCARDED)
+    /* Working backward from the last entry reserved, release discarded messages that the consumer
+        has not been shown yet.  Anything else is skipped by the consumer and released on its side. */
+    while (mq->prod.head != mq->prod.tail)
     {
-        /* Clean up the data ring state if this was internally allocated.  Only internally allocated
-            messages can be discarded, so this should be safe. */
-        idh = (RBMQ_InternalDataHdr *) (msg_info->data - sizeof(RBMQ_InternalDataHdr));
-        mq->data_ring.write_offset = idh->prev_offset;
+        msg_info = GetMessage(mq, mq->prod.head - 1);
+        if (msg_info->state != RBMQ_MSG_STATE_DISCARDED)
+            break;
 
-        /* Reset the state to unused so that it can be reserved again. */
+        /* Only internally allocated messages can be discarded, so this should be safe. */
+        mq->prod.write_offset = msg_info->prev_write_offset;
         msg_info->state = RBMQ_MSG_STATE_UNUSED;
-
-        /* Finally, update the last reserved index. */
-        idx = DecrementMessageIndex(mq, idx);
-        mq->msg_ring.last_reserved = idx;
-        msg_info = &mq->msg_ring.msgs[idx];
+        mq->prod.head--;
     }
 
+    PublishMessages(mq);
+
     return 0;
 }
 
 int RBMQ_CommitExternalMsg(RBMQ *mq, const void *hdr, uint8_t *msg, uint32_t length, SCMQMsgFreeFunc msgFreeFunc)
 {
     RBMQ_Msg *msg_info;
-    uint32_t idx;
 
     /* V Reserve and commit the message all in one step. V */
 
     /* Find the next entry in the message ring to reserve. */
-    idx = IncrementMessageIndex(mq, mq->msg_ring.last_reserved);
-    msg_info = &mq->msg_ring.msgs[idx];
-
-    /* Bail if the entry is in use. */
-    if (msg_info->state != RBMQ_MSG_STATE_UNUSED)
+    if (!(msg_info = ClaimMessage(mq)))
         return -ENOMEM;
 
     /* Require a header if there is a header size specified for the control ring and copy it over. */
-    if (mq->msg_ring.header_size)
+    if (mq->header_size)
     {
         if (!hdr)
             return -EINVAL;
-        memcpy(mq->msg_ring.headers + (idx * mq->msg_ring.header_size), hdr, mq->msg_ring.header_size);
+        memcpy(GetMessageHeader(mq, msg_info), hdr, mq->header_size);
     }
 
     msg_info->length = length;
@@ -315,43 +373,75 @@ int RBMQ_CommitExternalMsg(RBMQ *mq, const void *hdr, uint8_t *msg, uint32_t len
     msg_info->data = msg;
     msg_info->msgFreeFunc = msgFreeFunc;
 
-    /* Update the last reservation index in the control ring. */
-    mq->msg_ring.last_reserved = idx;
+    mq->prod.head++;
+
+    PublishMessages(mq);
 
     return 0;
 }
 
-int RBMQ_ReadMsg(RBMQ *mq, const void **hdr_ptr, const uint8_t **msg_ptr, uint32_t *length, void **msg_handle)
+/* Consumer: hand every acknowledged message at the front of the read range back to the producer. */
+static inline void ReleaseMessages(RBMQ *mq)
 {
     RBMQ_Msg *msg_info;
-    uint32_t idx;
+    uint32_t tail = mq->cons.tail;
+    uint32_t read_offset = mq->cons.read_offset;
+
+    while (tail != mq->cons.head)
+    {
+        msg_info = GetMessage(mq, tail);
+        if (msg_info->state != RBMQ_MSG_STATE_ACKED && msg_info->state != RBMQ_MSG_STATE_DISCARDED)
+            break;
 
-    /* Find the next entry in the message ring to read. */
-    idx = IncrementMessageIndex(mq, mq->msg_ring.last_read);
-    msg_info = &mq->msg_ring.msgs[idx];
+        /* Internal allocations are sequential in relation to sequential control entries. */
+        if (!(msg_info->flags & RBMQ_MSG_FLAG_EXTERNAL))
+            read_offset = msg_info->end_offset;
 
-    /* Skip over discarded messages -- the next ACK should clear them out. */
-    while (msg_info->state == RBMQ_MSG_STATE_DISCARDED)
+        msg_info->state = RBMQ_MSG_STATE_UNUSED;
+        tail++;
+    }
+
+    if (tail == mq->cons.tail)
+        return;
+
+    /* Data ring space must be visible before the control entries that refer to it are reused. */
+    if (read_offset != mq->cons.read_offset)
     {
-        mq->msg_ring.last_read = idx;
-        idx = IncrementMessageIndex(mq, idx);
-        msg_info = &mq->msg_ring.msgs[idx];
+        RBMQ_STORE_RELEASE(&mq->cons.read_offset, read_offset);
     }
+    RBMQ_STORE_RELEASE(&mq->cons.tail, tail);
+}
 
-    /* Return an error if there is not a committed entry ready to be read. */
-    if (msg_info->state != RBMQ_MSG_STATE_COMMITTED)
-        return -ENOENT;
+int RBMQ_ReadMsg(RBMQ *mq, const void **hdr_ptr, const uint8_t **msg_ptr, uint32_t *length, void **msg_handle)
+{
+    RBMQ_Msg *msg_info;
 
-    if (mq->msg_ring.header_size)
-        *hdr_ptr = mq->msg_ring.headers + (idx * mq->msg_ring.header_size);
-    else
-        *hdr_ptr = NULL;
+    for (;;)
+    {
+        /* Only go back to the producer for more once the last published batch has been consumed. */
+        if (mq->cons.head == mq->cons.cached_prod_tail)
+        {
+            mq->cons.cached_prod_tail = RBMQ_LOAD_ACQUIRE(&mq->prod.tail);
+            if (mq->cons.head == mq->cons.cached_prod_tail)
+                return -ENOENT;
+        }
+
+        msg_info = GetMessage(mq, mq->cons.head);
+        __atomic_store_n(&mq->cons.head, mq->cons.head + 1, __ATOMIC_RELAXED);
+
+        if (msg_info->state == RBMQ_MSG_STATE_COMMITTED)
+            break;
+
+        /* Skip over discarded messages and release them if nothing older is outstanding. */
+        ReleaseMessages(mq);
+    }
+
+    *hdr_ptr = GetMessageHeader(mq, msg_info);
     *msg_ptr = msg_info->data;
     *length = msg_info->length;
     *msg_handle = msg_info;
 
     msg_info->state = RBMQ_MSG_STATE_READ;
-    mq->msg_ring.last_read = idx;
 
     return 0;
 }
@@ -359,7 +449,6 @@ int RBMQ_ReadMsg(RBMQ *mq, const void **hdr_ptr, const uint8_t **msg_ptr, uint32
 int RBMQ_AckMsg(RBMQ *mq, void *msg_handle)
 {
     RBMQ_Msg *msg_info;
-    uint32_t idx;
 
     /* Sanity checking... */
     if (ValidateMsgHandle(mq, msg_handle))
@@ -378,42 +467,32 @@ int RBMQ_AckMsg(RBMQ *mq, void *msg_handle)
 
     msg_info->state = RBMQ_MSG_STATE_ACKED;
 
-    /* Working forward from the last entry ACK'd (in order), release ACK'd and discarded messages as allowed. */
-    do {
-        idx = IncrementMessageIndex(mq, mq->msg_ring.last_acked);
-        msg_info = &mq->msg_ring.msgs[idx];
-        if (msg_info->state != RBMQ_MSG_STATE_ACKED && msg_info->state != RBMQ_MSG_STATE_DISCARDED)
-            break;
-
-        /* Clean up the data ring state if this was internally allocated.  We are guaranteed that internal
-            allocations will be sequential in relation to sequential control entries.*/
-        if (!(msg_info->flags & RBMQ_MSG_FLAG_EXTERNAL))
-            mq->data_ring.read_offset = msg_info->data + msg_info->length - mq->data_ring.data;
-
-        /* Reset the state to unused so it can be reserved again. */
-        msg_info->state = RBMQ_MSG_STATE_UNUSED;
-
-        /* Finally, update the last ACK'd index to accurately represent how far processing has gotten. */
-        mq->msg_ring.last_acked = idx;
-    } while (mq->msg_ring.last_acked != mq->msg_ring.last_read);
+    ReleaseMessages(mq);
 
     return 0;
 }
 
+/* May be called from either side of the queue. */
 int RBMQ_IsEmpty(RBMQ *mq)
 {
-    RBMQ_Msg *msg_info;
-    uint32_t idx;
-
-    /* Find the next entry in the message ring to read and return true if it's not committed. */
-    idx = IncrementMessageIndex(mq, mq->msg_ring.last_read);
-    msg_info = &mq->msg_ring.msgs[idx];
-
-    return (msg_info->state != RBMQ_MSG_STATE_COMMITTED);
+    return (RBMQ_LOAD_ACQUIRE(&mq->prod.tail) == __atomic_load_n(&mq->cons.head, __ATOMIC_RELAXED));
 }
 
-void RBMQ_Stats(RBMQ_Ptr mq, const char *indent)
+void RBMQ_Stats(RBMQ *mq, const char *indent)
 {
+    uint32_t read_offset, write_offset, used;
+
+    read_offset = RBMQ_LOAD_ACQUIRE(&mq->cons.read_offset);
+    write_offset = mq->prod.write_offset;
+    if (write_offset >= read_offset)
+        used = write_offset - read_offset;
+    else
+        used = mq->data_size - (read_offset - write_offset);
+
+    LogMessage("%s  Length: %u (%u max, %u entries)\n", indent,
+                RBMQ_LOAD_ACQUIRE(&mq->prod.tail) - RBMQ_LOAD_ACQUIRE(&mq->cons.tail), mq->prod.max_depth, mq->entries);
+    LogMessage("%s  Size: %u used of %u\n", indent, used, mq->data_size);
+    LogMessage("%s  Reserve Failures: %u\n", indent, mq->prod.reserve_failures);
 }
 
 #endif /* !SC_USE_DMQ */
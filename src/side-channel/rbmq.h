@@ -32,6 +32,7 @@
 typedef struct _rbmq *RBMQ_Ptr;
 
 RBMQ_Ptr RBMQ_Alloc(uint32_t msg_ring_entries, uint16_t msg_ring_header_size, uint32_t data_ring_size);
+void RBMQ_Destroy(RBMQ_Ptr mq);
 int RBMQ_ReserveMsg(RBMQ_Ptr mq, uint32_t length, void **hdr_ptr, uint8_t **msg_ptr, void **msg_handle);
 int RBMQ_CommitReservedMsg(RBMQ_Ptr mq, void *msg_handle, uint32_t length, SCMQMsgFreeFunc msgFreeFunc);
 int RBMQ_DiscardReservedMsg(RBMQ_Ptr mq, void *msg_handle);
@@ -56,6 +56,20 @@
 #define RBMQ_AckMsg DMQ_AckMsg
 #define RBMQ_IsEmpty DMQ_IsEmpty
 #define RBMQ_Stats DMQ_Stats
+
+/* The dynamic message queue is not thread safe, so every access to it is serialized. */
+#define SCQueueLockProducer(mq)     pthread_mutex_lock(&(mq)->mutex)
+#define SCQueueUnlockProducer(mq)   pthread_mutex_unlock(&(mq)->mutex)
+#define SCQueueLockConsumer(mq)     pthread_mutex_lock(&(mq)->mutex)
+#define SCQueueUnlockConsumer(mq)   pthread_mutex_unlock(&(mq)->mutex)
+#else
+/* The ring buffer message queue is lock-free for a single producer and a single consumer.
+   The consumer never locks; producers only serialize among themselves on queues that can be
+   fed from more than one thread. */
+#define SCQueueLockProducer(mq)     do { if ((mq)->multi_producer) pthread_mutex_lock(&(mq)->mutex); } while (0)
+#define SCQueueUnlockProducer(mq)   do { if ((mq)->multi_producer) pthread_mutex_unlock(&(mq)->mutex); } while (0)
+#define SCQueueLockConsumer(mq)
+#define SCQueueUnlockConsumer(mq)
 #endif
 
 enum ConfState
@@ -97,15 +111,18 @@ typedef struct _SC_MESSAGE_QUEUE
 {
     RBMQ_Ptr queue;
     pthread_mutex_t mutex;
+    pthread_mutex_t cond_mutex;
     pthread_cond_t cond;
+    int consumer_waiting;
+    bool multi_producer;
     uint32_t max_data_size;
     uint32_t max_depth;
 } SCMessageQueue;
 
 static struct {
     uint64_t rx_messages_total;
-    uint64_t rx_messages_processed_ib;
-    uint64_t rx_messages_processed_oob;
+    uint64_t rx_messages_processed;
+    uint64_t rx_messages_dropped;
     uint64_t tx_messages_total;
     uint64_t tx_messages_processed;
 } Side_Channel_Stats;
@@ -260,9 +277,9 @@ static int SCPreallocMessage(SCMessageQueue *mq, uint32_t length, SCMsgHdr **hdr
 {
     int rval;
 
-    pthread_mutex_lock(&mq->mutex);
+    SCQueueLockProducer(mq);
     rval = RBMQ_ReserveMsg(mq->queue, length, (void **) hdr_ptr, msg_ptr, msg_handle);
-    pthread_mutex_unlock(&mq->mutex);
+    SCQueueUnlockProducer(mq);
 
     return rval;
 }
@@ -281,9 +298,9 @@ static int SCDiscardMessage(SCMessageQueue *mq, void *msg_handle)
 {
     int rval;
 
-    pthread_mutex_lock(&mq->mutex);
+    SCQueueLockProducer(mq);
     rval = RBMQ_DiscardReservedMsg(mq->queue, msg_handle);
-    pthread_mutex_unlock(&mq->mutex);
+    SCQueueUnlockProducer(mq);
 
     return rval;
 }
@@ -302,6 +319,7 @@ static int SCEnqueueMessage(SCMessageQueue *mq, SCMsgHdr *hdr, const uint8_t *ms
 {
     int rval;
 
+    SCQueueLockProducer(mq);
     if (!msg_handle)
     {
         SCMsgHdr *hdr_ptr;
@@ -310,6 +328,7 @@ static int SCEnqueueMessage(SCMessageQueue *mq, SCMsgHdr *hdr, const uint8_t *ms
         rval = RBMQ_ReserveMsg(mq->queue, length, (void **) &hdr_ptr, &msg_ptr, &msg_handle);
         if (rval != 0)
         {
+            SCQueueUnlockProducer(mq);
             ErrorMessage("%s: Could not reserve message: %d\n", __FUNCTION__, rval);
             return rval;
         }
@@ -318,12 +337,62 @@ static int SCEnqueueMessage(SCMessageQueue *mq, SCMsgHdr *hdr, const uint8_t *ms
         rval = RBMQ_CommitReservedMsg(mq->queue, msg_handle, length, msgFreeFunc);
         if (rval != 0)
         {
+            SCQueueUnlockProducer(mq);
             ErrorMessage("%s: Could not commit reserved message: %d\n", __FUNCTION__, rval);
             return rval;
         }
     }
     else
         rval = RBMQ_CommitReservedMsg(mq->queue, msg_handle, length, msgFreeFunc);
+    SCQueueUnlockProducer(mq);
+
+    return rval;
+}
+
+static inline int SCQueueIsEmpty(SCMessageQueue *mq)
+{
+    int empty;
+
+    SCQueueLockConsumer(mq);
+    empty = RBMQ_IsEmpty(mq->queue);
+    SCQueueUnlockConsumer(mq);
+
+    return empty;
+}
+
+/* Called by the producer after publishing to wake the consumer if it has gone to sleep. */
+static inline void SCWakeConsumer(SCMessageQueue *mq)
+{
+    /* Pairs with the fence in SCWaitForMessages(): either the consumer sees the new message
+        before it sleeps or we see that it is (about to be) waiting. */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&mq->consumer_waiting, __ATOMIC_RELAXED))
+    {
+        pthread_mutex_lock(&mq->cond_mutex);
+        pthread_cond_signal(&mq->cond);
+        pthread_mutex_unlock(&mq->cond_mutex);
+    }
+}
+
+/* Called by the consumer when it has run out of messages.  Returns the result of the timed wait. */
+static int SCWaitForMessages(SCMessageQueue *mq, unsigned timeout_secs)
+{
+    struct timespec ts;
+    struct timeval tv;
+    int rval = 0;
+
+    pthread_mutex_lock(&mq->cond_mutex);
+    __atomic_store_n(&mq->consumer_waiting, 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (SCQueueIsEmpty(mq) && !stop_processing)
+    {
+        gettimeofday(&tv, NULL);
+        ts.tv_sec = tv.tv_sec + timeout_secs;
+        ts.tv_nsec = tv.tv_usec * 1000;
+        rval = pthread_cond_timedwait(&mq->cond, &mq->cond_mutex, &ts);
+    }
+    __atomic_store_n(&mq->consumer_waiting, 0, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&mq->cond_mutex);
 
     return rval;
 }
@@ -339,31 +408,79 @@ static inline void SCProcessMessage(SCHandler *handlers, SCMsgHdr *hdr, const ui
     }
 }
 
-static int SCDrainAndProcess(SCMessageQueue *mq, SCHandler *handlers)
+/* Process up to max_msgs messages (0 for all available) from the queue.  Returns the number processed. */
+static uint32_t SCDrainAndProcess(SCMessageQueue *mq, SCHandler *handlers, unsigned max_msgs)
 {
-    SCHandler *handler;
     SCMsgHdr *hdr;
-    uint32_t length;
+    uint32_t length, processed = 0;
     const uint8_t *msg;
     void *msg_handle;
     int rval;
 
-    /* Read a message from the queue. */
-    pthread_mutex_lock(&mq->mutex);
-    rval = RBMQ_ReadMsg(mq->queue, (const void **) &hdr, &msg, &length, &msg_handle);
-    pthread_mutex_unlock(&mq->mutex);
-    if (rval != 0)
-        return 1;
+    while ((!max_msgs || processed < max_msgs) && !stop_processing)
+    {
+        /* Read a message from the queue. */
+        SCQueueLockConsumer(mq);
+        rval = RBMQ_ReadMsg(mq->queue, (const void **) &hdr, &msg, &length, &msg_handle);
+        SCQueueUnlockConsumer(mq);
+        if (rval != 0)
+            break;
 
-    /* Handle it. */
-    SCProcessMessage(handlers, hdr, msg, length);
+        /* Handle it. */
+        SCProcessMessage(handlers, hdr, msg, length);
 
-    /* And, finally, acknowledge it. */
-    pthread_mutex_lock(&mq->mutex);
-    rval = RBMQ_AckMsg(mq->queue, msg_handle);
-    pthread_mutex_unlock(&mq->mutex);
+        /* And, finally, acknowledge it. */
+        SCQueueLockConsumer(mq);
+        rval = RBMQ_AckMsg(mq->queue, msg_handle);
+        SCQueueUnlockConsumer(mq);
+        if (rval != 0)
+            WarningMessage("Error ACK'ing message %p!\n", msg_handle);
+
+        processed++;
+    }
+
+    return processed;
+}
+
+#ifdef SC_USE_DMQ
+/*
+ * Called by an out-of-band thread after queuing an RX message.  The Snort main thread drains the
+ * RX queue between packets and whenever DAQ_Acquire() returns, holding snort_process_lock while it
+ * does.  While it is waiting for packets in DAQ_Acquire() it does not hold the lock, so drain the
+ * queue here instead; otherwise an idle sensor (an HA standby, for one) would let it fill up.
+ */
+static void SCDrainRXOutOfBand(void)
+{
+    uint32_t processed;
+
+    if (pthread_mutex_trylock(&snort_process_lock) != 0)
+        return;
+
+    processed = SCDrainAndProcess(&rx_queue, rx_handlers, 0);
+    Side_Channel_Stats.rx_messages_processed += processed;
+
+    pthread_mutex_unlock(&snort_process_lock);
+}
+#else
+/*
+ * The ring buffer has a single consumer, the Snort main thread, which drains it between packets
+ * and whenever DAQ_Acquire() returns, including on its timeout when no packets arrive.  Nothing
+ * else may consume it, so the packet path never takes a lock for it.
+ */
+static inline void SCDrainRXOutOfBand(void)
+{
+}
+#endif
+
+static inline int SCCountRX(int rval)
+{
     if (rval != 0)
-        WarningMessage("Error ACK'ing message %p!\n", msg_handle);
+    {
+        __atomic_add_fetch(&Side_Channel_Stats.rx_messages_dropped, 1, __ATOMIC_RELAXED);
+        return rval;
+    }
+    __atomic_add_fetch(&Side_Channel_Stats.rx_messages_total, 1, __ATOMIC_RELAXED);
+    SCDrainRXOutOfBand();
 
     return 0;
 }
@@ -373,66 +490,29 @@ int SideChannelEnqueueMessageRX(SCMsgHdr *hdr, const uint8_t *msg, uint32_t leng
 {
     int rval;
 
-    /* 
-     * Because the Snort main thread relinquishes control to DAQ_Acquire for up to a second,
-     * we potentially need to preempt it and process RX messages as they are being enqueued
-     * to avoid backups and overruns.
-     * This should be safe since the main thread holds the snort_process_lock mutex while it
-     * is not in DAQ_Acquire().
-     */
-    while (pthread_mutex_trylock(&snort_process_lock) == 0)
+    rval = SCEnqueueMessage(&rx_queue, hdr, msg, length, msg_handle, msgFreeFunc);
+    if (rval != 0)
     {
-        /* If there are no more messages in the RX queue, process the new message without enqueuing it and return. */
-        if (SCDrainAndProcess(&rx_queue, rx_handlers) != 0)
-        {
-            SCProcessMessage(rx_handlers, hdr, msg, length);
-            if (msgFreeFunc)
-                msgFreeFunc((uint8_t *) msg);
-            if (msg_handle)
-            {
-                pthread_mutex_lock(&rx_queue.mutex);
-                RBMQ_DiscardReservedMsg(rx_queue.queue, msg_handle);
-                pthread_mutex_unlock(&rx_queue.mutex);
-            }
-            Side_Channel_Stats.rx_messages_total++;
-            Side_Channel_Stats.rx_messages_processed_oob++;
-
-            pthread_mutex_unlock(&snort_process_lock);
-            return 0;
-        }
-        else
-            Side_Channel_Stats.rx_messages_processed_oob++;
-
-        pthread_mutex_unlock(&snort_process_lock);
+        /* The queue is full; with DMQ make room if the main thread is idle and try once more. */
+        SCDrainRXOutOfBand();
+        rval = SCEnqueueMessage(&rx_queue, hdr, msg, length, msg_handle, msgFreeFunc);
     }
 
-    /* Finally, enqueue the message if we really have to. */
-    pthread_mutex_lock(&rx_queue.mutex);
-    rval = SCEnqueueMessage(&rx_queue, hdr, msg, length, msg_handle, msgFreeFunc);
-    /* TODO: Error check the above call. */
-    Side_Channel_Stats.rx_messages_total++;
-    pthread_mutex_unlock(&rx_queue.mutex);
-
-    return rval;
+    return SCCountRX(rval);
 }
 
 /* Called in the Snort main thread. */
 int SideChannelEnqueueMessageTX(SCMsgHdr *hdr, const uint8_t *msg, uint32_t length, void *msg_handle, SCMQMsgFreeFunc msgFreeFunc)
 {
-    int rval, empty;
+    int rval;
 
     /* Only bother queuing if the TX thread is running, otherwise just immediately process. */
     if (tx_thread_running)
     {
-        pthread_mutex_lock(&tx_queue.mutex);
-        empty = RBMQ_IsEmpty(tx_queue.queue);
         rval = SCEnqueueMessage(&tx_queue, hdr, msg, length, msg_handle, msgFreeFunc);
         /* TODO: Error check the above call. */
         Side_Channel_Stats.tx_messages_total++;
-        /* If the queue was empty, signal any waiters. */
-        if (empty)
-            pthread_cond_signal(&tx_queue.cond);
-        pthread_mutex_unlock(&tx_queue.mutex);
+        SCWakeConsumer(&tx_queue);
     }
     else
     {
@@ -442,11 +522,7 @@ int SideChannelEnqueueMessageTX(SCMsgHdr *hdr, const uint8_t *msg, uint32_t leng
         if (msgFreeFunc)
             msgFreeFunc((uint8_t *) msg);
         if (msg_handle)
-        {
-            pthread_mutex_lock(&tx_queue.mutex);
-            RBMQ_DiscardReservedMsg(tx_queue.queue, msg_handle);
-            pthread_mutex_unlock(&tx_queue.mutex);
-        }
+            SCDiscardMessage(&tx_queue, msg_handle);
         rval = 0;
     }
 
@@ -455,7 +531,13 @@ int SideChannelEnqueueMessageTX(SCMsgHdr *hdr, const uint8_t *msg, uint32_t leng
 
 static int SCEnqueueData(SCMessageQueue *mq, SCMsgHdr *hdr, uint8_t *msg, uint32_t length, SCMQMsgFreeFunc msgFreeFunc)
 {
-    return RBMQ_CommitExternalMsg(mq->queue, hdr, msg, length, msgFreeFunc);
+    int rval;
+
+    SCQueueLockProducer(mq);
+    rval = RBMQ_CommitExternalMsg(mq->queue, hdr, msg, length, msgFreeFunc);
+    SCQueueUnlockProducer(mq);
+
+    return rval;
 }
 
 /* Called by an out-of-band thread (probably a Side Channel Module). */
@@ -463,32 +545,28 @@ int SideChannelEnqueueDataRX(SCMsgHdr *hdr, uint8_t *msg, uint32_t length, SCMQM
 {
     int rval;
 
-    pthread_mutex_lock(&rx_queue.mutex);
     rval = SCEnqueueData(&rx_queue, hdr, msg, length, msgFreeFunc);
-    /* TODO: Error check the above call. */
-    Side_Channel_Stats.rx_messages_total++;
-    pthread_mutex_unlock(&rx_queue.mutex);
+    if (rval != 0)
+    {
+        SCDrainRXOutOfBand();
+        rval = SCEnqueueData(&rx_queue, hdr, msg, length, msgFreeFunc);
+    }
 
-    return rval;
+    return SCCountRX(rval);
 }
 
 /* Called in the Snort main thread. */
 int SideChannelEnqueueDataTX(SCMsgHdr *hdr, uint8_t *msg, uint32_t length, SCMQMsgFreeFunc msgFreeFunc)
 {
-    int rval, empty;
+    int rval;
 
     /* Only bother queuing if the TX thread is running, otherwise just immediately process. */
     if (tx_thread_running)
     {
-        pthread_mutex_lock(&tx_queue.mutex);
-        empty = RBMQ_IsEmpty(tx_queue.queue);
         rval = SCEnqueueData(&tx_queue, hdr, msg, length, msgFreeFunc);
         /* TODO: Error check the above call. */
         Side_Channel_Stats.tx_messages_total++;
-        /* If the queue was empty, signal any waiters. */
-        if (empty)
-            pthread_cond_signal(&tx_queue.cond);
-        pthread_mutex_unlock(&tx_queue.mutex);
+        SCWakeConsumer(&tx_queue);
     }
     else
     {
@@ -502,7 +580,7 @@ int SideChannelEnqueueDataTX(SCMsgHdr *hdr, uint8_t *msg, uint32_t length, SCMQM
     return rval;
 }
 
-/* Called in the Snort main thread. */
+/* Called in the Snort main thread (holding snort_process_lock with SC_USE_DMQ). */
 uint32_t SideChannelDrainRX(unsigned max_msgs)
 {
     uint32_t processed = 0;
@@ -510,65 +588,35 @@ uint32_t SideChannelDrainRX(unsigned max_msgs)
     if (!ScSideChannelEnabled())
         return 0;
 
-    if (RBMQ_IsEmpty(rx_queue.queue))
+    /* Cheap enough to be called for every packet: a single load when there is nothing to do. */
+    if (SCQueueIsEmpty(&rx_queue))
         return 0;
 
-    while (!max_msgs || processed < max_msgs)
-    {
-        if (stop_processing || SCDrainAndProcess(&rx_queue, rx_handlers) != 0)
-            break;
-
-        Side_Channel_Stats.rx_messages_processed_ib++;
-        processed++;
-    }
+    processed = SCDrainAndProcess(&rx_queue, rx_handlers, max_msgs);
+    Side_Channel_Stats.rx_messages_processed += processed;
 
     return processed;
 }
 
 static void *SideChannelThread(void *arg)
 {
-    struct timespec ts;
-    struct timeval tv;
-    SCHandler *handler;
     SCModule *module;
-    SCMsgHdr *hdr;
-    uint32_t length;
-    const uint8_t *msg;
-    void *msg_handle;
+    uint32_t processed;
     int rval;
 
     tx_thread_pid = gettid();
     tx_thread_running = 1;
 
-    pthread_mutex_lock(&tx_queue.mutex);
     while (!stop_processing)
     {
-        /* If the message queue is empty, we will stop without unlocking it so we can immediately start a timed wait. */
-        while ((rval = RBMQ_ReadMsg(tx_queue.queue, (const void **) &hdr, &msg, &length, &msg_handle)) == 0)
+        processed = SCDrainAndProcess(&tx_queue, tx_handlers, 0);
+        if (processed)
         {
-            pthread_mutex_unlock(&tx_queue.mutex);
-
-            for (handler = tx_handlers; handler; handler = handler->next)
-            {
-                if (hdr->type == handler->type || handler->type == SC_MSG_TYPE_ANY)
-                    handler->processMsgFunc(hdr, msg, length);
-            }
-
-            pthread_mutex_lock(&tx_queue.mutex);
-            rval = RBMQ_AckMsg(tx_queue.queue, msg_handle);
-            if (rval != 0)
-                WarningMessage("Error ACK'ing message %p!\n", msg_handle);
-            /* Again, not unlocking so that we're already locked for the three places we can go
-                from here, which are all expecting it (dequeue, timed wait, or done). */
-
-            Side_Channel_Stats.tx_messages_processed++;
-            if (stop_processing)
-                goto done;
+            Side_Channel_Stats.tx_messages_processed += processed;
+            continue;
         }
-        gettimeofday(&tv, NULL);
-        ts.tv_sec = tv.tv_sec + 10;
-        ts.tv_nsec = tv.tv_usec * 1000;
-        rval = pthread_cond_timedwait(&tx_queue.cond, &tx_queue.mutex, &ts);
+
+        rval = SCWaitForMessages(&tx_queue, 10);
         /* If we timed out waiting for new output messages to process, run the registered idle routines. */
         if (rval == ETIMEDOUT && !stop_processing)
         {
@@ -579,8 +627,6 @@ static void *SideChannelThread(void *arg)
             }
         }
     }
-done:
-    pthread_mutex_unlock(&tx_queue.mutex);
 
     LogMessage("Side Channel thread exiting...\n");
 
@@ -698,12 +744,18 @@ void SideChannelInit(void)
     if (!ScSideChannelEnabled())
         return;
 
+    /* RX messages can come from any number of side channel module threads; TX messages only
+        come from the Snort main thread. */
     pthread_mutex_init(&rx_queue.mutex, NULL);
+    pthread_mutex_init(&rx_queue.cond_mutex, NULL);
     pthread_cond_init(&rx_queue.cond, NULL);
+    rx_queue.multi_producer = true;
     rx_queue.queue = RBMQ_Alloc(rx_queue.max_depth, sizeof(SCMsgHdr), rx_queue.max_data_size);
 
     pthread_cond_init(&tx_queue.cond, NULL);
     pthread_mutex_init(&tx_queue.mutex, NULL);
+    pthread_mutex_init(&tx_queue.cond_mutex, NULL);
+    tx_queue.multi_producer = false;
     tx_queue.queue = RBMQ_Alloc(tx_queue.max_depth, sizeof(SCMsgHdr), tx_queue.max_data_size);
 
     for (module = modules; module; module = module->next)
@@ -785,9 +837,9 @@ void SideChannelStopTXThread(void)
     if (p_tx_thread_id != NULL)
     {
         stop_processing = 1;
-        pthread_mutex_lock(&tx_queue.mutex);
+        pthread_mutex_lock(&tx_queue.cond_mutex);
         pthread_cond_signal(&tx_queue.cond);
-        pthread_mutex_unlock(&tx_queue.mutex);
+        pthread_mutex_unlock(&tx_queue.cond_mutex);
         if ((rval = pthread_join(*p_tx_thread_id, NULL)) != 0)
             WarningMessage("Side channel TX thread termination returned an error: %s\n", strerror(rval));
     }
@@ -819,8 +871,8 @@ void SideChannelStats(int exiting, const char *separator)
     LogMessage("%s\n", separator);
     LogMessage("Side Channel:\n");
     LogMessage("  RX Messages Total:            %"PRIu64"\n", Side_Channel_Stats.rx_messages_total);
-    LogMessage("  RX Messages Processed (IB):   %"PRIu64"\n", Side_Channel_Stats.rx_messages_processed_ib);
-    LogMessage("  RX Messages Processed (OOB):  %"PRIu64"\n", Side_Channel_Stats.rx_messages_processed_oob);
+    LogMessage("  RX Messages Processed:        %"PRIu64"\n", Side_Channel_Stats.rx_messages_processed);
+    LogMessage("  RX Messages Dropped:          %"PRIu64"\n", Side_Channel_Stats.rx_messages_dropped);
     LogMessage("  TX Messages Total:            %"PRIu64"\n", Side_Channel_Stats.tx_messages_total);
     LogMessage("  TX Messages Processed:        %"PRIu64"\n", Side_Channel_Stats.tx_messages_processed);
 
@@ -862,8 +914,10 @@ void SideChannelCleanUp(void)
         free(module);
     }
     pthread_cond_destroy(&tx_queue.cond);
+    pthread_mutex_destroy(&tx_queue.cond_mutex);
     pthread_mutex_destroy(&tx_queue.mutex);
     pthread_cond_destroy(&rx_queue.cond);
+    pthread_mutex_destroy(&rx_queue.cond_mutex);
     pthread_mutex_destroy(&rx_queue.mutex);
 }
 
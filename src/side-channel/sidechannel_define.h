@@ -25,7 +25,9 @@
 
 #include <stdint.h>
 
-#define SC_USE_DMQ 1
+/* The lock-free ring buffer message queues (rbmq.c) are used by default.  SC_USE_DMQ,
+   defined by configure with --enable-side-channel-dmq, selects the dynamically allocated,
+   mutex protected message queues (dmq.c) instead. */
 
 /* You get 16 bits worth of types.  Use them wisely. */
 enum
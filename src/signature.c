@@ -383,6 +383,9 @@ void OtnFree(void *data)
     if (otn->tag != NULL)
         free(otn->tag);
 
+    if (otn->alert_template != NULL)
+        free(otn->alert_template);
+
     /* RTN was generated on the fly.  Don't necessarily know which policy
      * at this point so go through all RTNs and delete them */
     if (otn->generated)
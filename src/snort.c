@@ -87,6 +87,8 @@
 #include "encode.h"
 #include "sfdaq.h"
 #include "active.h"
+#include "bypass.h"
+#include "pcap_workers.h"
 #include "snort.h"
 #include "rules.h"
 #include "treenodes.h"
@@ -301,13 +303,19 @@ PeriodicCheckFuncNode *periodic_check_funcs = NULL;
 DynamicRuleNode *dynamic_rules = NULL;
 grinder_t grinder;
 
-#ifdef SIDE_CHANNEL
+#if defined(SIDE_CHANNEL) && defined(SC_USE_DMQ)
 pthread_mutex_t snort_process_lock;
 static bool snort_process_lock_held = false;
 #endif
 
 /* Locals/Private ************************************************************/
 static long int pcap_loop_count = 0;
+#ifndef WIN32
+static unsigned pcap_workers = 0;
+#endif
+#ifdef TARGET_BASED
+static char *compile_attribute_table = NULL;
+#endif
 static SF_QUEUE *pcap_save_queue = NULL;
 
 #if defined(INLINE_FAILOPEN) && !defined(WIN32)
@@ -414,6 +422,7 @@ static struct option long_options[] =
 
 #ifdef TARGET_BASED
    {"disable-attribute-reload-thread", LONGOPT_ARG_NONE, NULL, DISABLE_ATTRIBUTE_RELOAD},
+   {"compile-attribute-table", LONGOPT_ARG_REQUIRED, NULL, COMPILE_ATTRIBUTE_TABLE},
 #endif
 
    {"pcap-single", LONGOPT_ARG_REQUIRED, NULL, PCAP_SINGLE},
@@ -430,6 +439,9 @@ static struct option long_options[] =
    {"pcap-reload", LONGOPT_ARG_NONE, NULL, PCAP_RELOAD},
    {"pcap-reset", LONGOPT_ARG_NONE, NULL, PCAP_RESET},
    {"pcap-show", LONGOPT_ARG_NONE, NULL, PCAP_SHOW},
+#ifndef WIN32
+   {"pcap-workers", LONGOPT_ARG_REQUIRED, NULL, PCAP_WORKERS},
+#endif
 
 #ifdef EXIT_CHECK
    {"exit-check", LONGOPT_ARG_REQUIRED, NULL, ARG_EXIT_CHECK},
@@ -1105,6 +1117,33 @@ static void PQ_SetUp (void)
     }
 }
 
+#ifndef WIN32
+// split the pcaps (or their flows) among the workers; only
+// returns in the workers
+static void PQ_Workers (void)
+{
+    unsigned i, first, count;
+    unsigned num = (unsigned)sfqueue_count(pcap_queue);
+
+#if defined(SNORT_RELOAD)
+    if ( snort_conf->run_flags & RUN_FLAG__PCAP_RELOAD )
+        FatalError("--pcap-workers can't be used with --pcap-reload.\n");
+#endif
+    PcapWorkers_Start(snort_conf, pcap_workers, num, &first, &count);
+
+    for ( i = 0; i < num; i++ )
+    {
+        char* pcap = (char*)sfqueue_remove(pcap_queue);
+
+        if ( i < first || i >= first + count )
+            free(pcap);
+
+        else if ( sfqueue_add(pcap_queue, (NODE_DATA)pcap) == -1 )
+            FatalError("Could not add pcap to list\n");
+    }
+}
+#endif
+
 static int PQ_CleanUp (void)
 {
     /* clean up pcap queues */
@@ -1550,7 +1589,7 @@ static int MetaCallback(
     PreprocMetaEvalFuncNode *idx;
     PROFILE_VARS;
 
-#ifdef SIDE_CHANNEL
+#if defined(SIDE_CHANNEL) && defined(SC_USE_DMQ)
     if (ScSideChannelEnabled() && !snort_process_lock_held)
     {
         pthread_mutex_lock(&snort_process_lock);
@@ -1614,7 +1653,7 @@ static DAQ_Verdict PacketCallback(
 
     PREPROC_PROFILE_START(totalPerfStats);
 
-#ifdef SIDE_CHANNEL
+#if defined(SIDE_CHANNEL) && defined(SC_USE_DMQ)
     if (ScSideChannelEnabled() && !snort_process_lock_held)
     {
         pthread_mutex_lock(&snort_process_lock);
@@ -1637,6 +1676,17 @@ static DAQ_Verdict PacketCallback(
 #endif
     }
 
+#ifndef WIN32
+    /* Packets of flows that belong to other pcap workers only move
+     * the clock forward */
+    if ( PcapWorkers_Skip(pkthdr, pkt) )
+    {
+        packet_time_update(&pkthdr->ts);
+        PREPROC_PROFILE_END(totalPerfStats);
+        return verdict;
+    }
+#endif
+
     pc.total_from_daq++;
 
     /* Increment counter that we're evaling rules for caching results */
@@ -1668,6 +1718,23 @@ static DAQ_Verdict PacketCallback(
     }
 #endif
 
+    /* Flows that are already whitelisted or ignored get the same verdict
+     * without being decoded again. */
+    if ( Bypass_Lookup(pkthdr, pkt, &verdict) )
+    {
+        pc.bypassed++;
+        UpdateWireStats(&sfBase, pkthdr->caplen, 0, 0);
+        sfBase.total_bypassed_packets++;
+
+        checkLWSessionTimeout(4, pkthdr->ts.tv_sec);
+        ControlSocketDoWork(0);
+#ifdef SIDE_CHANNEL
+        SideChannelDrainRX(0);
+#endif
+        PREPROC_PROFILE_END(totalPerfStats);
+        return verdict;
+    }
+
     /* reset the thresholding subsystem checks for this packet */
     sfthreshold_reset();
 
@@ -1728,6 +1795,8 @@ static DAQ_Verdict PacketCallback(
                     verdict = DAQ_VERDICT_PASS;
                     pc.internal_whitelist++;
                 }
+                if ( !(p.packet_flags & PKT_IGNORE) )
+                    Bypass_Add(&p, verdict);
             }
             else if ( p.packet_flags & PKT_TRUST )
             {
@@ -1735,6 +1804,9 @@ static DAQ_Verdict PacketCallback(
                     stream_api->set_ignore_direction(p.ssnptr, SSN_DIR_BOTH);
 
                 verdict = DAQ_VERDICT_WHITELIST;
+
+                if ( p.ssnptr )
+                    Bypass_Add(&p, verdict);
             }
             else
             {
@@ -1984,6 +2056,7 @@ static int ShowUsage(char *program_name)
 #endif
 #ifdef TARGET_BASED
     FPUTS_UNIX ("   --disable-attribute-reload-thread Do not create a thread to reload the attribute table\n");
+    FPUTS_BOTH ("   --compile-attribute-table <file> Write the attribute table to <file> in binary form and exit\n");
 #endif
     FPUTS_BOTH ("   --pcap-single <tf>              Same as -r.\n");
     FPUTS_BOTH ("   --pcap-file <file>              file that contains a list of pcaps to read - read mode is implied.\n");
@@ -1998,6 +2071,7 @@ static int ShowUsage(char *program_name)
     FPUTS_BOTH ("   --pcap-reload                   if reading multiple pcaps, reload snort config between pcaps.\n");
 #endif
     FPUTS_BOTH ("   --pcap-show                     print a line saying what pcap is currently being read.\n");
+    FPUTS_UNIX ("   --pcap-workers <n>              analyze the pcaps with n processes and merge their output.\n");
     FPUTS_BOTH ("   --exit-check <count>            Signal termination after <count> callbacks from DAQ_Acquire(), showing the time it\n"
                 "                                   takes from signaling until DAQ_Stop() is called.\n");
     FPUTS_BOTH ("   --conf-error-out                Same as -x\n");
@@ -2308,6 +2382,12 @@ static void ParseCmdLine(int argc, char **argv)
             case DISABLE_ATTRIBUTE_RELOAD:
                 ConfigDisableAttributeReload(sc, NULL);
                 break;
+
+            case COMPILE_ATTRIBUTE_TABLE:
+                if (compile_attribute_table != NULL)
+                    free(compile_attribute_table);
+                compile_attribute_table = SnortStrdup(optarg);
+                break;
 #endif
             case DETECTION_SEARCH_METHOD:
                 if (sc->fast_pattern_config != NULL)
@@ -2774,6 +2854,22 @@ static void ParseCmdLine(int argc, char **argv)
             case PCAP_SHOW:
                 sc->run_flags |= RUN_FLAG__PCAP_SHOW;
                 break;
+
+#ifndef WIN32
+            case PCAP_WORKERS:
+                {
+                    long int workers = SnortStrtol(optarg, &endptr, 0);
+
+                    if ((errno == ERANGE) || (*endptr != '\0') ||
+                        (workers < 1) || (workers > MAX_PCAP_WORKERS))
+                    {
+                        FatalError("Valid values for --pcap-workers are between 1 and %d\n",
+                                   MAX_PCAP_WORKERS);
+                    }
+                    pcap_workers = (unsigned)workers;
+                }
+                break;
+#endif
 #ifdef MPLS
             case ENABLE_MPLS_MULTICAST:
                 ConfigEnableMplsMulticast(sc, NULL);
@@ -2859,6 +2955,14 @@ static void ParseCmdLine(int argc, char **argv)
                    "on the command line.\n");
     }
 
+#ifndef WIN32
+    if (pcap_workers && !(sc->run_flags & RUN_FLAG__READ))
+    {
+        FatalError("--pcap-workers can only be used in combination with pcaps "
+                   "on the command line.\n");
+    }
+#endif
+
 #if defined(SNORT_RELOAD) && !defined(WIN32)
     if ((sc->run_flags & RUN_FLAG__PCAP_RELOAD) &&
         !(sc->run_flags & RUN_FLAG__READ))
@@ -3123,6 +3227,7 @@ static int SetPktProcessor(void)
 #ifdef ACTIVE_RESPONSE
     Encode_Init();
 #endif
+    Bypass_Init(snort_conf, dlt);
     return 0;
 }
 
@@ -3160,9 +3265,21 @@ void PacketLoop (void)
 
     while ( !exit_logged )
     {
+#ifdef ACTIVE_RESPONSE
+        // queued injects are sent after each burst
+        int burst = (int)Active_GetBurst();
+
+        if ( burst && (!pkts_to_read || pkts_to_read > burst) )
+            error = DAQ_Acquire(burst, PacketCallback, NULL);
+        else
+            error = DAQ_Acquire(pkts_to_read, PacketCallback, NULL);
+
+        Active_SendQueued();
+#else
         error = DAQ_Acquire(pkts_to_read, PacketCallback, NULL);
+#endif
 
-#ifdef SIDE_CHANNEL
+#if defined(SIDE_CHANNEL) && defined(SC_USE_DMQ)
         /* If we didn't manage to lock the process lock in a DAQ acquire callback, lock it now. */
         if (ScSideChannelEnabled() && !snort_process_lock_held)
         {
@@ -3211,7 +3328,12 @@ void PacketLoop (void)
         // (since in that case we aren't idle here)
         SnortIdle();
 
-#ifdef SIDE_CHANNEL
+#ifdef ACTIVE_RESPONSE
+        // stream timeouts in SnortIdle() can flush and raise responses
+        Active_SendQueued();
+#endif
+
+#if defined(SIDE_CHANNEL) && defined(SC_USE_DMQ)
         /* Unlock the Snort process lock once we've hit the DAQ acquire timeout. */
         if (snort_process_lock_held)
         {
@@ -3221,7 +3343,7 @@ void PacketLoop (void)
 #endif
     }
 
-#ifdef SIDE_CHANNEL
+#if defined(SIDE_CHANNEL) && defined(SC_USE_DMQ)
     /* Error conditions can lead to exiting the packet loop prior to unlocking the process lock.  */
     if (snort_process_lock_held)
     {
@@ -3267,6 +3389,7 @@ static void SnortReset(void)
     sfthreshold_reset_active();
     RateFilter_ResetActive();
     TagCacheReset();
+    Bypass_Reset();
 
 #ifdef PERF_PROFILING
     ShowPreprocProfiles();
@@ -3413,6 +3536,9 @@ static void PrintStatistics (void)
     }
 #endif
 
+#ifndef WIN32
+    PcapWorkers_Report(&pc, DAQ_GetStats());
+#endif
     DropStats(2);
     print_thresholding(snort_conf->threshold_config, 1);
 }
@@ -3495,12 +3621,19 @@ static void SnortCleanup(int exit_val)
 #ifdef EXIT_CHECK
         if (snort_conf->exit_check)
             ExitCheckEnd();
+#endif
+#ifdef ACTIVE_RESPONSE
+        // send what was queued while the daq can still inject
+        Active_SendQueued();
 #endif
         DAQ_Stop();
     }
 
     ControlSocketCleanUp();
 #ifdef SIDE_CHANNEL
+    /* Give idle handlers a last chance to hand off anything they are holding
+       for the side channel, like batched Stream5 HA updates. */
+    IdleProcessingExecute();
     SideChannelStopTXThread();
     SideChannelCleanUp();
 #endif
@@ -3598,6 +3731,7 @@ static void SnortCleanup(int exit_val)
     Active_Term();
     Encode_Term();
 #endif
+    Bypass_Term();
 
 
     CleanupProtoNames();
@@ -3957,7 +4091,7 @@ static void InitGlobals(void)
 
     InitNetmasks();
     InitProtoNames();
-#ifdef SIDE_CHANNEL
+#if defined(SIDE_CHANNEL) && defined(SC_USE_DMQ)
     pthread_mutex_init(&snort_process_lock, NULL);
 #endif
 }
@@ -4011,6 +4145,7 @@ SnortConfig * SnortConfNew(void)
 #ifndef REG_TEST
     sc->paf_max = DEFAULT_PAF_MAX;
 #endif
+    sc->bypass_timeout = DEFAULT_BYPASS_TIMEOUT;
 
     return sc;
 }
@@ -4870,6 +5005,20 @@ void FreeVarList(VarNode *head)
                 file_name = saved_file_name;
                 file_line = saved_file_line;
             }
+
+            if (compile_attribute_table != NULL)
+            {
+                if (tbc->args == NULL)
+                {
+                    FatalError("--compile-attribute-table requires an "
+                               "attribute_table in the configuration.\n");
+                }
+
+                SFAT_CompileAttributeTable(compile_attribute_table);
+                free(compile_attribute_table);
+                compile_attribute_table = NULL;
+                CleanExit(0);
+            }
         }
 #endif
 
@@ -4929,6 +5078,11 @@ void FreeVarList(VarNode *head)
     /* Finish up the pcap list and put in the queues */
     PQ_SetUp();
 
+#ifndef WIN32
+    if (ScReadMode() && (pcap_workers > 1))
+        PQ_Workers();
+#endif
+
     if ((snort_conf->bpf_filter == NULL) && (snort_conf->bpf_file != NULL))
     {
         LogMessage("Reading filter from bpf file: %s\n", snort_conf->bpf_file);
@@ -5689,6 +5843,13 @@ static int VerifyReload(SnortConfig *sc)
         return -1;
     }
 
+    if (snort_conf->gtp_overlapping_ip != sc->gtp_overlapping_ip)
+    {
+        ErrorMessage("Snort Reload: Changing the GTP overlapping IP "
+                     "configuration requires a restart.\n");
+        return -1;
+    }
+
     if ((sc->bpf_filter == NULL) && (sc->bpf_file != NULL))
         sc->bpf_filter = read_infile(sc->bpf_file);
 
@@ -5710,7 +5871,8 @@ static int VerifyReload(SnortConfig *sc)
 
 #ifdef ACTIVE_RESPONSE
     if ( sc->respond_attempts != snort_conf->respond_attempts ||
-         sc->respond_device != snort_conf->respond_device )
+         sc->respond_device != snort_conf->respond_device ||
+         sc->respond_batch != snort_conf->respond_batch )
     {
         ErrorMessage("Snort Reload: Changing config response "
                      "requires a restart.\n");
@@ -5948,6 +6110,13 @@ static int VerifyReload(SnortConfig *sc)
         return -1;
     }
 
+    if (snort_conf->bypass_flows != sc->bypass_flows)
+    {
+        ErrorMessage("Snort Reload: Changing the bypass flows "
+                     "configuration requires a restart.\n");
+        return -1;
+    }
+
     if (VerifyOutputs(snort_conf, sc) == -1)
         return -1;
 
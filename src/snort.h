@@ -252,6 +252,7 @@ typedef enum _GetOptLongIds
     PCAP_RELOAD,
     PCAP_RESET,
     PCAP_SHOW,
+    PCAP_WORKERS,
 
 #define EXIT_CHECK  // allow for rollback for now
 #ifdef EXIT_CHECK
@@ -260,6 +261,7 @@ typedef enum _GetOptLongIds
 
 #ifdef TARGET_BASED
     DISABLE_ATTRIBUTE_RELOAD,
+    COMPILE_ATTRIBUTE_TABLE,
 #endif
 
     DETECTION_SEARCH_METHOD,
@@ -785,6 +787,7 @@ typedef struct _SnortConfig
     uint8_t respond_attempts;    /* config respond */
     char* respond_device;
     uint8_t *eth_dst;        /* config destination MAC address */
+    uint16_t respond_batch;  /* injected frames queued per DAQ burst */
 #endif
 
 #ifdef TARGET_BASED
@@ -883,6 +886,7 @@ typedef struct _SnortConfig
 
     uint8_t enable_teredo; /* config enable_deep_teredo_inspection */
     uint8_t enable_gtp; /* config enable_gtp */
+    uint8_t gtp_overlapping_ip; /* config enable_gtp_overlapping_ip */
     char *gtp_ports;
     uint8_t enable_esp;
     uint8_t vlan_agnostic; /* config vlan_agnostic */
@@ -892,6 +896,8 @@ typedef struct _SnortConfig
 
     uint32_t so_rule_memcap;
     uint32_t paf_max;          /* config paf_max */
+    uint32_t bypass_flows;     /* config bypass_flows */
+    uint32_t bypass_timeout;   /* config bypass_timeout */
     char *cs_dir;
     bool ha_peer;
     char *ha_out;
@@ -1054,6 +1060,10 @@ typedef struct _PacketCount
     uint64_t internal_blacklist;
     uint64_t internal_whitelist;
 
+    uint64_t bypassed;        /* packets answered from the bypass table */
+    uint64_t bypass_flows;    /* flows added to the bypass table */
+    uint64_t bypass_evicts;   /* bypassed flows pushed out by new ones */
+
 } PacketCount;
 
 typedef struct _PcapReadObject
@@ -1080,7 +1090,7 @@ extern PacketCount pc;        /* packet count information */
 extern char **protocol_names;
 extern grinder_t grinder;
 
-#ifdef SIDE_CHANNEL
+#if defined(SIDE_CHANNEL) && defined(SC_USE_DMQ)
 extern pthread_mutex_t snort_process_lock;
 #endif
 
@@ -1361,6 +1371,11 @@ static inline uint32_t ScPafMax (void)
     return snort_conf->paf_max;
 }
 
+static inline uint32_t ScBypassTimeout (void)
+{
+    return snort_conf->bypass_timeout;
+}
+
 static inline bool ScPafEnabled (void)
 {
     return ( ScPafMax() > 0 );
@@ -1685,6 +1700,11 @@ static inline int ScIsGTPPort(uint16_t port)
     return snort_conf->gtp_ports[port];
 }
 
+static inline int ScGTPOverlappingIp(void)
+{
+    return snort_conf->gtp_overlapping_ip;
+}
+
 static inline int ScESPDecoding(void)
 {
     return snort_conf->enable_esp;
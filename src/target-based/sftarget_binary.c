@@ -0,0 +1,971 @@
+/*
+** Copyright (C) 2013 Sourcefire, Inc.
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License Version 2 as
+** published by the Free Software Foundation.  You may not use, modify or
+** distribute this program under any other version of the GNU General
+** Public License.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+/*
+ * sftarget_binary.c
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#ifdef TARGET_BASED
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#endif
+
+#include "sftarget_binary.h"
+#include "sftarget_protocol_reference.h"
+#include "util.h"
+
+#define SFAT_BINARY_MAGIC "SFATBIN"
+#define SFAT_BINARY_VERSION 1
+#define SFAT_BYTE_ORDER 0x01020304
+
+/* IPv4 directory entries, one per /16 plus one past the end */
+#define SFAT_DIR4_SIZE (0x10000 + 1)
+
+#define SFAT_ALIGN(n) (((n) + 7) & ~(uint64_t)7)
+
+typedef struct _SFAT_BinaryHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+
+    /* Structure layout of the snort that wrote the file */
+    uint16_t host_size;
+    uint16_t app_size;
+    uint16_t ptr_size;
+    uint16_t pad;
+
+    uint32_t num_hosts;
+    uint32_t num_apps;
+    uint32_t num_ranges4;
+    uint32_t num_ranges6;
+    uint32_t num_protocols;
+    uint32_t strings_size;
+
+    /* Section offsets from the start of the file, 8 byte aligned */
+    uint64_t hosts;
+    uint64_t apps;
+    uint64_t dir4;
+    uint64_t ranges4;
+    uint64_t ranges6;
+    uint64_t protocols;
+    uint64_t strings;
+    uint64_t file_size;
+} SFAT_BinaryHeader;
+
+/* A range runs from its start up to the start of the next one.  host is
+ * the index of its entry in the hosts section plus 1, or 0 for none.  The
+ * first range of each family starts at address 0.  IPv6 addresses are
+ * stored as 4 words in host order so they compare as integers. */
+typedef struct _SFAT_Range4
+{
+    uint32_t start;
+    uint32_t host;
+} SFAT_Range4;
+
+typedef struct _SFAT_Range6
+{
+    uint32_t start[4];
+    uint32_t host;
+} SFAT_Range6;
+
+struct _SFAT_BinaryTable
+{
+    uint8_t *base;
+    size_t size;
+    int mapped;
+
+    HostAttributeEntry *hosts;
+    uint32_t num_hosts;
+
+    ApplicationEntry *apps;
+    uint32_t num_apps;
+
+    uint32_t *dir4;
+    SFAT_Range4 *ranges4;
+    uint32_t num_ranges4;
+
+    SFAT_Range6 *ranges6;
+    uint32_t num_ranges6;
+};
+
+/* Host or network being turned into ranges */
+typedef struct _SFAT_Prefix
+{
+    uint32_t start[4];
+    uint32_t end[4];
+    int bits;
+    uint32_t host;
+} SFAT_Prefix;
+
+static int CompareAddress(const uint32_t *a, const uint32_t *b)
+{
+    int i;
+
+    for (i = 0; i < 4; i++)
+    {
+        if (a[i] != b[i])
+            return (a[i] < b[i]) ? -1 : 1;
+    }
+    return 0;
+}
+
+/* Networks sort before the hosts and networks they contain.  Of identical
+ * prefixes the one inserted last is kept, as in the sfrt table. */
+static int ComparePrefix(const void *a, const void *b)
+{
+    const SFAT_Prefix *pa = (const SFAT_Prefix *)a;
+    const SFAT_Prefix *pb = (const SFAT_Prefix *)b;
+    int ret = CompareAddress(pa->start, pb->start);
+
+    if (ret)
+        return ret;
+
+    if (pa->bits != pb->bits)
+        return (pa->bits < pb->bits) ? -1 : 1;
+
+    return (pa->host < pb->host) ? -1 : (pa->host > pb->host);
+}
+
+static void SetPrefix(SFAT_Prefix *prefix, const uint32_t *addr, int bits,
+        int words, uint32_t host)
+{
+    int i;
+
+    for (i = 0; i < 4; i++)
+    {
+        int n = bits - 32 * i;
+        uint32_t mask;
+
+        if (i >= words || n <= 0)
+            mask = 0;
+        else if (n >= 32)
+            mask = 0xffffffff;
+        else
+            mask = ~(0xffffffff >> n);
+
+        prefix->start[i] = (i < words) ? (addr[i] & mask) : 0;
+        prefix->end[i] = (i < words) ? (prefix->start[i] | ~mask) : 0;
+    }
+    prefix->bits = bits;
+    prefix->host = host;
+}
+
+/* Returns 0 if the address wrapped past the end of the address space */
+static int IncrementAddress(uint32_t *addr, int words)
+{
+    int i;
+
+    for (i = words - 1; i >= 0; i--)
+    {
+        if (++addr[i])
+            return 1;
+    }
+    return 0;
+}
+
+static void AddRange(SFAT_Range6 *ranges, uint32_t *count,
+        const uint32_t *start, uint32_t host)
+{
+    if (*count)
+    {
+        SFAT_Range6 *last = &ranges[*count - 1];
+
+        if (!CompareAddress(last->start, start))
+        {
+            /* Nothing left of the previous range */
+            last->host = host;
+            if ((*count > 1) && (ranges[*count - 2].host == host))
+                (*count)--;
+            return;
+        }
+
+        if (last->host == host)
+            return;
+    }
+
+    memcpy(ranges[*count].start, start, sizeof(ranges[*count].start));
+    ranges[*count].host = host;
+    (*count)++;
+}
+
+/* CIDR blocks either contain each other or don't overlap, so with the
+ * prefixes sorted a stack of the ones containing the current address gives
+ * the most specific entry for each range.  Returns the number of ranges,
+ * ranges must have room for 2 * num_prefixes + 1. */
+static uint32_t BuildRanges(SFAT_Prefix *prefixes, uint32_t num_prefixes,
+        int words, SFAT_Range6 *ranges)
+{
+    SFAT_Prefix **stack;
+    uint32_t depth = 0, count = 0, i;
+    uint32_t start[4];
+
+    stack = (SFAT_Prefix **)SnortAlloc((num_prefixes + 1) * sizeof(*stack));
+    qsort(prefixes, num_prefixes, sizeof(*prefixes), ComparePrefix);
+
+    memset(start, 0, sizeof(start));
+    AddRange(ranges, &count, start, 0);
+
+    for (i = 0; i <= num_prefixes; i++)
+    {
+        SFAT_Prefix *prefix = (i < num_prefixes) ? &prefixes[i] : NULL;
+
+        if (prefix && (i + 1 < num_prefixes) &&
+            (prefix->bits == prefixes[i + 1].bits) &&
+            !CompareAddress(prefix->start, prefixes[i + 1].start))
+        {
+            continue;
+        }
+
+        /* Close the entries that end before this one starts */
+        while (depth &&
+               (!prefix || (CompareAddress(stack[depth - 1]->end, prefix->start) < 0)))
+        {
+            memcpy(start, stack[--depth]->end, sizeof(start));
+
+            if (IncrementAddress(start, words))
+                AddRange(ranges, &count, start, depth ? stack[depth - 1]->host : 0);
+        }
+
+        if (prefix)
+        {
+            stack[depth++] = prefix;
+            AddRange(ranges, &count, prefix->start, prefix->host);
+        }
+    }
+
+    free(stack);
+    return count;
+}
+
+/* Pad a section of size bytes out to the next section */
+static int WritePadding(FILE *fp, uint64_t size)
+{
+    static const uint8_t zeros[8] = { 0 };
+    size_t pad = (size_t)(SFAT_ALIGN(size) - size);
+
+    if (pad && (fwrite(zeros, pad, 1, fp) != 1))
+        return SFAT_ERROR;
+
+    return SFAT_OK;
+}
+
+static int WriteSection(FILE *fp, const void *data, uint64_t size)
+{
+    if (size && (fwrite(data, (size_t)size, 1, fp) != 1))
+        return SFAT_ERROR;
+
+    return WritePadding(fp, size);
+}
+
+static uint32_t CountApplications(ApplicationEntry *app)
+{
+    uint32_t count = 0;
+
+    for (; app; app = app->next)
+        count++;
+
+    return count;
+}
+
+static void MarkProtocol(uint16_t ordinal, uint8_t *used, uint32_t *num_protocols)
+{
+    if (!ordinal || (ordinal >= MAX_PROTOCOL_ORDINAL))
+        return;
+
+    used[ordinal] = 1;
+    if (ordinal >= *num_protocols)
+        *num_protocols = ordinal + 1;
+}
+
+static int WriteApplications(FILE *fp, ApplicationEntry *app, uint64_t *offset)
+{
+    for (; app; app = app->next)
+    {
+        ApplicationEntry entry = *app;
+
+        *offset += sizeof(entry);
+        entry.next = app->next ? (ApplicationEntry *)(uintptr_t)*offset : NULL;
+
+        if (fwrite(&entry, sizeof(entry), 1, fp) != 1)
+            return SFAT_ERROR;
+    }
+    return SFAT_OK;
+}
+
+int SFAT_WriteBinaryTable(HostAttributeEntry **hosts, uint32_t num_hosts,
+        const char *filename, char *errbuf, size_t errlen)
+{
+    SFAT_BinaryHeader header;
+    SFAT_Prefix *prefixes4, *prefixes6;
+    SFAT_Range6 *ranges4, *ranges6;
+    SFAT_Range4 *out4;
+    uint32_t *dir4, *protocols;
+    uint8_t *used;
+    char *strings;
+    uint32_t num4 = 0, num6 = 0, num_apps = 0, num_protocols = 1;
+    uint32_t strings_size = 1, i, j;
+    uint64_t offset;
+    char tmpname[PATH_MAX];
+    FILE *fp;
+    int ret = SFAT_ERROR;
+
+    prefixes4 = (SFAT_Prefix *)SnortAlloc((num_hosts + 1) * sizeof(*prefixes4));
+    prefixes6 = (SFAT_Prefix *)SnortAlloc((num_hosts + 1) * sizeof(*prefixes6));
+    used = (uint8_t *)SnortAlloc(MAX_PROTOCOL_ORDINAL);
+
+    for (i = 0; i < num_hosts; i++)
+    {
+        HostAttributeEntry *host = hosts[i];
+        ApplicationEntry *app;
+
+        if (host->ipAddr.family == AF_INET)
+        {
+            /* Already in host order, as inserted in the sfrt table */
+            SetPrefix(&prefixes4[num4++], host->ipAddr.ip32, host->ipAddr.bits, 1, i + 1);
+        }
+        else if (host->ipAddr.family == AF_INET6)
+        {
+            uint32_t addr[4];
+
+            for (j = 0; j < 4; j++)
+                addr[j] = ntohl(host->ipAddr.ip32[j]);
+
+            SetPrefix(&prefixes6[num6++], addr, host->ipAddr.bits, 4, i + 1);
+        }
+
+        num_apps += CountApplications(host->services);
+        num_apps += CountApplications(host->clients);
+
+        for (app = host->services; app; app = app->next)
+        {
+            MarkProtocol(app->ipproto, used, &num_protocols);
+            MarkProtocol(app->protocol, used, &num_protocols);
+        }
+        for (app = host->clients; app; app = app->next)
+        {
+            MarkProtocol(app->ipproto, used, &num_protocols);
+            MarkProtocol(app->protocol, used, &num_protocols);
+        }
+    }
+
+    ranges4 = (SFAT_Range6 *)SnortAlloc((2 * num4 + 1) * sizeof(*ranges4));
+    ranges6 = (SFAT_Range6 *)SnortAlloc((2 * num6 + 1) * sizeof(*ranges6));
+    num4 = BuildRanges(prefixes4, num4, 1, ranges4);
+    num6 = BuildRanges(prefixes6, num6, 4, ranges6);
+
+    out4 = (SFAT_Range4 *)SnortAlloc(num4 * sizeof(*out4));
+    for (i = 0; i < num4; i++)
+    {
+        out4[i].start = ranges4[i].start[0];
+        out4[i].host = ranges4[i].host;
+    }
+
+    dir4 = (uint32_t *)SnortAlloc(SFAT_DIR4_SIZE * sizeof(*dir4));
+    for (i = 0, j = 0; i < SFAT_DIR4_SIZE - 1; i++)
+    {
+        while ((j + 1 < num4) && (out4[j + 1].start <= (i << 16)))
+            j++;
+        dir4[i] = j;
+    }
+    dir4[SFAT_DIR4_SIZE - 1] = num4 - 1;
+
+    /* Protocol names by ordinal, offset 0 is the empty string */
+    protocols = (uint32_t *)SnortAlloc(num_protocols * sizeof(*protocols));
+    for (i = 1; i < num_protocols; i++)
+    {
+        const char *name = used[i] ? GetProtocolReferenceName((int16_t)i) : NULL;
+
+        if (name)
+            strings_size += strlen(name) + 1;
+    }
+    strings = (char *)SnortAlloc(strings_size);
+    for (i = 1, j = 1; i < num_protocols; i++)
+    {
+        const char *name = used[i] ? GetProtocolReferenceName((int16_t)i) : NULL;
+
+        if (name)
+        {
+            protocols[i] = j;
+            strcpy(strings + j, name);
+            j += strlen(name) + 1;
+        }
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SFAT_BINARY_MAGIC, sizeof(header.magic));
+    header.version = SFAT_BINARY_VERSION;
+    header.byte_order = SFAT_BYTE_ORDER;
+    header.host_size = sizeof(HostAttributeEntry);
+    header.app_size = sizeof(ApplicationEntry);
+    header.ptr_size = sizeof(void *);
+    header.num_hosts = num_hosts;
+    header.num_apps = num_apps;
+    header.num_ranges4 = num4;
+    header.num_ranges6 = num6;
+    header.num_protocols = num_protocols;
+    header.strings_size = strings_size;
+
+    offset = SFAT_ALIGN(sizeof(header));
+    header.hosts = offset;
+    offset += SFAT_ALIGN((uint64_t)num_hosts * sizeof(HostAttributeEntry));
+    header.apps = offset;
+    offset += SFAT_ALIGN((uint64_t)num_apps * sizeof(ApplicationEntry));
+    header.dir4 = offset;
+    offset += SFAT_ALIGN(SFAT_DIR4_SIZE * sizeof(*dir4));
+    header.ranges4 = offset;
+    offset += SFAT_ALIGN((uint64_t)num4 * sizeof(SFAT_Range4));
+    header.ranges6 = offset;
+    offset += SFAT_ALIGN((uint64_t)num6 * sizeof(SFAT_Range6));
+    header.protocols = offset;
+    offset += SFAT_ALIGN((uint64_t)num_protocols * sizeof(*protocols));
+    header.strings = offset;
+    offset += SFAT_ALIGN(strings_size);
+    header.file_size = offset;
+
+    SnortSnprintf(tmpname, sizeof(tmpname), "%s.tmp", filename);
+
+    if ((fp = fopen(tmpname, "wb")) == NULL)
+    {
+        SnortSnprintf(errbuf, errlen, "Failed to open '%s': %s\n",
+                tmpname, strerror(errno));
+        goto done;
+    }
+
+    if (WriteSection(fp, &header, sizeof(header)) != SFAT_OK)
+        goto write_error;
+
+    for (i = 0, offset = header.apps; i < num_hosts; i++)
+    {
+        HostAttributeEntry entry = *hosts[i];
+        uint32_t services = CountApplications(entry.services);
+
+        entry.services = services ? (ApplicationList *)(uintptr_t)offset : NULL;
+        offset += services * sizeof(ApplicationEntry);
+        entry.clients = entry.clients ? (ApplicationList *)(uintptr_t)offset : NULL;
+        offset += CountApplications(hosts[i]->clients) * sizeof(ApplicationEntry);
+
+        /* Policy ids depend on the configuration loading the table */
+        entry.hostInfo.streamPolicy = entry.hostInfo.fragPolicy = 0;
+        entry.hostInfo.streamPolicySet = entry.hostInfo.fragPolicySet = POLICY_NOT_SET;
+
+        if (fwrite(&entry, sizeof(entry), 1, fp) != 1)
+            goto write_error;
+    }
+    if (WritePadding(fp, (uint64_t)num_hosts * sizeof(HostAttributeEntry)) != SFAT_OK)
+        goto write_error;
+
+    for (i = 0, offset = header.apps; i < num_hosts; i++)
+    {
+        if ((WriteApplications(fp, hosts[i]->services, &offset) != SFAT_OK) ||
+            (WriteApplications(fp, hosts[i]->clients, &offset) != SFAT_OK))
+        {
+            goto write_error;
+        }
+    }
+    if ((WritePadding(fp, (uint64_t)num_apps * sizeof(ApplicationEntry)) != SFAT_OK) ||
+        (WriteSection(fp, dir4, SFAT_DIR4_SIZE * sizeof(*dir4)) != SFAT_OK) ||
+        (WriteSection(fp, out4, num4 * sizeof(*out4)) != SFAT_OK))
+    {
+        goto write_error;
+    }
+
+    for (i = 0; i < num6; i++)
+    {
+        if (fwrite(&ranges6[i], sizeof(SFAT_Range6), 1, fp) != 1)
+            goto write_error;
+    }
+    if ((WritePadding(fp, (uint64_t)num6 * sizeof(SFAT_Range6)) != SFAT_OK) ||
+        (WriteSection(fp, protocols, num_protocols * sizeof(*protocols)) != SFAT_OK) ||
+        (WriteSection(fp, strings, strings_size) != SFAT_OK))
+    {
+        goto write_error;
+    }
+
+    if (fclose(fp) != 0)
+    {
+        fp = NULL;
+        goto write_error;
+    }
+    fp = NULL;
+
+#ifdef WIN32
+    unlink(filename);
+#endif
+    if (rename(tmpname, filename) != 0)
+    {
+        SnortSnprintf(errbuf, errlen, "Failed to rename '%s' to '%s': %s\n",
+                tmpname, filename, strerror(errno));
+        unlink(tmpname);
+        goto done;
+    }
+
+    ret = SFAT_OK;
+    goto done;
+
+write_error:
+    SnortSnprintf(errbuf, errlen, "Failed to write '%s': %s\n",
+            tmpname, strerror(errno));
+    if (fp)
+        fclose(fp);
+    unlink(tmpname);
+
+done:
+    free(prefixes4);
+    free(prefixes6);
+    free(used);
+    free(ranges4);
+    free(ranges6);
+    free(out4);
+    free(dir4);
+    free(protocols);
+    free(strings);
+
+    return ret;
+}
+
+int SFAT_IsBinaryTable(const char *filename)
+{
+    char magic[8];
+    FILE *fp;
+    int ret = 0;
+
+    if ((fp = fopen(filename, "rb")) == NULL)
+        return 0;
+
+    if ((fread(magic, sizeof(magic), 1, fp) == 1) &&
+        !memcmp(magic, SFAT_BINARY_MAGIC, sizeof(magic)))
+    {
+        ret = 1;
+    }
+
+    fclose(fp);
+    return ret;
+}
+
+static int MapBinaryTable(SFAT_BinaryTable *table, const char *filename,
+        char *errbuf, size_t errlen)
+{
+#ifndef WIN32
+    struct stat st;
+    void *base;
+    int fd;
+
+    if ((fd = open(filename, O_RDONLY)) < 0)
+    {
+        SnortSnprintf(errbuf, errlen, "Failed to open '%s': %s\n",
+                filename, strerror(errno));
+        return SFAT_ERROR;
+    }
+
+    if (fstat(fd, &st) || (st.st_size < (off_t)sizeof(SFAT_BinaryHeader)))
+    {
+        SnortSnprintf(errbuf, errlen, "Invalid binary attribute table '%s'\n", filename);
+        close(fd);
+        return SFAT_ERROR;
+    }
+
+    /* Private and writable: the list pointers and policy ids are set in
+     * place, which copies just the pages holding the entries.  The lookup
+     * ranges stay shared with the page cache. */
+    base = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (base == MAP_FAILED)
+    {
+        SnortSnprintf(errbuf, errlen, "Failed to map '%s': %s\n",
+                filename, strerror(errno));
+        return SFAT_ERROR;
+    }
+
+    table->base = (uint8_t *)base;
+    table->size = st.st_size;
+    table->mapped = 1;
+#else
+    FILE *fp;
+    long size;
+
+    if ((fp = fopen(filename, "rb")) == NULL)
+    {
+        SnortSnprintf(errbuf, errlen, "Failed to open '%s': %s\n",
+                filename, strerror(errno));
+        return SFAT_ERROR;
+    }
+
+    if (fseek(fp, 0, SEEK_END) || ((size = ftell(fp)) < (long)sizeof(SFAT_BinaryHeader)) ||
+        fseek(fp, 0, SEEK_SET))
+    {
+        SnortSnprintf(errbuf, errlen, "Invalid binary attribute table '%s'\n", filename);
+        fclose(fp);
+        return SFAT_ERROR;
+    }
+
+    table->base = (uint8_t *)SnortAlloc(size);
+    table->size = size;
+
+    if (fread(table->base, size, 1, fp) != 1)
+    {
+        SnortSnprintf(errbuf, errlen, "Failed to read '%s': %s\n",
+                filename, strerror(errno));
+        fclose(fp);
+        return SFAT_ERROR;
+    }
+    fclose(fp);
+#endif
+    return SFAT_OK;
+}
+
+static void UnmapBinaryTable(SFAT_BinaryTable *table)
+{
+    if (!table->base)
+        return;
+
+#ifndef WIN32
+    if (table->mapped)
+        munmap(table->base, table->size);
+    else
+#endif
+        free(table->base);
+
+    table->base = NULL;
+}
+
+static int CheckSection(SFAT_BinaryTable *table, uint64_t offset,
+        uint64_t count, size_t size)
+{
+    if ((offset & 7) || (offset > table->size))
+        return 0;
+
+    return count <= (table->size - offset) / size;
+}
+
+static int CheckHeader(SFAT_BinaryTable *table, const SFAT_BinaryHeader *header)
+{
+    if (memcmp(header->magic, SFAT_BINARY_MAGIC, sizeof(header->magic)) ||
+        (header->version != SFAT_BINARY_VERSION) ||
+        (header->byte_order != SFAT_BYTE_ORDER) ||
+        (header->host_size != sizeof(HostAttributeEntry)) ||
+        (header->app_size != sizeof(ApplicationEntry)) ||
+        (header->ptr_size != sizeof(void *)) ||
+        (header->file_size != table->size))
+    {
+        return 0;
+    }
+
+    if (!CheckSection(table, header->hosts, header->num_hosts, sizeof(HostAttributeEntry)) ||
+        !CheckSection(table, header->apps, header->num_apps, sizeof(ApplicationEntry)) ||
+        !CheckSection(table, header->dir4, SFAT_DIR4_SIZE, sizeof(uint32_t)) ||
+        !CheckSection(table, header->ranges4, header->num_ranges4, sizeof(SFAT_Range4)) ||
+        !CheckSection(table, header->ranges6, header->num_ranges6, sizeof(SFAT_Range6)) ||
+        !CheckSection(table, header->protocols, header->num_protocols, sizeof(uint32_t)) ||
+        !CheckSection(table, header->strings, header->strings_size, 1))
+    {
+        return 0;
+    }
+
+    return header->num_ranges4 && header->num_ranges6 &&
+        (header->num_protocols <= MAX_PROTOCOL_ORDINAL) && header->strings_size &&
+        !table->base[header->strings + header->strings_size - 1];
+}
+
+static int CheckRanges(SFAT_BinaryTable *table)
+{
+    uint32_t i;
+
+    if (table->ranges4[0].start || table->ranges6[0].start[0] ||
+        table->ranges6[0].start[1] || table->ranges6[0].start[2] ||
+        table->ranges6[0].start[3])
+    {
+        return 0;
+    }
+
+    for (i = 0; i < table->num_ranges4; i++)
+    {
+        if ((table->ranges4[i].host > table->num_hosts) ||
+            (i && (table->ranges4[i].start <= table->ranges4[i - 1].start)))
+        {
+            return 0;
+        }
+    }
+
+    for (i = 0; i < table->num_ranges6; i++)
+    {
+        if ((table->ranges6[i].host > table->num_hosts) ||
+            (i && (CompareAddress(table->ranges6[i].start, table->ranges6[i - 1].start) <= 0)))
+        {
+            return 0;
+        }
+    }
+
+    /* Each directory entry is the last range starting at or before its /16 */
+    for (i = 0; i < SFAT_DIR4_SIZE - 1; i++)
+    {
+        uint32_t index = table->dir4[i];
+
+        if ((index >= table->num_ranges4) ||
+            (table->ranges4[index].start > (i << 16)) ||
+            ((index + 1 < table->num_ranges4) &&
+             (table->ranges4[index + 1].start <= (i << 16))))
+        {
+            return 0;
+        }
+    }
+
+    return table->dir4[SFAT_DIR4_SIZE - 1] == table->num_ranges4 - 1;
+}
+
+static ApplicationEntry *RelocateApplication(SFAT_BinaryTable *table,
+        const SFAT_BinaryHeader *header, uintptr_t offset, int *error)
+{
+    if (!offset)
+        return NULL;
+
+    if ((offset < header->apps) ||
+        ((offset - header->apps) % sizeof(ApplicationEntry)) ||
+        ((offset - header->apps) / sizeof(ApplicationEntry) >= header->num_apps))
+    {
+        *error = 1;
+        return NULL;
+    }
+
+    return (ApplicationEntry *)(table->base + offset);
+}
+
+/* Turn the offsets in the entries into pointers and the protocol ordinals
+ * of the snort that wrote the file into ours */
+static int RelocateEntries(SFAT_BinaryTable *table, const SFAT_BinaryHeader *header)
+{
+    uint32_t *protocols = (uint32_t *)(table->base + header->protocols);
+    const char *strings = (const char *)(table->base + header->strings);
+    uint16_t *ordinals;
+    int error = 0;
+    uint32_t i;
+
+    ordinals = (uint16_t *)SnortAlloc((header->num_protocols + 1) * sizeof(*ordinals));
+
+    for (i = 0; i < header->num_protocols; i++)
+    {
+        if (protocols[i] >= header->strings_size)
+        {
+            free(ordinals);
+            return 0;
+        }
+
+        if (strings[protocols[i]])
+            ordinals[i] = AddProtocolReference(&strings[protocols[i]]);
+        else
+            ordinals[i] = (uint16_t)i;
+    }
+
+    for (i = 0; (i < table->num_apps) && !error; i++)
+    {
+        ApplicationEntry *app = &table->apps[i];
+        uintptr_t offset = (uintptr_t)app->next;
+
+        /* Lists are written in order so they can't loop */
+        if (offset && (offset <= header->apps + i * sizeof(ApplicationEntry)))
+            error = 1;
+
+        app->next = RelocateApplication(table, header, offset, &error);
+
+        if (app->ipproto < header->num_protocols)
+            app->ipproto = ordinals[app->ipproto];
+
+        if (app->protocol < header->num_protocols)
+            app->protocol = ordinals[app->protocol];
+    }
+
+    for (i = 0; (i < table->num_hosts) && !error; i++)
+    {
+        HostAttributeEntry *host = &table->hosts[i];
+
+        host->services = RelocateApplication(
+            table, header, (uintptr_t)host->services, &error);
+        host->clients = RelocateApplication(
+            table, header, (uintptr_t)host->clients, &error);
+    }
+
+    free(ordinals);
+    return !error;
+}
+
+SFAT_BinaryTable *SFAT_LoadBinaryTable(const char *filename,
+        char *errbuf, size_t errlen)
+{
+    SFAT_BinaryTable *table;
+    SFAT_BinaryHeader header;
+
+    table = (SFAT_BinaryTable *)SnortAlloc(sizeof(*table));
+
+    if (MapBinaryTable(table, filename, errbuf, errlen) != SFAT_OK)
+    {
+        UnmapBinaryTable(table);
+        free(table);
+        return NULL;
+    }
+
+    memcpy(&header, table->base, sizeof(header));
+
+    if (!CheckHeader(table, &header))
+    {
+        SnortSnprintf(errbuf, errlen,
+            "Invalid binary attribute table '%s', it must be compiled by "
+            "this version of snort with --compile-attribute-table\n", filename);
+        UnmapBinaryTable(table);
+        free(table);
+        return NULL;
+    }
+
+    table->hosts = (HostAttributeEntry *)(table->base + header.hosts);
+    table->num_hosts = header.num_hosts;
+    table->apps = (ApplicationEntry *)(table->base + header.apps);
+    table->num_apps = header.num_apps;
+    table->dir4 = (uint32_t *)(table->base + header.dir4);
+    table->ranges4 = (SFAT_Range4 *)(table->base + header.ranges4);
+    table->num_ranges4 = header.num_ranges4;
+    table->ranges6 = (SFAT_Range6 *)(table->base + header.ranges6);
+    table->num_ranges6 = header.num_ranges6;
+
+    if (!CheckRanges(table) || !RelocateEntries(table, &header))
+    {
+        SnortSnprintf(errbuf, errlen, "Corrupt binary attribute table '%s'\n", filename);
+        UnmapBinaryTable(table);
+        free(table);
+        return NULL;
+    }
+
+    return table;
+}
+
+void SFAT_FreeBinaryTable(SFAT_BinaryTable *table)
+{
+    uint32_t i;
+
+    if (!table)
+        return;
+
+    /* Services learned at run time are allocated and added to the front
+     * of a host's list */
+    for (i = 0; i < table->num_hosts; i++)
+    {
+        HostAttributeEntry *host = &table->hosts[i];
+
+        while (host->services &&
+               (((uint8_t *)host->services < table->base) ||
+                ((uint8_t *)host->services >= table->base + table->size)))
+        {
+            ApplicationEntry *app = host->services;
+
+            host->services = app->next;
+            free(app);
+        }
+    }
+
+    UnmapBinaryTable(table);
+    free(table);
+}
+
+HostAttributeEntry *SFAT_LookupBinaryTable(SFAT_BinaryTable *table, sfip_t *ipAddr)
+{
+    uint32_t lo, hi, host;
+
+    if (!table || !ipAddr)
+        return NULL;
+
+    if (ipAddr->family == AF_INET)
+    {
+        uint32_t addr = ipAddr->ip32[0];
+
+        lo = table->dir4[addr >> 16];
+        hi = table->dir4[(addr >> 16) + 1];
+
+        while (lo < hi)
+        {
+            uint32_t mid = lo + (hi - lo + 1) / 2;
+
+            if (table->ranges4[mid].start <= addr)
+                lo = mid;
+            else
+                hi = mid - 1;
+        }
+        host = table->ranges4[lo].host;
+    }
+    else if (ipAddr->family == AF_INET6)
+    {
+        uint32_t addr[4];
+        int i;
+
+        for (i = 0; i < 4; i++)
+            addr[i] = ntohl(ipAddr->ip32[i]);
+
+        lo = 0;
+        hi = table->num_ranges6 - 1;
+
+        while (lo < hi)
+        {
+            uint32_t mid = lo + (hi - lo + 1) / 2;
+
+            if (CompareAddress(table->ranges6[mid].start, addr) <= 0)
+                lo = mid;
+            else
+                hi = mid - 1;
+        }
+        host = table->ranges6[lo].host;
+    }
+    else
+    {
+        return NULL;
+    }
+
+    return host ? &table->hosts[host - 1] : NULL;
+}
+
+uint32_t SFAT_BinaryTableNumHosts(SFAT_BinaryTable *table)
+{
+    return table ? table->num_hosts : 0;
+}
+
+void SFAT_IterateBinaryTable(SFAT_BinaryTable *table, sfrt_iterator_callback callback)
+{
+    uint32_t i;
+
+    if (!table)
+        return;
+
+    for (i = 0; i < table->num_hosts; i++)
+        callback(&table->hosts[i]);
+}
+
+#endif /* TARGET_BASED */
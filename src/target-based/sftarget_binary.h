@@ -0,0 +1,62 @@
+/*
+** Copyright (C) 2013 Sourcefire, Inc.
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License Version 2 as
+** published by the Free Software Foundation.  You may not use, modify or
+** distribute this program under any other version of the GNU General
+** Public License.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+/*
+ * sftarget_binary.h
+ *
+ * Compiled (binary) host attribute table.  snort --compile-attribute-table
+ * writes the loaded attribute table to a file that is mapped and used as
+ * is, so loading it takes no parsing and no memory beyond the file itself.
+ *
+ * The file holds the HostAttributeEntry and ApplicationEntry structures in
+ * the layout of the snort that wrote it, with offsets in place of the list
+ * pointers and the protocol names so their ordinals can be remapped.  The
+ * lookup structure is a sorted array of address ranges, each pointing to
+ * the most specific host or network containing it, with a directory on the
+ * upper 16 bits of IPv4 addresses.
+ */
+
+#ifndef SF_TARGET_BINARY_H_
+#define SF_TARGET_BINARY_H_
+
+#include "sftarget_reader.h"
+#include "sfutil/sfrt.h"
+
+typedef struct _SFAT_BinaryTable SFAT_BinaryTable;
+
+/* Returns 1 if filename starts with the binary table magic */
+int SFAT_IsBinaryTable(const char *filename);
+
+/* Write the hosts to filename.  The file is written under a temporary
+ * name and renamed so a reload never sees it partially written. */
+int SFAT_WriteBinaryTable(HostAttributeEntry **hosts, uint32_t num_hosts,
+        const char *filename, char *errbuf, size_t errlen);
+
+/* Returns NULL with the reason in errbuf if the file can't be used */
+SFAT_BinaryTable *SFAT_LoadBinaryTable(const char *filename,
+        char *errbuf, size_t errlen);
+void SFAT_FreeBinaryTable(SFAT_BinaryTable *table);
+
+/* ipAddr is as for sfrt_lookup(), i.e. IPv4 addresses in host order */
+HostAttributeEntry *SFAT_LookupBinaryTable(SFAT_BinaryTable *table, sfip_t *ipAddr);
+
+uint32_t SFAT_BinaryTableNumHosts(SFAT_BinaryTable *table);
+void SFAT_IterateBinaryTable(SFAT_BinaryTable *table, sfrt_iterator_callback callback);
+
+#endif /* SF_TARGET_BINARY_H_ */
@@ -153,6 +153,25 @@ int16_t FindProtocolReference(const char *protocol)
     return SFTARGET_UNKNOWN_PROTOCOL;
 }
 
+const char *GetProtocolReferenceName(int16_t ordinal)
+{
+    SFGHASH_NODE *node;
+
+    if (!proto_reference_table)
+        return NULL;
+
+    for (node = sfghash_findfirst(proto_reference_table); node;
+         node = sfghash_findnext(proto_reference_table))
+    {
+        SFTargetProtocolReference *reference = node->data;
+
+        if (reference->ordinal == ordinal)
+            return reference->name;
+    }
+
+    return NULL;
+}
+
 void InitializeProtocolReferenceTable(void)
 {
     char **protocol;
@@ -44,6 +44,7 @@ void InitializeProtocolReferenceTable(void);
 void FreeProtoocolReferenceTable(void);
 int16_t AddProtocolReference(const char *protocol);
 int16_t FindProtocolReference(const char *protocol);
+const char *GetProtocolReferenceName(int16_t ordinal);
 
 int16_t GetProtocolReference(Packet *p);
 
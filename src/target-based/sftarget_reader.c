@@ -38,6 +38,7 @@
 #include "sfutil/sfxhash.h"
 #include "sfutil/util_net.h"
 #include "sftarget_hostentry.h"
+#include "sftarget_binary.h"
 
 #include <signal.h>
 #include <sys/types.h>
@@ -62,6 +63,9 @@ typedef struct
 {
     table_t *lookupTable;
     SFXHASH *mapTable;
+
+    /* Set instead of the above when loaded from a compiled table */
+    SFAT_BinaryTable *binaryTable;
 } tTargetBasedConfig;
 
 typedef struct
@@ -110,6 +114,10 @@ extern const struct timespec thread_sleep;
 uint32_t SFAT_NumberOfHosts(void)
 {
     tTargetBasedPolicyConfig *pConfig = &targetBasedPolicyConfig;
+    if (pConfig->curr.binaryTable)
+    {
+        return SFAT_BinaryTableNumHosts(pConfig->curr.binaryTable);
+    }
     if (pConfig->curr.lookupTable)
     {
         return sfrt_num_entries(pConfig->curr.lookupTable);
@@ -118,6 +126,22 @@ uint32_t SFAT_NumberOfHosts(void)
     return 0;
 }
 
+static HostAttributeEntry *LookupHostEntry(tTargetBasedConfig *config, sfip_t *ipAddr)
+{
+    if (config->binaryTable)
+        return SFAT_LookupBinaryTable(config->binaryTable, ipAddr);
+
+    return sfrt_lookup(ipAddr, config->lookupTable);
+}
+
+static void IterateHostEntries(tTargetBasedConfig *config, sfrt_iterator_callback callback)
+{
+    if (config->binaryTable)
+        SFAT_IterateBinaryTable(config->binaryTable, callback);
+    else
+        sfrt_iterate(config->lookupTable, callback);
+}
+
 int SFAT_AddMapEntry(MapEntry *entry)
 {
     tTargetBasedPolicyConfig *pConfig = &targetBasedPolicyConfig;
@@ -552,7 +576,7 @@ HostAttributeEntry *SFAT_LookupHostEntryByIP(sfip_t *ipAddr)
         local_ipAddr.ip32[0] = ntohl(local_ipAddr.ip32[0]);
     }
 
-    host = sfrt_lookup(&local_ipAddr, pConfig->curr.lookupTable);
+    host = LookupHostEntry(&pConfig->curr, &local_ipAddr);
 
     if (host)
     {
@@ -602,7 +626,7 @@ void SFAT_SetPolicyIds(GetPolicyIdFunc policyCallback, int snortPolicyId)
 
     updatePolicyCallback = policyCallback;
 
-    sfrt_iterate(pConfig->curr.lookupTable, SFAT_SetPolicyCallback);
+    IterateHostEntries(&pConfig->curr, SFAT_SetPolicyCallback);
 
     if (!updatePolicyCallbackList)
     {
@@ -685,6 +709,10 @@ void SFAT_Cleanup(void)
         sfrt_free(pConfig->next.lookupTable);
     }
 
+    SFAT_FreeBinaryTable(pConfig->curr.binaryTable);
+    SFAT_FreeBinaryTable(pConfig->prev.binaryTable);
+    SFAT_FreeBinaryTable(pConfig->next.binaryTable);
+
     FreeProtoocolReferenceTable();
 
     if (sfat_saved_file)
@@ -731,6 +759,51 @@ void SFAT_VTAlrmHandler(int signal)
     return;
 }
 
+/* Load the table in filename into pConfig->next, either mapping a compiled
+ * table or parsing XML into a new lookup table. */
+static int LoadTargetMap(char *filename)
+{
+    tTargetBasedPolicyConfig *pConfig = &targetBasedPolicyConfig;
+
+    if (SFAT_IsBinaryTable(filename))
+    {
+        pConfig->next.binaryTable = SFAT_LoadBinaryTable(
+            filename, sfat_error_message, sizeof(sfat_error_message));
+
+        if (!pConfig->next.binaryTable)
+            return SFAT_ERROR;
+
+        /* Save off the filename for reloads, as ParseTargetMap() does */
+        if (!sfat_saved_file || strcmp(sfat_saved_file, filename))
+        {
+            char *saved_file = SnortStrdup(filename);
+
+            if (sfat_saved_file)
+                free(sfat_saved_file);
+            sfat_saved_file = saved_file;
+        }
+        return SFAT_OK;
+    }
+
+    /* Initialize a new lookup table */
+    if (!pConfig->next.lookupTable)
+    {
+        /* Add 1 to max for table purposes
+         * We use max_hosts to limit memcap, assume 16k per entry costs*/
+        pConfig->next.lookupTable =
+            sfrt_new(DIR_8x16, IPv6, ScMaxAttrHosts() + 1,
+                    ((ScMaxAttrHosts())>>6) + 1);
+        if (!pConfig->next.lookupTable)
+        {
+            SnortSnprintf(sfat_error_message, STD_BUF,
+                "Failed to initialize memory for new attribute table\n");
+            return SFAT_ERROR;
+        }
+    }
+
+    return ParseTargetMap(filename);
+}
+
 void *SFAT_ReloadAttributeTableThread(void *arg)
 {
 #ifndef WIN32
@@ -790,6 +863,9 @@ void *SFAT_ReloadAttributeTableThread(void *arg)
                 sfrt_cleanup(pConfig->prev.lookupTable, SFAT_CleanupCallback);
                 sfrt_free(pConfig->prev.lookupTable);
                 pConfig->prev.lookupTable = NULL;
+
+                SFAT_FreeBinaryTable(pConfig->prev.binaryTable);
+                pConfig->prev.binaryTable = NULL;
                 clear_attribute_table_flag(ATTRIBUTE_TABLE_AVAILABLE_FLAG);
             }
             clear_attribute_table_flag(ATTRIBUTE_TABLE_PARSE_FAILED_FLAG);
@@ -809,25 +885,7 @@ void *SFAT_ReloadAttributeTableThread(void *arg)
             reloads++;
             if (sfat_saved_file)
             {
-                /* Initialize a new lookup table */
-                if (!pConfig->next.lookupTable)
-                {
-                    /* Add 1 to max for table purposes
-                     * We use max_hosts to limit memcap, assume 16k per entry costs*/
-                    pConfig->next.lookupTable =
-                        sfrt_new(DIR_8x16, IPv6, ScMaxAttrHosts() + 1,
-                                ((ScMaxAttrHosts())>>6) + 1);
-                    if (!pConfig->next.lookupTable)
-                    {
-                        SnortSnprintf(sfat_error_message, STD_BUF,
-                            "Failed to initialize memory for new attribute table\n");
-                        clear_attribute_table_flag(ATTRIBUTE_TABLE_RELOAD_FLAG);
-                        clear_attribute_table_flag(ATTRIBUTE_TABLE_RELOADING_FLAG);
-                        set_attribute_table_flag(ATTRIBUTE_TABLE_PARSE_FAILED_FLAG);
-                        continue;
-                    }
-                }
-                ret = ParseTargetMap(sfat_saved_file);
+                ret = LoadTargetMap(sfat_saved_file);
                 if (ret == SFAT_OK)
                 {
                     GetPolicyIdsCallbackList *list_entry = NULL;
@@ -844,7 +902,7 @@ void *SFAT_ReloadAttributeTableThread(void *arg)
                     {
                         if (list_entry->policyCallback)
                         {
-                            sfrt_iterate(pConfig->next.lookupTable,
+                            IterateHostEntries(&pConfig->next,
                                 (sfrt_iterator_callback)list_entry->policyCallback);
                         }
                         list_entry = list_entry->next;
@@ -916,6 +974,10 @@ void AttributeTableReloadCheck(void)
         pConfig->curr.mapTable = pConfig->next.mapTable;
         pConfig->next.mapTable = NULL;
 
+        pConfig->prev.binaryTable = pConfig->curr.binaryTable;
+        pConfig->curr.binaryTable = pConfig->next.binaryTable;
+        pConfig->next.binaryTable = NULL;
+
         /* Set taken to indicate we've taken the new table */
         set_attribute_table_flag(ATTRIBUTE_TABLE_TAKEN_FLAG);
 
@@ -941,22 +1003,6 @@ int SFAT_ParseAttributeTable(char *args)
 
     DEBUG_WRAP(DebugMessage(DEBUG_CONFIGRULES,"AttributeTable\n"););
 
-
-    /* Initialize lookup table */
-    if (!pConfig->next.lookupTable)
-    {
-        /* Add 1 to max for table purposes
-         * We use max_hosts to limit memcap, assume 16k per entry costs*/
-        pConfig->next.lookupTable =
-            sfrt_new(DIR_8x16, IPv6, ScMaxAttrHosts() + 1,
-                    ((ScMaxAttrHosts())>>6)+ 1);
-        if (!pConfig->next.lookupTable)
-        {
-            FatalError("Failed to initialize attribute table memory\n");
-        }
-    }
-
-
     /* Parse filename */
     toks = mSplit(args, " \t", 0, &num_toks, 0);
 
@@ -977,7 +1023,7 @@ int SFAT_ParseAttributeTable(char *args)
     sfat_insufficient_space_logged = 0;
     sfat_fatal_error = 1;
 
-    ret = ParseTargetMap(toks[1]);
+    ret = LoadTargetMap(toks[1]);
 
     if (ret == SFAT_OK)
     {
@@ -985,6 +1031,8 @@ int SFAT_ParseAttributeTable(char *args)
         pConfig->next.lookupTable = NULL;
         pConfig->curr.mapTable = pConfig->next.mapTable;
         pConfig->next.mapTable = NULL;
+        pConfig->curr.binaryTable = pConfig->next.binaryTable;
+        pConfig->next.binaryTable = NULL;
         if (sfat_insufficient_space_logged)
             LogMessage("%s", sfat_error_message);
     }
@@ -1039,6 +1087,40 @@ void SFAT_StartReloadThread(void)
 #endif
 }
 
+static HostAttributeEntry **compile_hosts = NULL;
+static uint32_t compile_num_hosts = 0;
+static uint32_t compile_max_hosts = 0;
+static void SFAT_CompileCallback(void *host_attr_ent)
+{
+    if (compile_num_hosts < compile_max_hosts)
+        compile_hosts[compile_num_hosts++] = (HostAttributeEntry *)host_attr_ent;
+}
+
+void SFAT_CompileAttributeTable(const char *filename)
+{
+    tTargetBasedPolicyConfig *pConfig = &targetBasedPolicyConfig;
+    char errbuf[STD_BUF];
+
+    compile_max_hosts = SFAT_NumberOfHosts();
+    compile_hosts = (HostAttributeEntry **)SnortAlloc(
+        (compile_max_hosts + 1) * sizeof(*compile_hosts));
+    compile_num_hosts = 0;
+
+    IterateHostEntries(&pConfig->curr, SFAT_CompileCallback);
+
+    if (SFAT_WriteBinaryTable(compile_hosts, compile_num_hosts, filename,
+            errbuf, sizeof(errbuf)) != SFAT_OK)
+    {
+        FatalError("Failed to compile attribute table: %s", errbuf);
+    }
+
+    LogMessage("Attribute Table with %u hosts compiled to %s\n",
+        compile_num_hosts, filename);
+
+    free(compile_hosts);
+    compile_hosts = NULL;
+}
+
 int IsAdaptiveConfigured(tSfPolicyId id)
 {
     SnortConfig *sc = snort_conf;
@@ -1098,12 +1180,16 @@ void SFAT_UpdateApplicationProtocol(sfip_t *ipAddr, uint16_t port, uint16_t prot
     if (local_ipAddr.family == AF_INET)
         local_ipAddr.ip32[0] = ntohl(local_ipAddr.ip32[0]);
 
-    host_entry = sfrt_lookup(&local_ipAddr, pConfig->curr.lookupTable);
+    host_entry = LookupHostEntry(&pConfig->curr, &local_ipAddr);
 
     if (!host_entry)
     {
         GetPolicyIdsCallbackList *list_entry;
 
+        /* Hosts can't be added to a compiled table */
+        if (pConfig->curr.binaryTable)
+            return;
+
         if (sfrt_num_entries(pConfig->curr.lookupTable) >= ScMaxAttrHosts())
             return;
 
@@ -148,6 +148,9 @@ int SFAT_ParseAttributeTable(char *args);
 /* Function to swap out new table */
 void AttributeTableReloadCheck(void);
 
+/* Write the loaded table in the format of sftarget_binary.h */
+void SFAT_CompileAttributeTable(const char *filename);
+
 /* Status functions */
 uint32_t SFAT_NumberOfHosts(void);
 
@@ -132,6 +132,9 @@ typedef struct _OptTreeNode
     /* List of preprocessor registered fast pattern contents */
     void *preproc_fp_list;
 
+    /* text output of the rule's static alert fields, built on first alert */
+    struct _AlertTemplate *alert_template;
+
 } OptTreeNode;
 
 /* function pointer list for rule head nodes */
@@ -147,10 +150,32 @@ typedef struct _RuleFpList
     struct _RuleFpList *next;
 } RuleFpList;
 
+/* rule header checks compiled from the RTN flags, see CheckRuleHeader() */
+#define RULE_HDR_CHECK_BIDIRECTIONAL  0x01
+#define RULE_HDR_CHECK_DST_PORT       0x02
+#define RULE_HDR_CHECK_DST_PORT_NOT   0x04
+#define RULE_HDR_CHECK_SRC_PORT       0x08
+#define RULE_HDR_CHECK_SRC_PORT_NOT   0x10
+#define RULE_HDR_CHECK_SRC_IP         0x20
+#define RULE_HDR_CHECK_DST_IP         0x40
+
+/* rule header port object flattened into an array of ranges */
+typedef struct _RulePortRange
+{
+    uint16_t lport;
+    uint16_t hport;
+} RulePortRange;
+
 typedef struct _RuleTreeNode
 {
     RuleFpList *rule_func; /* match functions.. (Bidirectional etc.. ) */
 
+    uint32_t header_checks;
+    RulePortRange *src_ports;
+    RulePortRange *dst_ports;
+    unsigned int num_src_ports;
+    unsigned int num_dst_ports;
+
     int head_node_number;
 
     RuleType type;
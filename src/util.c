@@ -225,15 +225,24 @@ int DisplayBanner(void)
  *
  * Returns: void function
  *
+ * The date only changes once a day so it is formatted once and kept;
+ * the time of day is converted by hand.
+ *
  ****************************************************************************/
 void ts_print(register const struct timeval *tvp, char *timebuf)
 {
+    static time_t date_time = -1;
+    static int date_year = -1;
+    static char date_buf[TIMEBUF_SIZE];
+    static int date_len = 0;
+
     register int s;
     int    localzone;
+    int    year;
     time_t Time;
     struct timeval tv;
     struct timezone tz;
-    struct tm *lt;    /* place to stick the adjusted clock data */
+    char *t;
 
     /* if null was passed, we use current time */
     if(!tvp)
@@ -254,22 +263,48 @@ void ts_print(register const struct timeval *tvp, char *timebuf)
 
     s = (tvp->tv_sec + localzone) % 86400;
     Time = (tvp->tv_sec + localzone) - s;
+    year = ScOutputIncludeYear() ? 1 : 0;
 
-    lt = gmtime(&Time);
-
-    if (ScOutputIncludeYear())
-    {
-        (void) SnortSnprintf(timebuf, TIMEBUF_SIZE,
-                        "%02d/%02d/%02d-%02d:%02d:%02d",
-                        lt->tm_mon + 1, lt->tm_mday, lt->tm_year - 100,
-                        s / 3600, (s % 3600) / 60, s % 60);
-    }
-    else
+    if ((Time != date_time) || (year != date_year) || (s < 0))
     {
-        (void) SnortSnprintf(timebuf, TIMEBUF_SIZE,
-                        "%02d/%02d-%02d:%02d:%02d", lt->tm_mon + 1,
-                        lt->tm_mday, s / 3600, (s % 3600) / 60, s % 60);
+        struct tm *lt = gmtime(&Time);  /* place to stick the adjusted clock data */
+
+        if (year)
+        {
+            (void) SnortSnprintf(date_buf, sizeof(date_buf), "%02d/%02d/%02d-",
+                            lt->tm_mon + 1, lt->tm_mday, lt->tm_year - 100);
+        }
+        else
+        {
+            (void) SnortSnprintf(date_buf, sizeof(date_buf), "%02d/%02d-",
+                            lt->tm_mon + 1, lt->tm_mday);
+        }
+        date_len = strlen(date_buf);
+        date_time = Time;
+        date_year = year;
+
+        /* before the epoch the time of day is negative; print as is */
+        if (s < 0)
+        {
+            (void) SnortSnprintf(timebuf, TIMEBUF_SIZE, "%s%02d:%02d:%02d",
+                            date_buf, s / 3600, (s % 3600) / 60, s % 60);
+            date_time = -1;
+            return;
+        }
     }
+
+    memcpy(timebuf, date_buf, date_len);
+    t = timebuf + date_len;
+
+    t[0] = '0' + (s / 3600) / 10;
+    t[1] = '0' + (s / 3600) % 10;
+    t[2] = ':';
+    t[3] = '0' + ((s % 3600) / 60) / 10;
+    t[4] = '0' + ((s % 3600) / 60) % 10;
+    t[5] = ':';
+    t[6] = '0' + (s % 60) / 10;
+    t[7] = '0' + (s % 60) % 10;
+    t[8] = '\0';
 }
 
 
@@ -1220,6 +1255,14 @@ void DropStats(int exiting)
 
         if ( pc.internal_whitelist > 0 )
             LogStat("Int Whtlst", pc.internal_whitelist, pkts_recv);
+
+        if ( pc.bypass_flows > 0 )
+        {
+            LogMessage("Bypass:\n");
+            LogStat("Bypassed", pc.bypassed, pkts_recv);
+            LogCount("Flows", pc.bypass_flows);
+            LogCount("Evicted", pc.bypass_evicts);
+        }
     }
 #ifdef TARGET_BASED
     if (ScIdsMode() && IsAdaptiveConfigured(getDefaultPolicy()))
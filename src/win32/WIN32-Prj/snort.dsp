@@ -1142,6 +1142,14 @@ SOURCE=..\..\sfutil\sfmemcap.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\sfutil\sfohash.c
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\sfutil\sfohash.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\sfutil\sfPolicy.c
 # End Source File
 # Begin Source File
@@ -1434,6 +1442,14 @@ InputName=sf_attribute_table_parser
 # End Source File
 # Begin Source File
 
+SOURCE="..\..\target-based\sftarget_binary.c"
+# End Source File
+# Begin Source File
+
+SOURCE="..\..\target-based\sftarget_binary.h"
+# End Source File
+# Begin Source File
+
 SOURCE="..\..\target-based\sftarget_hostentry.c"
 # End Source File
 # Begin Source File
@@ -1601,6 +1617,14 @@ SOURCE=..\..\active.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\bypass.c
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\bypass.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\bounds.h
 # End Source File
 # Begin Source File
@@ -1777,6 +1801,14 @@ SOURCE=..\..\pcap_pkthdr32.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\pcap_workers.c
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\pcap_workers.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\pcrm.c
 # End Source File
 # Begin Source File
@@ -1849,6 +1881,14 @@ SOURCE=..\..\sfdaq.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\sfdaq_mmap.c
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\sfdaq_mmap.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\sfthreshold.c
 # End Source File
 # Begin Source File
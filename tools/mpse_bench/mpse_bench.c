@@ -0,0 +1,897 @@
+/*
+ * Copyright (C) 2013 Sourcefire, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 2 as
+ * published by the Free Software Foundation.  You may not use, modify or
+ * distribute this program under any other version of the GNU General
+ * Public License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * mpse_bench - compare the multi-pattern search engines
+ *
+ * Loads the port groups written by "config detection: dump-pattern-groups"
+ * and the payloads of one or more pcaps into memory, then for each search
+ * method builds a pattern matcher per port group and searches every
+ * payload with the groups Snort would pick for its protocol and ports.
+ * Reports build time, the matchers' own memory summary, throughput,
+ * cycles per byte and match counts, one line per method.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+
+#include <sys/types.h>
+#include <sys/time.h>
+#include <pcap.h>
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "snort.h"
+#include "util.h"
+#include "mpse.h"
+#include "pcrm.h"
+#include "cpuclock.h"
+
+#define FAILURE -1
+#define SUCCESS 0
+
+#define MAX_LINE_LENGTH 131072
+
+#define ETHERNET_HDR_LEN 14
+#define VLAN_HDR_LEN 4
+#define SLL_HDR_LEN 16
+#define IP6_HDR_LEN 40
+
+#ifndef DLT_LINUX_SLL
+#define DLT_LINUX_SLL 113
+#endif
+
+/* Snort searches at most a src, a dst and the any-any group per packet */
+#define MAX_PACKET_GROUPS 3
+
+typedef struct _BenchMethod
+{
+    const char *name;
+    int method;
+
+} BenchMethod;
+
+/* the names accepted by "config detection: search-method" */
+static const BenchMethod bench_methods[] =
+{
+    { "ac-std",         MPSE_AC },
+    { "ac-bnfa",        MPSE_AC_BNFA_Q },
+    { "ac-bnfa-nq",     MPSE_AC_BNFA },
+    { "ac",             MPSE_ACF_Q },
+    { "ac-nq",          MPSE_ACF },
+    { "acs",            MPSE_ACS },
+    { "ac-banded",      MPSE_ACB },
+    { "ac-sparsebands", MPSE_ACSB },
+    { "lowmem",         MPSE_LOWMEM_Q },
+    { "lowmem-nq",      MPSE_LOWMEM },
+    { NULL, 0 }
+};
+
+/* the rule maps in the dump, in the order fpdetect.c picks them */
+typedef enum _BenchProto
+{
+    BENCH_PROTO__TCP = 0,
+    BENCH_PROTO__UDP,
+    BENCH_PROTO__ICMP,
+    BENCH_PROTO__IP,
+    BENCH_PROTO__MAX
+
+} BenchProto;
+
+static const char *bench_protos[BENCH_PROTO__MAX] =
+{
+    "tcp", "udp", "icmp", "ip"
+};
+
+typedef struct _BenchPattern
+{
+    uint8_t *data;
+    int len;
+    int nocase;
+    int negated;
+    int id;
+    struct _BenchPattern *next;
+
+} BenchPattern;
+
+typedef struct _BenchGroup
+{
+    BenchPattern *patterns[PM_TYPE__MAX];
+    void *pms[PM_TYPE__MAX];
+
+} BenchGroup;
+
+/* group ids by port, 0 for none */
+typedef struct _BenchRuleMap
+{
+    unsigned src[MAX_PORTS];
+    unsigned dst[MAX_PORTS];
+    unsigned any;
+
+} BenchRuleMap;
+
+typedef struct _BenchPacket
+{
+    uint8_t *data;
+    unsigned len;
+    unsigned groups[MAX_PACKET_GROUPS];
+    int num_groups;
+
+} BenchPacket;
+
+typedef struct _BenchResult
+{
+    const char *name;
+    int patterns;
+    int matchers;
+    double build_usecs;
+    double search_usecs;
+    uint64_t search_ticks;
+    uint64_t matches;
+
+} BenchResult;
+
+static BenchGroup *groups = NULL;
+static unsigned num_groups = 0;
+static int num_patterns = 0;
+static int split_any_any = 0;
+
+static BenchRuleMap rule_maps[BENCH_PROTO__MAX];
+
+static BenchPacket *packets = NULL;
+static unsigned num_packets = 0;
+static unsigned max_packets = 0;
+static unsigned skipped_packets = 0;
+static uint64_t payload_bytes = 0;
+static uint64_t searched_bytes = 0;
+
+static int quiet = 0;
+
+/*
+ * The pattern matchers only need these few things from snort proper.
+ */
+static SnortConfig bench_conf;
+SnortConfig *snort_conf = &bench_conf;
+
+void LogMessage(const char *format, ...)
+{
+    va_list ap;
+
+    if (quiet)
+        return;
+
+    va_start(ap, format);
+    vfprintf(stdout, format, ap);
+    va_end(ap);
+}
+
+NORETURN void FatalError(const char *format, ...)
+{
+    va_list ap;
+
+    va_start(ap, format);
+    vfprintf(stderr, format, ap);
+    va_end(ap);
+
+    exit(EXIT_FAILURE);
+}
+
+#ifdef DEBUG_MSGS
+char *DebugMessageFile = NULL;
+int DebugMessageLine = 0;
+
+void DebugMessageFunc(uint64_t dbg, char *fmt, ...)
+{
+}
+
+#ifdef SF_WCHAR
+void DebugWideMessageFunc(uint64_t dbg, wchar_t *fmt, ...)
+{
+}
+#endif
+#endif
+
+static double GetUsecs(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return (double)tv.tv_sec * 1e6 + (double)tv.tv_usec;
+}
+
+/*
+ * Port groups
+ */
+
+static int HexValue(int c)
+{
+    if (isdigit(c))
+        return c - '0';
+
+    return toupper(c) - 'A' + 10;
+}
+
+static int GetProto(const char *name)
+{
+    int i;
+
+    for (i = 0; i < BENCH_PROTO__MAX; i++)
+    {
+        if (!strcmp(name, bench_protos[i]))
+            return i;
+    }
+    return -1;
+}
+
+static BenchGroup *GetGroup(unsigned id)
+{
+    if (id == 0)
+        return NULL;
+
+    if (id > num_groups)
+    {
+        groups = (BenchGroup *)realloc(groups, id * sizeof(*groups));
+
+        if (groups == NULL)
+            FatalError("Out of memory\n");
+
+        memset(groups + num_groups, 0, (id - num_groups) * sizeof(*groups));
+        num_groups = id;
+    }
+    return &groups[id - 1];
+}
+
+/* pattern <group> <pm type> <nocase> <negated> <hex bytes> */
+static int AddPattern(const char *args)
+{
+    BenchGroup *pg;
+    BenchPattern *bp;
+    unsigned id;
+    int type, nocase, negated, n = 0;
+    const char *hex;
+    size_t hex_len;
+    int i;
+
+    if ((sscanf(args, "%u %d %d %d %n", &id, &type, &nocase, &negated, &n) < 4)
+            || (n == 0) || (type < 0) || (type >= PM_TYPE__MAX))
+    {
+        return FAILURE;
+    }
+
+    hex = args + n;
+    hex_len = strspn(hex, "0123456789abcdefABCDEF");
+
+    if ((hex_len == 0) || (hex_len % 2)
+            || ((hex[hex_len] != '\0') && !isspace((int)hex[hex_len])))
+        return FAILURE;
+
+    pg = GetGroup(id);
+    if (pg == NULL)
+        return FAILURE;
+
+    bp = (BenchPattern *)calloc(1, sizeof(*bp));
+    if (bp == NULL)
+        FatalError("Out of memory\n");
+
+    bp->len = hex_len / 2;
+    bp->data = (uint8_t *)malloc(bp->len);
+    if (bp->data == NULL)
+        FatalError("Out of memory\n");
+
+    for (i = 0; i < bp->len; i++)
+        bp->data[i] = (uint8_t)((HexValue(hex[2*i]) << 4) | HexValue(hex[2*i+1]));
+
+    bp->nocase = nocase;
+    bp->negated = negated;
+    bp->id = ++num_patterns;
+    bp->next = pg->patterns[type];
+    pg->patterns[type] = bp;
+
+    return SUCCESS;
+}
+
+/* src|dst <proto> <port> <group> or any <proto> <group> */
+static int AddRuleMap(const char *line)
+{
+    char kind[8], proto_name[8];
+    unsigned id;
+    int port, proto;
+
+    if (sscanf(line, "%7s %7s", kind, proto_name) != 2)
+        return FAILURE;
+
+    if ((proto = GetProto(proto_name)) < 0)
+        return FAILURE;
+
+    if (!strcmp(kind, "any"))
+    {
+        if ((sscanf(line, "%*s %*s %u", &id) != 1) || (GetGroup(id) == NULL))
+            return FAILURE;
+
+        rule_maps[proto].any = id;
+        return SUCCESS;
+    }
+
+    if ((sscanf(line, "%*s %*s %d %u", &port, &id) != 2)
+            || (port < 0) || (port >= MAX_PORTS) || (GetGroup(id) == NULL))
+    {
+        return FAILURE;
+    }
+
+    if (!strcmp(kind, "src"))
+        rule_maps[proto].src[port] = id;
+    else if (!strcmp(kind, "dst"))
+        rule_maps[proto].dst[port] = id;
+    else
+        return FAILURE;
+
+    return SUCCESS;
+}
+
+static int LoadPatternGroups(const char *filename)
+{
+    FILE *fp = fopen(filename, "r");
+    char *line;
+    unsigned line_num = 0;
+    int ret = SUCCESS;
+
+    if (fp == NULL)
+    {
+        fprintf(stderr, "Error opening %s: %s\n", filename, strerror(errno));
+        return FAILURE;
+    }
+
+    line = (char *)malloc(MAX_LINE_LENGTH);
+    if (line == NULL)
+        FatalError("Out of memory\n");
+
+    while ((ret == SUCCESS) && (fgets(line, MAX_LINE_LENGTH, fp) != NULL))
+    {
+        line_num++;
+
+        if (strchr(line, '\n') == NULL && !feof(fp))
+        {
+            ret = FAILURE;
+        }
+        else if ((line[0] == '#') || (line[0] == '\n'))
+        {
+            continue;
+        }
+        else if (!strncmp(line, "pattern ", 8))
+        {
+            ret = AddPattern(line + 8);
+        }
+        else if (!strncmp(line, "split-any-any ", 14))
+        {
+            split_any_any = atoi(line + 14);
+        }
+        else
+        {
+            ret = AddRuleMap(line);
+        }
+    }
+
+    if (ret != SUCCESS)
+        fprintf(stderr, "%s(%u): invalid line\n", filename, line_num);
+
+    free(line);
+    fclose(fp);
+
+    return ret;
+}
+
+/* Picks the groups for a packet the way prmFindRuleGroup() does. */
+static void SelectGroups(BenchPacket *pkt, int proto, int sport, int dport)
+{
+    const BenchRuleMap *map = &rule_maps[proto];
+
+    pkt->num_groups = 0;
+
+    if (map->dst[dport])
+        pkt->groups[pkt->num_groups++] = map->dst[dport];
+
+    if ((sport >= 0) && map->src[sport])
+        pkt->groups[pkt->num_groups++] = map->src[sport];
+
+    if (map->any && (split_any_any || (pkt->num_groups == 0)))
+        pkt->groups[pkt->num_groups++] = map->any;
+}
+
+/*
+ * Packets
+ */
+
+static inline uint16_t Get16(const uint8_t *p)
+{
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+/* Finds the application payload of a frame and the rule map and ports
+ * Snort would look its port groups up with.  Returns NULL for anything
+ * that isn't ethernet, linux cooked or raw ip carrying ip4 or ip6. */
+static const uint8_t *GetPayload(int dlt, const uint8_t *pkt, unsigned caplen,
+        unsigned *len, int *proto, int *sport, int *dport)
+{
+    const uint8_t *end = pkt + caplen;
+    const uint8_t *l3 = pkt, *l4;
+    uint16_t type = 0;
+    uint8_t ip_proto;
+
+    switch (dlt)
+    {
+        case DLT_EN10MB:
+            if (caplen < ETHERNET_HDR_LEN)
+                return NULL;
+
+            type = Get16(pkt + 12);
+            l3 = pkt + ETHERNET_HDR_LEN;
+
+            while (type == ETHERNET_TYPE_8021Q && end - l3 >= VLAN_HDR_LEN)
+            {
+                type = Get16(l3 + 2);
+                l3 += VLAN_HDR_LEN;
+            }
+            break;
+
+        case DLT_LINUX_SLL:
+            if (caplen < SLL_HDR_LEN)
+                return NULL;
+
+            type = Get16(pkt + 14);
+            l3 = pkt + SLL_HDR_LEN;
+            break;
+
+        case DLT_RAW:
+            if (caplen < 1)
+                return NULL;
+
+            type = ((pkt[0] >> 4) == 6) ? ETHERNET_TYPE_IPV6 : ETHERNET_TYPE_IP;
+            break;
+
+        default:
+            return NULL;
+    }
+
+    if (type == ETHERNET_TYPE_IP)
+    {
+        unsigned hlen;
+
+        if (end - l3 < IP_HEADER_LEN)
+            return NULL;
+
+        hlen = (l3[0] & 0x0F) << 2;
+
+        if (hlen < IP_HEADER_LEN || end - l3 < (int)hlen)
+            return NULL;
+
+        ip_proto = l3[9];
+        l4 = l3 + hlen;
+
+        /* non-first fragments carry no transport header */
+        if (Get16(l3 + 6) & 0x1FFF)
+        {
+            *proto = BENCH_PROTO__IP;
+            *sport = -1;
+            *dport = ip_proto;
+            *len = end - l4;
+            return l4;
+        }
+    }
+    else if (type == ETHERNET_TYPE_IPV6)
+    {
+        if (end - l3 < IP6_HDR_LEN)
+            return NULL;
+
+        ip_proto = l3[6];
+        l4 = l3 + IP6_HDR_LEN;
+    }
+    else
+    {
+        return NULL;
+    }
+
+    if (ip_proto == IPPROTO_TCP && end - l4 >= TCP_HEADER_LEN)
+    {
+        unsigned hlen = (l4[12] >> 4) << 2;
+
+        *proto = BENCH_PROTO__TCP;
+        *sport = Get16(l4);
+        *dport = Get16(l4 + 2);
+
+        if (hlen >= TCP_HEADER_LEN && end - l4 >= (int)hlen)
+            l4 += hlen;
+    }
+    else if (ip_proto == IPPROTO_UDP && end - l4 >= UDP_HEADER_LEN)
+    {
+        *proto = BENCH_PROTO__UDP;
+        *sport = Get16(l4);
+        *dport = Get16(l4 + 2);
+        l4 += UDP_HEADER_LEN;
+    }
+    else if ((ip_proto == IPPROTO_ICMP || ip_proto == IPPROTO_ICMPV6)
+            && end - l4 >= ICMP_NORMAL_LEN)
+    {
+        *proto = BENCH_PROTO__ICMP;
+        *sport = -1;
+        *dport = l4[0];
+        l4 += ICMP_NORMAL_LEN;
+    }
+    else
+    {
+        *proto = BENCH_PROTO__IP;
+        *sport = -1;
+        *dport = ip_proto;
+    }
+
+    *len = end - l4;
+    return l4;
+}
+
+static int LoadPcap(const char *filename)
+{
+    char errbuf[PCAP_ERRBUF_SIZE];
+    struct pcap_pkthdr *hdr;
+    const u_char *pkt;
+    pcap_t *pcap;
+    int dlt, ret;
+
+    pcap = pcap_open_offline(filename, errbuf);
+    if (pcap == NULL)
+    {
+        fprintf(stderr, "Error opening %s: %s\n", filename, errbuf);
+        return FAILURE;
+    }
+
+    dlt = pcap_datalink(pcap);
+
+    while ((ret = pcap_next_ex(pcap, &hdr, &pkt)) == 1)
+    {
+        const uint8_t *payload;
+        unsigned len;
+        int proto, sport, dport;
+        BenchPacket *bp;
+
+        payload = GetPayload(dlt, pkt, hdr->caplen, &len, &proto, &sport, &dport);
+
+        /* the detection engine doesn't search empty payloads */
+        if ((payload == NULL) || (len == 0))
+        {
+            skipped_packets++;
+            continue;
+        }
+
+        if (num_packets == max_packets)
+        {
+            max_packets = max_packets ? max_packets * 2 : 1024;
+            packets = (BenchPacket *)realloc(packets, max_packets * sizeof(*packets));
+
+            if (packets == NULL)
+                FatalError("Out of memory\n");
+        }
+
+        bp = &packets[num_packets];
+        SelectGroups(bp, proto, sport, dport);
+
+        if (bp->num_groups == 0)
+        {
+            skipped_packets++;
+            continue;
+        }
+
+        bp->data = (uint8_t *)malloc(len);
+        if (bp->data == NULL)
+            FatalError("Out of memory\n");
+
+        memcpy(bp->data, payload, len);
+        bp->len = len;
+        payload_bytes += len;
+        searched_bytes += (uint64_t)len * bp->num_groups;
+        num_packets++;
+    }
+
+    if (ret == -1)
+        fprintf(stderr, "Error reading %s: %s\n", filename, pcap_geterr(pcap));
+
+    pcap_close(pcap);
+
+    return (ret == -1) ? FAILURE : SUCCESS;
+}
+
+/*
+ * Benchmark
+ */
+
+static int BenchMatch(void *id, void *tree, int index, void *data, void *neg_list)
+{
+    (*(uint64_t *)data)++;
+    return 0;
+}
+
+static void FreeMatchers(void)
+{
+    unsigned i;
+    int type;
+
+    for (i = 0; i < num_groups; i++)
+    {
+        for (type = 0; type < PM_TYPE__MAX; type++)
+        {
+            if (groups[i].pms[type] != NULL)
+            {
+                mpseFree(groups[i].pms[type]);
+                groups[i].pms[type] = NULL;
+            }
+        }
+    }
+}
+
+static int BuildMatchers(const BenchMethod *bm, BenchResult *res)
+{
+    BenchPattern *bp;
+    unsigned i;
+    int type;
+
+    for (i = 0; i < num_groups; i++)
+    {
+        for (type = 0; type < PM_TYPE__MAX; type++)
+        {
+            void *pm;
+
+            if (groups[i].patterns[type] == NULL)
+                continue;
+
+            pm = mpseNew(bm->method, MPSE_INCREMENT_GLOBAL_CNT, NULL, NULL, NULL);
+            if (pm == NULL)
+            {
+                fprintf(stderr, "Search method %s is not available\n", bm->name);
+                return FAILURE;
+            }
+
+            groups[i].pms[type] = pm;
+
+            for (bp = groups[i].patterns[type]; bp != NULL; bp = bp->next)
+            {
+                mpseAddPattern(pm, bp->data, bp->len, bp->nocase, 0, 0,
+                        bp->negated, (void *)bp, bp->id);
+            }
+
+            if (mpsePrepPatterns(pm, NULL, NULL) != 0)
+            {
+                fprintf(stderr, "Failed to compile patterns for %s\n", bm->name);
+                return FAILURE;
+            }
+
+            res->patterns += mpseGetPatternCount(pm);
+            res->matchers++;
+        }
+    }
+
+    return SUCCESS;
+}
+
+static int RunMethod(const BenchMethod *bm, int passes, BenchResult *res)
+{
+    double start;
+    uint64_t ticks_start = 0, ticks_end = 0;
+    unsigned i;
+    int pass, j;
+
+    memset(res, 0, sizeof(*res));
+    res->name = bm->name;
+
+    LogMessage("\n=== %s ===\n", bm->name);
+    mpseInitSummary();
+
+    start = GetUsecs();
+
+    if (BuildMatchers(bm, res) != SUCCESS)
+    {
+        FreeMatchers();
+        return FAILURE;
+    }
+
+    res->build_usecs = GetUsecs() - start;
+
+    mpsePrintSummary(bm->method);
+
+    start = GetUsecs();
+    get_clockticks(ticks_start);
+
+    /* only the packet payload is searched; the http buffers the other
+     * matchers are for are not available here */
+    for (pass = 0; pass < passes; pass++)
+    {
+        for (i = 0; i < num_packets; i++)
+        {
+            for (j = 0; j < packets[i].num_groups; j++)
+            {
+                void *pm = groups[packets[i].groups[j] - 1].pms[PM_TYPE__CONTENT];
+                int state = 0;
+
+                if (pm == NULL)
+                    continue;
+
+                mpseSearch(pm, packets[i].data, packets[i].len,
+                        BenchMatch, &res->matches, &state);
+            }
+        }
+    }
+
+    get_clockticks(ticks_end);
+    res->search_usecs = GetUsecs() - start;
+    res->search_ticks = ticks_end - ticks_start;
+
+    FreeMatchers();
+
+    return SUCCESS;
+}
+
+static void PrintResult(const BenchResult *res, int passes)
+{
+    double bytes = (double)payload_bytes * passes;
+    double mbps = 0.0, cpb = 0.0;
+    char matches[24];
+
+    if (res->search_usecs > 0)
+        mbps = bytes / res->search_usecs;
+
+    if (bytes > 0)
+        cpb = (double)res->search_ticks / bytes;
+
+    snprintf(matches, sizeof(matches), STDu64, res->matches);
+
+    printf("%-16s %9d %9d %10.2f %10.2f %10.2f %10.2f %14s\n",
+            res->name, res->matchers, res->patterns, res->build_usecs / 1000.0,
+            res->search_usecs / 1000.0, mbps, cpb, matches);
+}
+
+static void Usage(void)
+{
+    const BenchMethod *bm;
+
+    fprintf(stderr,
+            "Usage: mpse_bench [-q] [-n passes] [-m method[,method...]] "
+            "<pattern groups> <pcap> [pcap...]\n\n"
+            "The pattern groups file is written by Snort with\n"
+            "\"config detection: dump-pattern-groups <file>\".\n\n"
+            "Search methods:");
+
+    for (bm = bench_methods; bm->name != NULL; bm++)
+        fprintf(stderr, " %s", bm->name);
+
+    fprintf(stderr, "\n");
+}
+
+int main (int argc, char *argv[])
+{
+    const BenchMethod *run[sizeof(bench_methods) / sizeof(bench_methods[0])];
+    BenchResult results[sizeof(bench_methods) / sizeof(bench_methods[0])];
+    char *method_list = NULL;
+    int num_run = 0, num_results = 0;
+    int passes = 1;
+    int c, i;
+
+    opterr = 0;
+
+    while ((c = getopt(argc, argv, "m:n:q")) != -1)
+    {
+        switch (c)
+        {
+            case 'm':
+                method_list = optarg;
+                break;
+            case 'n':
+                passes = atoi(optarg);
+                if (passes <= 0)
+                {
+                    fprintf(stderr, "Invalid number of passes: %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'q':
+                quiet = 1;
+                break;
+            case '?':
+                if (optopt == 'm' || optopt == 'n')
+                    fprintf(stderr, "Option -%c requires an argument.\n", optopt);
+                else if (isprint(optopt))
+                    fprintf(stderr, "Unknown option -%c.\n", optopt);
+                Usage();
+                return EXIT_FAILURE;
+            default:
+                abort();
+        }
+    }
+
+    if (argc - optind < 2)
+    {
+        Usage();
+        return EXIT_FAILURE;
+    }
+
+    if (method_list == NULL)
+    {
+        const BenchMethod *bm;
+
+        for (bm = bench_methods; bm->name != NULL; bm++)
+            run[num_run++] = bm;
+    }
+    else
+    {
+        char *tok = strtok(method_list, ",");
+
+        for (; tok != NULL; tok = strtok(NULL, ","))
+        {
+            const BenchMethod *bm;
+
+            for (bm = bench_methods; bm->name != NULL; bm++)
+            {
+                if (!strcasecmp(tok, bm->name))
+                    break;
+            }
+
+            if (bm->name == NULL)
+            {
+                fprintf(stderr, "Unknown search method: %s\n", tok);
+                Usage();
+                return EXIT_FAILURE;
+            }
+
+            if (num_run < (int)(sizeof(run) / sizeof(run[0])) - 1)
+                run[num_run++] = bm;
+        }
+    }
+
+    if (LoadPatternGroups(argv[optind]) != SUCCESS)
+        return EXIT_FAILURE;
+
+    for (i = optind + 1; i < argc; i++)
+    {
+        if (LoadPcap(argv[i]) != SUCCESS)
+            return EXIT_FAILURE;
+    }
+
+    printf("%u port groups, %d fast patterns\n", num_groups, num_patterns);
+    printf("%u packets (%u skipped), " STDu64 " payload bytes, "
+            STDu64 " bytes searched, %d pass(es)\n",
+            num_packets, skipped_packets, payload_bytes, searched_bytes, passes);
+
+    for (i = 0; i < num_run; i++)
+    {
+        if (RunMethod(run[i], passes, &results[num_results]) == SUCCESS)
+            num_results++;
+    }
+
+    printf("\n%-16s %9s %9s %10s %10s %10s %10s %14s\n",
+            "method", "matchers", "patterns", "build-ms", "search-ms", "MB/s",
+            "ticks/byte", "matches");
+
+    for (i = 0; i < num_results; i++)
+        PrintResult(&results[i], passes);
+
+    return EXIT_SUCCESS;
+}